@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Times every call made through the layer, and reports per entry point how
+// often it was called, how long it took in total and its latency
+// percentiles. Every thread records to histograms of its own, which are
+// only merged when a report is written.
+
+#include "api_latency_functions.hpp"
+#include "latency_histogram.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::latency_histogram;
+
+constexpr size_t num_functions = sizeof(struct _cl_icd_dispatch) / sizeof(void *);
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+const char *function_names[num_functions];
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::standard_error, "cl_api_latency.log"};
+  // Seconds between reports, 0 only reports at exit.
+  unsigned report_interval = 0;
+  // Signal requesting a report, 0 for none.
+  int report_signal = 0;
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("api_latency", settings_from_file);
+
+  auto settings = layer_settings{};
+  settings.report.load(parser);
+  parser.get_unsigned("report_interval", settings.report_interval);
+  parser.get_enumeration("report_signal",
+                         std::map<std::string, int>{{"none", 0},
+#if !defined(_WIN32)
+                                                    {"SIGUSR1", SIGUSR1},
+                                                    {"SIGUSR2", SIGUSR2},
+#endif
+                                                   },
+                         settings.report_signal);
+  return settings;
+}
+
+layer_settings settings;
+
+// Histograms of the calls made by one thread, allocated on the first call
+// to each entry point. Only the owning thread records to them.
+struct thread_profile {
+  std::array<std::atomic<latency_histogram *>, num_functions> histograms;
+
+  thread_profile() {
+    for (auto &histogram : histograms)
+      histogram.store(nullptr, std::memory_order_relaxed);
+  }
+
+  ~thread_profile() {
+    for (auto &histogram : histograms)
+      delete histogram.load(std::memory_order_relaxed);
+  }
+
+  latency_histogram &get(size_t function) {
+    latency_histogram *histogram = histograms[function].load(std::memory_order_relaxed);
+    if (histogram == nullptr) {
+      histogram = new latency_histogram;
+      histograms[function].store(histogram, std::memory_order_release);
+    }
+    return *histogram;
+  }
+
+  void merge_into(std::vector<std::unique_ptr<latency_histogram>> &merged) const {
+    for (size_t i = 0; i < num_functions; ++i) {
+      const latency_histogram *histogram = histograms[i].load(std::memory_order_acquire);
+      if (histogram == nullptr)
+        continue;
+      if (!merged[i])
+        merged[i].reset(new latency_histogram);
+      merged[i]->merge(*histogram);
+    }
+  }
+};
+
+class profiler {
+public:
+  thread_profile *attach() {
+    auto profile = new thread_profile;
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(profile);
+    return profile;
+  }
+
+  // Keeps what profile recorded once its thread is gone.
+  void detach(thread_profile *profile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.erase(std::find(threads_.begin(), threads_.end(), profile));
+    for (size_t i = 0; i < num_functions; ++i) {
+      const latency_histogram *histogram = profile->histograms[i].load(std::memory_order_relaxed);
+      if (histogram != nullptr)
+        retired_.get(i).merge(*histogram);
+    }
+    delete profile;
+  }
+
+  void set_output(std::ostream *output) { output_ = output; }
+
+  void report(const char *reason);
+
+private:
+  std::mutex mutex_;
+  std::vector<thread_profile *> threads_;
+  thread_profile retired_;
+  std::ostream *output_ = &std::cerr;
+};
+
+void profiler::report(const char *reason) {
+  if (!output_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::unique_ptr<latency_histogram>> merged(num_functions);
+  retired_.merge_into(merged);
+  for (const thread_profile *profile : threads_)
+    profile->merge_into(merged);
+
+  std::vector<size_t> functions;
+  for (size_t i = 0; i < num_functions; ++i)
+    if (merged[i] && merged[i]->count() != 0)
+      functions.push_back(i);
+  std::sort(functions.begin(), functions.end(), [&merged](size_t a, size_t b) {
+    return merged[a]->total() > merged[b]->total();
+  });
+
+  std::ostream &out = *output_;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  const auto microseconds = [](uint64_t nanoseconds) { return nanoseconds / 1000.0; };
+  out << "api_latency report (" << reason << "), times in microseconds\n"
+      << std::left << std::setw(40) << "function" << std::right << std::setw(12) << "calls"
+      << std::setw(14) << "total" << std::setw(12) << "p50" << std::setw(12) << "p99"
+      << std::setw(12) << "p999" << std::setw(12) << "max" << '\n'
+      << std::fixed << std::setprecision(3);
+  for (size_t i : functions) {
+    const latency_histogram &histogram = *merged[i];
+    out << std::left << std::setw(40) << function_names[i] << std::right << std::setw(12)
+        << histogram.count() << std::setw(14) << microseconds(histogram.total()) << std::setw(12)
+        << microseconds(histogram.value_at_percentile(50.0)) << std::setw(12)
+        << microseconds(histogram.value_at_percentile(99.0)) << std::setw(12)
+        << microseconds(histogram.value_at_percentile(99.9)) << std::setw(12)
+        << microseconds(histogram.max()) << '\n';
+  }
+  out.flush();
+  out.flags(flags);
+  out.precision(precision);
+}
+
+profiler &state() {
+  return ocl_layer_utils::never_destroyed<profiler>();
+}
+
+// Plain pointer, so that the fast path does not go through the guard of a
+// thread_local object. Calls made after the thread's own thread_local
+// objects were destroyed, from static destructors for example, start a
+// new profile.
+thread_local thread_profile *profile = nullptr;
+
+struct thread_detach {
+  ~thread_detach() {
+    if (profile != nullptr)
+      state().detach(profile);
+    profile = nullptr;
+  }
+};
+
+thread_local thread_detach detach_at_exit;
+
+thread_profile &current_profile() {
+  if (profile == nullptr) {
+    profile = state().attach();
+    (void)&detach_at_exit;
+  }
+  return *profile;
+}
+
+class call_timer {
+public:
+  explicit call_timer(size_t function)
+      : function_(function), start_(std::chrono::steady_clock::now()) {}
+
+  ~call_timer() {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    current_profile().get(function_).record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+  }
+
+private:
+  size_t function_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Forwards calls to the member of the target dispatch table, timing them.
+template <typename Function, Function _cl_icd_dispatch::*Member, size_t Index>
+struct timed;
+
+template <typename Result, typename... Args, Result(CL_API_CALL *_cl_icd_dispatch::*Member)(Args...),
+          size_t Index>
+struct timed<Result(CL_API_CALL *)(Args...), Member, Index> {
+  static Result CL_API_CALL call(Args... args) {
+    const call_timer timer(Index);
+    return (tdispatch->*Member)(args...);
+  }
+};
+
+#define API_LATENCY_INDEX(name) (offsetof(struct _cl_icd_dispatch, name) / sizeof(void *))
+#define API_LATENCY_TIMED(name)                                                              \
+  dispatch.name = &timed<decltype(dispatch.name), &_cl_icd_dispatch::name,                 \
+                         API_LATENCY_INDEX(name)>::call;                                     \
+  function_names[API_LATENCY_INDEX(name)] = #name;
+
+void init_dispatch() {
+  API_LATENCY_FUNCTIONS(API_LATENCY_TIMED)
+#if defined(_WIN32)
+  API_LATENCY_WIN32_FUNCTIONS(API_LATENCY_TIMED)
+#endif
+}
+
+// Writes reports periodically and on request, in the background.
+std::atomic<bool> report_requested{false};
+std::atomic<bool> stop_reports{false};
+std::thread report_thread;
+
+extern "C" void request_report(int) { report_requested.store(true, std::memory_order_relaxed); }
+
+void run_reports(unsigned interval) {
+  auto next = std::chrono::steady_clock::now() + std::chrono::seconds(interval);
+  while (!stop_reports.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (report_requested.exchange(false, std::memory_order_relaxed)) {
+      state().report("signal");
+    } else if (interval != 0 && std::chrono::steady_clock::now() >= next) {
+      state().report("interval");
+      next += std::chrono::seconds(interval);
+    }
+  }
+}
+
+void report_at_exit() {
+  stop_reports.store(true, std::memory_order_relaxed);
+  if (report_thread.joinable())
+    report_thread.join();
+  state().report("exit");
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().set_output(settings.report.open("api_latency"));
+
+        tdispatch = target_dispatch;
+        init_dispatch();
+        if (settings.report_signal != 0)
+          std::signal(settings.report_signal, request_report);
+        if (settings.report_signal != 0 || settings.report_interval != 0)
+          report_thread = std::thread(run_reports, settings.report_interval);
+        atexit(report_at_exit);
+      });
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#pragma once
+
+// Entry points of struct _cl_icd_dispatch timed by the layer, grouped as in
+// the dispatch table. X(name) is expanded once per entry point.
+#define API_LATENCY_FUNCTIONS(X) \
+  X(clGetPlatformIDs) \
+  X(clGetPlatformInfo) \
+  X(clGetDeviceIDs) \
+  X(clGetDeviceInfo) \
+  X(clCreateContext) \
+  X(clCreateContextFromType) \
+  X(clRetainContext) \
+  X(clReleaseContext) \
+  X(clGetContextInfo) \
+  X(clCreateCommandQueue) \
+  X(clRetainCommandQueue) \
+  X(clReleaseCommandQueue) \
+  X(clGetCommandQueueInfo) \
+  X(clSetCommandQueueProperty) \
+  X(clCreateBuffer) \
+  X(clCreateImage2D) \
+  X(clCreateImage3D) \
+  X(clRetainMemObject) \
+  X(clReleaseMemObject) \
+  X(clGetSupportedImageFormats) \
+  X(clGetMemObjectInfo) \
+  X(clGetImageInfo) \
+  X(clCreateSampler) \
+  X(clRetainSampler) \
+  X(clReleaseSampler) \
+  X(clGetSamplerInfo) \
+  X(clCreateProgramWithSource) \
+  X(clCreateProgramWithBinary) \
+  X(clRetainProgram) \
+  X(clReleaseProgram) \
+  X(clBuildProgram) \
+  X(clUnloadCompiler) \
+  X(clGetProgramInfo) \
+  X(clGetProgramBuildInfo) \
+  X(clCreateKernel) \
+  X(clCreateKernelsInProgram) \
+  X(clRetainKernel) \
+  X(clReleaseKernel) \
+  X(clSetKernelArg) \
+  X(clGetKernelInfo) \
+  X(clGetKernelWorkGroupInfo) \
+  X(clWaitForEvents) \
+  X(clGetEventInfo) \
+  X(clRetainEvent) \
+  X(clReleaseEvent) \
+  X(clGetEventProfilingInfo) \
+  X(clFlush) \
+  X(clFinish) \
+  X(clEnqueueReadBuffer) \
+  X(clEnqueueWriteBuffer) \
+  X(clEnqueueCopyBuffer) \
+  X(clEnqueueReadImage) \
+  X(clEnqueueWriteImage) \
+  X(clEnqueueCopyImage) \
+  X(clEnqueueCopyImageToBuffer) \
+  X(clEnqueueCopyBufferToImage) \
+  X(clEnqueueMapBuffer) \
+  X(clEnqueueMapImage) \
+  X(clEnqueueUnmapMemObject) \
+  X(clEnqueueNDRangeKernel) \
+  X(clEnqueueTask) \
+  X(clEnqueueNativeKernel) \
+  X(clEnqueueMarker) \
+  X(clEnqueueWaitForEvents) \
+  X(clEnqueueBarrier) \
+  X(clGetExtensionFunctionAddress) \
+  X(clCreateFromGLBuffer) \
+  X(clCreateFromGLTexture2D) \
+  X(clCreateFromGLTexture3D) \
+  X(clCreateFromGLRenderbuffer) \
+  X(clGetGLObjectInfo) \
+  X(clGetGLTextureInfo) \
+  X(clEnqueueAcquireGLObjects) \
+  X(clEnqueueReleaseGLObjects) \
+  X(clGetGLContextInfoKHR) \
+  /* OpenCL 1.1 */ \
+  X(clSetEventCallback) \
+  X(clCreateSubBuffer) \
+  X(clSetMemObjectDestructorCallback) \
+  X(clCreateUserEvent) \
+  X(clSetUserEventStatus) \
+  X(clEnqueueReadBufferRect) \
+  X(clEnqueueWriteBufferRect) \
+  X(clEnqueueCopyBufferRect) \
+  /* cl_ext_device_fission */ \
+  X(clCreateSubDevicesEXT) \
+  X(clRetainDeviceEXT) \
+  X(clReleaseDeviceEXT) \
+  /* cl_khr_gl_event */ \
+  X(clCreateEventFromGLsyncKHR) \
+  /* OpenCL 1.2 */ \
+  X(clCreateSubDevices) \
+  X(clRetainDevice) \
+  X(clReleaseDevice) \
+  X(clCreateImage) \
+  X(clCreateProgramWithBuiltInKernels) \
+  X(clCompileProgram) \
+  X(clLinkProgram) \
+  X(clUnloadPlatformCompiler) \
+  X(clGetKernelArgInfo) \
+  X(clEnqueueFillBuffer) \
+  X(clEnqueueFillImage) \
+  X(clEnqueueMigrateMemObjects) \
+  X(clEnqueueMarkerWithWaitList) \
+  X(clEnqueueBarrierWithWaitList) \
+  X(clGetExtensionFunctionAddressForPlatform) \
+  X(clCreateFromGLTexture) \
+  /* cl_khr_egl_image */ \
+  X(clCreateFromEGLImageKHR) \
+  X(clEnqueueAcquireEGLObjectsKHR) \
+  X(clEnqueueReleaseEGLObjectsKHR) \
+  /* cl_khr_egl_event */ \
+  X(clCreateEventFromEGLSyncKHR) \
+  /* OpenCL 2.0 */ \
+  X(clCreateCommandQueueWithProperties) \
+  X(clCreatePipe) \
+  X(clGetPipeInfo) \
+  X(clSVMAlloc) \
+  X(clSVMFree) \
+  X(clEnqueueSVMFree) \
+  X(clEnqueueSVMMemcpy) \
+  X(clEnqueueSVMMemFill) \
+  X(clEnqueueSVMMap) \
+  X(clEnqueueSVMUnmap) \
+  X(clCreateSamplerWithProperties) \
+  X(clSetKernelArgSVMPointer) \
+  X(clSetKernelExecInfo) \
+  /* cl_khr_sub_groups */ \
+  X(clGetKernelSubGroupInfoKHR) \
+  /* OpenCL 2.1 */ \
+  X(clCloneKernel) \
+  X(clCreateProgramWithIL) \
+  X(clEnqueueSVMMigrateMem) \
+  X(clGetDeviceAndHostTimer) \
+  X(clGetHostTimer) \
+  X(clGetKernelSubGroupInfo) \
+  X(clSetDefaultDeviceCommandQueue) \
+  /* OpenCL 2.2 */ \
+  X(clSetProgramReleaseCallback) \
+  X(clSetProgramSpecializationConstant) \
+  /* OpenCL 3.0 */ \
+  X(clCreateBufferWithProperties) \
+  X(clCreateImageWithProperties) \
+  X(clSetContextDestructorCallback)
+
+// Direct3D and DirectX media sharing entry points only have a function type
+// on Windows.
+#define API_LATENCY_WIN32_FUNCTIONS(X) \
+  /* cl_khr_d3d10_sharing */ \
+  X(clGetDeviceIDsFromD3D10KHR) \
+  X(clCreateFromD3D10BufferKHR) \
+  X(clCreateFromD3D10Texture2DKHR) \
+  X(clCreateFromD3D10Texture3DKHR) \
+  X(clEnqueueAcquireD3D10ObjectsKHR) \
+  X(clEnqueueReleaseD3D10ObjectsKHR) \
+  /* cl_khr_d3d11_sharing */ \
+  X(clGetDeviceIDsFromD3D11KHR) \
+  X(clCreateFromD3D11BufferKHR) \
+  X(clCreateFromD3D11Texture2DKHR) \
+  X(clCreateFromD3D11Texture3DKHR) \
+  X(clCreateFromDX9MediaSurfaceKHR) \
+  X(clEnqueueAcquireD3D11ObjectsKHR) \
+  X(clEnqueueReleaseD3D11ObjectsKHR) \
+  /* cl_khr_dx9_media_sharing */ \
+  X(clGetDeviceIDsFromDX9MediaAdapterKHR) \
+  X(clEnqueueAcquireDX9MediaSurfacesKHR) \
+  X(clEnqueueReleaseDX9MediaSurfacesKHR)
@@ -0,0 +1,46 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+// Makes a known number of calls for the layer to report on.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_uint numPlatforms = 0;
+    cl_platform_id platform = NULL;
+    char name[256];
+    int i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        CL_err = clGetPlatformIDs(0, NULL, &numPlatforms);
+        checkErr(CL_err, "clGetPlatformIDs(numPlatforms)");
+    }
+    if (numPlatforms == 0)
+    {
+        printf("No OpenCL platform detected.\n");
+        exit( -1 );
+    }
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs(platform)");
+    CL_err = clGetPlatformInfo(platform, CL_PLATFORM_NAME, sizeof(name), name, NULL);
+    checkErr(CL_err, "clGetPlatformInfo(CL_PLATFORM_NAME)");
+    printf("Made 5 calls\n");
+
+    return 0;
+}
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Skips clSetKernelArg and clSetKernelArgSVMPointer calls that set an
+// argument to the value it already has, for applications setting every
+// argument before every launch. The layer remembers the last value set for
+// each argument of each kernel, values of up to inline_capacity bytes are
+// compared, larger ones are always passed through.
+//
+// A handle in an argument may name another object once the object it named
+// was released, so values of the size of a pointer also remember how many
+// times the handle they hold was released when they were set, and are only
+// compared while that did not change. SVM pointers do the same with the
+// frees of the allocation containing them, pointers outside of the
+// allocations made through clSVMAlloc are always passed through.
+
+#include "handle_registry.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::handle_registry;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::none, "cl_arg_elision.log"};
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("arg_elision", settings_from_file);
+
+  auto settings = layer_settings{};
+  settings.report.load(parser);
+  return settings;
+}
+
+layer_settings settings;
+
+// Large enough for handles and vectors of up to 16 floats.
+constexpr size_t inline_capacity = 64;
+
+// Releases of handles and frees of SVM pointers, hashed into a fixed number
+// of counters. Handles sharing a counter only elide fewer calls.
+class release_counters {
+public:
+  uint32_t of(const void *handle) const {
+    return counters_[index(handle)].load(std::memory_order_acquire);
+  }
+
+  void released(const void *handle) {
+    counters_[index(handle)].fetch_add(1, std::memory_order_acq_rel);
+  }
+
+private:
+  static constexpr size_t size = 4096;
+
+  static size_t index(const void *handle) {
+    const auto key = reinterpret_cast<uintptr_t>(handle) >> 3;
+    return static_cast<size_t>((key ^ (key >> 17)) * UINT64_C(0x9E3779B97F4A7C15) >> 32) &
+           (size - 1);
+  }
+
+  std::atomic<uint32_t> counters_[size] = {};
+};
+
+// Live allocations of clSVMAlloc, for arguments pointing inside of them to
+// be tracked by the allocation.
+class svm_allocations {
+public:
+  void insert(const void *base, size_t size) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    ranges_[reinterpret_cast<uintptr_t>(base)] = size;
+  }
+
+  void erase(const void *base) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    ranges_.erase(reinterpret_cast<uintptr_t>(base));
+  }
+
+  // The base of the allocation containing pointer, or nullptr.
+  const void *base_of(const void *pointer) const {
+    const auto address = reinterpret_cast<uintptr_t>(pointer);
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    auto it = ranges_.upper_bound(address);
+    if (it == ranges_.begin())
+      return nullptr;
+    --it;
+    if (address - it->first >= it->second)
+      return nullptr;
+    return reinterpret_cast<const void *>(it->first);
+  }
+
+private:
+  mutable std::shared_timed_mutex mutex_;
+  std::map<uintptr_t, size_t> ranges_;
+};
+
+// The last value set for an argument.
+struct arg_shadow {
+  enum class kind : unsigned char { unset, value, local, svm };
+
+  kind type = kind::unset;
+  // Bytes of the value, or of local memory for local arguments.
+  size_t size = 0;
+  // For values of the size of a pointer and SVM pointers, the releases of
+  // the handle or frees of the allocation when they were set.
+  uint32_t releases = 0;
+  unsigned char bytes[inline_capacity];
+};
+
+struct kernel_args {
+  std::vector<arg_shadow> args;
+};
+
+struct elision_state {
+  handle_registry<kernel_args> kernels;
+  release_counters releases;
+  svm_allocations allocations;
+  std::atomic<uint64_t> calls{0}, elided{0}, svm_calls{0}, svm_elided{0};
+};
+
+elision_state &state() {
+  return ocl_layer_utils::never_destroyed<elision_state>();
+}
+
+const void *handle_in(const void *arg_value, size_t arg_size) {
+  const void *handle = nullptr;
+  if (arg_value && arg_size == sizeof(handle))
+    std::memcpy(&handle, arg_value, sizeof(handle));
+  return handle;
+}
+
+// The shadow for a call setting arg_value, type unset if the call cannot be
+// elided.
+arg_shadow shadow_of(arg_shadow::kind type, size_t arg_size, const void *arg_value) {
+  arg_shadow shadow;
+  if (type == arg_shadow::kind::svm) {
+    const void *base = state().allocations.base_of(arg_value);
+    if (!base)
+      return shadow;
+    shadow.type = type;
+    shadow.size = sizeof(arg_value);
+    shadow.releases = state().releases.of(base);
+    std::memcpy(shadow.bytes, &arg_value, sizeof(arg_value));
+  } else if (!arg_value) {
+    shadow.type = arg_shadow::kind::local;
+    shadow.size = arg_size;
+  } else if (arg_size <= inline_capacity) {
+    shadow.type = arg_shadow::kind::value;
+    shadow.size = arg_size;
+    shadow.releases = state().releases.of(handle_in(arg_value, arg_size));
+    std::memcpy(shadow.bytes, arg_value, arg_size);
+  }
+  return shadow;
+}
+
+bool same(const arg_shadow &a, const arg_shadow &b) {
+  return a.type != arg_shadow::kind::unset && a.type == b.type && a.size == b.size &&
+         a.releases == b.releases &&
+         (a.type == arg_shadow::kind::local || std::memcmp(a.bytes, b.bytes, a.size) == 0);
+}
+
+// Whether arg_index of kernel was last set to shadow.
+bool already_set(cl_kernel kernel, cl_uint arg_index, const arg_shadow &shadow) {
+  if (shadow.type == arg_shadow::kind::unset)
+    return false;
+  bool result = false;
+  state().kernels.find(kernel, [&](const handle_registry<kernel_args>::entry &entry) {
+    result = arg_index < entry.payload.args.size() &&
+             same(entry.payload.args[arg_index], shadow);
+  });
+  return result;
+}
+
+void remember(cl_kernel kernel, cl_uint arg_index, const arg_shadow &shadow) {
+  state().kernels.update(kernel, [&](kernel_args &args) {
+    if (arg_index >= args.args.size())
+      args.args.resize(arg_index + 1);
+    args.args[arg_index] = shadow;
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg_wrap(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    size_t arg_size,
+    const void *arg_value) {
+  state().calls.fetch_add(1, std::memory_order_relaxed);
+  const arg_shadow shadow = shadow_of(arg_shadow::kind::value, arg_size, arg_value);
+  if (already_set(kernel, arg_index, shadow)) {
+    state().elided.fetch_add(1, std::memory_order_relaxed);
+    return CL_SUCCESS;
+  }
+  const cl_int result = tdispatch->clSetKernelArg(kernel, arg_index, arg_size, arg_value);
+  // A failed call may leave the argument in any state.
+  remember(kernel, arg_index, result == CL_SUCCESS ? shadow : arg_shadow{});
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer_wrap(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    const void *arg_value) {
+  state().svm_calls.fetch_add(1, std::memory_order_relaxed);
+  const arg_shadow shadow = shadow_of(arg_shadow::kind::svm, 0, arg_value);
+  if (already_set(kernel, arg_index, shadow)) {
+    state().svm_elided.fetch_add(1, std::memory_order_relaxed);
+    return CL_SUCCESS;
+  }
+  const cl_int result = tdispatch->clSetKernelArgSVMPointer(kernel, arg_index, arg_value);
+  remember(kernel, arg_index, result == CL_SUCCESS ? shadow : arg_shadow{});
+  return result;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel_wrap(
+    cl_program program,
+    const char *kernel_name,
+    cl_int *errcode_ret) {
+  cl_kernel kernel = tdispatch->clCreateKernel(program, kernel_name, errcode_ret);
+  if (kernel)
+    state().kernels.on_create(kernel, kernel_args{});
+  return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram_wrap(
+    cl_program program,
+    cl_uint num_kernels,
+    cl_kernel *kernels,
+    cl_uint *num_kernels_ret) {
+  cl_uint created = 0;
+  const cl_int result = tdispatch->clCreateKernelsInProgram(program, num_kernels, kernels, &created);
+  if (num_kernels_ret)
+    *num_kernels_ret = created;
+  if (result == CL_SUCCESS && kernels != nullptr)
+    for (cl_uint i = 0; i < created; ++i)
+      state().kernels.on_create(kernels[i], kernel_args{});
+  return result;
+}
+
+// Clones start with the arguments of their source kernel.
+CL_API_ENTRY cl_kernel CL_API_CALL clCloneKernel_wrap(
+    cl_kernel source_kernel,
+    cl_int *errcode_ret) {
+  cl_kernel kernel = tdispatch->clCloneKernel(source_kernel, errcode_ret);
+  if (kernel) {
+    kernel_args args;
+    state().kernels.find(source_kernel, [&args](const handle_registry<kernel_args>::entry &entry) {
+      args = entry.payload;
+    });
+    state().kernels.on_create(kernel, std::move(args));
+  }
+  return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
+    cl_kernel kernel) {
+  const cl_int result = tdispatch->clRetainKernel(kernel);
+  if (result == CL_SUCCESS)
+    state().kernels.on_retain(kernel);
+  return result;
+}
+
+// The handle of a released kernel may be handed out for a new one, which
+// must not inherit the arguments.
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel_wrap(
+    cl_kernel kernel) {
+  state().kernels.on_release(kernel);
+  return tdispatch->clReleaseKernel(kernel);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject_wrap(
+    cl_mem memobj) {
+  state().releases.released(memobj);
+  return tdispatch->clReleaseMemObject(memobj);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseSampler_wrap(
+    cl_sampler sampler) {
+  state().releases.released(sampler);
+  return tdispatch->clReleaseSampler(sampler);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue_wrap(
+    cl_command_queue command_queue) {
+  state().releases.released(command_queue);
+  return tdispatch->clReleaseCommandQueue(command_queue);
+}
+
+void svm_freed(const void *svm_pointer) {
+  if (!svm_pointer)
+    return;
+  state().releases.released(svm_pointer);
+  state().allocations.erase(svm_pointer);
+}
+
+CL_API_ENTRY void *CL_API_CALL clSVMAlloc_wrap(
+    cl_context context,
+    cl_svm_mem_flags flags,
+    size_t size,
+    cl_uint alignment) {
+  void *pointer = tdispatch->clSVMAlloc(context, flags, size, alignment);
+  if (pointer)
+    state().allocations.insert(pointer, size);
+  return pointer;
+}
+
+CL_API_ENTRY void CL_API_CALL clSVMFree_wrap(
+    cl_context context,
+    void *svm_pointer) {
+  svm_freed(svm_pointer);
+  tdispatch->clSVMFree(context, svm_pointer);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMFree_wrap(
+    cl_command_queue command_queue,
+    cl_uint num_svm_pointers,
+    void *svm_pointers[],
+    void(CL_CALLBACK *pfn_free_func)(cl_command_queue queue, cl_uint num_svm_pointers,
+                                     void *svm_pointers[], void *user_data),
+    void *user_data,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  for (cl_uint i = 0; svm_pointers && i < num_svm_pointers; ++i)
+    svm_freed(svm_pointers[i]);
+  return tdispatch->clEnqueueSVMFree(command_queue, num_svm_pointers, svm_pointers,
+                                     pfn_free_func, user_data, num_events_in_wait_list,
+                                     event_wait_list, event);
+}
+
+void init_dispatch() {
+  dispatch.clSetKernelArg = &clSetKernelArg_wrap;
+  dispatch.clSetKernelArgSVMPointer = &clSetKernelArgSVMPointer_wrap;
+  dispatch.clCreateKernel = &clCreateKernel_wrap;
+  dispatch.clCreateKernelsInProgram = &clCreateKernelsInProgram_wrap;
+  dispatch.clCloneKernel = &clCloneKernel_wrap;
+  dispatch.clRetainKernel = &clRetainKernel_wrap;
+  dispatch.clReleaseKernel = &clReleaseKernel_wrap;
+  dispatch.clReleaseMemObject = &clReleaseMemObject_wrap;
+  dispatch.clReleaseSampler = &clReleaseSampler_wrap;
+  dispatch.clReleaseCommandQueue = &clReleaseCommandQueue_wrap;
+  dispatch.clSVMAlloc = &clSVMAlloc_wrap;
+  dispatch.clSVMFree = &clSVMFree_wrap;
+  dispatch.clEnqueueSVMFree = &clEnqueueSVMFree_wrap;
+}
+
+std::ostream *output = nullptr;
+
+void report(uint64_t calls, uint64_t elided) {
+  *output << calls << " calls, " << elided << " elided (" << std::fixed << std::setprecision(1)
+          << (calls ? 100.0 * static_cast<double>(elided) / static_cast<double>(calls) : 0.0)
+          << "%)\n";
+}
+
+void report_at_exit() {
+  if (!output)
+    return;
+  *output << "arg_elision report\n"
+          << "clSetKernelArg: ";
+  report(state().calls, state().elided);
+  *output << "clSetKernelArgSVMPointer: ";
+  report(state().svm_calls, state().svm_elided);
+  output->flush();
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        output = settings.report.open("arg_elision");
+
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(report_at_exit);
+      });
+}
@@ -0,0 +1,135 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+// Sets every argument before every launch, for the layer to skip the calls
+// that do not change anything, and changes arguments in the ways that must
+// still reach the implementation.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_command_queue queue = NULL;
+    cl_mem buffer = NULL;
+    cl_program program = NULL;
+    cl_kernel saxpy = NULL, clone = NULL;
+    const char *source = "kernel void saxpy(global float *y, float a) {}";
+    size_t global_work_size = 64;
+    float a = 2.0f;
+    void *svm = NULL;
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+    queue = clCreateCommandQueue(context, device, 0, &CL_err);
+    checkErr(CL_err, "clCreateCommandQueue");
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 64 * sizeof(float), NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer");
+    program = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+    checkErr(CL_err, "clCreateProgramWithSource");
+    CL_err = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
+    checkErr(CL_err, "clBuildProgram");
+    saxpy = clCreateKernel(program, "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+
+    for (i = 0; i < 5; ++i)
+    {
+        CL_err = clSetKernelArg(saxpy, 0, sizeof(buffer), &buffer);
+        checkErr(CL_err, "clSetKernelArg(0)");
+        CL_err = clSetKernelArg(saxpy, 1, sizeof(a), &a);
+        checkErr(CL_err, "clSetKernelArg(1)");
+        CL_err = clEnqueueNDRangeKernel(queue, saxpy, 1, NULL, &global_work_size, NULL, 0, NULL, NULL);
+        checkErr(CL_err, "clEnqueueNDRangeKernel");
+    }
+    printf("Launched 5 kernels\n");
+
+    // A new value, then local memory of the same and of another size
+    a = 3.0f;
+    CL_err = clSetKernelArg(saxpy, 1, sizeof(a), &a);
+    checkErr(CL_err, "clSetKernelArg(1, 3.0f)");
+    CL_err = clSetKernelArg(saxpy, 1, 64, NULL);
+    checkErr(CL_err, "clSetKernelArg(1, local 64)");
+    CL_err = clSetKernelArg(saxpy, 1, 64, NULL);
+    checkErr(CL_err, "clSetKernelArg(1, local 64)");
+    CL_err = clSetKernelArg(saxpy, 1, 128, NULL);
+    checkErr(CL_err, "clSetKernelArg(1, local 128)");
+
+    // Clones have the arguments of their source
+    clone = clCloneKernel(saxpy, &CL_err);
+    checkErr(CL_err, "clCloneKernel");
+    CL_err = clSetKernelArg(clone, 0, sizeof(buffer), &buffer);
+    checkErr(CL_err, "clSetKernelArg(clone, 0)");
+    clReleaseKernel(clone);
+
+    // The new buffer may get the handle of the released one
+    clReleaseMemObject(buffer);
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 64 * sizeof(float), NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer");
+    CL_err = clSetKernelArg(saxpy, 0, sizeof(buffer), &buffer);
+    checkErr(CL_err, "clSetKernelArg(0, new buffer)");
+
+    svm = clSVMAlloc(context, CL_MEM_READ_WRITE, 64 * sizeof(float), 0);
+    if (!svm)
+        checkErr(CL_OUT_OF_RESOURCES, "clSVMAlloc");
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, svm);
+    checkErr(CL_err, "clSetKernelArgSVMPointer");
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, svm);
+    checkErr(CL_err, "clSetKernelArgSVMPointer");
+    clSVMFree(context, svm);
+    svm = clSVMAlloc(context, CL_MEM_READ_WRITE, 64 * sizeof(float), 0);
+    if (!svm)
+        checkErr(CL_OUT_OF_RESOURCES, "clSVMAlloc");
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, svm);
+    checkErr(CL_err, "clSetKernelArgSVMPointer(new pointer)");
+
+    // A pointer inside of an allocation is not elided once the allocation
+    // was freed, even if the new one starts at the same address
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, (char *)svm + 16);
+    checkErr(CL_err, "clSetKernelArgSVMPointer(interior)");
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, (char *)svm + 16);
+    checkErr(CL_err, "clSetKernelArgSVMPointer(interior)");
+    clSVMFree(context, svm);
+    svm = clSVMAlloc(context, CL_MEM_READ_WRITE, 64 * sizeof(float), 0);
+    if (!svm)
+        checkErr(CL_OUT_OF_RESOURCES, "clSVMAlloc");
+    CL_err = clSetKernelArgSVMPointer(saxpy, 0, (char *)svm + 16);
+    checkErr(CL_err, "clSetKernelArgSVMPointer(interior, new pointer)");
+    clSVMFree(context, svm);
+
+    // A kernel that gets the handle of a released one starts over
+    clReleaseKernel(saxpy);
+    saxpy = clCreateKernel(program, "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+    CL_err = clSetKernelArg(saxpy, 0, sizeof(buffer), &buffer);
+    checkErr(CL_err, "clSetKernelArg(0, new kernel)");
+
+    CL_err = clFinish(queue);
+    checkErr(CL_err, "clFinish");
+    clReleaseKernel(saxpy);
+    clReleaseProgram(program);
+    clReleaseMemObject(buffer);
+    clReleaseCommandQueue(queue);
+    clReleaseContext(context);
+
+    return 0;
+}
@@ -0,0 +1,929 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Recycles buffers for applications that create and release transient
+// buffers over and over. Buffers created without a host pointer are
+// allocated with their size rounded up to a size class, and when the
+// application releases its last reference they go to a free list of their
+// context, flags and size class instead of being released. Later buffers
+// of the same context, flags and size class are served from that list.
+//
+// The layer keeps the reference counts and sizes the application sees, the
+// implementation only ever sees one reference. Commands that were enqueued
+// before a buffer was released may still use it, so a marker is enqueued on
+// every queue of its context when it is pooled, and the buffer is only
+// handed out again once all of them completed.
+//
+// The implementation only knows the size of the class, so the commands
+// reading, writing, copying, filling or mapping part of a buffer are
+// checked against the size the application asked for. Kernels may still
+// reach past it unnoticed. Buffers with sub-buffers or images created from
+// them are never pooled, so what those reach is not handed out again.
+
+#include "handle_registry.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::handle_registry;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  // MiB of pooled buffers over all contexts.
+  unsigned max_size = 256;
+  // Percent of the global memory of the smallest device of a context above
+  // which buffers are not pooled.
+  unsigned max_buffer_percent = 5;
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::none, "cl_buffer_pool.log"};
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("buffer_pool", settings_from_file);
+
+  auto settings = layer_settings{};
+  parser.get_unsigned("max_size", settings.max_size);
+  parser.get_unsigned("max_buffer_percent", settings.max_buffer_percent);
+  settings.report.load(parser);
+  return settings;
+}
+
+layer_settings settings;
+
+// Sizes up to 64 bytes share a class, above that every power of two is
+// split into four classes, so a buffer wastes at most a quarter of its size.
+size_t size_class(size_t size) {
+  if (size <= 64)
+    return 64;
+  size_t power = 64;
+  while (power < size / 2 + size % 2)
+    power *= 2;
+  const size_t step = power / 4;
+  return (size + step - 1) / step * step;
+}
+
+// Buffers the application holds references to that were allocated with the
+// size of their class.
+struct buffer_info {
+  cl_context context = nullptr;
+  cl_mem_flags flags = 0;
+  // The size the application asked for.
+  size_t size = 0;
+  size_t class_size = 0;
+  // Cleared for buffers that others may still refer to after the
+  // application released them, which are then released for real.
+  bool poolable = true;
+};
+
+class pool_state {
+public:
+  // Whether buffers of class_size are pooled in context.
+  bool admits(cl_context context, size_t class_size);
+
+  // Takes a buffer out of the free list of context, flags and class_size
+  // whose commands completed, or returns null.
+  cl_mem take(cl_context context, cl_mem_flags flags, size_t class_size);
+
+  // Puts buffer in its free list, or releases it if it cannot be pooled.
+  void put(cl_mem buffer, const buffer_info &info);
+
+  // Releases the buffers pooled for context.
+  void flush(cl_context context);
+
+  void add_queue(cl_context context, cl_command_queue queue);
+  void remove_queue(cl_command_queue queue);
+
+  void count_request(bool admitted);
+
+  void set_output(std::ostream *output) { output_ = output; }
+  void report();
+
+  handle_registry<buffer_info> buffers;
+  // Contexts and queues mapped to the context they belong to, to know when
+  // the application released them.
+  handle_registry<cl_context> contexts;
+  handle_registry<cl_context> queues;
+
+private:
+  using pool_key = std::tuple<cl_context, cl_mem_flags, size_t>;
+
+  struct pooled {
+    pool_key key;
+    cl_mem buffer;
+    // Markers enqueued on the queues of the context when it was pooled.
+    std::vector<cl_event> markers;
+  };
+
+  using lru_list = std::list<pooled>;
+
+  // Removes entry from the pool and returns what to release, with mutex_
+  // held.
+  void remove(lru_list::iterator entry, std::vector<cl_mem> &released_buffers,
+              std::vector<cl_event> &released_events);
+
+  static void release(const std::vector<cl_mem> &released_buffers,
+                      const std::vector<cl_event> &released_events);
+
+  std::mutex mutex_;
+  // From the least to the most recently released.
+  lru_list lru_;
+  std::map<pool_key, std::vector<lru_list::iterator>> free_lists_;
+  std::map<cl_context, std::vector<cl_command_queue>> context_queues_;
+  // Smallest CL_DEVICE_GLOBAL_MEM_SIZE of the devices of each context.
+  std::map<cl_context, cl_ulong> global_mem_sizes_;
+  uint64_t bytes_ = 0;
+  uint64_t requests_ = 0, hits_ = 0, not_admitted_ = 0, pooled_ = 0, trimmed_ = 0,
+           flushed_ = 0;
+  std::ostream *output_ = nullptr;
+};
+
+pool_state &state() {
+  return ocl_layer_utils::never_destroyed<pool_state>();
+}
+
+cl_ulong smallest_global_mem_size(cl_context context) {
+  size_t devices_size = 0;
+  if (tdispatch->clGetContextInfo(context, CL_CONTEXT_DEVICES, 0, nullptr, &devices_size) !=
+          CL_SUCCESS ||
+      devices_size == 0)
+    return 0;
+  std::vector<cl_device_id> devices(devices_size / sizeof(cl_device_id));
+  if (tdispatch->clGetContextInfo(context, CL_CONTEXT_DEVICES, devices_size, devices.data(),
+                                  nullptr) != CL_SUCCESS)
+    return 0;
+  cl_ulong smallest = ~cl_ulong(0);
+  for (cl_device_id device : devices) {
+    cl_ulong global_mem_size = 0;
+    if (tdispatch->clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(global_mem_size),
+                                   &global_mem_size, nullptr) != CL_SUCCESS)
+      return 0;
+    smallest = std::min(smallest, global_mem_size);
+  }
+  return smallest;
+}
+
+bool pool_state::admits(cl_context context, size_t class_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = global_mem_sizes_.find(context);
+  if (it == global_mem_sizes_.end())
+    it = global_mem_sizes_.emplace(context, smallest_global_mem_size(context)).first;
+  return class_size <= settings.max_size * uint64_t(1024 * 1024) &&
+         class_size * 100.0 <= it->second * static_cast<double>(settings.max_buffer_percent);
+}
+
+void pool_state::count_request(bool admitted) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (admitted)
+    ++requests_;
+  else
+    ++not_admitted_;
+}
+
+bool completed(cl_event marker) {
+  cl_int status = CL_QUEUED;
+  if (tdispatch->clGetEventInfo(marker, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status),
+                                &status, nullptr) != CL_SUCCESS)
+    return false;
+  // Negative values are errors, the commands are done with the buffer.
+  return status <= CL_COMPLETE;
+}
+
+void pool_state::remove(lru_list::iterator entry, std::vector<cl_mem> &released_buffers,
+                        std::vector<cl_event> &released_events) {
+  auto list = free_lists_.find(entry->key);
+  list->second.erase(std::find(list->second.begin(), list->second.end(), entry));
+  if (list->second.empty())
+    free_lists_.erase(list);
+  bytes_ -= std::get<2>(entry->key);
+  released_buffers.push_back(entry->buffer);
+  released_events.insert(released_events.end(), entry->markers.begin(), entry->markers.end());
+  lru_.erase(entry);
+}
+
+void pool_state::release(const std::vector<cl_mem> &released_buffers,
+                         const std::vector<cl_event> &released_events) {
+  for (cl_event marker : released_events)
+    tdispatch->clReleaseEvent(marker);
+  for (cl_mem buffer : released_buffers)
+    tdispatch->clReleaseMemObject(buffer);
+}
+
+cl_mem pool_state::take(cl_context context, cl_mem_flags flags, size_t class_size) {
+  std::vector<cl_mem> taken;
+  std::vector<cl_event> markers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto list = free_lists_.find(pool_key(context, flags, class_size));
+    if (list == free_lists_.end())
+      return nullptr;
+    // Most recently released first, its memory is the most likely to be
+    // resident still.
+    for (auto it = list->second.rbegin(); it != list->second.rend(); ++it) {
+      const auto entry = *it;
+      if (std::all_of(entry->markers.begin(), entry->markers.end(), completed)) {
+        remove(entry, taken, markers);
+        ++hits_;
+        break;
+      }
+    }
+  }
+  release({}, markers);
+  return taken.empty() ? nullptr : taken.front();
+}
+
+void pool_state::put(cl_mem buffer, const buffer_info &info) {
+  std::vector<cl_mem> released_buffers;
+  std::vector<cl_event> released_events;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pooled entry{pool_key(info.context, info.flags, info.class_size), buffer, {}};
+    bool marked = true;
+    for (cl_command_queue queue : context_queues_[info.context]) {
+      cl_event marker = nullptr;
+      marked = tdispatch->clEnqueueMarkerWithWaitList(queue, 0, nullptr, &marker) == CL_SUCCESS;
+      if (!marked)
+        break;
+      entry.markers.push_back(marker);
+    }
+    if (!marked) {
+      released_buffers.push_back(buffer);
+      released_events = std::move(entry.markers);
+    } else {
+      lru_.push_back(std::move(entry));
+      free_lists_[lru_.back().key].push_back(std::prev(lru_.end()));
+      bytes_ += info.class_size;
+      ++pooled_;
+      // The least recently released buffers make room.
+      const uint64_t budget = settings.max_size * uint64_t(1024 * 1024);
+      while (bytes_ > budget) {
+        remove(lru_.begin(), released_buffers, released_events);
+        ++trimmed_;
+      }
+    }
+  }
+  release(released_buffers, released_events);
+}
+
+void pool_state::flush(cl_context context) {
+  std::vector<cl_mem> released_buffers;
+  std::vector<cl_event> released_events;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+      const auto entry = it++;
+      if (std::get<0>(entry->key) == context) {
+        remove(entry, released_buffers, released_events);
+        ++flushed_;
+      }
+    }
+    context_queues_.erase(context);
+    global_mem_sizes_.erase(context);
+  }
+  release(released_buffers, released_events);
+}
+
+// The markers for pooled buffers are enqueued under mutex_, so that queues
+// are not released while they are.
+void pool_state::add_queue(cl_context context, cl_command_queue queue) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  context_queues_[context].push_back(queue);
+}
+
+void pool_state::remove_queue(cl_command_queue queue) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &context : context_queues_) {
+    auto it = std::find(context.second.begin(), context.second.end(), queue);
+    if (it != context.second.end()) {
+      context.second.erase(it);
+      return;
+    }
+  }
+}
+
+void pool_state::report() {
+  if (!output_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostream &out = *output_;
+  out << "buffer_pool report\n"
+      << "requests: " << requests_ << '\n'
+      << "hits: " << hits_ << " (" << std::fixed << std::setprecision(1)
+      << (requests_ ? 100.0 * static_cast<double>(hits_) / static_cast<double>(requests_) : 0.0)
+      << "%)\n"
+      << "misses: " << requests_ - hits_ << '\n'
+      << "not admitted: " << not_admitted_ << '\n'
+      << "pooled: " << pooled_ << '\n'
+      << "trimmed: " << trimmed_ << '\n'
+      << "flushed: " << flushed_ << '\n'
+      << "pooled at exit: " << lru_.size() << " buffers, " << bytes_ << " bytes\n";
+  out.flush();
+}
+
+// Serves a buffer from the pool, or creates one of the size of its class,
+// or returns null with *errcode_ret untouched if the buffer is not pooled.
+cl_mem create_pooled(cl_context context, cl_mem_flags flags, size_t size, void *host_ptr,
+                     cl_int *errcode_ret,
+                     cl_mem (*create)(cl_context, cl_mem_flags, size_t, cl_int *)) {
+  if (host_ptr || size == 0 || !context)
+    return nullptr;
+  const size_t class_size = size_class(size);
+  const bool admitted = state().admits(context, class_size);
+  state().count_request(admitted);
+  if (!admitted)
+    return nullptr;
+
+  cl_mem buffer = state().take(context, flags, class_size);
+  // The larger size may not be allowed, then the buffer is not pooled.
+  if (!buffer)
+    buffer = create(context, flags, class_size, nullptr);
+  if (!buffer)
+    return nullptr;
+  buffer_info info;
+  info.context = context;
+  info.flags = flags;
+  info.size = size;
+  info.class_size = class_size;
+  state().buffers.on_create(buffer, info);
+  if (errcode_ret)
+    *errcode_ret = CL_SUCCESS;
+  return buffer;
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer_wrap(
+    cl_context context,
+    cl_mem_flags flags,
+    size_t size,
+    void *host_ptr,
+    cl_int *errcode_ret) {
+  cl_mem buffer = create_pooled(context, flags, size, host_ptr, errcode_ret,
+                                [](cl_context c, cl_mem_flags f, size_t s, cl_int *e) {
+                                  return tdispatch->clCreateBuffer(c, f, s, nullptr, e);
+                                });
+  if (buffer)
+    return buffer;
+  return tdispatch->clCreateBuffer(context, flags, size, host_ptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBufferWithProperties_wrap(
+    cl_context context,
+    const cl_mem_properties *properties,
+    cl_mem_flags flags,
+    size_t size,
+    void *host_ptr,
+    cl_int *errcode_ret) {
+  // Buffers with properties keep them, they are not pooled.
+  if (!properties || properties[0] == 0) {
+    cl_mem buffer = create_pooled(context, flags, size, host_ptr, errcode_ret,
+                                  [](cl_context c, cl_mem_flags f, size_t s, cl_int *e) {
+                                    return tdispatch->clCreateBufferWithProperties(
+                                        c, nullptr, f, s, nullptr, e);
+                                  });
+    if (buffer)
+      return buffer;
+  }
+  return tdispatch->clCreateBufferWithProperties(context, properties, flags, size, host_ptr,
+                                                 errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainMemObject_wrap(
+    cl_mem memobj) {
+  if (state().buffers.on_retain(memobj))
+    return CL_SUCCESS;
+  return tdispatch->clRetainMemObject(memobj);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject_wrap(
+    cl_mem memobj) {
+  handle_registry<buffer_info>::entry released = {};
+  if (!state().buffers.on_release(memobj, &released))
+    return tdispatch->clReleaseMemObject(memobj);
+  // Only filled in when the last reference was released.
+  if (released.generation == 0)
+    return CL_SUCCESS;
+  // Buffers outliving the last reference to their context are not pooled,
+  // the pool of the context was released with it.
+  if (released.payload.poolable && state().contexts.contains(released.payload.context))
+    state().put(memobj, released.payload);
+  else
+    tdispatch->clReleaseMemObject(memobj);
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetMemObjectInfo_wrap(
+    cl_mem memobj,
+    cl_mem_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  if (param_name == CL_MEM_SIZE || param_name == CL_MEM_REFERENCE_COUNT) {
+    size_t size = 0;
+    cl_uint refcount = 0;
+    if (state().buffers.find(memobj, [&](const handle_registry<buffer_info>::entry &entry) {
+          size = entry.payload.size;
+          refcount = static_cast<cl_uint>(entry.refcount);
+        })) {
+      const size_t value_size = param_name == CL_MEM_SIZE ? sizeof(size) : sizeof(refcount);
+      if (param_value && param_value_size < value_size)
+        return CL_INVALID_VALUE;
+      if (param_value && param_name == CL_MEM_SIZE)
+        *static_cast<size_t *>(param_value) = size;
+      else if (param_value)
+        *static_cast<cl_uint *>(param_value) = refcount;
+      if (param_value_size_ret)
+        *param_value_size_ret = value_size;
+      return CL_SUCCESS;
+    }
+  }
+  return tdispatch->clGetMemObjectInfo(memobj, param_name, param_value_size, param_value,
+                                       param_value_size_ret);
+}
+
+// Sub-buffers keep their buffer alive, a pooled buffer must not be handed
+// out while they are, so buffers with sub-buffers are not pooled.
+CL_API_ENTRY cl_mem CL_API_CALL clCreateSubBuffer_wrap(
+    cl_mem buffer,
+    cl_mem_flags flags,
+    cl_buffer_create_type buffer_create_type,
+    const void *buffer_create_info,
+    cl_int *errcode_ret) {
+  size_t size = 0;
+  if (buffer_create_type == CL_BUFFER_CREATE_TYPE_REGION && buffer_create_info &&
+      state().buffers.find(buffer, [&size](const handle_registry<buffer_info>::entry &entry) {
+        size = entry.payload.size;
+      })) {
+    // The implementation only knows the size of the class.
+    const auto *region = static_cast<const cl_buffer_region *>(buffer_create_info);
+    if (region->origin > size || region->size > size - region->origin) {
+      if (errcode_ret)
+        *errcode_ret = CL_INVALID_VALUE;
+      return nullptr;
+    }
+  }
+  cl_mem sub_buffer = tdispatch->clCreateSubBuffer(buffer, flags, buffer_create_type,
+                                                   buffer_create_info, errcode_ret);
+  if (sub_buffer)
+    state().buffers.update(buffer, [](buffer_info &info) { info.poolable = false; });
+  return sub_buffer;
+}
+
+// Images created from a buffer alias its memory, and keep it alive in the
+// implementation, so the buffer must not be handed out again.
+cl_mem keep_image_buffer(cl_mem image, const cl_image_desc *image_desc) {
+  if (image && image_desc && image_desc->buffer)
+    state().buffers.update(image_desc->buffer, [](buffer_info &info) { info.poolable = false; });
+  return image;
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImage_wrap(
+    cl_context context,
+    cl_mem_flags flags,
+    const cl_image_format *image_format,
+    const cl_image_desc *image_desc,
+    void *host_ptr,
+    cl_int *errcode_ret) {
+  return keep_image_buffer(
+      tdispatch->clCreateImage(context, flags, image_format, image_desc, host_ptr, errcode_ret),
+      image_desc);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImageWithProperties_wrap(
+    cl_context context,
+    const cl_mem_properties *properties,
+    cl_mem_flags flags,
+    const cl_image_format *image_format,
+    const cl_image_desc *image_desc,
+    void *host_ptr,
+    cl_int *errcode_ret) {
+  return keep_image_buffer(tdispatch->clCreateImageWithProperties(context, properties, flags,
+                                                                  image_format, image_desc,
+                                                                  host_ptr, errcode_ret),
+                           image_desc);
+}
+
+// Whether the range of buffer from offset reaches past the size the
+// application asked for.
+bool out_of_bounds(cl_mem buffer, size_t offset, size_t size) {
+  bool result = false;
+  state().buffers.find(buffer, [&](const handle_registry<buffer_info>::entry &entry) {
+    result = offset > entry.payload.size || size > entry.payload.size - offset;
+  });
+  return result;
+}
+
+// Same for a rectangle, with the default pitches of clEnqueueReadBufferRect.
+// Invalid rectangles are left for the implementation to report.
+bool out_of_bounds(cl_mem buffer, const size_t *origin, const size_t *region, size_t row_pitch,
+                   size_t slice_pitch) {
+  if (!origin || !region || region[0] == 0 || region[1] == 0 || region[2] == 0)
+    return false;
+  if (row_pitch == 0)
+    row_pitch = region[0];
+  if (slice_pitch == 0)
+    slice_pitch = region[1] * row_pitch;
+  return out_of_bounds(buffer, origin[2] * slice_pitch + origin[1] * row_pitch + origin[0],
+                       (region[2] - 1) * slice_pitch + (region[1] - 1) * row_pitch + region[0]);
+}
+
+// Bytes of image a region of it is copied to or from, 0 if unknown.
+size_t image_region_size(cl_mem image, const size_t *region) {
+  size_t element_size = 0;
+  if (!region || tdispatch->clGetImageInfo(image, CL_IMAGE_ELEMENT_SIZE, sizeof(element_size),
+                                           &element_size, nullptr) != CL_SUCCESS)
+    return 0;
+  return element_size * region[0] * region[1] * region[2];
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_read,
+    size_t offset,
+    size_t size,
+    void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(buffer, offset, size))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueReadBuffer(command_queue, buffer, blocking_read, offset, size, ptr,
+                                        num_events_in_wait_list, event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    size_t offset,
+    size_t size,
+    const void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(buffer, offset, size))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueWriteBuffer(command_queue, buffer, blocking_write, offset, size, ptr,
+                                         num_events_in_wait_list, event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_read,
+    const size_t *buffer_origin,
+    const size_t *host_origin,
+    const size_t *region,
+    size_t buffer_row_pitch,
+    size_t buffer_slice_pitch,
+    size_t host_row_pitch,
+    size_t host_slice_pitch,
+    void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(buffer, buffer_origin, region, buffer_row_pitch, buffer_slice_pitch))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueReadBufferRect(
+      command_queue, buffer, blocking_read, buffer_origin, host_origin, region, buffer_row_pitch,
+      buffer_slice_pitch, host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list,
+      event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    const size_t *buffer_origin,
+    const size_t *host_origin,
+    const size_t *region,
+    size_t buffer_row_pitch,
+    size_t buffer_slice_pitch,
+    size_t host_row_pitch,
+    size_t host_slice_pitch,
+    const void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(buffer, buffer_origin, region, buffer_row_pitch, buffer_slice_pitch))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueWriteBufferRect(
+      command_queue, buffer, blocking_write, buffer_origin, host_origin, region, buffer_row_pitch,
+      buffer_slice_pitch, host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list,
+      event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_buffer,
+    size_t src_offset,
+    size_t dst_offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(src_buffer, src_offset, size) || out_of_bounds(dst_buffer, dst_offset, size))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueCopyBuffer(command_queue, src_buffer, dst_buffer, src_offset,
+                                        dst_offset, size, num_events_in_wait_list,
+                                        event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_buffer,
+    const size_t *src_origin,
+    const size_t *dst_origin,
+    const size_t *region,
+    size_t src_row_pitch,
+    size_t src_slice_pitch,
+    size_t dst_row_pitch,
+    size_t dst_slice_pitch,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(src_buffer, src_origin, region, src_row_pitch, src_slice_pitch) ||
+      out_of_bounds(dst_buffer, dst_origin, region, dst_row_pitch, dst_slice_pitch))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueCopyBufferRect(
+      command_queue, src_buffer, dst_buffer, src_origin, dst_origin, region, src_row_pitch,
+      src_slice_pitch, dst_row_pitch, dst_slice_pitch, num_events_in_wait_list, event_wait_list,
+      event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    const void *pattern,
+    size_t pattern_size,
+    size_t offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(buffer, offset, size))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueFillBuffer(command_queue, buffer, pattern, pattern_size, offset,
+                                        size, num_events_in_wait_list, event_wait_list, event);
+}
+
+CL_API_ENTRY void *CL_API_CALL clEnqueueMapBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_map,
+    cl_map_flags map_flags,
+    size_t offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event,
+    cl_int *errcode_ret) {
+  if (out_of_bounds(buffer, offset, size)) {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_VALUE;
+    return nullptr;
+  }
+  return tdispatch->clEnqueueMapBuffer(command_queue, buffer, blocking_map, map_flags, offset,
+                                       size, num_events_in_wait_list, event_wait_list, event,
+                                       errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImageToBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_image,
+    cl_mem dst_buffer,
+    const size_t *src_origin,
+    const size_t *region,
+    size_t dst_offset,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(dst_buffer, dst_offset, image_region_size(src_image, region)))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueCopyImageToBuffer(command_queue, src_image, dst_buffer, src_origin,
+                                               region, dst_offset, num_events_in_wait_list,
+                                               event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferToImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_image,
+    size_t src_offset,
+    const size_t *dst_origin,
+    const size_t *region,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (out_of_bounds(src_buffer, src_offset, image_region_size(dst_image, region)))
+    return CL_INVALID_VALUE;
+  return tdispatch->clEnqueueCopyBufferToImage(command_queue, src_buffer, dst_image, src_offset,
+                                               dst_origin, region, num_events_in_wait_list,
+                                               event_wait_list, event);
+}
+
+// The callback has to run when the buffer is released.
+CL_API_ENTRY cl_int CL_API_CALL clSetMemObjectDestructorCallback_wrap(
+    cl_mem memobj,
+    void(CL_CALLBACK *pfn_notify)(cl_mem memobj, void *user_data),
+    void *user_data) {
+  const cl_int result = tdispatch->clSetMemObjectDestructorCallback(memobj, pfn_notify, user_data);
+  if (result == CL_SUCCESS)
+    state().buffers.update(memobj, [](buffer_info &info) { info.poolable = false; });
+  return result;
+}
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContext_wrap(
+    const cl_context_properties *properties,
+    cl_uint num_devices,
+    const cl_device_id *devices,
+    void(CL_CALLBACK *pfn_notify)(const char *errinfo, const void *private_info,
+                                  size_t cb, void *user_data),
+    void *user_data,
+    cl_int *errcode_ret) {
+  cl_context context = tdispatch->clCreateContext(properties, num_devices, devices, pfn_notify,
+                                                  user_data, errcode_ret);
+  if (context)
+    state().contexts.on_create(context, context);
+  return context;
+}
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContextFromType_wrap(
+    const cl_context_properties *properties,
+    cl_device_type device_type,
+    void(CL_CALLBACK *pfn_notify)(const char *errinfo, const void *private_info,
+                                  size_t cb, void *user_data),
+    void *user_data,
+    cl_int *errcode_ret) {
+  cl_context context = tdispatch->clCreateContextFromType(properties, device_type, pfn_notify,
+                                                          user_data, errcode_ret);
+  if (context)
+    state().contexts.on_create(context, context);
+  return context;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainContext_wrap(
+    cl_context context) {
+  const cl_int result = tdispatch->clRetainContext(context);
+  if (result == CL_SUCCESS)
+    state().contexts.on_retain(context);
+  return result;
+}
+
+// Pooled buffers keep their context alive, they are released along with
+// the last reference of the application.
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext_wrap(
+    cl_context context) {
+  handle_registry<cl_context>::entry released = {};
+  if (state().contexts.on_release(context, &released) && released.generation != 0)
+    state().flush(context);
+  return tdispatch->clReleaseContext(context);
+}
+
+void track_queue(cl_command_queue queue) {
+  cl_context context = nullptr;
+  if (tdispatch->clGetCommandQueueInfo(queue, CL_QUEUE_CONTEXT, sizeof(context), &context,
+                                       nullptr) != CL_SUCCESS)
+    return;
+  state().queues.on_create(queue, context);
+  state().add_queue(context, queue);
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue_wrap(
+    cl_context context,
+    cl_device_id device,
+    cl_command_queue_properties properties,
+    cl_int *errcode_ret) {
+  cl_command_queue queue = tdispatch->clCreateCommandQueue(context, device, properties,
+                                                           errcode_ret);
+  if (queue)
+    track_queue(queue);
+  return queue;
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithProperties_wrap(
+    cl_context context,
+    cl_device_id device,
+    const cl_queue_properties *properties,
+    cl_int *errcode_ret) {
+  cl_command_queue queue = tdispatch->clCreateCommandQueueWithProperties(context, device,
+                                                                         properties, errcode_ret);
+  if (queue)
+    track_queue(queue);
+  return queue;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue_wrap(
+    cl_command_queue command_queue) {
+  const cl_int result = tdispatch->clRetainCommandQueue(command_queue);
+  if (result == CL_SUCCESS)
+    state().queues.on_retain(command_queue);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue_wrap(
+    cl_command_queue command_queue) {
+  handle_registry<cl_context>::entry released = {};
+  if (state().queues.on_release(command_queue, &released) && released.generation != 0)
+    state().remove_queue(command_queue);
+  return tdispatch->clReleaseCommandQueue(command_queue);
+}
+
+void init_dispatch() {
+  dispatch.clCreateBuffer = &clCreateBuffer_wrap;
+  dispatch.clCreateBufferWithProperties = &clCreateBufferWithProperties_wrap;
+  dispatch.clRetainMemObject = &clRetainMemObject_wrap;
+  dispatch.clReleaseMemObject = &clReleaseMemObject_wrap;
+  dispatch.clGetMemObjectInfo = &clGetMemObjectInfo_wrap;
+  dispatch.clCreateSubBuffer = &clCreateSubBuffer_wrap;
+  dispatch.clCreateImage = &clCreateImage_wrap;
+  dispatch.clCreateImageWithProperties = &clCreateImageWithProperties_wrap;
+  dispatch.clSetMemObjectDestructorCallback = &clSetMemObjectDestructorCallback_wrap;
+  dispatch.clEnqueueReadBuffer = &clEnqueueReadBuffer_wrap;
+  dispatch.clEnqueueWriteBuffer = &clEnqueueWriteBuffer_wrap;
+  dispatch.clEnqueueReadBufferRect = &clEnqueueReadBufferRect_wrap;
+  dispatch.clEnqueueWriteBufferRect = &clEnqueueWriteBufferRect_wrap;
+  dispatch.clEnqueueCopyBuffer = &clEnqueueCopyBuffer_wrap;
+  dispatch.clEnqueueCopyBufferRect = &clEnqueueCopyBufferRect_wrap;
+  dispatch.clEnqueueFillBuffer = &clEnqueueFillBuffer_wrap;
+  dispatch.clEnqueueMapBuffer = &clEnqueueMapBuffer_wrap;
+  dispatch.clEnqueueCopyImageToBuffer = &clEnqueueCopyImageToBuffer_wrap;
+  dispatch.clEnqueueCopyBufferToImage = &clEnqueueCopyBufferToImage_wrap;
+  dispatch.clCreateContext = &clCreateContext_wrap;
+  dispatch.clCreateContextFromType = &clCreateContextFromType_wrap;
+  dispatch.clRetainContext = &clRetainContext_wrap;
+  dispatch.clReleaseContext = &clReleaseContext_wrap;
+  dispatch.clCreateCommandQueue = &clCreateCommandQueue_wrap;
+  dispatch.clCreateCommandQueueWithProperties = &clCreateCommandQueueWithProperties_wrap;
+  dispatch.clRetainCommandQueue = &clRetainCommandQueue_wrap;
+  dispatch.clReleaseCommandQueue = &clReleaseCommandQueue_wrap;
+}
+
+void report_at_exit() {
+  state().report();
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().set_output(settings.report.open("buffer_pool"));
+
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(report_at_exit);
+      });
+}
@@ -0,0 +1,141 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+#include <string.h> // memset
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+cl_uint referenceCount(cl_mem buffer)
+{
+    cl_uint count = 0;
+    cl_int CL_err = clGetMemObjectInfo(buffer, CL_MEM_REFERENCE_COUNT, sizeof(count), &count, NULL);
+    checkErr(CL_err, "clGetMemObjectInfo(CL_MEM_REFERENCE_COUNT)");
+    return count;
+}
+
+size_t size(cl_mem buffer)
+{
+    size_t result = 0;
+    cl_int CL_err = clGetMemObjectInfo(buffer, CL_MEM_SIZE, sizeof(result), &result, NULL);
+    checkErr(CL_err, "clGetMemObjectInfo(CL_MEM_SIZE)");
+    return result;
+}
+
+// Creates and releases transient buffers, for the layer to hand out the
+// same buffer again when the context, flags and size class match.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_command_queue queue = NULL;
+    cl_mem buffer = NULL, first = NULL, sub_buffer = NULL, image = NULL;
+    cl_image_format format = {CL_RGBA, CL_FLOAT};
+    cl_image_desc desc;
+    cl_buffer_region region = {0, 1024};
+    float data[16] = {0};
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+    queue = clCreateCommandQueue(context, device, 0, &CL_err);
+    checkErr(CL_err, "clCreateCommandQueue");
+
+    for (i = 0; i < 4; ++i)
+    {
+        buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 1000, NULL, &CL_err);
+        checkErr(CL_err, "clCreateBuffer");
+        if (i == 0)
+        {
+            first = buffer;
+            printf("Buffer size: %u\n", (unsigned)size(buffer));
+        }
+        else
+            printf("Buffer %i reused: %s\n", i, buffer == first ? "yes" : "no");
+        CL_err = clEnqueueWriteBuffer(queue, buffer, CL_FALSE, 0, sizeof(data), data, 0, NULL, NULL);
+        checkErr(CL_err, "clEnqueueWriteBuffer");
+        CL_err = clReleaseMemObject(buffer);
+        checkErr(CL_err, "clReleaseMemObject");
+    }
+
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 800, NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer(800)");
+    printf("Smaller buffer reused: %s\n", buffer == first ? "yes" : "no");
+    printf("Reference count: %u\n", referenceCount(buffer));
+    CL_err = clRetainMemObject(buffer);
+    checkErr(CL_err, "clRetainMemObject");
+    printf("Reference count after retain: %u\n", referenceCount(buffer));
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+    CL_err = clEnqueueWriteBuffer(queue, buffer, CL_FALSE, 800 - sizeof(data) / 2, sizeof(data), data, 0, NULL, NULL);
+    printf("Write past the end: %s\n", CL_err == CL_INVALID_VALUE ? "CL_INVALID_VALUE" : "enqueued");
+    CL_err = clEnqueueWriteBuffer(queue, buffer, CL_FALSE, 800 - sizeof(data), sizeof(data), data, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueWriteBuffer(end)");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+
+    buffer = clCreateBufferWithProperties(context, NULL, CL_MEM_READ_WRITE, 1000, NULL, &CL_err);
+    checkErr(CL_err, "clCreateBufferWithProperties");
+    printf("Buffer with properties reused: %s\n", buffer == first ? "yes" : "no");
+    sub_buffer = clCreateSubBuffer(buffer, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &CL_err);
+    printf("Sub-buffer past the end: %s\n", CL_err == CL_INVALID_VALUE ? "CL_INVALID_VALUE" : "created");
+    region.size = 512;
+    sub_buffer = clCreateSubBuffer(buffer, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &CL_err);
+    checkErr(CL_err, "clCreateSubBuffer");
+    CL_err = clReleaseMemObject(sub_buffer);
+    checkErr(CL_err, "clReleaseMemObject(sub_buffer)");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 2000, NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer(2000)");
+    first = buffer;
+    memset(&desc, 0, sizeof(desc));
+    desc.image_type = CL_MEM_OBJECT_IMAGE1D_BUFFER;
+    desc.image_width = 2000 / 16;
+    desc.buffer = buffer;
+    image = clCreateImage(context, CL_MEM_READ_WRITE, &format, &desc, NULL, &CL_err);
+    checkErr(CL_err, "clCreateImage");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 2000, NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer(2000)");
+    printf("Buffer of an image reused: %s\n", buffer == first ? "yes" : "no");
+    CL_err = clReleaseMemObject(image);
+    checkErr(CL_err, "clReleaseMemObject(image)");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(data), data, &CL_err);
+    checkErr(CL_err, "clCreateBuffer(CL_MEM_COPY_HOST_PTR)");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 100000, NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer(100000)");
+    CL_err = clReleaseMemObject(buffer);
+    checkErr(CL_err, "clReleaseMemObject");
+
+    CL_err = clFinish(queue);
+    checkErr(CL_err, "clFinish");
+    clReleaseCommandQueue(queue);
+    clReleaseContext(context);
+
+    return 0;
+}
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Records every clBuildProgram, clCompileProgram and clLinkProgram call
+// with how long it took, its options, the size and hash of the source or
+// IL, the devices and the size of the build logs, and appends the records
+// to a history file shared by all the runs. cl_build_history_summary ranks
+// the builds in the history and finds sources built over and over by one
+// process.
+
+#include "build_history_record.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using build_history::record;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  std::string history_filename = "cl_build_history.tsv";
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("build_history", settings_from_file);
+
+  auto settings = layer_settings{};
+  parser.get_filename("history_filename", settings.history_filename);
+  return settings;
+}
+
+layer_settings settings;
+std::string process;
+
+uint64_t now() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+uint64_t seconds_since_epoch() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// FNV-1a of size bytes at data, in hexadecimal.
+std::string hash_hex(const void *data, size_t size) {
+  std::ostringstream out;
+  out << std::hex << std::setfill('0') << std::setw(16) << ocl_layer_utils::fnv1a(data, size);
+  return out.str();
+}
+
+// Each record is appended with a single write, so that the records of
+// processes sharing the history do not interleave.
+void append(const record &r) {
+  static std::mutex mutex;
+  const std::string line = build_history::format(r);
+  std::lock_guard<std::mutex> lock(mutex);
+#if defined(_WIN32)
+  std::ofstream history(settings.history_filename, std::ios::out | std::ios::app);
+  history << line;
+#else
+  const int fd =
+      open(settings.history_filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return;
+  ssize_t written = write(fd, line.data(), line.size());
+  (void)written;
+  close(fd);
+#endif
+}
+
+template <typename Query, typename Object, typename Param>
+std::vector<char> query(Query query, Object object, Param param_name) {
+  size_t size = 0;
+  if (query(object, param_name, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+    return {};
+  std::vector<char> value(size);
+  if (query(object, param_name, size, value.data(), nullptr) != CL_SUCCESS)
+    return {};
+  return value;
+}
+
+std::string query_string(cl_device_id device, cl_device_info param_name) {
+  const std::vector<char> value = query(tdispatch->clGetDeviceInfo, device, param_name);
+  return value.empty() ? std::string() : std::string(value.data());
+}
+
+std::vector<cl_device_id> program_devices(cl_program program) {
+  const std::vector<char> value = query(tdispatch->clGetProgramInfo, program, CL_PROGRAM_DEVICES);
+  const cl_device_id *devices = reinterpret_cast<const cl_device_id *>(value.data());
+  return std::vector<cl_device_id>(devices, devices + value.size() / sizeof(cl_device_id));
+}
+
+std::string describe(const std::vector<cl_device_id> &devices) {
+  std::string result;
+  for (cl_device_id device : devices) {
+    if (!result.empty())
+      result += "; ";
+    result += query_string(device, CL_DEVICE_NAME);
+    const std::string driver = query_string(device, CL_DRIVER_VERSION);
+    if (!driver.empty())
+      result += " (" + driver + ")";
+  }
+  return result;
+}
+
+// Hashes the source of program, or its IL.
+void hash_code(cl_program program, std::string &hash, uint64_t &size) {
+  std::vector<char> code = query(tdispatch->clGetProgramInfo, program, CL_PROGRAM_SOURCE);
+  if (code.size() > 1)
+    code.pop_back();
+  else
+    code = query(tdispatch->clGetProgramInfo, program, CL_PROGRAM_IL);
+  hash = hash_hex(code.data(), code.size());
+  size = code.size();
+}
+
+// A call being timed, recorded by finish() when it returns or, when the
+// application passed a callback, when the callback runs.
+struct pending_call {
+  record data;
+  uint64_t begin;
+  std::vector<cl_device_id> devices;
+  void(CL_CALLBACK *pfn_notify)(cl_program, void *);
+  void *user_data;
+
+  pending_call(const char *operation, const char *options, std::vector<cl_device_id> on_devices)
+      : begin(now()), devices(std::move(on_devices)), pfn_notify(nullptr), user_data(nullptr) {
+    data.process = process;
+    data.timestamp = seconds_since_epoch();
+    data.operation = operation;
+    data.options = options ? options : "";
+  }
+
+  void finish(cl_program program, cl_int status) {
+    data.wall_time = now() - begin;
+    data.status = status;
+    if (program && devices.empty())
+      devices = program_devices(program);
+    data.devices = describe(devices);
+    for (cl_device_id device : devices) {
+      size_t size = 0;
+      if (program && tdispatch->clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0,
+                                                      nullptr, &size) == CL_SUCCESS &&
+          size > 1)
+        data.log_size += size - 1;
+    }
+    append(data);
+  }
+};
+
+// Status of the build of program, for asynchronous builds that completed.
+cl_int build_status(cl_program program, const std::vector<cl_device_id> &devices) {
+  for (cl_device_id device : devices) {
+    cl_build_status status = CL_BUILD_NONE;
+    if (tdispatch->clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_STATUS, sizeof(status),
+                                         &status, nullptr) == CL_SUCCESS &&
+        status == CL_BUILD_ERROR)
+      return CL_BUILD_PROGRAM_FAILURE;
+  }
+  return CL_SUCCESS;
+}
+
+void CL_CALLBACK on_complete(cl_program program, void *user_data) {
+  std::unique_ptr<pending_call> pending(static_cast<pending_call *>(user_data));
+  if (pending->devices.empty())
+    pending->devices = program_devices(program);
+  pending->finish(program, build_status(program, pending->devices));
+  pending->pfn_notify(program, pending->user_data);
+}
+
+// Calls call with the callback and user data to pass on, and records it
+// once the build completes.
+template <typename Call>
+cl_program timed(pending_call *pending,
+                 void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+                 void *user_data, cl_int &result, Call call) {
+  if (!pfn_notify) {
+    cl_program program = call(nullptr, nullptr);
+    pending->finish(program, result);
+    delete pending;
+    return program;
+  }
+  pending->pfn_notify = pfn_notify;
+  pending->user_data = user_data;
+  cl_program program = call(on_complete, pending);
+  // The callback only runs for builds that were started.
+  if (result != CL_SUCCESS) {
+    pending->finish(program, result);
+    delete pending;
+  }
+  return program;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  auto pending = new pending_call(
+      "build", options,
+      device_list ? std::vector<cl_device_id>(device_list, device_list + num_devices)
+                  : program_devices(program));
+  hash_code(program, pending->data.source_hash, pending->data.source_size);
+  cl_int result = CL_SUCCESS;
+  timed(pending, pfn_notify, user_data, result,
+        [&](void(CL_CALLBACK * notify)(cl_program, void *), void *data) {
+          result = tdispatch->clBuildProgram(program, num_devices, device_list, options, notify,
+                                             data);
+          return program;
+        });
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_headers,
+    const cl_program *input_headers,
+    const char **header_include_names,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  auto pending = new pending_call(
+      "compile", options,
+      device_list ? std::vector<cl_device_id>(device_list, device_list + num_devices)
+                  : program_devices(program));
+  hash_code(program, pending->data.source_hash, pending->data.source_size);
+  cl_int result = CL_SUCCESS;
+  timed(pending, pfn_notify, user_data, result,
+        [&](void(CL_CALLBACK * notify)(cl_program, void *), void *data) {
+          result = tdispatch->clCompileProgram(program, num_devices, device_list, options,
+                                               num_input_headers, input_headers,
+                                               header_include_names, notify, data);
+          return program;
+        });
+  return result;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
+    cl_context context,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_programs,
+    const cl_program *input_programs,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data,
+    cl_int *errcode_ret) {
+  // Links are identified by the sources of their inputs.
+  auto pending = new pending_call(
+      "link", options,
+      device_list ? std::vector<cl_device_id>(device_list, device_list + num_devices)
+                  : std::vector<cl_device_id>());
+  std::string hashes;
+  for (cl_uint i = 0; input_programs && i < num_input_programs; ++i) {
+    std::string hash;
+    uint64_t size = 0;
+    hash_code(input_programs[i], hash, size);
+    hashes += hash;
+    pending->data.source_size += size;
+  }
+  pending->data.source_hash = hash_hex(hashes.data(), hashes.size());
+  cl_int result = CL_SUCCESS;
+  cl_program program = timed(
+      pending, pfn_notify, user_data, result,
+      [&](void(CL_CALLBACK * notify)(cl_program, void *), void *data) {
+        return tdispatch->clLinkProgram(context, num_devices, device_list, options,
+                                        num_input_programs, input_programs, notify, data, &result);
+      });
+  if (errcode_ret)
+    *errcode_ret = result;
+  return program;
+}
+
+void init_dispatch() {
+  dispatch.clBuildProgram = &clBuildProgram_wrap;
+  dispatch.clCompileProgram = &clCompileProgram_wrap;
+  dispatch.clLinkProgram = &clLinkProgram_wrap;
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+#if defined(_WIN32)
+        process = std::to_string(_getpid());
+#else
+        process = std::to_string(getpid());
+#endif
+        process += '-' + std::to_string(seconds_since_epoch());
+
+        // Everything that is not a build goes straight to the target.
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+      });
+}
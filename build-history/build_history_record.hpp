@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace build_history {
+
+// One clBuildProgram, clCompileProgram or clLinkProgram call. The history
+// file holds one record per line, its fields separated by tabs:
+//
+//   v1 <process> <timestamp> <operation> <status> <wall time> <source hash>
+//      <source size> <options> <devices> <log size>
+//
+// Tabs, line breaks and backslashes in the strings are escaped with
+// backslashes.
+struct record {
+  // Process id and the time the layer was loaded, unique across restarts.
+  std::string process;
+  // Seconds since the epoch when the call was made.
+  uint64_t timestamp = 0;
+  // build, compile or link.
+  std::string operation;
+  int status = 0;
+  // Nanoseconds until the call returned, or until its callback ran.
+  uint64_t wall_time = 0;
+  // FNV-1a of the source or IL, of the hashes of the inputs for links.
+  std::string source_hash;
+  uint64_t source_size = 0;
+  std::string options;
+  // Name and driver version of every device, separated by "; ".
+  std::string devices;
+  // Bytes of build log over all the devices.
+  uint64_t log_size = 0;
+};
+
+inline std::string escape(const std::string &value) {
+  std::string result;
+  for (char c : value) {
+    switch (c) {
+    case '\t':
+      result += "\\t";
+      break;
+    case '\n':
+      result += "\\n";
+      break;
+    case '\r':
+      result += "\\r";
+      break;
+    case '\\':
+      result += "\\\\";
+      break;
+    default:
+      result += c;
+    }
+  }
+  return result;
+}
+
+inline std::string unescape(const std::string &value) {
+  std::string result;
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] != '\\' || i + 1 == value.size()) {
+      result += value[i];
+      continue;
+    }
+    const char c = value[++i];
+    result += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+  }
+  return result;
+}
+
+// The line for r, with its newline.
+inline std::string format(const record &r) {
+  return "v1\t" + escape(r.process) + '\t' + std::to_string(r.timestamp) + '\t' +
+         escape(r.operation) + '\t' + std::to_string(r.status) + '\t' +
+         std::to_string(r.wall_time) + '\t' + escape(r.source_hash) + '\t' +
+         std::to_string(r.source_size) + '\t' + escape(r.options) + '\t' + escape(r.devices) +
+         '\t' + std::to_string(r.log_size) + '\n';
+}
+
+// Returns false for lines of other versions or with missing fields.
+inline bool parse(const std::string &line, record &r) {
+  std::vector<std::string> fields;
+  for (size_t begin = 0;;) {
+    const size_t end = line.find('\t', begin);
+    fields.push_back(line.substr(begin, end == std::string::npos ? end : end - begin));
+    if (end == std::string::npos)
+      break;
+    begin = end + 1;
+  }
+  if (fields.size() != 11 || fields[0] != "v1")
+    return false;
+  const auto number = [](const std::string &field) {
+    return static_cast<uint64_t>(std::strtoull(field.c_str(), nullptr, 10));
+  };
+  r.process = unescape(fields[1]);
+  r.timestamp = number(fields[2]);
+  r.operation = unescape(fields[3]);
+  r.status = std::atoi(fields[4].c_str());
+  r.wall_time = number(fields[5]);
+  r.source_hash = unescape(fields[6]);
+  r.source_size = number(fields[7]);
+  r.options = unescape(fields[8]);
+  r.devices = unescape(fields[9]);
+  r.log_size = number(fields[10]);
+  return true;
+}
+
+} // namespace build_history
@@ -0,0 +1,135 @@
+// Summarizes a build history written by the build_history layer:
+//
+//   cl_build_history_summary <history file> [<count>]
+//
+// ranks the <count> (default 20) programs that took the longest to build
+// over all the runs, shows how long builds took on each device and driver,
+// and lists the programs one process built more than once with the same
+// source and options.
+
+#include "build_history_record.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using build_history::record;
+
+struct totals {
+  uint64_t builds = 0;
+  uint64_t wall_time = 0;
+  // In order of first appearance, to break ties.
+  size_t first = 0;
+};
+
+double milliseconds(uint64_t nanoseconds) { return nanoseconds / 1e6; }
+
+template <typename Key>
+std::vector<std::pair<Key, totals>> ranked(const std::map<Key, totals> &aggregates) {
+  std::vector<std::pair<Key, totals>> result(aggregates.begin(), aggregates.end());
+  std::sort(result.begin(), result.end(), [](const std::pair<Key, totals> &a,
+                                             const std::pair<Key, totals> &b) {
+    return a.second.wall_time != b.second.wall_time ? a.second.wall_time > b.second.wall_time
+                                                    : a.second.first < b.second.first;
+  });
+  return result;
+}
+
+void add(totals &t, const record &r, size_t index) {
+  if (t.builds++ == 0)
+    t.first = index;
+  t.wall_time += r.wall_time;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <history file> [<count>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::ifstream file(argv[1]);
+  if (!file.good()) {
+    std::cerr << "error: could not open " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+  using program = std::tuple<std::string, std::string, std::string>;
+  std::map<program, totals> programs;
+  std::map<std::string, totals> devices;
+  std::map<std::tuple<std::string, std::string, std::string, std::string>, totals> per_process;
+  std::set<std::string> processes;
+  uint64_t builds = 0, wall_time = 0, skipped = 0;
+  size_t index = 0;
+  for (std::string line; std::getline(file, line); ++index) {
+    record r;
+    if (!build_history::parse(line, r)) {
+      ++skipped;
+      continue;
+    }
+    ++builds;
+    wall_time += r.wall_time;
+    processes.insert(r.process);
+    add(programs[program(r.operation, r.source_hash, r.options)], r, index);
+    add(devices[r.devices], r, index);
+    add(per_process[std::make_tuple(r.process, r.operation, r.source_hash, r.options)], r, index);
+  }
+
+  std::cout << std::fixed << std::setprecision(3) << "builds: " << builds
+            << ", processes: " << processes.size() << ", total: " << milliseconds(wall_time)
+            << " ms";
+  if (skipped)
+    std::cout << ", " << skipped << " lines skipped";
+  std::cout << '\n';
+
+  std::cout << "most expensive, times in milliseconds\n"
+            << std::left << std::setw(10) << "operation" << std::right << std::setw(8)
+            << "builds" << std::setw(12) << "total" << std::setw(12) << "mean" << "  "
+            << std::left << std::setw(18) << "source" << "options\n";
+  size_t shown = 0;
+  for (const auto &entry : ranked(programs)) {
+    if (shown++ == count)
+      break;
+    const totals &t = entry.second;
+    std::cout << std::left << std::setw(10) << std::get<0>(entry.first) << std::right
+              << std::setw(8) << t.builds << std::setw(12) << milliseconds(t.wall_time)
+              << std::setw(12) << milliseconds(t.wall_time / t.builds) << "  " << std::left
+              << std::setw(18) << std::get<1>(entry.first) << std::get<2>(entry.first) << '\n';
+  }
+
+  std::cout << "by device, times in milliseconds\n"
+            << std::right << std::setw(8) << "builds" << std::setw(12) << "total"
+            << std::setw(12) << "mean" << "  devices\n";
+  for (const auto &entry : ranked(devices)) {
+    const totals &t = entry.second;
+    std::cout << std::right << std::setw(8) << t.builds << std::setw(12)
+              << milliseconds(t.wall_time) << std::setw(12)
+              << milliseconds(t.wall_time / t.builds) << "  " << entry.first << '\n';
+  }
+
+  // Builds after the first could have reused the first one's program.
+  std::cout << "repeated in one process, times in milliseconds\n"
+            << std::left << std::setw(24) << "process" << std::setw(10) << "operation"
+            << std::right << std::setw(8) << "builds" << std::setw(12) << "total" << "  "
+            << std::left << std::setw(18) << "source" << "options\n";
+  for (const auto &entry : ranked(per_process)) {
+    const totals &t = entry.second;
+    if (t.builds < 2)
+      continue;
+    std::cout << std::left << std::setw(24) << std::get<0>(entry.first) << std::setw(10)
+              << std::get<1>(entry.first) << std::right << std::setw(8) << t.builds
+              << std::setw(12) << milliseconds(t.wall_time) << "  " << std::left << std::setw(18)
+              << std::get<2>(entry.first) << std::get<3>(entry.first) << '\n';
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+void CL_CALLBACK notify(cl_program program, void *user_data)
+{
+    (void)program;
+    ++*(int *)user_data;
+}
+
+// Builds the same source twice with the same options, once more with other
+// options and a callback, and compiles and links it.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_program programs[4];
+    cl_program linked = NULL;
+    const char *options[3] = {"-DN=1", "-DN=1", "-DN=2"};
+    const char *source = "kernel void saxpy() {}";
+    int notified = 0;
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+
+    for (i = 0; i < 4; ++i)
+    {
+        programs[i] = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+        checkErr(CL_err, "clCreateProgramWithSource");
+    }
+    for (i = 0; i < 3; ++i)
+    {
+        CL_err = clBuildProgram(programs[i], 0, NULL, options[i], i == 2 ? notify : NULL, &notified);
+        checkErr(CL_err, "clBuildProgram");
+    }
+    printf("Build notified: %d\n", notified);
+    CL_err = clCompileProgram(programs[3], 0, NULL, "-DM=1", 0, NULL, NULL, NULL, NULL);
+    checkErr(CL_err, "clCompileProgram");
+    linked = clLinkProgram(context, 0, NULL, "", 1, &programs[3], NULL, NULL, &CL_err);
+    checkErr(CL_err, "clLinkProgram");
+
+    clReleaseProgram(linked);
+    for (i = 0; i < 4; ++i)
+        clReleaseProgram(programs[i]);
+    clReleaseContext(context);
+
+    return 0;
+}
@@ -1,3 +1,8 @@
+if(CLEAN_DIRECTORY)
+    # State left behind by earlier runs, e.g. caches or histories
+    file(REMOVE_RECURSE "${CLEAN_DIRECTORY}")
+endif()
+
 execute_process(
     COMMAND ${COMMAND}
     OUTPUT_VARIABLE COMMAND_STDOUT
@@ -7,7 +12,16 @@ execute_process(
 message("command output:\n${COMMAND_STDOUT}")
 
 if(EXTRA_OUTPUT)
-  file(READ "${EXTRA_OUTPUT}"          OUTPUT_FILE)
+  if(EXTRA_OUTPUT_FILTER)
+    # Compare what the filter prints for the file, e.g. for binary logs
+    execute_process(
+        COMMAND ${EXTRA_OUTPUT_FILTER} "${EXTRA_OUTPUT}"
+        OUTPUT_VARIABLE FILTERED_OUTPUT
+    )
+    set(OUTPUT_FILE "${FILTERED_OUTPUT}")
+  else()
+    file(READ "${EXTRA_OUTPUT}"          OUTPUT_FILE)
+  endif()
   message("command extra output:\n${OUTPUT_FILE}")
 endif()
 
@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Recycles kernels for applications that create and release them around
+// every launch. The layer keeps the reference counts the application sees,
+// the implementation only ever sees one reference. When the application
+// releases its last reference the kernel goes to a pool of its program and
+// name instead of being released, and clCreateKernel hands it out again.
+//
+// A recycled kernel still holds the arguments it was last launched with,
+// launching it before setting all of them again fails with
+// CL_INVALID_KERNEL_ARGS as it would with a new kernel. The pool of a
+// program is released along with the last reference the application holds
+// to the program, and before the program is built again, which is not
+// allowed while it has kernels. Kernels released after their program are
+// not pooled, they would keep the program alive.
+
+#include "handle_registry.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::handle_registry;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  // Kernels kept for each program and name, and over all of them.
+  unsigned max_per_kernel = 4;
+  unsigned max_kernels = 256;
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::none, "cl_kernel_pool.log"};
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("kernel_pool", settings_from_file);
+
+  auto settings = layer_settings{};
+  parser.get_unsigned("max_per_kernel", settings.max_per_kernel);
+  parser.get_unsigned("max_kernels", settings.max_kernels);
+  settings.report.load(parser);
+  return settings;
+}
+
+layer_settings settings;
+
+// Kernels the application holds references to.
+struct kernel_info {
+  // Null for kernels that are not pooled, those created with
+  // clCreateKernelsInProgram or clCloneKernel.
+  cl_program program = nullptr;
+  std::string name;
+  // For recycled kernels, which arguments were set since they were handed
+  // out again. Empty for new kernels.
+  std::vector<bool> args_set;
+};
+
+class pool_state {
+public:
+  // Takes a kernel of program and name out of the pool, or returns null.
+  cl_kernel take(cl_program program, const std::string &name);
+
+  // Puts kernel back in the pool, or releases it if the pool is full.
+  void put(cl_program program, const std::string &name, cl_kernel kernel);
+
+  // Releases the kernels pooled for program.
+  void flush(cl_program program);
+
+  void set_output(std::ostream *output) { output_ = output; }
+  void report();
+
+  handle_registry<kernel_info> kernels;
+  // Programs the application holds references to, the payload is unused.
+  handle_registry<bool> programs;
+
+private:
+  using pool_key = std::pair<cl_program, std::string>;
+
+  std::mutex mutex_;
+  std::map<pool_key, std::vector<cl_kernel>> pools_;
+  // Pooled kernels from the least to the most recently released.
+  std::deque<std::pair<pool_key, cl_kernel>> order_;
+  uint64_t created_ = 0, reused_ = 0, pooled_ = 0, evicted_ = 0, flushed_ = 0;
+  std::ostream *output_ = nullptr;
+};
+
+pool_state &state() {
+  return ocl_layer_utils::never_destroyed<pool_state>();
+}
+
+cl_kernel pool_state::take(cl_program program, const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pools_.find(pool_key(program, name));
+  if (it == pools_.end() || it->second.empty()) {
+    ++created_;
+    return nullptr;
+  }
+  const cl_kernel kernel = it->second.back();
+  it->second.pop_back();
+  order_.erase(std::find(order_.begin(), order_.end(), std::make_pair(it->first, kernel)));
+  ++reused_;
+  return kernel;
+}
+
+void pool_state::put(cl_program program, const std::string &name, cl_kernel kernel) {
+  std::vector<cl_kernel> evicted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const pool_key key(program, name);
+    std::vector<cl_kernel> &pool = pools_[key];
+    if (pool.size() >= settings.max_per_kernel || settings.max_kernels == 0) {
+      evicted.push_back(kernel);
+    } else {
+      pool.push_back(kernel);
+      order_.emplace_back(key, kernel);
+      ++pooled_;
+      // The least recently released kernels make room.
+      while (order_.size() > settings.max_kernels) {
+        std::vector<cl_kernel> &oldest = pools_[order_.front().first];
+        oldest.erase(std::find(oldest.begin(), oldest.end(), order_.front().second));
+        evicted.push_back(order_.front().second);
+        order_.pop_front();
+      }
+    }
+    evicted_ += evicted.size();
+  }
+  for (cl_kernel released : evicted)
+    tdispatch->clReleaseKernel(released);
+}
+
+void pool_state::flush(cl_program program) {
+  std::vector<cl_kernel> released;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = pools_.lower_bound(pool_key(program, std::string()));
+         it != pools_.end() && it->first.first == program;) {
+      released.insert(released.end(), it->second.begin(), it->second.end());
+      it = pools_.erase(it);
+    }
+    order_.erase(std::remove_if(order_.begin(), order_.end(),
+                                [program](const std::pair<pool_key, cl_kernel> &pooled) {
+                                  return pooled.first.first == program;
+                                }),
+                 order_.end());
+    flushed_ += released.size();
+  }
+  for (cl_kernel kernel : released)
+    tdispatch->clReleaseKernel(kernel);
+}
+
+void pool_state::report() {
+  if (!output_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  *output_ << "kernel_pool report\n"
+           << "created: " << created_ << '\n'
+           << "reused: " << reused_ << '\n'
+           << "pooled: " << pooled_ << '\n'
+           << "evicted: " << evicted_ << '\n'
+           << "flushed: " << flushed_ << '\n'
+           << "pooled at exit: " << order_.size() << '\n';
+  output_->flush();
+}
+
+cl_uint num_args(cl_kernel kernel) {
+  cl_uint count = 0;
+  tdispatch->clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(count), &count, nullptr);
+  return count;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel_wrap(
+    cl_program program,
+    const char *kernel_name,
+    cl_int *errcode_ret) {
+  if (program && kernel_name) {
+    if (cl_kernel kernel = state().take(program, kernel_name)) {
+      kernel_info info;
+      info.program = program;
+      info.name = kernel_name;
+      info.args_set.assign(num_args(kernel), false);
+      state().kernels.on_create(kernel, std::move(info));
+      if (errcode_ret)
+        *errcode_ret = CL_SUCCESS;
+      return kernel;
+    }
+  }
+  cl_kernel kernel = tdispatch->clCreateKernel(program, kernel_name, errcode_ret);
+  if (kernel) {
+    kernel_info info;
+    info.program = program;
+    info.name = kernel_name;
+    state().kernels.on_create(kernel, std::move(info));
+  }
+  return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram_wrap(
+    cl_program program,
+    cl_uint num_kernels,
+    cl_kernel *kernels,
+    cl_uint *num_kernels_ret) {
+  cl_uint created = 0;
+  const cl_int result = tdispatch->clCreateKernelsInProgram(program, num_kernels, kernels, &created);
+  if (num_kernels_ret)
+    *num_kernels_ret = created;
+  if (result == CL_SUCCESS && kernels != nullptr)
+    for (cl_uint i = 0; i < created; ++i)
+      state().kernels.on_create(kernels[i], kernel_info{});
+  return result;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCloneKernel_wrap(
+    cl_kernel source_kernel,
+    cl_int *errcode_ret) {
+  cl_kernel kernel = tdispatch->clCloneKernel(source_kernel, errcode_ret);
+  if (kernel)
+    state().kernels.on_create(kernel, kernel_info{});
+  return kernel;
+}
+
+// References the application takes and drops are only counted, the
+// implementation keeps the one reference of the layer.
+CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
+    cl_kernel kernel) {
+  if (state().kernels.on_retain(kernel))
+    return CL_SUCCESS;
+  return tdispatch->clRetainKernel(kernel);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel_wrap(
+    cl_kernel kernel) {
+  handle_registry<kernel_info>::entry released = {};
+  if (!state().kernels.on_release(kernel, &released))
+    return tdispatch->clReleaseKernel(kernel);
+  // Only filled in when the last reference was released.
+  if (released.generation == 0)
+    return CL_SUCCESS;
+  if (released.payload.program && state().programs.contains(released.payload.program))
+    state().put(released.payload.program, released.payload.name, kernel);
+  else
+    tdispatch->clReleaseKernel(kernel);
+  return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo_wrap(
+    cl_kernel kernel,
+    cl_kernel_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  if (param_name != CL_KERNEL_REFERENCE_COUNT)
+    return tdispatch->clGetKernelInfo(kernel, param_name, param_value_size, param_value,
+                                      param_value_size_ret);
+  cl_uint refcount = 0;
+  if (!state().kernels.find(kernel, [&refcount](const handle_registry<kernel_info>::entry &entry) {
+        refcount = static_cast<cl_uint>(entry.refcount);
+      }))
+    return tdispatch->clGetKernelInfo(kernel, param_name, param_value_size, param_value,
+                                      param_value_size_ret);
+  if (param_value && param_value_size < sizeof(refcount))
+    return CL_INVALID_VALUE;
+  if (param_value)
+    *static_cast<cl_uint *>(param_value) = refcount;
+  if (param_value_size_ret)
+    *param_value_size_ret = sizeof(refcount);
+  return CL_SUCCESS;
+}
+
+void mark_set(cl_kernel kernel, cl_uint arg_index) {
+  state().kernels.update(kernel, [arg_index](kernel_info &info) {
+    if (arg_index < info.args_set.size())
+      info.args_set[arg_index] = true;
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg_wrap(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    size_t arg_size,
+    const void *arg_value) {
+  const cl_int result = tdispatch->clSetKernelArg(kernel, arg_index, arg_size, arg_value);
+  if (result == CL_SUCCESS)
+    mark_set(kernel, arg_index);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer_wrap(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    const void *arg_value) {
+  const cl_int result = tdispatch->clSetKernelArgSVMPointer(kernel, arg_index, arg_value);
+  if (result == CL_SUCCESS)
+    mark_set(kernel, arg_index);
+  return result;
+}
+
+// False if kernel was recycled and some of its arguments were not set
+// since.
+bool args_ready(cl_kernel kernel) {
+  bool ready = true;
+  state().kernels.find(kernel, [&ready](const handle_registry<kernel_info>::entry &entry) {
+    ready = std::all_of(entry.payload.args_set.begin(), entry.payload.args_set.end(),
+                        [](bool set) { return set; });
+  });
+  return ready;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel_wrap(
+    cl_command_queue command_queue,
+    cl_kernel kernel,
+    cl_uint work_dim,
+    const size_t *global_work_offset,
+    const size_t *global_work_size,
+    const size_t *local_work_size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (!args_ready(kernel))
+    return CL_INVALID_KERNEL_ARGS;
+  return tdispatch->clEnqueueNDRangeKernel(command_queue, kernel, work_dim, global_work_offset,
+                                           global_work_size, local_work_size,
+                                           num_events_in_wait_list, event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask_wrap(
+    cl_command_queue command_queue,
+    cl_kernel kernel,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  if (!args_ready(kernel))
+    return CL_INVALID_KERNEL_ARGS;
+  return tdispatch->clEnqueueTask(command_queue, kernel, num_events_in_wait_list,
+                                  event_wait_list, event);
+}
+
+cl_program track_program(cl_program program) {
+  if (program)
+    state().programs.on_create(program, true);
+  return program;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource_wrap(
+    cl_context context,
+    cl_uint count,
+    const char **strings,
+    const size_t *lengths,
+    cl_int *errcode_ret) {
+  return track_program(
+      tdispatch->clCreateProgramWithSource(context, count, strings, lengths, errcode_ret));
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithIL_wrap(
+    cl_context context,
+    const void *il,
+    size_t length,
+    cl_int *errcode_ret) {
+  return track_program(tdispatch->clCreateProgramWithIL(context, il, length, errcode_ret));
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary_wrap(
+    cl_context context,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const size_t *lengths,
+    const unsigned char **binaries,
+    cl_int *binary_status,
+    cl_int *errcode_ret) {
+  return track_program(tdispatch->clCreateProgramWithBinary(
+      context, num_devices, device_list, lengths, binaries, binary_status, errcode_ret));
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBuiltInKernels_wrap(
+    cl_context context,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *kernel_names,
+    cl_int *errcode_ret) {
+  return track_program(tdispatch->clCreateProgramWithBuiltInKernels(
+      context, num_devices, device_list, kernel_names, errcode_ret));
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
+    cl_context context,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_programs,
+    const cl_program *input_programs,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data,
+    cl_int *errcode_ret) {
+  return track_program(tdispatch->clLinkProgram(context, num_devices, device_list, options,
+                                                num_input_programs, input_programs, pfn_notify,
+                                                user_data, errcode_ret));
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainProgram_wrap(
+    cl_program program) {
+  const cl_int result = tdispatch->clRetainProgram(program);
+  if (result == CL_SUCCESS)
+    state().programs.on_retain(program);
+  return result;
+}
+
+// Pooled kernels would keep the program alive, so they are released with
+// the last reference of the application.
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram_wrap(
+    cl_program program) {
+  handle_registry<bool>::entry released = {};
+  // Only filled in when the last reference was released.
+  if (state().programs.on_release(program, &released) && released.generation != 0)
+    state().flush(program);
+  return tdispatch->clReleaseProgram(program);
+}
+
+// Pooled kernels would make building the program again fail.
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  state().flush(program);
+  return tdispatch->clBuildProgram(program, num_devices, device_list, options, pfn_notify,
+                                   user_data);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_headers,
+    const cl_program *input_headers,
+    const char **header_include_names,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  state().flush(program);
+  return tdispatch->clCompileProgram(program, num_devices, device_list, options,
+                                     num_input_headers, input_headers, header_include_names,
+                                     pfn_notify, user_data);
+}
+
+void init_dispatch() {
+  dispatch.clCreateKernel = &clCreateKernel_wrap;
+  dispatch.clCreateKernelsInProgram = &clCreateKernelsInProgram_wrap;
+  dispatch.clCloneKernel = &clCloneKernel_wrap;
+  dispatch.clRetainKernel = &clRetainKernel_wrap;
+  dispatch.clReleaseKernel = &clReleaseKernel_wrap;
+  dispatch.clGetKernelInfo = &clGetKernelInfo_wrap;
+  dispatch.clSetKernelArg = &clSetKernelArg_wrap;
+  dispatch.clSetKernelArgSVMPointer = &clSetKernelArgSVMPointer_wrap;
+  dispatch.clEnqueueNDRangeKernel = &clEnqueueNDRangeKernel_wrap;
+  dispatch.clEnqueueTask = &clEnqueueTask_wrap;
+  dispatch.clCreateProgramWithSource = &clCreateProgramWithSource_wrap;
+  dispatch.clCreateProgramWithIL = &clCreateProgramWithIL_wrap;
+  dispatch.clCreateProgramWithBinary = &clCreateProgramWithBinary_wrap;
+  dispatch.clCreateProgramWithBuiltInKernels = &clCreateProgramWithBuiltInKernels_wrap;
+  dispatch.clLinkProgram = &clLinkProgram_wrap;
+  dispatch.clRetainProgram = &clRetainProgram_wrap;
+  dispatch.clReleaseProgram = &clReleaseProgram_wrap;
+  dispatch.clBuildProgram = &clBuildProgram_wrap;
+  dispatch.clCompileProgram = &clCompileProgram_wrap;
+}
+
+void report_at_exit() {
+  state().report();
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().set_output(settings.report.open("kernel_pool"));
+
+        // Everything that is not about kernels goes straight to the target.
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(report_at_exit);
+      });
+}
@@ -0,0 +1,122 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+cl_uint referenceCount(cl_kernel kernel)
+{
+    cl_uint count = 0;
+    cl_int CL_err = clGetKernelInfo(kernel, CL_KERNEL_REFERENCE_COUNT, sizeof(count), &count, NULL);
+    checkErr(CL_err, "clGetKernelInfo(CL_KERNEL_REFERENCE_COUNT)");
+    return count;
+}
+
+// Creates and releases a kernel around every launch, for the layer to hand
+// out the same kernel again, which then needs all its arguments set again.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_command_queue queue = NULL;
+    cl_mem buffer = NULL;
+    cl_program program = NULL;
+    cl_kernel saxpy = NULL, first = NULL, clone = NULL;
+    const char *source = "kernel void saxpy(global float *y, float a) {}";
+    size_t global_work_size = 64;
+    float a = 2.0f;
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+    queue = clCreateCommandQueue(context, device, 0, &CL_err);
+    checkErr(CL_err, "clCreateCommandQueue");
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 64 * sizeof(float), NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer");
+    program = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+    checkErr(CL_err, "clCreateProgramWithSource");
+    CL_err = clBuildProgram(program, 1, &device, NULL, NULL, NULL);
+    checkErr(CL_err, "clBuildProgram");
+
+    for (i = 0; i < 3; ++i)
+    {
+        saxpy = clCreateKernel(program, "saxpy", &CL_err);
+        checkErr(CL_err, "clCreateKernel");
+        if (i == 0)
+            first = saxpy;
+        else
+            printf("Kernel %i reused: %s\n", i, saxpy == first ? "yes" : "no");
+        CL_err = clSetKernelArg(saxpy, 0, sizeof(buffer), &buffer);
+        checkErr(CL_err, "clSetKernelArg(0)");
+        CL_err = clSetKernelArg(saxpy, 1, sizeof(a), &a);
+        checkErr(CL_err, "clSetKernelArg(1)");
+        CL_err = clEnqueueNDRangeKernel(queue, saxpy, 1, NULL, &global_work_size, NULL, 0, NULL, NULL);
+        checkErr(CL_err, "clEnqueueNDRangeKernel");
+        CL_err = clReleaseKernel(saxpy);
+        checkErr(CL_err, "clReleaseKernel");
+    }
+
+    saxpy = clCreateKernel(program, "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+    printf("Reference count: %u\n", referenceCount(saxpy));
+    CL_err = clRetainKernel(saxpy);
+    checkErr(CL_err, "clRetainKernel");
+    printf("Reference count after retain: %u\n", referenceCount(saxpy));
+    CL_err = clReleaseKernel(saxpy);
+    checkErr(CL_err, "clReleaseKernel");
+
+    CL_err = clSetKernelArg(saxpy, 0, sizeof(buffer), &buffer);
+    checkErr(CL_err, "clSetKernelArg(0)");
+    CL_err = clEnqueueTask(queue, saxpy, 0, NULL, NULL);
+    printf("Launch with an argument missing: %s\n",
+           CL_err == CL_INVALID_KERNEL_ARGS ? "CL_INVALID_KERNEL_ARGS" : "accepted");
+    CL_err = clSetKernelArg(saxpy, 1, sizeof(a), &a);
+    checkErr(CL_err, "clSetKernelArg(1)");
+    CL_err = clEnqueueTask(queue, saxpy, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueTask");
+
+    clone = clCloneKernel(saxpy, &CL_err);
+    checkErr(CL_err, "clCloneKernel");
+    CL_err = clEnqueueNDRangeKernel(queue, clone, 1, NULL, &global_work_size, NULL, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueNDRangeKernel(clone)");
+    CL_err = clFinish(queue);
+    checkErr(CL_err, "clFinish");
+
+    clReleaseKernel(clone);
+    first = saxpy;
+    clReleaseKernel(saxpy);
+    CL_err = clRetainProgram(program);
+    checkErr(CL_err, "clRetainProgram");
+    CL_err = clReleaseProgram(program);
+    checkErr(CL_err, "clReleaseProgram");
+    saxpy = clCreateKernel(program, "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+    printf("Kernel reused after retaining and releasing the program: %s\n",
+           saxpy == first ? "yes" : "no");
+
+    clReleaseProgram(program);
+    clReleaseKernel(saxpy);
+    clReleaseMemObject(buffer);
+    clReleaseCommandQueue(queue);
+    clReleaseContext(context);
+
+    return 0;
+}
@@ -0,0 +1,1007 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Times every kernel launch on the device, without changes to the
+// application. Command queues are created with profiling enabled, every
+// clEnqueueNDRangeKernel and clEnqueueTask gets an event, created by the
+// layer when the application does not ask for one, and the profiling
+// timestamps of the event are collected when the command completes.
+// Reports how often each kernel ran, how long it took on the device and
+// how long launches waited between being queued and starting.
+//
+// With timeline enabled, transfers, maps, markers and barriers are followed
+// the same way, and all the commands are written to timeline_filename as
+// Chrome trace events, one track per queue next to the calls made by the
+// host, along with a report of how busy each queue kept its device. Only
+// the last timeline_max_records commands and host calls are kept.
+
+#include "handle_registry.hpp"
+#include "kernel_timing_timeline.hpp"
+#include "latency_histogram.hpp"
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::handle_registry;
+using ocl_layer_utils::latency_histogram;
+using kernel_timing::command_kind;
+using kernel_timing::timeline;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::standard_error, "cl_kernel_timing.log"};
+  bool timeline = false;
+  std::string timeline_filename = "cl_kernel_timing.json";
+  unsigned timeline_max_records = 1000000;
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("kernel_timing", settings_from_file);
+
+  auto settings = layer_settings{};
+  settings.report.load(parser);
+  parser.get_bool("timeline", settings.timeline);
+  parser.get_filename("timeline_filename", settings.timeline_filename);
+  parser.get_unsigned("timeline_max_records", settings.timeline_max_records);
+  return settings;
+}
+
+layer_settings settings;
+
+// Launches of all the kernels sharing a name. Completion callbacks may run
+// on any thread, recording is serialized by the mutex.
+struct kernel_stats {
+  explicit kernel_stats(std::string kernel_name) : name(std::move(kernel_name)) {}
+
+  const std::string name;
+  std::mutex mutex;
+  latency_histogram execution;
+  latency_histogram launch;
+  uint64_t failed = 0;
+
+  void record(cl_ulong queued, cl_ulong start, cl_ulong end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    execution.record(end > start ? end - start : 0);
+    launch.record(start > queued ? start - queued : 0);
+  }
+
+  void record_failure() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++failed;
+  }
+};
+
+class timing_state {
+public:
+  // Never returns null, kernels whose name cannot be queried share the
+  // stats of the empty name.
+  kernel_stats *stats_of_name(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &stats = stats_[name];
+    if (!stats)
+      stats.reset(new kernel_stats(name));
+    return stats.get();
+  }
+
+  kernel_stats *stats_of(cl_kernel kernel) {
+    kernel_stats *stats = nullptr;
+    if (kernels.find(kernel, [&stats](const handle_registry<kernel_stats *>::entry &entry) {
+          stats = entry.payload;
+        }))
+      return stats;
+    return stats_of_name(query_name(kernel));
+  }
+
+  static std::string query_name(cl_kernel kernel) {
+    size_t size = 0;
+    if (tdispatch->clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, 0, nullptr, &size) !=
+            CL_SUCCESS ||
+        size == 0)
+      return std::string();
+    std::vector<char> name(size);
+    if (tdispatch->clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, size, name.data(),
+                                   nullptr) != CL_SUCCESS)
+      return std::string();
+    return std::string(name.data());
+  }
+
+  void set_output(std::ostream *output) { output_ = output; }
+  // Null if the report is not written.
+  std::ostream *output() { return output_; }
+
+  void report();
+
+  // Kernels created through the layer, with the stats of their name.
+  handle_registry<kernel_stats *> kernels;
+  // Queues the layer enabled profiling on.
+  struct queue_info {
+    // What the application asked for.
+    cl_command_queue_properties properties;
+    cl_device_id device;
+    // Track of the queue in the timeline.
+    unsigned track;
+  };
+  handle_registry<queue_info> queues;
+  std::atomic<unsigned> queue_count{0};
+
+  timeline commands;
+
+private:
+  std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<kernel_stats>> stats_;
+  std::ostream *output_ = &std::cerr;
+};
+
+void timing_state::report() {
+  if (!output_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<std::string, kernel_stats *>> kernels_run;
+  for (const auto &kv : stats_)
+    kernels_run.emplace_back(kv.first, kv.second.get());
+
+  std::ostream &out = *output_;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  const auto microseconds = [](uint64_t nanoseconds) { return nanoseconds / 1000.0; };
+  out << "kernel_timing report, times in microseconds\n"
+      << std::left << std::setw(32) << "kernel" << std::right << std::setw(10) << "launches"
+      << std::setw(14) << "total" << std::setw(12) << "p50" << std::setw(12) << "p99"
+      << std::setw(12) << "max" << std::setw(12) << "launch p50" << std::setw(12)
+      << "launch p99" << std::setw(8) << "failed" << '\n'
+      << std::fixed << std::setprecision(3);
+
+  struct row {
+    std::string name;
+    uint64_t launches, total, p50, p99, max, launch_p50, launch_p99, failed;
+  };
+  std::vector<row> rows;
+  for (const auto &kernel : kernels_run) {
+    kernel_stats &stats = *kernel.second;
+    std::lock_guard<std::mutex> stats_lock(stats.mutex);
+    if (stats.execution.count() == 0 && stats.failed == 0)
+      continue;
+    rows.push_back({kernel.first, stats.execution.count(), stats.execution.total(),
+                    stats.execution.value_at_percentile(50.0),
+                    stats.execution.value_at_percentile(99.0), stats.execution.max(),
+                    stats.launch.value_at_percentile(50.0),
+                    stats.launch.value_at_percentile(99.0), stats.failed});
+  }
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const row &a, const row &b) { return a.total > b.total; });
+  for (const row &r : rows)
+    out << std::left << std::setw(32) << (r.name.empty() ? "<unknown>" : r.name) << std::right
+        << std::setw(10) << r.launches << std::setw(14) << microseconds(r.total)
+        << std::setw(12) << microseconds(r.p50) << std::setw(12) << microseconds(r.p99)
+        << std::setw(12) << microseconds(r.max) << std::setw(12) << microseconds(r.launch_p50)
+        << std::setw(12) << microseconds(r.launch_p99) << std::setw(8) << r.failed << '\n';
+  out.flush();
+  out.flags(flags);
+  out.precision(precision);
+}
+
+using queue_entry = handle_registry<timing_state::queue_info>::entry;
+
+timing_state &state() {
+  return ocl_layer_utils::never_destroyed<timing_state>();
+}
+
+// Host side of a call, recorded to the timeline if it is enabled.
+class call_timer {
+public:
+  explicit call_timer(const char *function)
+      : function_(function), begin_(settings.timeline ? timeline::host_now() : 0) {}
+
+  ~call_timer() {
+    if (settings.timeline)
+      state().commands.add(
+          kernel_timing::host_call{thread(), function_, begin_, timeline::host_now()});
+  }
+
+private:
+  static unsigned thread() {
+    static std::atomic<unsigned> thread_count{0};
+    thread_local unsigned id = ++thread_count;
+    return id;
+  }
+
+  const char *function_;
+  uint64_t begin_;
+};
+
+// A command followed until it completes.
+struct pending_command {
+  command_kind kind;
+  const char *function;
+  // Not null for kernel launches.
+  kernel_stats *stats;
+  cl_device_id device;
+  unsigned track;
+};
+
+// Called once the command behind event completed, consumes the reference
+// to event the layer holds.
+void CL_CALLBACK on_command_complete(cl_event event, cl_int status, void *user_data) {
+  std::unique_ptr<pending_command> command(static_cast<pending_command *>(user_data));
+  cl_ulong queued = 0, submit = 0, start = 0, end = 0;
+  if (status < 0) {
+    if (command->stats)
+      command->stats->record_failure();
+  } else if (tdispatch->clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED,
+                                                sizeof(queued), &queued, nullptr) == CL_SUCCESS &&
+             tdispatch->clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_SUBMIT,
+                                                sizeof(submit), &submit, nullptr) == CL_SUCCESS &&
+             tdispatch->clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                                sizeof(start), &start, nullptr) == CL_SUCCESS &&
+             tdispatch->clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end),
+                                                &end, nullptr) == CL_SUCCESS) {
+    if (command->stats)
+      command->stats->record(queued, start, end);
+    if (settings.timeline && command->track != 0)
+      state().commands.add(
+          kernel_timing::device_command{command->device, command->track, command->kind,
+                                        command->stats ? command->stats->name : command->function,
+                                        queued, submit, start, end},
+          timeline::host_now());
+  }
+  tdispatch->clReleaseEvent(event);
+}
+
+// Follows the command enqueued to queue with event. The layer holds its
+// own reference to the event until the command completes, if owned is
+// false the event also belongs to the application.
+void track_command(cl_command_queue queue, command_kind kind, const char *function,
+                   kernel_stats *stats, cl_event event, bool owned) {
+  if (!owned && tdispatch->clRetainEvent(event) != CL_SUCCESS)
+    return;
+  auto command = new pending_command{kind, function, stats, nullptr, 0};
+  state().queues.find(queue, [command](const queue_entry &entry) {
+    command->device = entry.payload.device;
+    command->track = entry.payload.track;
+  });
+  if (tdispatch->clSetEventCallback(event, CL_COMPLETE, on_command_complete, command) !=
+      CL_SUCCESS) {
+    delete command;
+    tdispatch->clReleaseEvent(event);
+  }
+}
+
+// Enqueues a command with enqueue(cl_event *), which the layer gets an
+// event for even if the application does not ask for one.
+template <typename Enqueue>
+auto enqueue_command(cl_command_queue queue, command_kind kind, const char *function,
+                     kernel_stats *stats, cl_event *event, Enqueue &&enqueue)
+    -> decltype(enqueue(event)) {
+  const call_timer timer(function);
+  cl_event command = nullptr;
+  auto result = enqueue(&command);
+  if (command != nullptr) {
+    if (event)
+      *event = command;
+    track_command(queue, kind, function, stats, command, event == nullptr);
+  }
+  return result;
+}
+
+// Measures the offset between the clocks of device and the host, for the
+// timeline. Devices older than OpenCL 2.1 cannot tell, the timeline then
+// estimates it from completed commands.
+void correlate(cl_device_id device) {
+  cl_ulong device_time = 0, host_time = 0;
+  const uint64_t before = timeline::host_now();
+  if (tdispatch->clGetDeviceAndHostTimer(device, &device_time, &host_time) == CL_SUCCESS)
+    state().commands.correlate(device, device_time, before, timeline::host_now());
+}
+
+void track_queue(cl_command_queue queue, cl_device_id device,
+                 cl_command_queue_properties properties) {
+  const unsigned track = ++state().queue_count;
+  state().queues.on_create(queue, timing_state::queue_info{properties, device, track});
+  if (settings.timeline)
+    correlate(device);
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue_wrap(
+    cl_context context,
+    cl_device_id device,
+    cl_command_queue_properties properties,
+    cl_int *errcode_ret) {
+  cl_command_queue queue = tdispatch->clCreateCommandQueue(
+      context, device, properties | CL_QUEUE_PROFILING_ENABLE, errcode_ret);
+  if (queue != nullptr)
+    track_queue(queue, device, properties);
+  return queue;
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithProperties_wrap(
+    cl_context context,
+    cl_device_id device,
+    const cl_queue_properties *properties,
+    cl_int *errcode_ret) {
+  std::vector<cl_queue_properties> profiled;
+  cl_command_queue_properties requested = 0;
+  bool found = false;
+  for (const cl_queue_properties *property = properties; property && *property != 0;
+       property += 2) {
+    profiled.push_back(property[0]);
+    profiled.push_back(property[1]);
+    if (property[0] == CL_QUEUE_PROPERTIES) {
+      requested = static_cast<cl_command_queue_properties>(property[1]);
+      profiled.back() |= CL_QUEUE_PROFILING_ENABLE;
+      found = true;
+    }
+  }
+  if (!found) {
+    profiled.push_back(CL_QUEUE_PROPERTIES);
+    profiled.push_back(CL_QUEUE_PROFILING_ENABLE);
+  }
+  profiled.push_back(0);
+
+  cl_command_queue queue = tdispatch->clCreateCommandQueueWithProperties(
+      context, device, profiled.data(), errcode_ret);
+  if (queue != nullptr)
+    track_queue(queue, device, requested);
+  return queue;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue_wrap(
+    cl_command_queue command_queue) {
+  cl_int result = tdispatch->clRetainCommandQueue(command_queue);
+  if (result == CL_SUCCESS)
+    state().queues.on_retain(command_queue);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue_wrap(
+    cl_command_queue command_queue) {
+  cl_int result = tdispatch->clReleaseCommandQueue(command_queue);
+  if (result == CL_SUCCESS)
+    state().queues.on_release(command_queue);
+  return result;
+}
+
+// The application sees the properties it asked for, not profiling enabled
+// behind its back.
+CL_API_ENTRY cl_int CL_API_CALL clGetCommandQueueInfo_wrap(
+    cl_command_queue command_queue,
+    cl_command_queue_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  cl_int result = tdispatch->clGetCommandQueueInfo(
+      command_queue, param_name, param_value_size, param_value, param_value_size_ret);
+  if (result != CL_SUCCESS || param_value == nullptr)
+    return result;
+  cl_command_queue_properties requested = 0;
+  if (!state().queues.find(command_queue,
+                           [&requested](const queue_entry &entry) {
+                             requested = entry.payload.properties;
+                           }) ||
+      (requested & CL_QUEUE_PROFILING_ENABLE))
+    return result;
+
+  if (param_name == CL_QUEUE_PROPERTIES) {
+    *static_cast<cl_command_queue_properties *>(param_value) &= ~CL_QUEUE_PROFILING_ENABLE;
+  } else if (param_name == CL_QUEUE_PROPERTIES_ARRAY) {
+    auto properties = static_cast<cl_queue_properties *>(param_value);
+    const size_t count = param_value_size / sizeof(cl_queue_properties);
+    for (size_t i = 0; i + 1 < count && properties[i] != 0; i += 2)
+      if (properties[i] == CL_QUEUE_PROPERTIES)
+        properties[i + 1] &= ~static_cast<cl_queue_properties>(CL_QUEUE_PROFILING_ENABLE);
+  }
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetEventProfilingInfo_wrap(
+    cl_event event,
+    cl_profiling_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  cl_command_queue queue = nullptr;
+  cl_command_queue_properties requested = CL_QUEUE_PROFILING_ENABLE;
+  if (tdispatch->clGetEventInfo(event, CL_EVENT_COMMAND_QUEUE, sizeof(queue), &queue, nullptr) ==
+          CL_SUCCESS &&
+      queue != nullptr)
+    state().queues.find(queue,
+                        [&requested](const queue_entry &entry) {
+                          requested = entry.payload.properties;
+                        });
+  if (!(requested & CL_QUEUE_PROFILING_ENABLE))
+    return CL_PROFILING_INFO_NOT_AVAILABLE;
+  return tdispatch->clGetEventProfilingInfo(
+      event, param_name, param_value_size, param_value, param_value_size_ret);
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel_wrap(
+    cl_program program,
+    const char *kernel_name,
+    cl_int *errcode_ret) {
+  cl_kernel kernel = tdispatch->clCreateKernel(program, kernel_name, errcode_ret);
+  if (kernel != nullptr)
+    state().kernels.on_create(kernel, state().stats_of_name(kernel_name ? kernel_name : ""));
+  return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram_wrap(
+    cl_program program,
+    cl_uint num_kernels,
+    cl_kernel *kernels,
+    cl_uint *num_kernels_ret) {
+  cl_uint created = 0;
+  cl_int result = tdispatch->clCreateKernelsInProgram(program, num_kernels, kernels, &created);
+  if (num_kernels_ret)
+    *num_kernels_ret = created;
+  if (result == CL_SUCCESS && kernels != nullptr)
+    for (cl_uint i = 0; i < created; ++i)
+      state().kernels.on_create(kernels[i],
+                                state().stats_of_name(timing_state::query_name(kernels[i])));
+  return result;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCloneKernel_wrap(
+    cl_kernel source_kernel,
+    cl_int *errcode_ret) {
+  cl_kernel kernel = tdispatch->clCloneKernel(source_kernel, errcode_ret);
+  if (kernel != nullptr)
+    state().kernels.on_create(kernel, state().stats_of(source_kernel));
+  return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
+    cl_kernel kernel) {
+  cl_int result = tdispatch->clRetainKernel(kernel);
+  if (result == CL_SUCCESS)
+    state().kernels.on_retain(kernel);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel_wrap(
+    cl_kernel kernel) {
+  cl_int result = tdispatch->clReleaseKernel(kernel);
+  if (result == CL_SUCCESS)
+    state().kernels.on_release(kernel);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel_wrap(
+    cl_command_queue command_queue,
+    cl_kernel kernel,
+    cl_uint work_dim,
+    const size_t *global_work_offset,
+    const size_t *global_work_size,
+    const size_t *local_work_size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::kernel, "clEnqueueNDRangeKernel", state().stats_of(kernel),
+      event, [&](cl_event *command) {
+        return tdispatch->clEnqueueNDRangeKernel(
+            command_queue, kernel, work_dim, global_work_offset, global_work_size,
+            local_work_size, num_events_in_wait_list, event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask_wrap(
+    cl_command_queue command_queue,
+    cl_kernel kernel,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::kernel, "clEnqueueTask", state().stats_of(kernel), event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueTask(command_queue, kernel, num_events_in_wait_list,
+                                        event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_read,
+    size_t offset,
+    size_t size,
+    void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueReadBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueReadBuffer(command_queue, buffer, blocking_read, offset, size,
+                                              ptr, num_events_in_wait_list, event_wait_list,
+                                              command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_read,
+    const size_t *buffer_origin,
+    const size_t *host_origin,
+    const size_t *region,
+    size_t buffer_row_pitch,
+    size_t buffer_slice_pitch,
+    size_t host_row_pitch,
+    size_t host_slice_pitch,
+    void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueReadBufferRect", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueReadBufferRect(command_queue, buffer, blocking_read,
+                                                  buffer_origin, host_origin, region,
+                                                  buffer_row_pitch, buffer_slice_pitch,
+                                                  host_row_pitch, host_slice_pitch, ptr,
+                                                  num_events_in_wait_list, event_wait_list,
+                                                  command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    size_t offset,
+    size_t size,
+    const void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueWriteBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueWriteBuffer(command_queue, buffer, blocking_write, offset, size,
+                                               ptr, num_events_in_wait_list, event_wait_list,
+                                               command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_write,
+    const size_t *buffer_origin,
+    const size_t *host_origin,
+    const size_t *region,
+    size_t buffer_row_pitch,
+    size_t buffer_slice_pitch,
+    size_t host_row_pitch,
+    size_t host_slice_pitch,
+    const void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueWriteBufferRect", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueWriteBufferRect(command_queue, buffer, blocking_write,
+                                                   buffer_origin, host_origin, region,
+                                                   buffer_row_pitch, buffer_slice_pitch,
+                                                   host_row_pitch, host_slice_pitch, ptr,
+                                                   num_events_in_wait_list, event_wait_list,
+                                                   command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_buffer,
+    size_t src_offset,
+    size_t dst_offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueCopyBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueCopyBuffer(command_queue, src_buffer, dst_buffer, src_offset,
+                                              dst_offset, size, num_events_in_wait_list,
+                                              event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferRect_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_buffer,
+    const size_t *src_origin,
+    const size_t *dst_origin,
+    const size_t *region,
+    size_t src_row_pitch,
+    size_t src_slice_pitch,
+    size_t dst_row_pitch,
+    size_t dst_slice_pitch,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueCopyBufferRect", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueCopyBufferRect(command_queue, src_buffer, dst_buffer, src_origin,
+                                                  dst_origin, region, src_row_pitch,
+                                                  src_slice_pitch, dst_row_pitch, dst_slice_pitch,
+                                                  num_events_in_wait_list, event_wait_list,
+                                                  command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    const void *pattern,
+    size_t pattern_size,
+    size_t offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueFillBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueFillBuffer(command_queue, buffer, pattern, pattern_size, offset,
+                                              size, num_events_in_wait_list, event_wait_list,
+                                              command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem image,
+    cl_bool blocking_read,
+    const size_t *origin,
+    const size_t *region,
+    size_t row_pitch,
+    size_t slice_pitch,
+    void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueReadImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueReadImage(command_queue, image, blocking_read, origin, region,
+                                             row_pitch, slice_pitch, ptr, num_events_in_wait_list,
+                                             event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem image,
+    cl_bool blocking_write,
+    const size_t *origin,
+    const size_t *region,
+    size_t input_row_pitch,
+    size_t input_slice_pitch,
+    const void *ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueWriteImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueWriteImage(command_queue, image, blocking_write, origin, region,
+                                              input_row_pitch, input_slice_pitch, ptr,
+                                              num_events_in_wait_list, event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_image,
+    cl_mem dst_image,
+    const size_t *src_origin,
+    const size_t *dst_origin,
+    const size_t *region,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueCopyImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueCopyImage(command_queue, src_image, dst_image, src_origin,
+                                             dst_origin, region, num_events_in_wait_list,
+                                             event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImageToBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_image,
+    cl_mem dst_buffer,
+    const size_t *src_origin,
+    const size_t *region,
+    size_t dst_offset,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueCopyImageToBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueCopyImageToBuffer(command_queue, src_image, dst_buffer,
+                                                     src_origin, region, dst_offset,
+                                                     num_events_in_wait_list, event_wait_list,
+                                                     command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferToImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem src_buffer,
+    cl_mem dst_image,
+    size_t src_offset,
+    const size_t *dst_origin,
+    const size_t *region,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueCopyBufferToImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueCopyBufferToImage(command_queue, src_buffer, dst_image,
+                                                     src_offset, dst_origin, region,
+                                                     num_events_in_wait_list, event_wait_list,
+                                                     command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem image,
+    const void *fill_color,
+    const size_t *origin,
+    const size_t *region,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueFillImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueFillImage(command_queue, image, fill_color, origin, region,
+                                             num_events_in_wait_list, event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY void * CL_API_CALL clEnqueueMapBuffer_wrap(
+    cl_command_queue command_queue,
+    cl_mem buffer,
+    cl_bool blocking_map,
+    cl_map_flags map_flags,
+    size_t offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event,
+    cl_int *errcode_ret) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueMapBuffer", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueMapBuffer(command_queue, buffer, blocking_map, map_flags, offset,
+                                             size, num_events_in_wait_list, event_wait_list,
+                                             command, errcode_ret);
+      });
+}
+
+CL_API_ENTRY void * CL_API_CALL clEnqueueMapImage_wrap(
+    cl_command_queue command_queue,
+    cl_mem image,
+    cl_bool blocking_map,
+    cl_map_flags map_flags,
+    const size_t *origin,
+    const size_t *region,
+    size_t *image_row_pitch,
+    size_t *image_slice_pitch,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event,
+    cl_int *errcode_ret) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueMapImage", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueMapImage(command_queue, image, blocking_map, map_flags, origin,
+                                            region, image_row_pitch, image_slice_pitch,
+                                            num_events_in_wait_list, event_wait_list, command,
+                                            errcode_ret);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueUnmapMemObject_wrap(
+    cl_command_queue command_queue,
+    cl_mem memobj,
+    void *mapped_ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::transfer, "clEnqueueUnmapMemObject", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueUnmapMemObject(command_queue, memobj, mapped_ptr,
+                                                  num_events_in_wait_list, event_wait_list,
+                                                  command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarker_wrap(
+    cl_command_queue command_queue,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::sync, "clEnqueueMarker", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueMarker(command_queue, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarkerWithWaitList_wrap(
+    cl_command_queue command_queue,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::sync, "clEnqueueMarkerWithWaitList", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueMarkerWithWaitList(command_queue, num_events_in_wait_list,
+                                                      event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrierWithWaitList_wrap(
+    cl_command_queue command_queue,
+    cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list,
+    cl_event *event) {
+  return enqueue_command(
+      command_queue, command_kind::sync, "clEnqueueBarrierWithWaitList", nullptr, event,
+      [&](cl_event *command) {
+        return tdispatch->clEnqueueBarrierWithWaitList(command_queue, num_events_in_wait_list,
+                                                       event_wait_list, command);
+      });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFlush_wrap(
+    cl_command_queue command_queue) {
+  const call_timer timer("clFlush");
+  return tdispatch->clFlush(command_queue);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish_wrap(
+    cl_command_queue command_queue) {
+  const call_timer timer("clFinish");
+  return tdispatch->clFinish(command_queue);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents_wrap(
+    cl_uint num_events,
+    const cl_event *event_list) {
+  const call_timer timer("clWaitForEvents");
+  return tdispatch->clWaitForEvents(num_events, event_list);
+}
+
+void init_dispatch() {
+  dispatch.clCreateCommandQueue = &clCreateCommandQueue_wrap;
+  dispatch.clCreateCommandQueueWithProperties = &clCreateCommandQueueWithProperties_wrap;
+  dispatch.clRetainCommandQueue = &clRetainCommandQueue_wrap;
+  dispatch.clReleaseCommandQueue = &clReleaseCommandQueue_wrap;
+  dispatch.clGetCommandQueueInfo = &clGetCommandQueueInfo_wrap;
+  dispatch.clGetEventProfilingInfo = &clGetEventProfilingInfo_wrap;
+  dispatch.clCreateKernel = &clCreateKernel_wrap;
+  dispatch.clCreateKernelsInProgram = &clCreateKernelsInProgram_wrap;
+  dispatch.clCloneKernel = &clCloneKernel_wrap;
+  dispatch.clRetainKernel = &clRetainKernel_wrap;
+  dispatch.clReleaseKernel = &clReleaseKernel_wrap;
+  dispatch.clEnqueueNDRangeKernel = &clEnqueueNDRangeKernel_wrap;
+  dispatch.clEnqueueTask = &clEnqueueTask_wrap;
+  if (!settings.timeline)
+    return;
+  dispatch.clEnqueueReadBuffer = &clEnqueueReadBuffer_wrap;
+  dispatch.clEnqueueReadBufferRect = &clEnqueueReadBufferRect_wrap;
+  dispatch.clEnqueueWriteBuffer = &clEnqueueWriteBuffer_wrap;
+  dispatch.clEnqueueWriteBufferRect = &clEnqueueWriteBufferRect_wrap;
+  dispatch.clEnqueueCopyBuffer = &clEnqueueCopyBuffer_wrap;
+  dispatch.clEnqueueCopyBufferRect = &clEnqueueCopyBufferRect_wrap;
+  dispatch.clEnqueueFillBuffer = &clEnqueueFillBuffer_wrap;
+  dispatch.clEnqueueReadImage = &clEnqueueReadImage_wrap;
+  dispatch.clEnqueueWriteImage = &clEnqueueWriteImage_wrap;
+  dispatch.clEnqueueCopyImage = &clEnqueueCopyImage_wrap;
+  dispatch.clEnqueueCopyImageToBuffer = &clEnqueueCopyImageToBuffer_wrap;
+  dispatch.clEnqueueCopyBufferToImage = &clEnqueueCopyBufferToImage_wrap;
+  dispatch.clEnqueueFillImage = &clEnqueueFillImage_wrap;
+  dispatch.clEnqueueMapBuffer = &clEnqueueMapBuffer_wrap;
+  dispatch.clEnqueueMapImage = &clEnqueueMapImage_wrap;
+  dispatch.clEnqueueUnmapMemObject = &clEnqueueUnmapMemObject_wrap;
+  dispatch.clEnqueueMarker = &clEnqueueMarker_wrap;
+  dispatch.clEnqueueMarkerWithWaitList = &clEnqueueMarkerWithWaitList_wrap;
+  dispatch.clEnqueueBarrierWithWaitList = &clEnqueueBarrierWithWaitList_wrap;
+  dispatch.clFlush = &clFlush_wrap;
+  dispatch.clFinish = &clFinish_wrap;
+  dispatch.clWaitForEvents = &clWaitForEvents_wrap;
+}
+
+void report_at_exit() {
+  state().report();
+  if (!settings.timeline)
+    return;
+  if (state().output())
+    state().commands.report(*state().output());
+  std::ofstream trace(settings.timeline_filename);
+  if (trace.good())
+    state().commands.write_chrome(trace);
+  else
+    std::cerr << "kernel_timing failed to open the timeline file: " << settings.timeline_filename
+              << std::endl;
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().set_output(settings.report.open("kernel_timing"));
+        state().commands.set_max_records(settings.timeline_max_records);
+
+        // Everything that is not timed goes straight to the target.
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(report_at_exit);
+      });
+}
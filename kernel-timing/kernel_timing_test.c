@@ -0,0 +1,103 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+// Launches kernels on a queue created without profiling, for the layer to
+// time them anyway, between transfers on two queues for the timeline.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_command_queue queue = NULL, transfer_queue = NULL;
+    cl_mem buffer = NULL;
+    float data[64] = {0};
+    cl_program program = NULL;
+    cl_kernel saxpy = NULL, clone = NULL;
+    cl_kernel kernels[3];
+    cl_event event = NULL;
+    cl_command_queue_properties properties = 0;
+    cl_ulong start = 0;
+    const char *source = "kernel void saxpy() {}";
+    size_t global_work_size = 64;
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+    queue = clCreateCommandQueue(context, device, 0, &CL_err);
+    checkErr(CL_err, "clCreateCommandQueue");
+    CL_err = clGetCommandQueueInfo(queue, CL_QUEUE_PROPERTIES, sizeof(properties), &properties, NULL);
+    checkErr(CL_err, "clGetCommandQueueInfo(CL_QUEUE_PROPERTIES)");
+    printf("Queue properties: %u\n", (unsigned)properties);
+    transfer_queue = clCreateCommandQueue(context, device, 0, &CL_err);
+    checkErr(CL_err, "clCreateCommandQueue(transfer_queue)");
+    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(data), NULL, &CL_err);
+    checkErr(CL_err, "clCreateBuffer");
+
+    program = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+    checkErr(CL_err, "clCreateProgramWithSource");
+    saxpy = clCreateKernel(program, "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+    clone = clCloneKernel(saxpy, &CL_err);
+    checkErr(CL_err, "clCloneKernel");
+    CL_err = clCreateKernelsInProgram(program, 3, kernels, NULL);
+    checkErr(CL_err, "clCreateKernelsInProgram");
+
+    CL_err = clEnqueueWriteBuffer(queue, buffer, CL_FALSE, 0, sizeof(data), data, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueWriteBuffer");
+    for (i = 0; i < 3; ++i)
+    {
+        CL_err = clEnqueueNDRangeKernel(queue, saxpy, 1, NULL, &global_work_size, NULL, 0, NULL, NULL);
+        checkErr(CL_err, "clEnqueueNDRangeKernel");
+    }
+    CL_err = clEnqueueNDRangeKernel(queue, clone, 1, NULL, &global_work_size, NULL, 0, NULL, &event);
+    checkErr(CL_err, "clEnqueueNDRangeKernel(event)");
+    CL_err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL);
+    printf("Profiling info available: %s\n", CL_err == CL_SUCCESS ? "yes" : "no");
+    CL_err = clReleaseEvent(event);
+    checkErr(CL_err, "clReleaseEvent");
+    CL_err = clEnqueueMarkerWithWaitList(queue, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueMarkerWithWaitList");
+    CL_err = clEnqueueTask(queue, kernels[1], 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueTask");
+    CL_err = clEnqueueReadBuffer(transfer_queue, buffer, CL_FALSE, 0, sizeof(data), data, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueReadBuffer");
+    CL_err = clEnqueueBarrierWithWaitList(transfer_queue, 0, NULL, NULL);
+    checkErr(CL_err, "clEnqueueBarrierWithWaitList");
+    CL_err = clFinish(queue);
+    checkErr(CL_err, "clFinish");
+    CL_err = clFinish(transfer_queue);
+    checkErr(CL_err, "clFinish(transfer_queue)");
+    printf("Launched 5 kernels\n");
+
+    for (i = 0; i < 3; ++i)
+        clReleaseKernel(kernels[i]);
+    clReleaseKernel(clone);
+    clReleaseKernel(saxpy);
+    clReleaseProgram(program);
+    clReleaseMemObject(buffer);
+    clReleaseCommandQueue(transfer_queue);
+    clReleaseCommandQueue(queue);
+    clReleaseContext(context);
+
+    return 0;
+}
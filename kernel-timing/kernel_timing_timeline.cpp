@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#include "kernel_timing_timeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <vector>
+
+namespace kernel_timing {
+
+namespace {
+
+struct interval {
+  int64_t begin, end;
+};
+
+// Sorts intervals and merges the overlapping ones.
+std::vector<interval> merge(std::vector<interval> intervals) {
+  std::sort(intervals.begin(), intervals.end(),
+            [](const interval &a, const interval &b) { return a.begin < b.begin; });
+  std::vector<interval> merged;
+  for (const interval &i : intervals) {
+    if (!merged.empty() && i.begin <= merged.back().end)
+      merged.back().end = std::max(merged.back().end, i.end);
+    else
+      merged.push_back(i);
+  }
+  return merged;
+}
+
+int64_t length(const std::vector<interval> &merged) {
+  int64_t result = 0;
+  for (const interval &i : merged)
+    result += i.end - i.begin;
+  return result;
+}
+
+// Length of the intersection of two merged lists of intervals.
+int64_t overlap(const std::vector<interval> &a, const std::vector<interval> &b) {
+  int64_t result = 0;
+  for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+    const int64_t begin = std::max(a[i].begin, b[j].begin);
+    const int64_t end = std::min(a[i].end, b[j].end);
+    if (begin < end)
+      result += end - begin;
+    if (a[i].end < b[j].end)
+      ++i;
+    else
+      ++j;
+  }
+  return result;
+}
+
+const char *category(command_kind kind) {
+  switch (kind) {
+  case command_kind::kernel:
+    return "kernel";
+  case command_kind::transfer:
+    return "transfer";
+  case command_kind::sync:
+    return "sync";
+  }
+  return "";
+}
+
+std::string json_escape(const std::string &value) {
+  std::string result;
+  for (char c : value) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      result += c;
+  }
+  return result;
+}
+
+} // namespace
+
+uint64_t timeline::host_now() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+void timeline::set_max_records(size_t max_records) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_records_ = max_records;
+}
+
+// The host timestamp clGetDeviceAndHostTimer returns is on a clock of the
+// implementation's choosing, so the call is bracketed with host_now()
+// instead and the device is assumed to have been sampled halfway.
+void timeline::correlate(cl_device_id device, cl_ulong device_time, uint64_t before,
+                         uint64_t after) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  device_clock &clock = clocks_[device];
+  clock.correlated = true;
+  clock.offset = static_cast<int64_t>(before + (after - before) / 2) -
+                 static_cast<int64_t>(device_time);
+}
+
+// A command cannot end later than its completion is noticed on the host,
+// the smallest difference seen is the best estimate of the offset.
+void timeline::add(device_command command, uint64_t completed_at) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  device_clock &clock = clocks_[command.device];
+  if (!clock.correlated)
+    clock.offset = std::min(clock.offset, static_cast<int64_t>(completed_at) -
+                                              static_cast<int64_t>(command.end));
+  commands_.push_back(std::move(command));
+  if (commands_.size() > max_records_) {
+    commands_.pop_front();
+    ++dropped_commands_;
+  }
+}
+
+void timeline::add(const host_call &call) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  calls_.push_back(call);
+  if (calls_.size() > max_records_) {
+    calls_.pop_front();
+    ++dropped_calls_;
+  }
+}
+
+int64_t timeline::offset_of(cl_device_id device) const {
+  auto it = clocks_.find(device);
+  return it != clocks_.end() && it->second.offset != std::numeric_limits<int64_t>::max()
+             ? it->second.offset
+             : 0;
+}
+
+void timeline::write_chrome(std::ostream &out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t origin = std::numeric_limits<int64_t>::max();
+  std::set<unsigned> queues;
+  for (const host_call &call : calls_)
+    origin = std::min(origin, static_cast<int64_t>(call.begin));
+  for (const device_command &command : commands_) {
+    origin = std::min(origin, static_cast<int64_t>(command.queued) + offset_of(command.device));
+    queues.insert(command.queue);
+  }
+  const auto microseconds = [origin](int64_t timestamp) { return (timestamp - origin) / 1000.0; };
+
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+      << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"host\"}},\n"
+      << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"device\"}}";
+  for (unsigned queue : queues)
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":" << queue
+        << ",\"args\":{\"name\":\"queue " << queue << "\"}}";
+  for (const host_call &call : calls_)
+    out << ",\n{\"name\":\"" << call.function << "\",\"cat\":\"opencl\",\"ph\":\"X\",\"ts\":"
+        << microseconds(static_cast<int64_t>(call.begin))
+        << ",\"dur\":" << (call.end - call.begin) / 1000.0 << ",\"pid\":1,\"tid\":" << call.thread
+        << '}';
+  for (const device_command &command : commands_) {
+    const int64_t offset = offset_of(command.device);
+    out << ",\n{\"name\":\"" << json_escape(command.name) << "\",\"cat\":\""
+        << category(command.kind) << "\",\"ph\":\"X\",\"ts\":"
+        << microseconds(static_cast<int64_t>(command.start) + offset)
+        << ",\"dur\":" << (command.end - command.start) / 1000.0 << ",\"pid\":2,\"tid\":"
+        << command.queue << ",\"args\":{\"queued\":"
+        << microseconds(static_cast<int64_t>(command.queued) + offset)
+        << ",\"submit\":" << microseconds(static_cast<int64_t>(command.submit) + offset) << "}}";
+  }
+  out << "\n]}\n";
+  out.flush();
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void timeline::report(std::ostream &out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Markers and barriers do not keep the device busy.
+  std::map<unsigned, std::vector<interval>> busy;
+  std::map<unsigned, size_t> counts;
+  std::vector<interval> transfers, kernels;
+  for (const device_command &command : commands_) {
+    ++counts[command.queue];
+    if (command.kind == command_kind::sync)
+      continue;
+    const int64_t offset = offset_of(command.device);
+    const interval run = {static_cast<int64_t>(command.start) + offset,
+                          static_cast<int64_t>(command.end) + offset};
+    busy[command.queue].push_back(run);
+    (command.kind == command_kind::kernel ? kernels : transfers).push_back(run);
+  }
+
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  const auto microseconds = [](int64_t nanoseconds) { return nanoseconds / 1000.0; };
+  out << "queue timeline, times in microseconds\n"
+      << std::left << std::setw(8) << "queue" << std::right << std::setw(10) << "commands"
+      << std::setw(14) << "busy" << std::setw(14) << "span" << std::setw(13) << "utilization"
+      << std::setw(8) << "gaps" << std::setw(14) << "idle" << std::setw(12) << "max gap" << '\n'
+      << std::fixed << std::setprecision(3);
+  for (const auto &count : counts) {
+    const std::vector<interval> merged = merge(busy[count.first]);
+    const int64_t busy_time = length(merged);
+    const int64_t span = merged.empty() ? 0 : merged.back().end - merged.front().begin;
+    int64_t max_gap = 0;
+    for (size_t i = 1; i < merged.size(); ++i)
+      max_gap = std::max(max_gap, merged[i].begin - merged[i - 1].end);
+    out << std::left << std::setw(8) << count.first << std::right << std::setw(10)
+        << count.second << std::setw(14) << microseconds(busy_time) << std::setw(14)
+        << microseconds(span) << std::setw(12)
+        << (span != 0 ? 100.0 * static_cast<double>(busy_time) / static_cast<double>(span)
+                      : 0.0)
+        << '%' << std::setw(8) << (merged.empty() ? 0 : merged.size() - 1) << std::setw(14)
+        << microseconds(span - busy_time) << std::setw(12) << microseconds(max_gap) << '\n';
+  }
+  const std::vector<interval> merged_transfers = merge(transfers);
+  out << "transfer/compute overlap: " << microseconds(overlap(merged_transfers, merge(kernels)))
+      << " of " << microseconds(length(merged_transfers)) << " transferring\n";
+  if (dropped_commands_ != 0 || dropped_calls_ != 0)
+    out << "dropped the oldest " << dropped_commands_ << " commands and " << dropped_calls_
+        << " host calls past " << max_records_ << " records\n";
+  out.flush();
+  out.flags(flags);
+  out.precision(precision);
+}
+
+} // namespace kernel_timing
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#pragma once
+
+#include <CL/cl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace kernel_timing {
+
+enum class command_kind { kernel, transfer, sync };
+
+// A command as it ran on a device, timestamps on the clock of the device.
+struct device_command {
+  cl_device_id device;
+  // Numbered from 1 in order of creation of the queues.
+  unsigned queue;
+  command_kind kind;
+  std::string name;
+  cl_ulong queued, submit, start, end;
+};
+
+// A call made on the host, timestamps from host_now().
+struct host_call {
+  // Numbered from 1 in order of their first recorded call.
+  unsigned thread;
+  const char *function;
+  uint64_t begin, end;
+};
+
+// Commands of all queues and the host calls that enqueued and waited for
+// them, on a common timeline. Device timestamps are moved to the host clock
+// with the offset measured by correlate() for their device, devices that
+// cannot be correlated fall back to an estimate taken when their commands
+// complete. Only the most recent max_records commands and host calls are
+// kept, the oldest ones are dropped past it.
+class timeline {
+public:
+  // Nanoseconds on a steady clock.
+  static uint64_t host_now();
+
+  void set_max_records(size_t max_records);
+
+  // Records that the device clock read device_time somewhere between the
+  // host times before and after. Later samples replace earlier ones.
+  void correlate(cl_device_id device, cl_ulong device_time, uint64_t before, uint64_t after);
+
+  void add(device_command command, uint64_t completed_at);
+  void add(const host_call &call);
+
+  // One track per thread for the host calls, one per queue for the
+  // commands.
+  void write_chrome(std::ostream &out) const;
+
+  // Per queue utilization and idle gaps between commands, and how much
+  // transfers and kernels overlapped across all queues, over the commands
+  // that were kept.
+  void report(std::ostream &out) const;
+
+private:
+  struct device_clock {
+    bool correlated = false;
+    // Host time minus device time.
+    int64_t offset = std::numeric_limits<int64_t>::max();
+  };
+
+  int64_t offset_of(cl_device_id device) const;
+
+  mutable std::mutex mutex_;
+  std::map<cl_device_id, device_clock> clocks_;
+  size_t max_records_ = std::numeric_limits<size_t>::max();
+  std::deque<device_command> commands_;
+  std::deque<host_call> calls_;
+  uint64_t dropped_commands_ = 0;
+  uint64_t dropped_calls_ = 0;
+};
+
+} // namespace kernel_timing
@@ -3,6 +3,11 @@
 #endif
 
 #include "utils.hpp"
+#include "dispatch_mask.hpp"
+#include "log_sink.hpp"
+#include "published.hpp"
+#include "settings_watcher.hpp"
+#include "violation_reporter.hpp"
 
 #include <cstdlib>
 #include <cstring>
@@ -139,19 +144,25 @@ struct stream_deleter {
 };
 
 ocl_layer_utils::stream_ptr log_stream;
+ocl_layer_utils::violation_reporter reporter;
 
 struct layer_settings {
   enum class DebugLogType { StdOut, StdErr, File };
 
-  static layer_settings load();
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
 
   DebugLogType log_type = DebugLogType::StdErr;
   std::string log_filename;
+  ocl_layer_utils::log_sink_options log_options;
   bool transparent = false;
+  unsigned report_limit = 10;
+  ocl_layer_utils::dispatch_mask mask;
+  // Reload the settings file when it changes. log_options and mask only
+  // take effect at initialization.
+  bool watch_settings = false;
 };
 
-layer_settings layer_settings::load() {
-  const auto settings_from_file = ocl_layer_utils::load_settings();
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
   const auto parser =
       ocl_layer_utils::settings_parser("object_lifetime", settings_from_file);
 
@@ -162,12 +173,17 @@ layer_settings layer_settings::load() {
                                           {"file", DebugLogType::File}};
   parser.get_enumeration("log_sink", debug_log_values, settings.log_type);
   parser.get_filename("log_filename", settings.log_filename);
+  settings.log_options = ocl_layer_utils::load_log_sink_options(parser);
   parser.get_bool("transparent", settings.transparent);
+  parser.get_unsigned("report_limit", settings.report_limit);
+  settings.mask = ocl_layer_utils::dispatch_mask::load(parser);
+  parser.get_bool("watch_settings", settings.watch_settings);
 
   return settings;
 }
 
-layer_settings settings;
+// Current settings, replaced when the settings file is reloaded.
+ocl_layer_utils::published<layer_settings> settings;
 
 static struct _cl_icd_dispatch dispatch = {};
 
@@ -175,66 +191,78 @@ static const struct _cl_icd_dispatch *tdispatch;
 }
 
 static cl_int error_already_exist(const trimmed__func__& func, void *handle, object_type t, cl_long ref_count) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " already exist with refcount: " << ref_count << "\n";
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[t];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[t];
+  reporter.report({func.str, func.length, "object already exist", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " already exist with refcount: " << ref_count << "\n";
+  });
+  return error;
 }
 
 static cl_int error_ref_count(const trimmed__func__& func, void *handle, object_type t, cl_long ref_count) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " used with refcount: " << ref_count << "\n";
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[t];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[t];
+  reporter.report({func.str, func.length, "object used with invalid refcount", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " used with refcount: " << ref_count << "\n";
+  });
+  return error;
 }
 
 static cl_int error_invalid_type(const trimmed__func__& func, void *handle, object_type t, object_type expect) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " was used whereas function expects: " <<
-               object_type_names[expect] << "\n";
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[expect];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[expect];
+  reporter.report({func.str, func.length, "object of the wrong type was used", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " was used whereas function expects: " <<
+           object_type_names[expect] << "\n";
+  });
+  return error;
 }
 
 static cl_int error_does_not_exist(const trimmed__func__& func, void *handle, object_type t) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " was used but ";
-  auto it = deleted_objects.find(handle);
-  if (it == deleted_objects.end()) {
-    *log_stream << "it does not exist" << "\n";
-  } else {
-    *log_stream << "it was recently deleted with type: " <<
-                 object_type_names[it->second.back().type] << "\n";
-  }
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[t];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[t];
+  reporter.report({func.str, func.length, "object was used but it does not exist", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " was used but ";
+    auto it = deleted_objects.find(handle);
+    if (it == deleted_objects.end()) {
+      out << "it does not exist" << "\n";
+    } else {
+      out << "it was recently deleted with type: " <<
+             object_type_names[it->second.back().type] << "\n";
+    }
+  });
+  return error;
 }
 
 static cl_int error_invalid_release(const trimmed__func__& func, void *handle, object_type t) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " was released before being retained" << "\n";
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[t];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[t];
+  reporter.report({func.str, func.length, "object was released before being retained", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " was released before being retained" << "\n";
+  });
+  return error;
 }
 
 static cl_int error_implicitly_retained(const trimmed__func__& func, void *handle, object_type t, cl_long num_children) {
-  *log_stream << "In " << func << " " <<
-               object_type_names[t] <<
-               ": " << handle <<
-               " used with explicit refcount: 0 and implicit refcount: " <<
-               num_children << "\n";
-  log_stream->flush();
-  return settings.transparent ? CL_SUCCESS : object_errors[t];
+  const cl_int error = settings.get()->transparent ? CL_SUCCESS : object_errors[t];
+  reporter.report({func.str, func.length, "object used with explicit refcount: 0", {handle}, error}, [&](std::ostream& out) {
+    out << "In " << func << " " <<
+           object_type_names[t] <<
+           ": " << handle <<
+           " used with explicit refcount: 0 and implicit refcount: " <<
+           num_children << "\n";
+  });
+  return error;
 }
 
 static cl_version get_platform_version(cl_platform_id platform) {
@@ -865,10 +893,15 @@ cl_int check_retain<OCL_MEM>(const trimmed__func__& func, void *handle) {
 }
 
 static void report() {
+  reporter.summarize();
   std::lock_guard<std::mutex> g{objects_mutex};
   bool header_printed = false;
+  const bool structured = reporter.format() != ocl_layer_utils::log_format::text;
   for (auto it = objects.begin(); it != objects.end(); ++it) {
-    if (it->second.refcount > 0) {
+    if (it->second.refcount > 0 && structured) {
+      static const char exit_function[] = "exit";
+      reporter.report({exit_function, sizeof(exit_function) - 1, "object leaked", {it->first}, CL_SUCCESS});
+    } else if (it->second.refcount > 0) {
       if(!header_printed) {
         *log_stream << "OpenCL object leaks:\n";
         header_printed = true;
@@ -882,6 +915,8 @@ static void report() {
   }
   objects.clear();
   deleted_objects.clear();
+  if (structured)
+    reporter.summarize();
 }
 
 #define CHECK_RETAIN(type, handle)                                             \
@@ -915,27 +950,68 @@ clGetLayerInfo(
   return CL_SUCCESS;
 }
 
-void init_output_stream() {
-  switch(settings.log_type) {
+void init_output_stream(const layer_settings &current) {
+  using ocl_layer_utils::log_sink_stream;
+  switch(current.log_type) {
   case layer_settings::DebugLogType::StdOut:
-    log_stream.reset(&std::cout);
+    log_stream.reset(new log_sink_stream(std::cout, current.log_options));
     break;
   case layer_settings::DebugLogType::StdErr:
-    log_stream.reset(&std::cerr);
+    log_stream.reset(new log_sink_stream(std::cerr, current.log_options));
     break;
-  case layer_settings::DebugLogType::File:
-    log_stream.reset(new std::ofstream(settings.log_filename));
-    if (log_stream->fail()) {
-      log_stream.reset(&std::cerr);
+  case layer_settings::DebugLogType::File: {
+    auto sink = std::make_unique<log_sink_stream>(current.log_filename, current.log_options);
+    if (sink->is_open()) {
+      log_stream.reset(sink.release());
+    } else {
+      log_stream.reset(new log_sink_stream(std::cerr, current.log_options));
       *log_stream << "object_lifetime failed to open specified output stream: "
-                  << settings.log_filename << ". Falling back to stderr." << '\n';
+                  << current.log_filename << ". Falling back to stderr." << '\n';
     }
 
     break;
   }
-} // namespace
+  }
+  reporter.init(log_stream.get(), current.report_limit, current.log_options.format);
+}
+
+// Switches the existing log stream over, so that references to it stay valid.
+static void retarget_output_stream(const layer_settings &current) {
+  auto &sink = static_cast<ocl_layer_utils::log_sink_stream &>(*log_stream);
+  switch(current.log_type) {
+  case layer_settings::DebugLogType::StdOut:
+    sink.retarget(std::cout);
+    break;
+  case layer_settings::DebugLogType::StdErr:
+    sink.retarget(std::cerr);
+    break;
+  case layer_settings::DebugLogType::File:
+    if (!sink.retarget(current.log_filename))
+      sink << "object_lifetime failed to open specified output stream: "
+           << current.log_filename << ". Keeping the current one." << std::endl;
+    break;
+  }
+}
+
+static void reload_settings(const std::map<std::string, std::string> &settings_from_file) {
+  const layer_settings &previous = *settings.get();
+  auto next = std::make_unique<layer_settings>(layer_settings::load(settings_from_file));
+  next->log_options = previous.log_options;
+  next->mask = previous.mask;
+  next->watch_settings = previous.watch_settings;
+
+  if (next->log_type != previous.log_type || next->log_filename != previous.log_filename)
+    retarget_output_stream(*next);
+  reporter.set_limit(next->report_limit);
+  settings.publish(std::move(next));
+}
+
+// Declared last, so that its thread is stopped before the state it updates
+// is destroyed.
+static ocl_layer_utils::settings_watcher watcher;
 
 static void _init_dispatch(void);
+static void _mask_dispatch(const ocl_layer_utils::dispatch_mask &mask);
 
 CL_API_ENTRY cl_int CL_API_CALL
 clInitLayer(
@@ -946,11 +1022,16 @@ clInitLayer(
   if (!target_dispatch || !layer_dispatch_ret ||!num_entries_out || num_entries < sizeof(dispatch)/sizeof(dispatch.clGetPlatformIDs))
     return CL_INVALID_VALUE;
 
-  settings = layer_settings::load();
-  init_output_stream();
+  const auto settings_path = ocl_layer_utils::find_settings();
+  settings.publish(std::make_unique<layer_settings>(
+      layer_settings::load(ocl_layer_utils::load_settings(settings_path))));
+  init_output_stream(*settings.get());
 
   tdispatch = target_dispatch;
   _init_dispatch();
+  _mask_dispatch(settings.get()->mask);
+  if (settings.get()->watch_settings)
+    watcher.start(settings_path, reload_settings);
 
   *layer_dispatch_ret = &dispatch;
   *num_entries_out = sizeof(dispatch)/sizeof(dispatch.clGetPlatformIDs);
@@ -4212,3 +4293,49 @@ static void _init_dispatch(void) {
   dispatch.clCreateImageWithProperties = &clCreateImageWithProperties_wrap;
   dispatch.clSetContextDestructorCallback = &clSetContextDestructorCallback_wrap;
 }
+
+// Entry points that neither create nor release objects can be left out
+// without losing track of object lifetimes; the others ignore the mask.
+static void _mask_dispatch(const ocl_layer_utils::dispatch_mask &mask) {
+#define MASK_ENTRY(name, family) \
+  if (!mask.enabled(#name, #family)) \
+    dispatch.name = tdispatch->name
+  MASK_ENTRY(clGetPlatformInfo, platform);
+  MASK_ENTRY(clGetDeviceInfo, platform);
+  MASK_ENTRY(clSetCommandQueueProperty, queue);
+  MASK_ENTRY(clGetSupportedImageFormats, image);
+  MASK_ENTRY(clBuildProgram, program);
+  MASK_ENTRY(clGetProgramBuildInfo, program);
+  MASK_ENTRY(clSetKernelArg, kernel);
+  MASK_ENTRY(clGetKernelWorkGroupInfo, kernel);
+  MASK_ENTRY(clWaitForEvents, event);
+  MASK_ENTRY(clGetEventProfilingInfo, event);
+  MASK_ENTRY(clFlush, queue);
+  MASK_ENTRY(clFinish, queue);
+  MASK_ENTRY(clEnqueueWaitForEvents, event);
+  MASK_ENTRY(clEnqueueBarrier, event);
+  MASK_ENTRY(clGetGLObjectInfo, platform);
+  MASK_ENTRY(clGetGLTextureInfo, platform);
+  MASK_ENTRY(clSetEventCallback, event);
+  MASK_ENTRY(clSetMemObjectDestructorCallback, mem);
+  MASK_ENTRY(clSetUserEventStatus, event);
+  MASK_ENTRY(clCompileProgram, program);
+  MASK_ENTRY(clUnloadPlatformCompiler, program);
+  MASK_ENTRY(clGetKernelArgInfo, kernel);
+  MASK_ENTRY(clGetExtensionFunctionAddressForPlatform, platform);
+  MASK_ENTRY(clCreateEventFromEGLSyncKHR, event);
+  MASK_ENTRY(clGetPipeInfo, mem);
+  MASK_ENTRY(clSVMAlloc, svm);
+  MASK_ENTRY(clSVMFree, svm);
+  MASK_ENTRY(clSetKernelArgSVMPointer, svm);
+  MASK_ENTRY(clSetKernelExecInfo, kernel);
+  MASK_ENTRY(clGetKernelSubGroupInfoKHR, kernel);
+  MASK_ENTRY(clGetDeviceAndHostTimer, platform);
+  MASK_ENTRY(clGetHostTimer, platform);
+  MASK_ENTRY(clGetKernelSubGroupInfo, kernel);
+  MASK_ENTRY(clSetDefaultDeviceCommandQueue, queue);
+  MASK_ENTRY(clSetProgramReleaseCallback, program);
+  MASK_ENTRY(clSetProgramSpecializationConstant, program);
+  MASK_ENTRY(clSetContextDestructorCallback, context);
+#undef MASK_ENTRY
+}
@@ -2,6 +2,9 @@
 #include "object_lifetime_test_icd_surface.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
 
 namespace lifetime
 {
@@ -202,6 +205,33 @@ cl_int _cl_device_id::clGetDeviceInfo(
         std::back_inserter(result));
       break;
     }
+    case CL_DEVICE_GLOBAL_MEM_SIZE:
+    {
+      cl_ulong global_mem_size = 0x100000; // Arbitrary value
+      std::copy(
+        reinterpret_cast<char*>(&global_mem_size),
+        reinterpret_cast<char*>(&global_mem_size) + sizeof(global_mem_size),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_DEVICE_SVM_CAPABILITIES:
+    {
+      cl_device_svm_capabilities svm_capabilities = CL_DEVICE_SVM_COARSE_GRAIN_BUFFER;
+      std::copy(
+        reinterpret_cast<char*>(&svm_capabilities),
+        reinterpret_cast<char*>(&svm_capabilities) + sizeof(svm_capabilities),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS:
+    {
+      cl_uint dimensions = 3;
+      std::copy(
+        reinterpret_cast<char*>(&dimensions),
+        reinterpret_cast<char*>(&dimensions) + sizeof(dimensions),
+        std::back_inserter(result));
+      break;
+    }
     case CL_DEVICE_MEM_BASE_ADDR_ALIGN:
     {
       cl_uint align = 16;
@@ -351,6 +381,20 @@ cl_int _cl_device_id::clReleaseDevice()
     return release();
 }
 
+cl_int _cl_device_id::clGetDeviceAndHostTimer(
+  cl_ulong* device_timestamp,
+  cl_ulong* host_timestamp)
+{
+  if (device_timestamp == nullptr || host_timestamp == nullptr)
+    return CL_INVALID_VALUE;
+
+  *device_timestamp = _cl_event::device_time();
+  *host_timestamp = static_cast<cl_ulong>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+  return CL_SUCCESS;
+}
+
 cl_context _cl_device_id::clCreateContext(
   const cl_context_properties*,
   cl_uint num_devices,
@@ -803,6 +847,20 @@ cl_int _cl_command_queue::clEnqueueNDRangeKernel(
   if (!kernel->is_valid())
     return CL_INVALID_KERNEL;
 
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    _cl_event::execution_time
+  );
+}
+
+cl_int _cl_command_queue::enqueue(
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event,
+  cl_ulong duration)
+{
   if ((num_events_in_wait_list == 0 && event_wait_list != nullptr) ||
       (num_events_in_wait_list != 0 && event_wait_list == nullptr))
     return CL_INVALID_EVENT_WAIT_LIST;
@@ -830,11 +888,126 @@ cl_int _cl_command_queue::clEnqueueNDRangeKernel(
       parents.parent_context,
       this
     );
+    (*event)->profile(duration);
   }
 
   return CL_SUCCESS;
 }
 
+cl_int _cl_command_queue::clEnqueueTask(
+  cl_kernel kernel,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  static constexpr size_t one = 1;
+  return clEnqueueNDRangeKernel(
+    kernel,
+    1,
+    nullptr,
+    &one,
+    &one,
+    num_events_in_wait_list,
+    event_wait_list,
+    event
+  );
+}
+
+cl_int _cl_command_queue::clEnqueueReadBuffer(
+  cl_mem buffer,
+  cl_bool,
+  size_t,
+  size_t,
+  void*,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  if (!buffer->is_valid())
+    return CL_INVALID_MEM_OBJECT;
+
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    _cl_event::transfer_time
+  );
+}
+
+cl_int _cl_command_queue::clEnqueueWriteBuffer(
+  cl_mem buffer,
+  cl_bool,
+  size_t,
+  size_t,
+  const void*,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  if (!buffer->is_valid())
+    return CL_INVALID_MEM_OBJECT;
+
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    _cl_event::transfer_time
+  );
+}
+
+cl_int _cl_command_queue::clEnqueueCopyBuffer(
+  cl_mem src_buffer,
+  cl_mem dst_buffer,
+  size_t,
+  size_t,
+  size_t,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  if (!src_buffer->is_valid() || !dst_buffer->is_valid())
+    return CL_INVALID_MEM_OBJECT;
+
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    _cl_event::transfer_time
+  );
+}
+
+cl_int _cl_command_queue::clEnqueueMarkerWithWaitList(
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    0
+  );
+}
+
+cl_int _cl_command_queue::clEnqueueBarrierWithWaitList(
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return enqueue(
+    num_events_in_wait_list,
+    event_wait_list,
+    event,
+    0
+  );
+}
+
+cl_int _cl_command_queue::clFinish()
+{
+  // Commands complete as soon as they are enqueued.
+  return CL_SUCCESS;
+}
+
 cl_int _cl_command_queue::clRetainCommandQueue()
 {
   return retain();
@@ -1120,13 +1293,14 @@ cl_command_queue _cl_context::clCreateCommandQueue(
     return nullptr;
   }
 
+  const cl_queue_properties props[] = { CL_QUEUE_PROPERTIES, properties };
   reference();
   return lifetime::create_or_exit<cl_command_queue>(
     errcode_ret,
     device,
     this,
-    &properties,
-    &properties + 1
+    std::begin(props),
+    std::end(props)
   );
 }
 
@@ -1150,7 +1324,7 @@ cl_command_queue _cl_context::clCreateCommandQueueWithProperties(
   std::vector<cl_queue_properties> props;
   {
     const cl_queue_properties* it = properties;
-    while(*it != 0)
+    while(it != nullptr && *it != 0)
       props.push_back(*it++);
   }
 
@@ -1223,18 +1397,137 @@ cl_command_queue _cl_context::clCreateCommandQueueWithProperties(
 }
 
 cl_program _cl_context::clCreateProgramWithSource(
-  cl_uint,
-  const char**,
-  const size_t*,
+  cl_uint count,
+  const char** strings,
+  const size_t* lengths,
   cl_int* errcode_ret)
 {
   reference();
-  return lifetime::create_or_exit<cl_program>(
+  cl_program program = lifetime::create_or_exit<cl_program>(
     errcode_ret,
     this,
     parents.parent_devices.data(),
     parents.parent_devices.data() + parents.parent_devices.size()
   );
+  for (cl_uint i = 0; strings && i < count; ++i)
+    if (lengths && lengths[i])
+      program->_source.append(strings[i], lengths[i]);
+    else
+      program->_source.append(strings[i]);
+  return program;
+}
+
+cl_program _cl_context::clCreateProgramWithBinary(
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const size_t* lengths,
+  const unsigned char** binaries,
+  cl_int* binary_status,
+  cl_int* errcode_ret)
+{
+  if (num_devices == 0 || device_list == nullptr ||
+      lengths == nullptr || binaries == nullptr)
+  {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_VALUE;
+    return nullptr;
+  }
+
+  bool all_devices_are_in_context = std::all_of(
+    device_list,
+    device_list + num_devices,
+    [this](const cl_device_id& device)
+    {
+      return std::find(
+        parents.parent_devices.cbegin(),
+        parents.parent_devices.cend(),
+        device
+      ) != parents.parent_devices.cend();
+    }
+  );
+  if (!all_devices_are_in_context)
+  {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_DEVICE;
+    return nullptr;
+  }
+
+  for (cl_uint i = 0; i < num_devices; ++i)
+    if (lengths[i] == 0 || binaries[i] == nullptr)
+    {
+      if (errcode_ret)
+        *errcode_ret = CL_INVALID_VALUE;
+      return nullptr;
+    }
+
+  reference();
+  cl_program program = lifetime::create_or_exit<cl_program>(
+    errcode_ret,
+    this,
+    device_list,
+    device_list + num_devices
+  );
+  program->_binary.assign(reinterpret_cast<const char*>(binaries[0]), lengths[0]);
+  if (binary_status)
+    std::fill(binary_status, binary_status + num_devices, CL_SUCCESS);
+  return program;
+}
+
+cl_program _cl_context::clLinkProgram(
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_programs,
+  const cl_program* input_programs,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data,
+  cl_int* errcode_ret)
+{
+  if (num_input_programs == 0 || input_programs == nullptr ||
+      (num_devices == 0) != (device_list == nullptr))
+  {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_VALUE;
+    return nullptr;
+  }
+
+  bool all_programs_are_ours_and_valid = std::all_of(
+    input_programs,
+    input_programs + num_input_programs,
+    [this](const cl_program& program)
+    {
+      return program->is_valid() && program->parents.parent_context == this;
+    }
+  );
+  if (!all_programs_are_ours_and_valid)
+  {
+    if (errcode_ret)
+      *errcode_ret = CL_INVALID_PROGRAM;
+    return nullptr;
+  }
+
+  reference();
+  cl_program program = num_devices ?
+    lifetime::create_or_exit<cl_program>(
+      errcode_ret,
+      this,
+      device_list,
+      device_list + num_devices
+    ) :
+    lifetime::create_or_exit<cl_program>(
+      errcode_ret,
+      this,
+      parents.parent_devices.data(),
+      parents.parent_devices.data() + parents.parent_devices.size()
+    );
+  program->_options = options ? options : "";
+  program->_binary = "linked(" + program->_options + ")";
+  for (cl_uint i = 0; i < num_input_programs; ++i)
+    program->_binary += ":" + input_programs[i]->_binary;
+
+  if (pfn_notify)
+    pfn_notify(program, user_data);
+  return program;
 }
 
 cl_event _cl_context::clCreateUserEvent(
@@ -1357,9 +1650,9 @@ _cl_program::_cl_program(
 cl_int _cl_program::clBuildProgram(
   cl_uint num_devices,
   const cl_device_id* device_list,
-  const char*,
-  void (CL_CALLBACK*)(cl_program program, void* user_data),
-  void*)
+  const char* options,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data)
 {
   bool all_devices_are_in_context = std::all_of(
     device_list,
@@ -1379,6 +1672,40 @@ cl_int _cl_program::clBuildProgram(
     return CL_INVALID_DEVICE;
   }
 
+  _options = options ? options : "";
+  if (!_source.empty())
+    _binary = "binary(" + _options + "):" + _source;
+
+  if (pfn_notify)
+    pfn_notify(this, user_data);
+  return CL_SUCCESS;
+}
+
+cl_int _cl_program::clCompileProgram(
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_headers,
+  const cl_program* input_headers,
+  const char** header_include_names,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data)
+{
+  if ((num_devices == 0) != (device_list == nullptr) ||
+      (num_input_headers == 0) != (input_headers == nullptr) ||
+      (num_input_headers == 0) != (header_include_names == nullptr))
+    return CL_INVALID_VALUE;
+
+  if (_source.empty())
+    return CL_INVALID_OPERATION;
+
+  _options = options ? options : "";
+  _binary = "object(" + _options + "):" + _source;
+  for (cl_uint i = 0; i < num_input_headers; ++i)
+    _binary += std::string(":") + header_include_names[i] + "=" + input_headers[i]->_source;
+
+  if (pfn_notify)
+    pfn_notify(this, user_data);
   return CL_SUCCESS;
 }
 
@@ -1391,9 +1718,40 @@ cl_int _cl_program::clGetProgramInfo(
   if (param_value_size == 0 && param_value != NULL)
     return CL_INVALID_VALUE;
 
+  if (param_name == CL_PROGRAM_BINARIES)
+  {
+    const size_t size = parents.parent_devices.size() * sizeof(unsigned char*);
+    if (param_value_size_ret)
+      *param_value_size_ret = size;
+    if (param_value_size && param_value_size < size)
+      return CL_INVALID_VALUE;
+    if (param_value)
+      for (size_t i = 0; i < parents.parent_devices.size(); ++i)
+      {
+        unsigned char* binary = static_cast<unsigned char**>(param_value)[i];
+        if (binary)
+          std::copy(_binary.begin(), _binary.end(), binary);
+      }
+    return CL_SUCCESS;
+  }
+
   std::vector<char> result;
   switch(param_name)
   {
+    case CL_PROGRAM_SOURCE:
+      std::copy(_source.begin(), _source.end(), std::back_inserter(result));
+      result.push_back('\0');
+      break;
+    case CL_PROGRAM_BINARY_SIZES:
+      for (size_t i = 0; i < parents.parent_devices.size(); ++i)
+      {
+        size_t tmp = _binary.size();
+        std::copy(
+          reinterpret_cast<char*>(&tmp),
+          reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+          std::back_inserter(result));
+      }
+      break;
     case CL_PROGRAM_REFERENCE_COUNT:
     {
       cl_uint tmp = CL_OBJECT_REFERENCE_COUNT();
@@ -1442,6 +1800,60 @@ cl_int _cl_program::clGetProgramInfo(
   return CL_SUCCESS;
 }
 
+cl_int _cl_program::clGetProgramBuildInfo(
+  cl_device_id device,
+  cl_program_build_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  if (param_value_size == 0 && param_value != NULL)
+    return CL_INVALID_VALUE;
+
+  if (std::find(
+        parents.parent_devices.cbegin(),
+        parents.parent_devices.cend(),
+        device) == parents.parent_devices.cend())
+    return CL_INVALID_DEVICE;
+
+  // There is no compiler, every build succeeds
+  std::vector<char> result;
+  switch(param_name)
+  {
+    case CL_PROGRAM_BUILD_STATUS:
+    {
+      cl_build_status tmp = CL_BUILD_SUCCESS;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_PROGRAM_BUILD_OPTIONS:
+      std::copy(_options.begin(), _options.end(), std::back_inserter(result));
+      result.push_back('\0');
+      break;
+    case CL_PROGRAM_BUILD_LOG:
+      result.push_back('\0');
+      break;
+    default:
+      return CL_INVALID_VALUE;
+  }
+
+  if (param_value_size_ret)
+    *param_value_size_ret = result.size();
+
+  if (param_value_size && param_value_size < result.size())
+    return CL_INVALID_VALUE;
+
+  if (param_value)
+  {
+    std::copy(result.begin(), result.end(), static_cast<char*>(param_value));
+  }
+
+  return CL_SUCCESS;
+}
+
 cl_int _cl_program::clRetainProgram()
 {
   return retain();
@@ -1453,13 +1865,14 @@ cl_int _cl_program::clReleaseProgram()
 }
 
 cl_kernel _cl_program::clCreateKernel(
-  const char*,
+  const char* kernel_name,
   cl_int* errcode_ret)
 {
   reference();
   return lifetime::create_or_exit<cl_kernel>(
     errcode_ret,
-    this
+    this,
+    kernel_name ? kernel_name : ""
   );
 }
 
@@ -1485,7 +1898,7 @@ cl_int _cl_program::clCreateKernelsInProgram(
     std::generate_n(
       std::back_inserter(result),
       3,
-      [=](){ return std::make_shared<_cl_kernel>(this); }
+      [=, i = 0]() mutable { return std::make_shared<_cl_kernel>(this, "kernel_" + std::to_string(i++)); }
     );
 
     std::copy(
@@ -1509,9 +1922,10 @@ cl_int _cl_program::clCreateKernelsInProgram(
   return CL_SUCCESS;
 }
 
-_cl_kernel::_cl_kernel(const cl_program parent_program)
+_cl_kernel::_cl_kernel(const cl_program parent_program, std::string name)
   : icd_compatible{}
   , ref_counted_object<cl_kernel>{ lifetime::object_parents<cl_kernel>{ parent_program } }
+  , _name{ std::move(name) }
 {}
 
 cl_int _cl_kernel::clGetKernelInfo(
@@ -1550,6 +1964,95 @@ cl_int _cl_kernel::clGetKernelInfo(
         std::back_inserter(result));
       break;
     }
+    case CL_KERNEL_NUM_ARGS:
+    {
+      cl_uint tmp = kernel_arg_count;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_KERNEL_FUNCTION_NAME:
+      std::copy(_name.begin(), _name.end(), std::back_inserter(result));
+      result.push_back('\0');
+      break;
+    default:
+      return CL_INVALID_VALUE;
+  }
+
+  if (param_value_size_ret)
+    *param_value_size_ret = result.size();
+
+  if (param_value_size && param_value_size < result.size())
+    return CL_INVALID_VALUE;
+
+  if (param_value)
+  {
+    std::copy(result.begin(), result.end(), static_cast<char*>(param_value));
+  }
+
+  return CL_SUCCESS;
+}
+
+cl_int _cl_kernel::clGetKernelArgInfo(
+  cl_uint arg_index,
+  cl_kernel_arg_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  if (param_value_size == 0 && param_value != NULL)
+    return CL_INVALID_VALUE;
+
+  if (arg_index >= kernel_arg_count)
+    return CL_INVALID_ARG_INDEX;
+
+  std::vector<char> result;
+  switch(param_name)
+  {
+    case CL_KERNEL_ARG_ADDRESS_QUALIFIER:
+    {
+      cl_kernel_arg_address_qualifier tmp = arg_index == 0 ?
+        CL_KERNEL_ARG_ADDRESS_GLOBAL : CL_KERNEL_ARG_ADDRESS_PRIVATE;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_KERNEL_ARG_ACCESS_QUALIFIER:
+    {
+      cl_kernel_arg_access_qualifier tmp = CL_KERNEL_ARG_ACCESS_NONE;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_KERNEL_ARG_TYPE_QUALIFIER:
+    {
+      cl_kernel_arg_type_qualifier tmp = CL_KERNEL_ARG_TYPE_NONE;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
+    case CL_KERNEL_ARG_TYPE_NAME:
+    {
+      std::string tmp = arg_index == 0 ? "float*" : "int4";
+      std::copy(tmp.begin(), tmp.end(), std::back_inserter(result));
+      result.push_back('\0');
+      break;
+    }
+    case CL_KERNEL_ARG_NAME:
+    {
+      std::string tmp = arg_index == 0 ? "a" : "b";
+      std::copy(tmp.begin(), tmp.end(), std::back_inserter(result));
+      result.push_back('\0');
+      break;
+    }
     default:
       return CL_INVALID_VALUE;
   }
@@ -1591,15 +2094,47 @@ cl_kernel _cl_kernel::clCloneKernel(
 {
   return lifetime::create_or_exit<cl_kernel>(
     errcode_ret,
-    parents.parent_program
+    parents.parent_program,
+    _name
   );
 }
 
 _cl_event::_cl_event(const cl_context parent_context, const cl_command_queue parent_queue)
   : icd_compatible{}
   , ref_counted_object<cl_event>{ lifetime::object_parents<cl_event>{ parent_context, parent_queue } }
+  , _profiling{ false }
+  , _queued{ 0 }
+  , _submit{ 0 }
+  , _start{ 0 }
+  , _end{ 0 }
 {}
 
+namespace
+{
+  // Commands of all queues run one after the other on a single device.
+  std::atomic<cl_ulong> device_clock{ 1000000 };
+}
+
+cl_ulong _cl_event::device_time()
+{
+  return device_clock.load();
+}
+
+void _cl_event::profile(cl_ulong duration)
+{
+  const auto& props = parents.parent_queue->_props;
+  auto it = std::find(props.cbegin(), props.cend(), CL_QUEUE_PROPERTIES);
+  if (it == props.cend() || ++it == props.cend() ||
+      !(*it & CL_QUEUE_PROFILING_ENABLE))
+    return;
+
+  _queued = device_clock.fetch_add(start_delay + duration);
+  _submit = _queued + submit_delay;
+  _start = _queued + start_delay;
+  _end = _start + duration;
+  _profiling = true;
+}
+
 cl_int _cl_event::clGetEventInfo(
   cl_event_info param_name,
   size_t param_value_size,
@@ -1644,6 +2179,16 @@ cl_int _cl_event::clGetEventInfo(
         std::back_inserter(result));
       break;
     }
+    case CL_EVENT_COMMAND_EXECUTION_STATUS:
+    {
+      // Commands complete as soon as they are enqueued
+      cl_int tmp = CL_COMPLETE;
+      std::copy(
+        reinterpret_cast<char*>(&tmp),
+        reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+        std::back_inserter(result));
+      break;
+    }
     default:
       return CL_INVALID_VALUE;
   }
@@ -1694,6 +2239,72 @@ cl_int _cl_event::clWaitForEvents(
     return CL_INVALID_EVENT;
 }
 
+cl_int _cl_event::clGetEventProfilingInfo(
+  cl_profiling_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  if (param_value_size == 0 && param_value != NULL)
+    return CL_INVALID_VALUE;
+
+  if (!_profiling)
+    return CL_PROFILING_INFO_NOT_AVAILABLE;
+
+  cl_ulong tmp;
+  switch(param_name)
+  {
+    case CL_PROFILING_COMMAND_QUEUED:
+      tmp = _queued;
+      break;
+    case CL_PROFILING_COMMAND_SUBMIT:
+      tmp = _submit;
+      break;
+    case CL_PROFILING_COMMAND_START:
+      tmp = _start;
+      break;
+    case CL_PROFILING_COMMAND_END:
+    case CL_PROFILING_COMMAND_COMPLETE:
+      tmp = _end;
+      break;
+    default:
+      return CL_INVALID_VALUE;
+  }
+
+  if (param_value_size_ret)
+    *param_value_size_ret = sizeof(tmp);
+
+  if (param_value_size && param_value_size < sizeof(tmp))
+    return CL_INVALID_VALUE;
+
+  if (param_value)
+  {
+    std::copy(
+      reinterpret_cast<char*>(&tmp),
+      reinterpret_cast<char*>(&tmp) + sizeof(tmp),
+      static_cast<char*>(param_value));
+  }
+
+  return CL_SUCCESS;
+}
+
+cl_int _cl_event::clSetEventCallback(
+  cl_int command_exec_callback_type,
+  void (CL_CALLBACK* pfn_notify)(cl_event event, cl_int event_command_status, void *user_data),
+  void* user_data)
+{
+  if (pfn_notify == nullptr ||
+      (command_exec_callback_type != CL_SUBMITTED &&
+       command_exec_callback_type != CL_RUNNING &&
+       command_exec_callback_type != CL_COMPLETE))
+    return CL_INVALID_VALUE;
+
+  // Commands are complete by the time their event is handed out, so the
+  // callback is due right away.
+  pfn_notify(this, command_exec_callback_type, user_data);
+  return CL_SUCCESS;
+}
+
 cl_int _cl_event::clSetUserEventStatus(
   cl_int execution_status)
 {
@@ -1863,6 +2474,7 @@ void _cl_platform_id::init_dispatch()
   dispatch->clCreateSubDevices = clCreateSubDevices_wrap;
   dispatch->clRetainDevice = clRetainDevice_wrap;
   dispatch->clReleaseDevice = clReleaseDevice_wrap;
+  dispatch->clGetDeviceAndHostTimer = clGetDeviceAndHostTimer_wrap;
   dispatch->clCreateContext = clCreateContext_wrap;
   dispatch->clGetContextInfo = clGetContextInfo_wrap;
   dispatch->clRetainContext = clRetainContext_wrap;
@@ -1882,11 +2494,22 @@ void _cl_platform_id::init_dispatch()
   dispatch->clGetMemObjectInfo = clGetMemObjectInfo_wrap;
   dispatch->clGetCommandQueueInfo = clGetCommandQueueInfo_wrap;
   dispatch->clEnqueueNDRangeKernel = clEnqueueNDRangeKernel_wrap;
+  dispatch->clEnqueueTask = clEnqueueTask_wrap;
+  dispatch->clEnqueueReadBuffer = clEnqueueReadBuffer_wrap;
+  dispatch->clEnqueueWriteBuffer = clEnqueueWriteBuffer_wrap;
+  dispatch->clEnqueueCopyBuffer = clEnqueueCopyBuffer_wrap;
+  dispatch->clEnqueueMarkerWithWaitList = clEnqueueMarkerWithWaitList_wrap;
+  dispatch->clEnqueueBarrierWithWaitList = clEnqueueBarrierWithWaitList_wrap;
+  dispatch->clFinish = clFinish_wrap;
   dispatch->clRetainCommandQueue = clRetainCommandQueue_wrap;
   dispatch->clReleaseCommandQueue = clReleaseCommandQueue_wrap;
   dispatch->clCreateProgramWithSource = clCreateProgramWithSource_wrap;
   dispatch->clBuildProgram = clBuildProgram_wrap;
+  dispatch->clCreateProgramWithBinary = clCreateProgramWithBinary_wrap;
+  dispatch->clCompileProgram = clCompileProgram_wrap;
+  dispatch->clLinkProgram = clLinkProgram_wrap;
   dispatch->clGetProgramInfo = clGetProgramInfo_wrap;
+  dispatch->clGetProgramBuildInfo = clGetProgramBuildInfo_wrap;
   dispatch->clRetainProgram = clRetainProgram_wrap;
   dispatch->clReleaseProgram = clReleaseProgram_wrap;
   dispatch->clCreateKernel = clCreateKernel_wrap;
@@ -1894,11 +2517,14 @@ void _cl_platform_id::init_dispatch()
   dispatch->clSetKernelArg = clSetKernelArg_wrap;
   dispatch->clCloneKernel = clCloneKernel_wrap;
   dispatch->clGetKernelInfo = clGetKernelInfo_wrap;
+  dispatch->clGetKernelArgInfo = clGetKernelArgInfo_wrap;
   dispatch->clRetainKernel = clRetainKernel_wrap;
   dispatch->clReleaseKernel = clReleaseKernel_wrap;
   dispatch->clCreateUserEvent = clCreateUserEvent_wrap;
   dispatch->clSetUserEventStatus = clSetUserEventStatus_wrap;
   dispatch->clGetEventInfo = clGetEventInfo_wrap;
+  dispatch->clGetEventProfilingInfo = clGetEventProfilingInfo_wrap;
+  dispatch->clSetEventCallback = clSetEventCallback_wrap;
   dispatch->clWaitForEvents = clWaitForEvents_wrap;
   dispatch->clRetainEvent = clRetainEvent_wrap;
   dispatch->clReleaseEvent = clReleaseEvent_wrap;
@@ -1908,6 +2534,11 @@ void _cl_platform_id::init_dispatch()
   dispatch->clRetainSampler = clRetainSampler_wrap;
   dispatch->clReleaseSampler = clReleaseSampler_wrap;
   dispatch->clEnqueueFillBuffer = clEnqueueFillBuffer_wrap;
+  dispatch->clSVMAlloc = clSVMAlloc_wrap;
+  dispatch->clSVMFree = clSVMFree_wrap;
+  dispatch->clEnqueueSVMMemFill = clEnqueueSVMMemFill_wrap;
+  dispatch->clEnqueueSVMMigrateMem = clEnqueueSVMMigrateMem_wrap;
+  dispatch->clSetKernelArgSVMPointer = clSetKernelArgSVMPointer_wrap;
   dispatch->clEnqueueCopyImageToBuffer = clEnqueueCopyImageToBuffer_wrap;
   dispatch->clEnqueueCopyImage = clEnqueueCopyImage_wrap;
   dispatch->clGetSupportedImageFormats = clGetSupportedImageFormats_wrap;
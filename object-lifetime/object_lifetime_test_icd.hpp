@@ -235,6 +235,10 @@ struct _cl_device_id
 
   cl_int clReleaseDevice();
 
+  cl_int clGetDeviceAndHostTimer(
+    cl_ulong* device_timestamp,
+    cl_ulong* host_timestamp);
+
   cl_context clCreateContext(
   const cl_context_properties* properties,
   cl_uint num_devices,
@@ -338,6 +342,62 @@ struct _cl_command_queue
     const cl_event* event_wait_list,
     cl_event* event);
 
+  cl_int clEnqueueTask(
+    cl_kernel kernel,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clEnqueueReadBuffer(
+    cl_mem buffer,
+    cl_bool blocking_read,
+    size_t offset,
+    size_t size,
+    void* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clEnqueueWriteBuffer(
+    cl_mem buffer,
+    cl_bool blocking_write,
+    size_t offset,
+    size_t size,
+    const void* ptr,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clEnqueueCopyBuffer(
+    cl_mem src_buffer,
+    cl_mem dst_buffer,
+    size_t src_offset,
+    size_t dst_offset,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clEnqueueMarkerWithWaitList(
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clEnqueueBarrierWithWaitList(
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+  cl_int clFinish();
+
+  // Checks the wait list and, if event is not null, returns the event of a
+  // command taking duration on the device.
+  cl_int enqueue(
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event,
+    cl_ulong duration);
+
   cl_int clRetainCommandQueue();
 
   cl_int clReleaseCommandQueue();
@@ -438,6 +498,24 @@ struct _cl_context
     const size_t* lengths,
     cl_int* errcode_ret);
 
+  cl_program clCreateProgramWithBinary(
+    cl_uint num_devices,
+    const cl_device_id* device_list,
+    const size_t* lengths,
+    const unsigned char** binaries,
+    cl_int* binary_status,
+    cl_int* errcode_ret);
+
+  cl_program clLinkProgram(
+    cl_uint num_devices,
+    const cl_device_id* device_list,
+    const char* options,
+    cl_uint num_input_programs,
+    const cl_program* input_programs,
+    void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+    void* user_data,
+    cl_int* errcode_ret);
+
   cl_event clCreateUserEvent(
     cl_int* errcode_ret);
 
@@ -463,6 +541,10 @@ struct _cl_program
   : public lifetime::icd_compatible
   , public lifetime::ref_counted_object<cl_program>
 {
+  // There is no compiler, building, compiling and linking only record what
+  // the result was made of in the binary, which is the same for all devices.
+  std::string _source, _options, _binary;
+
   _cl_program() = delete;
   _cl_program(const cl_context parent_context, const cl_device_id* first_device = nullptr, const cl_device_id* last_device = nullptr);
   _cl_program(const _cl_program&) = delete;
@@ -478,12 +560,29 @@ struct _cl_program
     void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
     void* user_data);
 
+  cl_int clCompileProgram(
+    cl_uint num_devices,
+    const cl_device_id* device_list,
+    const char* options,
+    cl_uint num_input_headers,
+    const cl_program* input_headers,
+    const char** header_include_names,
+    void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+    void* user_data);
+
   cl_int clGetProgramInfo(
     cl_program_info param_name,
     size_t param_value_size,
     void* param_value,
     size_t* param_value_size_ret);
 
+  cl_int clGetProgramBuildInfo(
+    cl_device_id device,
+    cl_program_build_info param_name,
+    size_t param_value_size,
+    void* param_value,
+    size_t* param_value_size_ret);
+
   cl_int clRetainProgram();
 
   cl_int clReleaseProgram();
@@ -502,20 +601,32 @@ struct _cl_kernel
   : public lifetime::icd_compatible
   , public lifetime::ref_counted_object<cl_kernel>
 {
+  std::string _name;
+
   _cl_kernel() = delete;
-  _cl_kernel(const cl_program parent_program);
+  _cl_kernel(const cl_program parent_program, std::string name);
   _cl_kernel(const _cl_kernel&) = delete;
   _cl_kernel(_cl_kernel&&) = delete;
   ~_cl_kernel() = default;
   _cl_kernel &operator=(const _cl_kernel&) = delete;
   _cl_kernel &operator=(_cl_kernel&&) = delete;
 
+  // Every kernel has the signature (global float* a, int4 b)
+  static constexpr cl_uint kernel_arg_count = 2;
+
   cl_int clGetKernelInfo(
     cl_kernel_info param_name,
     size_t param_value_size,
     void* param_value,
     size_t* param_value_size_ret);
 
+  cl_int clGetKernelArgInfo(
+    cl_uint arg_index,
+    cl_kernel_arg_info param_name,
+    size_t param_value_size,
+    void* param_value,
+    size_t* param_value_size_ret);
+
   cl_int clSetKernelArg(
     cl_uint arg_index,
     size_t arg_size,
@@ -533,6 +644,16 @@ struct _cl_event
   : public lifetime::icd_compatible
   , public lifetime::ref_counted_object<cl_event>
 {
+  // Commands complete as soon as they are enqueued, on queues with
+  // profiling enabled they take a fixed time on a simulated device clock.
+  static constexpr cl_ulong submit_delay = 1000,
+                            start_delay = 2500,
+                            execution_time = 10000,
+                            transfer_time = 4000;
+
+  bool _profiling;
+  cl_ulong _queued, _submit, _start, _end;
+
   _cl_event() = delete;
   _cl_event(const cl_context parent_context, const cl_command_queue parent_queue);
   _cl_event(const _cl_event&) = delete;
@@ -554,6 +675,23 @@ struct _cl_event
   cl_int clSetUserEventStatus(
     cl_int execution_status);
 
+  cl_int clGetEventProfilingInfo(
+    cl_profiling_info param_name,
+    size_t param_value_size,
+    void* param_value,
+    size_t* param_value_size_ret);
+
+  cl_int clSetEventCallback(
+    cl_int command_exec_callback_type,
+    void (CL_CALLBACK* pfn_notify)(cl_event event, cl_int event_command_status, void *user_data),
+    void* user_data);
+
+  // Records the command as run on the simulated device clock.
+  void profile(cl_ulong duration);
+
+  // Current time of the simulated device clock.
+  static cl_ulong device_time();
+
   cl_int clRetainEvent();
 
   cl_int clReleaseEvent();
@@ -4,6 +4,7 @@
 #include <type_traits>  // std::remove_pointer_t
 #include <algorithm>    // std::find_if
 #include <mutex>        // std::lock_guard
+#include <cstdlib>      // std::malloc, std::free
 
 template <typename T, typename F>
 cl_int invoke_if_valid(T cl_object, F&& f, bool retain = false)
@@ -166,6 +167,20 @@ CL_API_ENTRY cl_int CL_API_CALL clGetDeviceInfo_wrap(
   });
 }
 
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceAndHostTimer_wrap(
+  cl_device_id device,
+  cl_ulong* device_timestamp,
+  cl_ulong* host_timestamp)
+{
+  return invoke_if_valid(device, [&]()
+  {
+    return device->clGetDeviceAndHostTimer(
+      device_timestamp,
+      host_timestamp
+    );
+  });
+}
+
 CL_API_ENTRY cl_int CL_API_CALL clCreateSubDevices_wrap(
   cl_device_id in_device,
   const cl_device_partition_property* properties,
@@ -473,6 +488,143 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel_wrap(
   });
 }
 
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask_wrap(
+  cl_command_queue command_queue,
+  cl_kernel kernel,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueTask(
+      kernel,
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem buffer,
+  cl_bool blocking_read,
+  size_t offset,
+  size_t size,
+  void* ptr,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueReadBuffer(
+      buffer,
+      blocking_read,
+      offset,
+      size,
+      ptr,
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem buffer,
+  cl_bool blocking_write,
+  size_t offset,
+  size_t size,
+  const void* ptr,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueWriteBuffer(
+      buffer,
+      blocking_write,
+      offset,
+      size,
+      ptr,
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem src_buffer,
+  cl_mem dst_buffer,
+  size_t src_offset,
+  size_t dst_offset,
+  size_t size,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueCopyBuffer(
+      src_buffer,
+      dst_buffer,
+      src_offset,
+      dst_offset,
+      size,
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarkerWithWaitList_wrap(
+  cl_command_queue command_queue,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueMarkerWithWaitList(
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrierWithWaitList_wrap(
+  cl_command_queue command_queue,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clEnqueueBarrierWithWaitList(
+      num_events_in_wait_list,
+      event_wait_list,
+      event
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish_wrap(
+  cl_command_queue command_queue)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return command_queue->clFinish();
+  });
+}
+
 CL_API_ENTRY cl_mem CL_API_CALL clCreateSubBuffer_wrap(
   cl_mem buffer,
   cl_mem_flags flags,
@@ -585,6 +737,80 @@ CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource_wrap(
   });
 }
 
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary_wrap(
+  cl_context context,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const size_t* lengths,
+  const unsigned char** binaries,
+  cl_int* binary_status,
+  cl_int* errcode_ret)
+{
+  return create_if_valid(context, errcode_ret, [&]()
+  {
+    return context->clCreateProgramWithBinary(
+      num_devices,
+      device_list,
+      lengths,
+      binaries,
+      binary_status,
+      errcode_ret
+    );
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
+  cl_program program,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_headers,
+  const cl_program* input_headers,
+  const char** header_include_names,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data)
+{
+  return invoke_if_valid(program, [&]()
+  {
+    return program->clCompileProgram(
+      num_devices,
+      device_list,
+      options,
+      num_input_headers,
+      input_headers,
+      header_include_names,
+      pfn_notify,
+      user_data
+    );
+  });
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
+  cl_context context,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_programs,
+  const cl_program* input_programs,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data,
+  cl_int* errcode_ret)
+{
+  return create_if_valid(context, errcode_ret, [&]()
+  {
+    return context->clLinkProgram(
+      num_devices,
+      device_list,
+      options,
+      num_input_programs,
+      input_programs,
+      pfn_notify,
+      user_data,
+      errcode_ret
+    );
+  });
+}
+
 CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
   cl_program program,
   cl_uint num_devices,
@@ -623,6 +849,26 @@ CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo_wrap(
   });
 }
 
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo_wrap(
+  cl_program program,
+  cl_device_id device,
+  cl_program_build_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  return invoke_if_valid(program, [&]()
+  {
+    return program->clGetProgramBuildInfo(
+      device,
+      param_name,
+      param_value_size,
+      param_value,
+      param_value_size_ret
+    );
+  });
+}
+
 CL_API_ENTRY cl_int CL_API_CALL clRetainProgram_wrap(
   cl_program program)
 {
@@ -719,6 +965,26 @@ CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo_wrap(
   });
 }
 
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelArgInfo_wrap(
+  cl_kernel kernel,
+  cl_uint arg_index,
+  cl_kernel_arg_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  return invoke_if_valid(kernel, [&]()
+  {
+    return kernel->clGetKernelArgInfo(
+      arg_index,
+      param_name,
+      param_value_size,
+      param_value,
+      param_value_size_ret
+    );
+  });
+}
+
 CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
   cl_kernel kernel)
 {
@@ -779,6 +1045,38 @@ CL_API_ENTRY cl_int CL_API_CALL clGetEventInfo_wrap(
   });
 }
 
+CL_API_ENTRY cl_int CL_API_CALL clGetEventProfilingInfo_wrap(
+  cl_event event,
+  cl_profiling_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret)
+{
+  return invoke_if_valid(event, [&]()
+  {
+    return event->clGetEventProfilingInfo(
+    param_name,
+    param_value_size,
+    param_value,
+    param_value_size_ret);
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetEventCallback_wrap(
+  cl_event event,
+  cl_int command_exec_callback_type,
+  void (CL_CALLBACK* pfn_notify)(cl_event event, cl_int event_command_status, void *user_data),
+  void* user_data)
+{
+  return invoke_if_valid(event, [&]()
+  {
+    return event->clSetEventCallback(
+    command_exec_callback_type,
+    pfn_notify,
+    user_data);
+  });
+}
+
 CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents_wrap(
   cl_uint num_events,
   const cl_event* event_list)
@@ -962,6 +1260,75 @@ CL_API_ENTRY cl_int CL_API_CALL clGetSupportedImageFormats_wrap(
   });
 }
 
+CL_API_ENTRY void* CL_API_CALL clSVMAlloc_wrap(
+    cl_context context,
+    cl_svm_mem_flags,
+    size_t size,
+    cl_uint)
+{
+  void* result = nullptr;
+  invoke_if_valid(context, [&]()
+  {
+    result = size ? std::malloc(size) : nullptr;
+    return CL_SUCCESS;
+  });
+  return result;
+}
+
+CL_API_ENTRY void CL_API_CALL clSVMFree_wrap(
+    cl_context context,
+    void* svm_pointer)
+{
+  invoke_if_valid(context, [&]()
+  {
+    std::free(svm_pointer);
+    return CL_SUCCESS;
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemFill_wrap(
+    cl_command_queue command_queue,
+    void*,
+    const void*,
+    size_t,
+    size_t,
+    cl_uint,
+    const cl_event*,
+    cl_event*)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return CL_SUCCESS;
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem_wrap(
+    cl_command_queue command_queue,
+    cl_uint,
+    const void**,
+    const size_t*,
+    cl_mem_migration_flags,
+    cl_uint,
+    const cl_event*,
+    cl_event*)
+{
+  return invoke_if_valid(command_queue, [&]()
+  {
+    return CL_SUCCESS;
+  });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer_wrap(
+    cl_kernel kernel,
+    cl_uint,
+    const void*)
+{
+  return invoke_if_valid(kernel, [&]()
+  {
+    return CL_SUCCESS;
+  });
+}
+
 // Loader hooks
 
 CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(
@@ -36,6 +36,11 @@ CL_API_ENTRY cl_int CL_API_CALL clRetainDevice_wrap(
 CL_API_ENTRY cl_int CL_API_CALL clReleaseDevice_wrap(
   cl_device_id device);
 
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceAndHostTimer_wrap(
+  cl_device_id device,
+  cl_ulong* device_timestamp,
+  cl_ulong* host_timestamp);
+
 CL_API_ENTRY cl_context CL_API_CALL clCreateContext_wrap(
   const cl_context_properties* properties,
   cl_uint num_devices,
@@ -169,6 +174,61 @@ CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel_wrap(
   const cl_event* event_wait_list,
   cl_event* event);
 
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask_wrap(
+  cl_command_queue command_queue,
+  cl_kernel kernel,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem buffer,
+  cl_bool blocking_read,
+  size_t offset,
+  size_t size,
+  void* ptr,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem buffer,
+  cl_bool blocking_write,
+  size_t offset,
+  size_t size,
+  const void* ptr,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer_wrap(
+  cl_command_queue command_queue,
+  cl_mem src_buffer,
+  cl_mem dst_buffer,
+  size_t src_offset,
+  size_t dst_offset,
+  size_t size,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarkerWithWaitList_wrap(
+  cl_command_queue command_queue,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrierWithWaitList_wrap(
+  cl_command_queue command_queue,
+  cl_uint num_events_in_wait_list,
+  const cl_event* event_wait_list,
+  cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish_wrap(
+  cl_command_queue command_queue);
+
 CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue_wrap(
   cl_command_queue command_queue);
 
@@ -182,6 +242,37 @@ CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource_wrap(
   const size_t* lengths,
   cl_int* errcode_ret);
 
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary_wrap(
+  cl_context context,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const size_t* lengths,
+  const unsigned char** binaries,
+  cl_int* binary_status,
+  cl_int* errcode_ret);
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
+  cl_program program,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_headers,
+  const cl_program* input_headers,
+  const char** header_include_names,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data);
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
+  cl_context context,
+  cl_uint num_devices,
+  const cl_device_id* device_list,
+  const char* options,
+  cl_uint num_input_programs,
+  const cl_program* input_programs,
+  void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
+  void* user_data,
+  cl_int* errcode_ret);
+
 CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
   cl_program program,
   cl_uint num_devices,
@@ -197,6 +288,14 @@ CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo_wrap(
   void* param_value,
   size_t* param_value_size_ret);
 
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo_wrap(
+  cl_program program,
+  cl_device_id device,
+  cl_program_build_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret);
+
 CL_API_ENTRY cl_int CL_API_CALL clRetainProgram_wrap(
   cl_program program);
 
@@ -231,6 +330,14 @@ CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo_wrap(
   void* param_value,
   size_t* param_value_size_ret);
 
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelArgInfo_wrap(
+  cl_kernel kernel,
+  cl_uint arg_index,
+  cl_kernel_arg_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret);
+
 CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
   cl_kernel kernel);
 
@@ -252,6 +359,19 @@ CL_API_ENTRY cl_int CL_API_CALL clGetEventInfo_wrap(
   void* param_value,
   size_t* param_value_size_ret);
 
+CL_API_ENTRY cl_int CL_API_CALL clGetEventProfilingInfo_wrap(
+  cl_event event,
+  cl_profiling_info param_name,
+  size_t param_value_size,
+  void* param_value,
+  size_t* param_value_size_ret);
+
+CL_API_ENTRY cl_int CL_API_CALL clSetEventCallback_wrap(
+  cl_event event,
+  cl_int command_exec_callback_type,
+  void (CL_CALLBACK* pfn_notify)(cl_event event, cl_int event_command_status, void *user_data),
+  void* user_data);
+
 CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents_wrap(
   cl_uint num_events,
   const cl_event* event_list);
@@ -335,6 +455,41 @@ CL_API_ENTRY cl_int CL_API_CALL clGetImageInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret);
 
+CL_API_ENTRY void* CL_API_CALL clSVMAlloc_wrap(
+    cl_context context,
+    cl_svm_mem_flags flags,
+    size_t size,
+    cl_uint alignment);
+
+CL_API_ENTRY void CL_API_CALL clSVMFree_wrap(
+    cl_context context,
+    void* svm_pointer);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemFill_wrap(
+    cl_command_queue command_queue,
+    void* svm_ptr,
+    const void* pattern,
+    size_t pattern_size,
+    size_t size,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem_wrap(
+    cl_command_queue command_queue,
+    cl_uint num_svm_pointers,
+    const void** svm_pointers,
+    const size_t* sizes,
+    cl_mem_migration_flags flags,
+    cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list,
+    cl_event* event);
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer_wrap(
+    cl_kernel kernel,
+    cl_uint arg_index,
+    const void* arg_value);
+
 // Loader hooks
 
 CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(
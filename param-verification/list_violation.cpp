@@ -453,7 +453,7 @@ bool list_violation(cl_version version, const char * name, T param)
   return true;
 }
 
-std::vector<cl_device_id> get_devices(cl_context context)
+inline std::vector<cl_device_id> get_devices(cl_context context)
 {
   // suppose minimum OpenCL 1.1
   size_t nd = 0;
@@ -475,9 +475,9 @@ std::vector<cl_device_id> get_devices(cl_context context)
   return devices;
 }
 
-std::vector<cl_device_id> get_devices(cl_program program)
+inline std::vector<cl_device_id> get_devices(cl_program program)
 {
-  size_t nd = 0;
+  cl_uint nd = 0;
   tdispatch->clGetProgramInfo(
     program,
     CL_PROGRAM_NUM_DEVICES,
@@ -496,7 +496,7 @@ std::vector<cl_device_id> get_devices(cl_program program)
   return devices;
 }
 
-std::vector<cl_device_id> get_devices(cl_kernel kernel)
+inline std::vector<cl_device_id> get_devices(cl_kernel kernel)
 {
   cl_program pr;
   tdispatch->clGetKernelInfo(
@@ -505,7 +505,7 @@ std::vector<cl_device_id> get_devices(cl_kernel kernel)
     sizeof(pr),
     &pr,
     NULL);
-  size_t nd;
+  cl_uint nd = 0;
   tdispatch->clGetProgramInfo(
     pr,
     CL_PROGRAM_NUM_DEVICES,
@@ -544,7 +544,7 @@ std::vector<cl_device_id> get_devices(cl_kernel kernel)
 //bool object_not_in(T1 object, T2 in);
 
 // device should belong to context
-bool object_not_in(cl_device_id device, cl_context context)
+inline bool object_not_in(cl_device_id device, cl_context context)
 {
   std::vector<cl_device_id> devices = get_devices(context);
   size_t nd = devices.size();
@@ -556,8 +556,24 @@ bool object_not_in(cl_device_id device, cl_context context)
   return true;
 }
 
+// context of a mem object, from the shadow state when available
+inline cl_context mem_context(cl_mem mem)
+{
+  layer::mem_record record;
+  if (layer::find_mem_record(mem, record))
+    return record.context;
+  cl_context context = NULL;
+  tdispatch->clGetMemObjectInfo(
+    mem,
+    CL_MEM_CONTEXT,
+    sizeof(cl_context),
+    &context,
+    NULL);
+  return context;
+}
+
 // command queue and buffer should belong to the same context
-bool object_not_in(cl_command_queue command_queue, cl_mem buffer)
+inline bool object_not_in(cl_command_queue command_queue, cl_mem buffer)
 {
   cl_context c_context;
   tdispatch->clGetCommandQueueInfo(
@@ -566,13 +582,7 @@ bool object_not_in(cl_command_queue command_queue, cl_mem buffer)
     sizeof(cl_context),
     &c_context,
     NULL);
-  cl_context b_context;
-  tdispatch->clGetMemObjectInfo(
-    buffer,
-    CL_MEM_CONTEXT,
-    sizeof(cl_context),
-    &b_context,
-    NULL);
+  cl_context b_context = mem_context(buffer);
 
   if (b_context == c_context)
       return false;
@@ -580,7 +590,7 @@ bool object_not_in(cl_command_queue command_queue, cl_mem buffer)
 }
 
 // events and command queue should belong to the same context
-bool object_not_in(cl_event event, cl_command_queue command_queue)
+inline bool object_not_in(cl_event event, cl_command_queue command_queue)
 {
   cl_context e_context;
   tdispatch->clGetEventInfo(
@@ -603,15 +613,9 @@ bool object_not_in(cl_event event, cl_command_queue command_queue)
 }
 
 // mem objects and command queue should belong to the same context
-bool object_not_in(cl_mem object, cl_command_queue command_queue)
+inline bool object_not_in(cl_mem object, cl_command_queue command_queue)
 {
-  cl_context m_context;
-  tdispatch->clGetMemObjectInfo(
-    object,
-    CL_MEM_CONTEXT,
-    sizeof(cl_context),
-    &m_context,
-    NULL);
+  cl_context m_context = mem_context(object);
   cl_context c_context;
   tdispatch->clGetCommandQueueInfo(
     command_queue,
@@ -626,7 +630,7 @@ bool object_not_in(cl_mem object, cl_command_queue command_queue)
 }
 
 // command queue and kernel should belong to the same context
-bool object_not_in(cl_command_queue command_queue, cl_kernel kernel)
+inline bool object_not_in(cl_command_queue command_queue, cl_kernel kernel)
 {
   cl_context c_context;
   tdispatch->clGetCommandQueueInfo(
@@ -649,7 +653,7 @@ bool object_not_in(cl_command_queue command_queue, cl_kernel kernel)
 }
 
 // events should belong to the same context
-bool object_not_in(cl_event event1, cl_event event2)
+inline bool object_not_in(cl_event event1, cl_event event2)
 {
   cl_context e_context;
   tdispatch->clGetEventInfo(
@@ -672,7 +676,7 @@ bool object_not_in(cl_event event1, cl_event event2)
 }
 
 // command_queue should be on device
-bool object_not_in(cl_command_queue command_queue, cl_device_id device)
+inline bool object_not_in(cl_command_queue command_queue, cl_device_id device)
 {
   cl_device_id q_device;
   tdispatch->clGetCommandQueueInfo(
@@ -688,7 +692,7 @@ bool object_not_in(cl_command_queue command_queue, cl_device_id device)
 }
 
 // device should belong to the program
-bool object_not_in(cl_device_id device, cl_program program)
+inline bool object_not_in(cl_device_id device, cl_program program)
 {
   std::vector<cl_device_id> devices = get_devices(program);
   size_t nd = devices.size();
@@ -703,7 +707,7 @@ bool object_not_in(cl_device_id device, cl_program program)
 }
 
 // device should belong to the kernel
-bool object_not_in(cl_device_id device, cl_kernel kernel)
+inline bool object_not_in(cl_device_id device, cl_kernel kernel)
 {
   std::vector<cl_device_id> devices = get_devices(kernel);
   size_t nd = devices.size();
@@ -718,7 +722,7 @@ bool object_not_in(cl_device_id device, cl_kernel kernel)
 }
 
 // kernel must be built for the device of command_queue
-bool object_not_in(cl_kernel kernel, cl_command_queue command_queue)
+inline bool object_not_in(cl_kernel kernel, cl_command_queue command_queue)
 {
   std::vector<cl_device_id> devices = get_devices(kernel);
   size_t nd = devices.size();
@@ -900,7 +904,7 @@ bool for_any(cl_program program, std::function<bool(return_type<property>)> chec
 }
 
 // adopted from Appendix D of OpenCL 3.0 standard
-bool check_copy_overlap(
+inline bool check_copy_overlap(
   const size_t src_origin[],
   const size_t dst_origin[],
   const size_t region[],
@@ -957,7 +961,7 @@ bool check_copy_overlap(
 }
 
 // check overlap for clEnqueueSVMMemcpy
-bool check_copy_overlap(
+inline bool check_copy_overlap(
   void * dst_ptr,
   const void * src_ptr,
   size_t size)
@@ -975,7 +979,7 @@ bool check_copy_overlap(
 }
 
 // check if ptr is not aligned to align
-bool not_aligned(
+inline bool not_aligned(
   void * ptr,
   size_t align)
 {
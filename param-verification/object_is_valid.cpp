@@ -1,64 +1,70 @@
-bool object_is_valid(cl_platform_id platform) {
+inline bool object_is_valid(cl_platform_id platform) {
   size_t size;
   cl_int res = tdispatch->clGetPlatformInfo(platform, CL_PLATFORM_NAME, 0, nullptr, &size);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_device_id device) {
+inline bool object_is_valid(cl_device_id device) {
   cl_device_type type;
   cl_int res = tdispatch->clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(cl_device_type), &type, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_context context) {
+inline bool object_is_valid(cl_context context) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetContextInfo(context, CL_CONTEXT_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_command_queue command_queue) {
+inline bool object_is_valid(cl_command_queue command_queue) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetCommandQueueInfo(command_queue, CL_QUEUE_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_mem mem) {
+inline bool object_is_valid(cl_mem mem) {
+  layer::mem_record record;
+  if (layer::find_mem_record(mem, record))
+    return true;
   cl_uint refcount;
   cl_int res = tdispatch->clGetMemObjectInfo(mem, CL_MEM_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_mem mem, cl_mem_object_type type) {
+inline bool object_is_valid(cl_mem mem, cl_mem_object_type type) {
+  layer::mem_record record;
+  if (layer::find_mem_record(mem, record))
+    return record.type == type;
   cl_mem_object_type curr_type = 0;
   cl_int res = tdispatch->clGetMemObjectInfo(mem, CL_MEM_TYPE, sizeof(cl_mem_object_type), &curr_type, nullptr);
   return (res == CL_SUCCESS) && (curr_type == type);
 }
 
-bool object_is_valid(cl_sampler sampler) {
+inline bool object_is_valid(cl_sampler sampler) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetSamplerInfo(sampler, CL_SAMPLER_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_program program) {
+inline bool object_is_valid(cl_program program) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetProgramInfo(program, CL_PROGRAM_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_kernel kernel) {
+inline bool object_is_valid(cl_kernel kernel) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetKernelInfo(kernel, CL_KERNEL_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_event event) {
+inline bool object_is_valid(cl_event event) {
   cl_uint refcount;
   cl_int res = tdispatch->clGetEventInfo(event, CL_EVENT_REFERENCE_COUNT, sizeof(cl_uint), &refcount, nullptr);
   return res == CL_SUCCESS;
 }
 
-bool object_is_valid(cl_event event, cl_command_type type) {
+inline bool object_is_valid(cl_event event, cl_command_type type) {
   cl_command_type curr_type = 0;
   cl_int res = tdispatch->clGetEventInfo(event, CL_EVENT_COMMAND_TYPE, sizeof(cl_command_type), &curr_type, nullptr);
   return (res == CL_SUCCESS) && (curr_type == type);
@@ -135,9 +141,13 @@ return_type<property> query(cl_command_queue queue)
 template<cl_uint property>
 return_type<property> query(cl_mem object)
 {
-  cl_version version = get_object_version(object);
   return_type<property> a;
   memset(&a, 0, sizeof(return_type<property>));
+  layer::mem_record record;
+  if (layer::find_mem_record(object, record) &&
+      layer::query_mem_record(record, property, &a, sizeof(a)))
+    return a;
+  cl_version version = get_object_version(object);
   if (!enum_violation(version, "cl_mem_info", property)) {
     tdispatch->clGetMemObjectInfo(object, property, sizeof(a), &a, NULL);
   } else if (!enum_violation(version, "cl_image_info", property)) {
@@ -169,9 +179,11 @@ return_type<property> query(cl_program program)
 template<cl_uint property>
 return_type<property> query(cl_kernel kernel)
 {
-  cl_version version = get_object_version(kernel);
   return_type<property> a;
   memset(&a, 0, sizeof(return_type<property>));
+  if (layer::query_kernel_record(kernel, property, &a, sizeof(a)))
+    return a;
+  cl_version version = get_object_version(kernel);
   if (!enum_violation(version, "cl_kernel_info", property)) {
     tdispatch->clGetKernelInfo(kernel, property, sizeof(a), &a, NULL);
   } else {
@@ -1,5 +1,7 @@
 #include "param_verification.hpp"
-#include <fstream>
+#include "shadow_state.hpp"
+#include "settings_watcher.hpp"
+#include <cstdlib>
 #include <memory>
 
 struct _cl_icd_dispatch dispatch = {};
@@ -8,29 +10,78 @@ const struct _cl_icd_dispatch *tdispatch;
 
 namespace layer {
   ocl_layer_utils::stream_ptr log_stream;
-  layer_settings settings;
+  ocl_layer_utils::violation_reporter reporter;
+  ocl_layer_utils::published<struct _cl_icd_dispatch> active_dispatch;
+  ocl_layer_utils::published<layer_settings> settings;
+
+  void set_dispatch_mask(const ocl_layer_utils::dispatch_mask & mask) {
+    auto table = std::make_unique<struct _cl_icd_dispatch>();
+    init_dispatch(mask, *table);
+    active_dispatch.publish(std::move(table));
+  }
 
-  void init_output_stream() {
-    switch(settings.log_type) {
+  void init_output_stream(const layer_settings & current) {
+    using ocl_layer_utils::log_sink_stream;
+    switch(current.log_type) {
     case layer_settings::DebugLogType::StdOut:
-      log_stream.reset(&std::cout);
+      log_stream.reset(new log_sink_stream(std::cout, current.log_options));
       break;
     case layer_settings::DebugLogType::StdErr:
-      log_stream.reset(&std::cerr);
+      log_stream.reset(new log_sink_stream(std::cerr, current.log_options));
       break;
-    case layer_settings::DebugLogType::File:
-      log_stream.reset(new std::ofstream(settings.log_filename));
-      if (log_stream->fail()) {
-        log_stream.reset(&std::cerr);
+    case layer_settings::DebugLogType::File: {
+      auto sink = std::make_unique<log_sink_stream>(current.log_filename, current.log_options);
+      if (sink->is_open()) {
+        log_stream.reset(sink.release());
+      } else {
+        log_stream.reset(new log_sink_stream(std::cerr, current.log_options));
         *log_stream << "param_verification failed to open specified output stream: "
-                    << settings.log_filename << ". Falling back to stderr." << '\n';
+                    << current.log_filename << ". Falling back to stderr." << '\n';
       }
       break;
     }
+    }
+    reporter.init(log_stream.get(), current.report_limit, current.log_options.format);
   }
 
-  layer_settings layer_settings::load() {
-    const auto settings_from_file = ocl_layer_utils::load_settings();
+  // Switches the existing log stream over, so that references to it stay valid.
+  void retarget_output_stream(const layer_settings & current) {
+    auto & sink = static_cast<ocl_layer_utils::log_sink_stream &>(*log_stream);
+    switch(current.log_type) {
+    case layer_settings::DebugLogType::StdOut:
+      sink.retarget(std::cout);
+      break;
+    case layer_settings::DebugLogType::StdErr:
+      sink.retarget(std::cerr);
+      break;
+    case layer_settings::DebugLogType::File:
+      if (!sink.retarget(current.log_filename))
+        sink << "param_verification failed to open specified output stream: "
+             << current.log_filename << ". Keeping the current one." << std::endl;
+      break;
+    }
+  }
+
+  void reload_settings(const std::map<std::string, std::string> & settings_from_file) {
+    const layer_settings & previous = *settings.get();
+    auto next = std::make_unique<layer_settings>(layer_settings::load(settings_from_file));
+    next->log_options = previous.log_options;
+    next->runtime_mask = previous.runtime_mask;
+    next->watch_settings = previous.watch_settings;
+
+    if (next->log_type != previous.log_type || next->log_filename != previous.log_filename)
+      retarget_output_stream(*next);
+    reporter.set_limit(next->report_limit);
+    if (next->runtime_mask)
+      set_dispatch_mask(next->mask);
+    settings.publish(std::move(next));
+  }
+
+  static void summarize_violations() {
+    reporter.summarize();
+  }
+
+  layer_settings layer_settings::load(const std::map<std::string, std::string> & settings_from_file) {
     const auto parser =
       ocl_layer_utils::settings_parser("param_verification", settings_from_file);
 
@@ -41,10 +92,19 @@ namespace layer {
                                           {"file", DebugLogType::File}};
     parser.get_enumeration("log_sink", debug_log_values, result.log_type);
     parser.get_filename("log_filename", result.log_filename);
+    result.log_options = ocl_layer_utils::load_log_sink_options(parser);
     parser.get_bool("transparent", result.transparent);
+    parser.get_unsigned("report_limit", result.report_limit);
+    result.mask = ocl_layer_utils::dispatch_mask::load(parser);
+    parser.get_bool("runtime_mask", result.runtime_mask);
+    parser.get_bool("watch_settings", result.watch_settings);
 
     return result;
   }
+
+  // Declared last, so that its thread is stopped before the state it
+  // updates is destroyed.
+  ocl_layer_utils::settings_watcher watcher;
 }
 
   /* Layer API entry points */
@@ -79,14 +139,24 @@ clInitLayer(
   if (!target_dispatch || !layer_dispatch_ret || !num_entries_out || num_entries < sizeof(dispatch) / sizeof(dispatch.clGetPlatformIDs))
     return CL_INVALID_VALUE;
 
-  layer::settings = layer::layer_settings::load();
-  layer::init_output_stream();
+  const auto settings_path = ocl_layer_utils::find_settings();
+  layer::settings.publish(std::make_unique<layer::layer_settings>(
+    layer::layer_settings::load(ocl_layer_utils::load_settings(settings_path))));
+  const layer::layer_settings & settings = *layer::settings.get();
+  layer::init_output_stream(settings);
 
   tdispatch = target_dispatch;
-  init_dispatch();
+  layer::set_dispatch_mask(settings.mask);
+  if (settings.runtime_mask)
+    init_dispatch_switch(dispatch);
+  else
+    dispatch = *layer::active_dispatch.get();
+  if (settings.watch_settings)
+    layer::watcher.start(settings_path, layer::reload_settings);
 
   *layer_dispatch_ret = &dispatch;
   *num_entries_out = sizeof(dispatch)/sizeof(dispatch.clGetPlatformIDs);
+  atexit(layer::summarize_violations);
   return CL_SUCCESS;
 }
 
@@ -177,6 +247,9 @@ cl_version get_object_version(cl_command_queue queue) {
 cl_version get_object_version(cl_mem mem) {
   if (!mem)
     return layer::FALLBACK_VERSION;
+  layer::mem_record record;
+  if (layer::find_mem_record(mem, record))
+    return record.version;
   cl_context context;
   cl_int res = tdispatch->clGetMemObjectInfo(
     mem,
@@ -2,6 +2,10 @@
 
 #include <CL/cl_layer.h>
 #include "utils.hpp"
+#include "dispatch_mask.hpp"
+#include "log_sink.hpp"
+#include "published.hpp"
+#include "violation_reporter.hpp"
 #include <vector>
 
 namespace layer {
@@ -10,24 +14,44 @@ namespace layer {
   struct layer_settings {
     enum class DebugLogType { StdOut, StdErr, File };
 
-    static layer_settings load();
+    static layer_settings load(const std::map<std::string, std::string> & settings_from_file);
 
     DebugLogType log_type = DebugLogType::StdErr;
     std::string log_filename;
+    ocl_layer_utils::log_sink_options log_options;
     bool transparent = false;
+    // Number of times the same violation is logged before it is only
+    // counted, 0 logs every occurrence.
+    unsigned report_limit = 10;
+    // Entry points that are not checked, and forwarded straight to the
+    // target dispatch table instead.
+    ocl_layer_utils::dispatch_mask mask;
+    // Forward every entry point through active_dispatch, so that the mask
+    // can be changed with set_dispatch_mask after initialization.
+    bool runtime_mask = false;
+    // Reload the settings file when it changes. log_options and
+    // runtime_mask only take effect at initialization.
+    bool watch_settings = false;
   };
 
-  extern layer_settings settings;
+  // Current settings, replaced when the settings file is reloaded.
+  extern ocl_layer_utils::published<layer_settings> settings;
   extern ocl_layer_utils::stream_ptr log_stream;
+  extern ocl_layer_utils::violation_reporter reporter;
+
+  // Dispatch table the entry points forward to when runtime_mask is set.
+  extern ocl_layer_utils::published<struct _cl_icd_dispatch> active_dispatch;
+
+  // Rebuilds the active dispatch table for mask and publishes it.
+  void set_dispatch_mask(const ocl_layer_utils::dispatch_mask & mask);
 }
 
-// auxilary functions
-std::vector<cl_device_id> get_devices(cl_kernel kernel);
-std::vector<cl_device_id> get_devices(cl_context context);
-std::vector<cl_device_id> get_devices(cl_program program);
-size_t pixel_size(const cl_image_format * image_format);
+// Fills table with the checking entry points enabled in mask, and with the
+// entries of the target dispatch table for the others.
+void init_dispatch(const ocl_layer_utils::dispatch_mask & mask, struct _cl_icd_dispatch & table);
 
-void init_dispatch();
+// Fills table with entry points forwarding to layer::active_dispatch.
+void init_dispatch_switch(struct _cl_icd_dispatch & table);
 
 extern struct _cl_icd_dispatch dispatch;
 
@@ -7,11 +7,13 @@
 #include <regex>
 #include <map>
 #include <array>
+#include <set>
 #include "rapidxml.hpp"
 
 using namespace rapidxml;
 
 bool generate_get_version;
+enum class backend { codegen, table } code_backend = backend::codegen;
 std::map<std::string, std::string> func_params;
 
 // prototypes
@@ -34,6 +36,23 @@ std::string render_from(const char * const version_str, bool call_get_version) {
     return std::string(call_get_version ? "(get_version()" : "(version") + " >= CL_MAKE_VERSION(" + major + ", " + minor + ", 0))";
 }
 
+// Render a call to one of the checks against the shadow state, see
+// shadow_state.hpp, passing the given attributes of the violation in order.
+std::string render_shadow_check(
+    const char * const function,
+    xml_node<> const * const violation,
+    std::initializer_list<const char *> attributes)
+{
+    std::string res = std::string("(layer::") + function + "(";
+    const char * separator = "";
+    for (const char * attribute : attributes) {
+        res += separator;
+        res += violation->first_attribute(attribute)->value();
+        separator = ", ";
+    }
+    return res + "))";
+}
+
 std::string parse_expression(xml_node<> const * const node)
 {
     std::string res;
@@ -277,6 +296,38 @@ std::string parse_violation(xml_node<> const * const violation)
             else
                 test = "(!object_is_valid(" + tmp + "))";
         }
+        else if (strcmp(name, "kernel_args_not_set") == 0)
+        {
+            test = render_shadow_check(name, violation, {"kernel"});
+        }
+        else if (strcmp(name, "kernel_arg_size_mismatch") == 0)
+        {
+            test = render_shadow_check(name, violation, {"kernel", "index", "size"});
+        }
+        else if (strcmp(name, "svm_not_allocated") == 0)
+        {
+            test = render_shadow_check(name, violation, {"pointer"});
+        }
+        else if (strcmp(name, "any_svm_not_allocated") == 0)
+        {
+            test = render_shadow_check(name, violation, {"array", "elements"});
+        }
+        else if ((strcmp(name, "svm_range_not_allocated") == 0) || (strcmp(name, "svm_range_out_of_bounds") == 0))
+        {
+            test = render_shadow_check(name, violation, {"pointer", "size"});
+        }
+        else if (strcmp(name, "any_svm_range_not_allocated") == 0)
+        {
+            test = render_shadow_check(name, violation, {"array", "sizes", "elements", "in"});
+        }
+        else if (strcmp(name, "svm_not_in") == 0)
+        {
+            test = render_shadow_check(name, violation, {"pointer", "in"});
+        }
+        else if (strcmp(name, "any_svm_not_in") == 0)
+        {
+            test = render_shadow_check(name, violation, {"array", "elements", "in"});
+        }
         else if (strcmp(name, "any_zero") == 0)
         {
             test = "(any_zero("
@@ -601,14 +652,14 @@ void parse_literal_lists(std::stringstream& code, xml_node<> *& root_node)
 
     code << "// special case of cl_image_format *\n"
          << "template<>\n"
-         << "size_t literal_list(cl_version version, const char * name, cl_image_format * const param)\n"
+         << "inline size_t literal_list(cl_version version, const char * name, cl_image_format * const param)\n"
          << "{\n"
          << "  (void)version;\n"
          << "  (void)name;\n"
          << "  return pixel_size(param);\n"
          << "}\n"
          << "template<>\n"
-         << "size_t literal_list(cl_version version, const char * name, const cl_image_format * const param)\n"
+         << "inline size_t literal_list(cl_version version, const char * name, const cl_image_format * const param)\n"
          << "{\n"
          << "  (void)version;\n"
          << "  (void)name;\n"
@@ -705,13 +756,248 @@ void render_fetch_version(std::stringstream& code, const std::string& handle, co
     code << "  };\n";
 }
 
-void parse_commands(std::stringstream& code, xml_node<> *& root_node)
+// Commands the layer keeps shadow state for, see shadow_state.hpp. Their
+// entry points call layer::pre_<command>(args...) before forwarding the call
+// and/or layer::post_<command>(result, args...) after it.
+const std::set<std::string> pre_dispatch_hooks = {
+    "clReleaseMemObject", "clReleaseKernel", "clSVMFree", "clEnqueueSVMFree",
+};
+const std::set<std::string> post_dispatch_hooks = {
+    "clCreateBuffer", "clCreateBufferWithProperties", "clCreateSubBuffer",
+    "clCreateImage", "clCreateImageWithProperties", "clCreateImage2D", "clCreateImage3D",
+    "clCreatePipe", "clRetainMemObject",
+    "clCreateKernel", "clCreateKernelsInProgram", "clCloneKernel",
+    "clSetKernelArg", "clSetKernelArgSVMPointer", "clRetainKernel",
+    "clSVMAlloc",
+};
+
+// Render the forwarding of a command to the next layer, along with its hooks.
+std::string render_dispatch(
+    const char * const name,
+    const std::string& ret_type,
+    const std::vector<std::string>& param_names,
+    const std::string& invoke)
+{
+    std::string args;
+    for (const auto& param : param_names)
+        args += ", " + param;
+
+    std::string res;
+    if (pre_dispatch_hooks.count(name))
+        res += std::string("  layer::pre_") + name + "(" + (args.empty() ? args : args.substr(2)) + ");\n";
+
+    if (!post_dispatch_hooks.count(name)) {
+        res += "  return " + invoke;
+    }
+    else if (ret_type == "void") {
+        res += "  " + invoke;
+        res += std::string("  layer::post_") + name + "(" + (args.empty() ? args : args.substr(2)) + ");\n";
+    }
+    else {
+        res += "  " + ret_type + " result = " + invoke;
+        res += std::string("  layer::post_") + name + "(result" + args + ");\n";
+        res += "  return result;\n";
+    }
+    return res;
+}
+
+// Object handles a command is called with, reported along with violations.
+const std::set<std::string> object_types = {
+    "cl_platform_id", "cl_device_id", "cl_context", "cl_command_queue",
+    "cl_mem", "cl_sampler", "cl_program", "cl_kernel", "cl_event"
+};
+
+std::string render_handles(const std::vector<std::string>& handles)
+{
+    std::string res = "{";
+    for (const auto& handle : handles)
+        res += (res.size() == 1 ? "" : ", ") + handle;
+    return res + "}";
+}
+
+// Render the string literal logged when a rule is violated, without the
+// leading "In <command>: " part.
+std::string render_log_message(xml_node<> const * const result_node, const char * const name, const std::string& indent)
+{
+    std::stringstream message;
+
+    std::string log_ret;
+    std::string log_param;
+    for (xml_node<> * name_node = result_node->first_node("name"),
+                    * value_node = result_node->first_node("value");
+        (name_node != nullptr) && (value_node != nullptr);
+        name_node = name_node->next_sibling("name"),
+        value_node = value_node->next_sibling("value"))
+    {
+        if (strcmp(name, name_node->value()) == 0)
+        {
+            log_ret = value_node->value();
+        }
+        else
+        {
+            if (log_param != "")
+                log_param += ", ";
+            log_param += std::string("*") + name_node->value() + " = " + value_node->value();
+        }
+    }
+
+    // commands returning void (clSVMFree) have nothing to report
+    const bool returns = log_ret != "" || log_param != "";
+    for (xml_node<> * log_node = result_node->first_node("log");
+        log_node != nullptr;
+        log_node = log_node->next_sibling("log"))
+    {
+        const bool last = log_node->next_sibling("log") == nullptr;
+        message << indent << "\"" << log_node->value() << (last && !returns ? "." : ". ") << "\"";
+        if (!last || returns)
+            message << "\n";
+    }
+    if (!returns)
+        return message.str();
+
+    message << indent << "\"Returning " << log_ret;
+    if (log_param != "") {
+        if (log_ret != "")
+            message << ", ";
+    }
+    message << log_param << ".\"";
+
+    return message.str();
+}
+
+// Table backend: every rule becomes a predicate function and an entry in a
+// constant table evaluated by layer::first_violation (see rule_table.hpp).
+void render_rule_table(
+    std::stringstream& code,
+    xml_node<> const * const command_node,
+    const char * const name,
+    const std::string& proto,
+    const std::string& ret_type,
+    const std::string& handle,
+    const std::string& params,
+    const std::vector<std::string>& param_names,
+    const std::vector<std::string>& handles,
+    const std::string& invoke)
+{
+    std::stringstream table;
+    std::string out_param;
+
+    int n = 0;
+    for (xml_node<> * violation_node = command_node->first_node("if"),
+                    * result_node = command_node->first_node("then");
+        (violation_node != nullptr) && (result_node != nullptr);
+        violation_node = violation_node->next_sibling("if"),
+        result_node = result_node->next_sibling("then"))
+    {
+        const std::string predicate = std::string(name) + "_rule_" + std::to_string(n);
+
+        generate_get_version = false;
+        std::string test = parse_violation(violation_node->first_node());
+
+        code << "static bool " << predicate << "(\n" << params << "{\n";
+        for (const auto& param : param_names)
+            code << "  (void)" << param << ";\n";
+        if (generate_get_version)
+            render_fetch_version(code, handle, name);
+        code << "  return " << test << ";\n"
+             << "}\n\n";
+
+        std::string ret = "{}";
+        std::string errcode = "CL_SUCCESS";
+        bool sets_errcode = false;
+        for (xml_node<> * name_node = result_node->first_node("name"),
+                        * value_node = result_node->first_node("value");
+            (name_node != nullptr) && (value_node != nullptr);
+            name_node = name_node->next_sibling("name"),
+            value_node = value_node->next_sibling("value"))
+        {
+            if (strcmp(name, name_node->value()) == 0)
+            {
+                ret = value_node->value();
+            }
+            else
+            {
+                out_param = name_node->value();
+                errcode = value_node->value();
+                sets_errcode = true;
+            }
+        }
+
+        table << "    { &" << predicate << ",\n"
+              << render_log_message(result_node, name, "      ") << ",\n"
+              << "      " << ret << ", " << errcode << ", " << (sets_errcode ? "true" : "false") << " },\n";
+        ++n;
+    }
+
+    code << proto << "{\n";
+
+    if (n != 0) {
+        code << "  static const layer::rule<" << ret_type;
+        for (const auto& param : param_names)
+            code << ",\n    decltype(" << param << ")";
+        code << "> rules[] = {\n" << table.rdbuf() << "  };\n\n";
+
+        code << "  if (auto rule = layer::first_violation(rules";
+        for (const auto& param : param_names)
+            code << ", " << param;
+        code << ")) {\n"
+             << "    layer::reporter.report({\"" << name << "\", " << strlen(name) << ", rule->message,\n"
+             << "      " << render_handles(handles) << ", " << (ret_type == "cl_int" ? "rule->result" : "rule->errcode") << "});\n"
+             << "    if (!layer::settings.get()->transparent) {\n";
+        if (out_param != "")
+            code << "      if (rule->sets_errcode && " << out_param << " != NULL)\n"
+                 << "        *" << out_param << " = rule->errcode;\n";
+        code << "      return" << (ret_type == "void" ? "" : " rule->result") << ";\n"
+             << "    }\n"
+             << "  }\n\n";
+    }
+
+    code << render_dispatch(name, ret_type, param_names, invoke) << "}\n\n";
+}
+
+// API families, one generated translation unit (res_<family>.cpp) each.
+// Keep in sync with PARAM_VERIFICATION_SHARDS in CMakeLists.txt.
+const std::vector<std::string> families = {
+    "platform", "context", "queue", "mem", "image", "svm",
+    "sampler", "program", "kernel", "event"
+};
+
+std::string command_family(const std::string& name)
+{
+    // first match wins, e.g. clEnqueueCopyImageToBuffer is an image command
+    static const std::vector<std::pair<std::string, std::string>> patterns = {
+        { "SVM", "svm" },
+        { "Image", "image" },
+        { "Sampler", "sampler" },
+        { "Program", "program" },
+        { "Compiler", "program" },
+        { "Kernel", "kernel" },
+        { "Task", "kernel" },
+        { "Event", "event" },
+        { "Marker", "event" },
+        { "Barrier", "event" },
+        { "Context", "context" },
+        { "CommandQueue", "queue" },
+        { "Flush", "queue" },
+        { "Finish", "queue" },
+        { "Buffer", "mem" },
+        { "MemObject", "mem" },
+        { "Pipe", "mem" },
+    };
+    for (const auto& pattern : patterns)
+        if (name.find(pattern.first) != std::string::npos)
+            return pattern.second;
+    return "platform";
+}
+
+void parse_commands(std::map<std::string, std::stringstream>& shards, xml_node<> *& root_node)
 {
     ///////////////////////////////////////////////////////////////////////
     // commands
     ///////////////////////////////////////////////////////////////////////
 
-    std::stringstream init_dispatch;
+    std::map<std::string, std::stringstream> init_dispatch;
+    std::map<std::string, std::stringstream> init_switch;
 
     // Iterate over the commands
     for (xml_node<> * commands_node = root_node->first_node("commands");
@@ -734,13 +1020,23 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
             std::string proto = prefix + " " + type + " " + qual + " " + suffix  + " " + name + "_layer(\n";
             proto = std::regex_replace(proto, std::regex("[ ]+"), " ");
 
-            init_dispatch << "    dispatch." << name << " = &" << name << "_layer;\n";
+            std::stringstream& code = shards[command_family(name)];
+            // commands with hooks keep the shadow state up to date, when
+            // masked they only run the hooks
+            const bool hooked = pre_dispatch_hooks.count(name) || post_dispatch_hooks.count(name);
+            init_dispatch[command_family(name)]
+                << "    table." << name << " = mask.enabled(\"" << name << "\", \"" << command_family(name) << "\") ? &"
+                << name << "_layer : " << (hooked ? "&" : "tdispatch->") << name << (hooked ? "_hooks" : "") << ";\n";
+            init_switch[command_family(name)] << "    table." << name << " = &" << name << "_switch;\n";
 
 //            if (param_node->value())
                 //printf("I have visited %s\n", proto.c_str());
 //            code << proto;
 
             std::string handle;
+            std::string params;
+            std::vector<std::string> param_names;
+            std::vector<std::string> handles;
 
             int n = 0;
             func_params.clear();
@@ -761,6 +1057,7 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
                 if (n == 0) {
                     handle = param_node->first_node("name")->value();
                 }
+                param_names.push_back(param_node->first_node("name")->value());
 
                 // read all the contents as text omitting tags - works for 1-level tags only
                 node = param_node->first_node();
@@ -776,12 +1073,39 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
                 tmp = std::regex_replace(tmp, std::regex(" \\)"), ")");
                 //printf("%s", tmp.c_str());
 
+                xml_node<> * type_node = param_node->first_node("type");
+                if (type_node != nullptr && object_types.count(type_node->value()) != 0 &&
+                    tmp.find_first_of("*[") == std::string::npos)
+                    handles.push_back(param_names.back());
+
                 proto += tmp;
+                params += tmp;
                 ++n;
             }
             proto += ")\n";
+            params += ")\n";
             invoke += ");\n";
 
+            const std::string ret_type = std::regex_replace(type + qual, std::regex("[ ]+$"), "");
+
+            // forwards to the entry of the currently active dispatch table,
+            // installed instead of the wrappers when the mask can change
+            code << std::regex_replace(proto, std::regex(std::string(name) + "_layer\\("), std::string(name) + "_switch(")
+                 << "{\n"
+                 << "  return " << std::regex_replace(invoke, std::regex("^tdispatch->"), "layer::active_dispatch.get()->")
+                 << "}\n\n";
+
+            if (hooked)
+                code << std::regex_replace(proto, std::regex(std::string(name) + "_layer\\("), std::string(name) + "_hooks(")
+                     << "{\n"
+                     << render_dispatch(name, ret_type, param_names, invoke)
+                     << "}\n\n";
+
+            if (code_backend == backend::table) {
+                render_rule_table(code, command_node, name, proto, ret_type, handle, params, param_names, handles, invoke);
+                continue;
+            }
+
             code << proto << "{\n";
 
             std::stringstream body;
@@ -796,8 +1120,9 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
             {
                 body << "  if " << parse_violation(violation_node->first_node()) << " {\n";
 
-                std::string log_ret;
-                std::string log_param;
+                std::string ret;
+                std::string error = "CL_SUCCESS";
+                std::stringstream out_params;
                 for (xml_node<> * name_node = result_node->first_node("name"),
                                 * value_node = result_node->first_node("value");
                     (name_node != nullptr) && (value_node != nullptr);
@@ -806,62 +1131,38 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
                 {
                     if (strcmp(name, name_node->value()) == 0)
                     {
-                        log_ret = value_node->value();
+                        ret = value_node->value();
+                        if (ret_type == "cl_int")
+                            error = ret;
                     }
                     else
                     {
-                        if (log_param != "")
-                            log_param += ", ";
-                        log_param += std::string("*") + name_node->value() + " = " + value_node->value();
+                        error = value_node->value();
+                        out_params << "    if (" << name_node->value() << " != NULL)\n"
+                                   << "      *" << name_node->value() << " = " << value_node->value() << ";\n";
                     }
                 }
 
-                body << "    *layer::log_stream << \"In " << name << ": \"\n";
-
-                for (xml_node<> * log_node = result_node->first_node("log");
-                    log_node != nullptr;
-                    log_node = log_node->next_sibling("log"))
-                {
-                    body << "      \"" << log_node->value() << ". \"\n";
-                }
-
-                body << "      \"Returning " << log_ret;
-                if (log_param != "") {
-                    if (log_ret != "")
-                        body << ", ";
-                }
-                body << log_param << ".\" << std::endl;\n";
+                body << "    layer::reporter.report({\"" << name << "\", " << strlen(name) << ",\n";
+                body << render_log_message(result_node, name, "      ") << ",\n"
+                     << "      " << render_handles(handles) << ", " << error << "});\n";
 
-                body << "    if (layer::settings.transparent)\n";
+                body << "    if (layer::settings.get()->transparent)\n";
                 body << "      goto " << name << "_dispatch;\n";
                 generate_label = true;
 
-                std::string ret;
-                for (xml_node<> * name_node = result_node->first_node("name"),
-                                * value_node = result_node->first_node("value");
-                    (name_node != nullptr) && (value_node != nullptr);
-                    name_node = name_node->next_sibling("name"),
-                    value_node = value_node->next_sibling("value"))
-                {
-                    if (strcmp(name, name_node->value()) == 0)
-                    {
-                        ret = value_node->value();
-                    }
-                    else
-                    {
-                        body << "    if (" << name_node->value() << " != NULL)\n"
-                             << "      *" << name_node->value() << " = " << value_node->value() << ";\n";
-                    }
-                }
+                body << out_params.str();
 
                 if (ret != "")
                     body << "    return " << ret << ";\n";
+                else
+                    body << "    return;\n";
                 body << "  }\n\n";
             }
 
             if (generate_label)
                 body << name << "_dispatch:\n";
-            body << "  return " << invoke << "}\n\n";
+            body << render_dispatch(name, ret_type, param_names, invoke) << "}\n\n";
 
             if (generate_get_version) {
               render_fetch_version(code, handle, name);
@@ -872,13 +1173,39 @@ void parse_commands(std::stringstream& code, xml_node<> *& root_node)
 
     }
 
-    code << "void init_dispatch() {\n" << init_dispatch.rdbuf() << "}\n";
+    for (const auto& family : families) {
+        shards[family] << "void init_dispatch_" << family << "(const ocl_layer_utils::dispatch_mask& mask, struct _cl_icd_dispatch& table) {\n"
+                       << "  (void)mask;\n"
+                       << init_dispatch[family].str() << "}\n\n";
+        shards[family] << "void init_dispatch_switch_" << family << "(struct _cl_icd_dispatch& table) {\n"
+                       << init_switch[family].str() << "}\n";
+    }
+}
+
+// Only touch outputs whose content changed, so that the build system
+// recompiles just the affected shards.
+void write_if_changed(const std::string& filename, const std::string& content)
+{
+    std::ifstream existing(filename);
+    if (existing) {
+        std::stringstream old;
+        old << existing.rdbuf();
+        if (old.str() == content)
+            return;
+    }
+    existing.close();
+
+    std::ofstream file(filename);
+    file << content;
 }
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <path to cl.xml>" << std::endl;
+    if (argc == 4 && strcmp(argv[2], "--backend") == 0 && strcmp(argv[3], "table") == 0) {
+        code_backend = backend::table;
+    }
+    else if (argc != 2 && !(argc == 4 && strcmp(argv[2], "--backend") == 0 && strcmp(argv[3], "codegen") == 0)) {
+        std::cerr << "Usage: " << argv[0] << " <path to cl.xml> [--backend codegen|table]" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -888,9 +1215,10 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    // stream for generated code
+    // stream for the helpers shared by all the generated translation units
     std::stringstream code;
-    code << "#ifdef _WIN32\n"
+    code << "#pragma once\n"
+         << "#ifdef _WIN32\n"
          << "#define NOMINMAX\n"
          << "#endif\n"
          << "#include <CL/cl.h>\n"
@@ -899,7 +1227,18 @@ int main(int argc, char* argv[])
          << "#include <vector>\n"
          << "#include <algorithm>\n"
          << "#include <functional>\n"
-         << "#include \"param_verification.hpp\"\n\n\n";
+         << "#include \"param_verification.hpp\"\n"
+         << "#include \"shadow_state.hpp\"\n";
+    if (code_backend == backend::table)
+        code << "#include \"rule_table.hpp\"\n";
+    code << "\n";
+
+    // auxiliary functions defined in the included helpers below
+    code << "inline std::vector<cl_device_id> get_devices(cl_kernel kernel);\n"
+         << "inline std::vector<cl_device_id> get_devices(cl_context context);\n"
+         << "inline std::vector<cl_device_id> get_devices(cl_program program);\n"
+         << "inline size_t pixel_size(const cl_image_format * image_format);\n"
+         << "\n\n";
 
     xml_document<> doc;
     xml_node<> * root_node;
@@ -962,7 +1301,7 @@ int main(int argc, char* argv[])
          << "  return false;\n"
          << "}\n\n";
 
-    code << "bool any_not_available(const cl_device_id * devices, size_t size)\n"
+    code << "inline bool any_not_available(const cl_device_id * devices, size_t size)\n"
          << "{\n"
          << "  cl_bool avail = false;\n"
          << "  for (size_t i = 0; i < size; ++i) {\n"
@@ -980,13 +1319,31 @@ int main(int argc, char* argv[])
          << "#include \"struct_violation.cpp\"\n"
          << "\n\n";
 
-    code << "//////////////////////////////////////////////////////////////////////\n\n";
-
-    parse_commands(code, root_node);
-
-    std::ofstream file("res.cpp");
-    file << code.str();
-    file.close();
+    // streams for the layer entry points, one per API family
+    std::map<std::string, std::stringstream> shards;
+    for (const auto& family : families)
+        shards[family] << "#include \"res_helpers.hpp\"\n\n";
+
+    parse_commands(shards, root_node);
+
+    std::stringstream dispatch;
+    dispatch << "#include \"param_verification.hpp\"\n\n";
+    for (const auto& family : families)
+        dispatch << "void init_dispatch_" << family << "(const ocl_layer_utils::dispatch_mask& mask, struct _cl_icd_dispatch& table);\n"
+                 << "void init_dispatch_switch_" << family << "(struct _cl_icd_dispatch& table);\n";
+    dispatch << "\nvoid init_dispatch(const ocl_layer_utils::dispatch_mask& mask, struct _cl_icd_dispatch& table) {\n";
+    for (const auto& family : families)
+        dispatch << "    init_dispatch_" << family << "(mask, table);\n";
+    dispatch << "}\n";
+    dispatch << "\nvoid init_dispatch_switch(struct _cl_icd_dispatch& table) {\n";
+    for (const auto& family : families)
+        dispatch << "    init_dispatch_switch_" << family << "(table);\n";
+    dispatch << "}\n";
+
+    write_if_changed("res_helpers.hpp", code.str());
+    for (const auto& family : families)
+        write_if_changed("res_" + family + ".cpp", shards[family].str());
+    write_if_changed("res_dispatch.cpp", dispatch.str());
     //std::cout << code.str();
     return 0;
 }
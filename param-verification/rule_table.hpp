@@ -0,0 +1,41 @@
+#pragma once
+
+#include <CL/cl.h>
+#include <cstddef>
+
+// Support for the table-driven backend of CLParamVerificationGenerator.
+//
+// Instead of expanding every rule of a command inline in its wrapper, the
+// table backend emits one out-of-line predicate per rule and a constant table
+// describing what to report when the predicate holds. Wrappers then share the
+// evaluation loop below and a single reporting path.
+namespace layer {
+  template<typename R>
+  struct rule_result { typedef R type; };
+
+  // Commands returning void (clSVMFree) have no result to report.
+  template<>
+  struct rule_result<void> { typedef bool type; };
+
+  template<typename R, typename... Args>
+  struct rule {
+    bool (*violated)(Args...);
+    // Message logged after "In <command>: ", including the returned values.
+    const char * message;
+    typename rule_result<R>::type result;
+    // Value stored to the errcode_ret out-parameter, if the command has one
+    // and the rule sets it.
+    cl_int errcode;
+    bool sets_errcode;
+  };
+
+  // Returns the first rule whose predicate holds, or nullptr.
+  template<typename Rule, size_t N, typename... Args>
+  const Rule * first_violation(const Rule (&rules)[N], Args... args)
+  {
+    for (const Rule & r : rules)
+      if (r.violated(args...))
+        return &r;
+    return nullptr;
+  }
+}
@@ -0,0 +1,701 @@
+#include "shadow_state.hpp"
+#include "param_verification.hpp"
+#include "handle_registry.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace {
+  // Open addressing hash table from handles to small trivially copyable
+  // records, readable without locks.
+  //
+  // Each slot is guarded by a sequence counter: writers make it odd while
+  // they update the record, readers retry when they observe an odd or a
+  // changed counter. When a segment gets half full a twice as large one is
+  // pushed in front of it; old segments are never freed so readers can walk
+  // the chain without synchronizing with writers.
+  template<typename Record>
+  class shadow_table {
+  public:
+    shadow_table() : head(new segment(initial_capacity, nullptr)) {}
+
+    bool find(const void * handle, Record & record) const
+    {
+      const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+      for (const segment * seg = head.load(); seg != nullptr; seg = seg->next) {
+        const slot * s = seg->find(key);
+        if (s != nullptr && s->read(key, record))
+          return true;
+      }
+      return false;
+    }
+
+    void insert(const void * handle, const Record & record)
+    {
+      const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+      if (key <= busy_key)
+        return;
+      // the driver may hand out a handle again once the previous object
+      // died without us seeing its last release
+      erase(handle);
+      for (;;) {
+        segment * seg = head.load();
+        if (seg->claim(key, record))
+          return;
+        grow(seg);
+      }
+    }
+
+    void retain(const void * handle)
+    {
+      slot * s = lookup(reinterpret_cast<uintptr_t>(handle));
+      if (s != nullptr)
+        s->refcount.fetch_add(1);
+    }
+
+    void release(const void * handle)
+    {
+      const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+      slot * s = lookup(key);
+      if (s != nullptr && s->refcount.fetch_sub(1) == 1) {
+        uintptr_t expected = key;
+        s->key.compare_exchange_strong(expected, tombstone_key);
+      }
+    }
+
+    void erase(const void * handle)
+    {
+      const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+      for (segment * seg = head.load(); seg != nullptr; seg = seg->next) {
+        slot * s = seg->find(key);
+        if (s != nullptr) {
+          uintptr_t expected = key;
+          s->key.compare_exchange_strong(expected, tombstone_key);
+        }
+      }
+    }
+
+  private:
+    static constexpr uintptr_t empty_key = 0;
+    static constexpr uintptr_t tombstone_key = 1;
+    static constexpr uintptr_t busy_key = 2;
+    static constexpr size_t initial_capacity = 1024;
+    static constexpr size_t words = (sizeof(Record) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct slot {
+      std::atomic<uintptr_t> key{empty_key};
+      std::atomic<uint32_t> sequence{0};
+      std::atomic<cl_uint> refcount{0};
+      std::atomic<uint64_t> data[words];
+
+      void write(const Record & record)
+      {
+        uint64_t buffer[words] = {};
+        memcpy(buffer, &record, sizeof(Record));
+        sequence.fetch_add(1);
+        for (size_t i = 0; i < words; ++i)
+          data[i].store(buffer[i], std::memory_order_relaxed);
+        sequence.fetch_add(1);
+      }
+
+      bool read(uintptr_t expected_key, Record & record) const
+      {
+        uint64_t buffer[words];
+        for (;;) {
+          const uint32_t before = sequence.load();
+          if (before & 1)
+            continue;
+          for (size_t i = 0; i < words; ++i)
+            buffer[i] = data[i].load(std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (sequence.load(std::memory_order_relaxed) != before)
+            continue;
+          if (key.load() != expected_key)
+            return false;
+          memcpy(&record, buffer, sizeof(Record));
+          return true;
+        }
+      }
+    };
+
+    struct segment {
+      segment(size_t capacity, segment * older)
+        : slots(new slot[capacity]), mask(capacity - 1), next(older) {}
+
+      static size_t hash(uintptr_t key)
+      {
+        // handles are at least pointer aligned
+        return static_cast<size_t>((key >> 3) * UINT64_C(0x9E3779B97F4A7C15) >> 17);
+      }
+
+      slot * find(uintptr_t key) const
+      {
+        for (size_t i = 0, pos = hash(key); i <= mask; ++i, ++pos) {
+          slot & s = slots[pos & mask];
+          const uintptr_t k = s.key.load();
+          if (k == key)
+            return &s;
+          if (k == empty_key)
+            return nullptr;
+        }
+        return nullptr;
+      }
+
+      bool claim(uintptr_t key, const Record & record)
+      {
+        if (used.load() * 2 > mask)
+          return false;
+        for (size_t i = 0, pos = hash(key); i <= mask; ++i, ++pos) {
+          slot & s = slots[pos & mask];
+          uintptr_t k = s.key.load();
+          if ((k == empty_key || k == tombstone_key) &&
+              s.key.compare_exchange_strong(k, busy_key)) {
+            if (k == empty_key)
+              used.fetch_add(1);
+            s.refcount.store(1);
+            s.write(record);
+            s.key.store(key);
+            return true;
+          }
+        }
+        return false;
+      }
+
+      std::unique_ptr<slot[]> slots;
+      const size_t mask;
+      std::atomic<size_t> used{0};
+      segment * const next;
+    };
+
+    slot * lookup(uintptr_t key) const
+    {
+      for (segment * seg = head.load(); seg != nullptr; seg = seg->next) {
+        slot * s = seg->find(key);
+        if (s != nullptr)
+          return s;
+      }
+      return nullptr;
+    }
+
+    void grow(segment * full)
+    {
+      std::lock_guard<std::mutex> lock(grow_mutex);
+      if (head.load() == full)
+        head.store(new segment((full->mask + 1) * 2, full));
+    }
+
+    std::atomic<segment *> head;
+    std::mutex grow_mutex;
+  };
+
+  shadow_table<layer::mem_record> mem_records;
+
+  template<typename T>
+  T mem_info(cl_mem mem, cl_mem_info property)
+  {
+    T value{};
+    tdispatch->clGetMemObjectInfo(mem, property, sizeof(T), &value, nullptr);
+    return value;
+  }
+
+  // The values are read back from the driver once, so that defaults and
+  // properties inherited from parent buffers are exactly what it reports.
+  void record_mem(cl_mem mem)
+  {
+    if (mem == nullptr)
+      return;
+    layer::mem_record record;
+    record.type = mem_info<cl_mem_object_type>(mem, CL_MEM_TYPE);
+    record.flags = mem_info<cl_mem_flags>(mem, CL_MEM_FLAGS);
+    record.size = mem_info<size_t>(mem, CL_MEM_SIZE);
+    record.host_ptr = mem_info<void *>(mem, CL_MEM_HOST_PTR);
+    record.parent = mem_info<cl_mem>(mem, CL_MEM_ASSOCIATED_MEMOBJECT);
+    record.origin = mem_info<size_t>(mem, CL_MEM_OFFSET);
+    record.context = mem_info<cl_context>(mem, CL_MEM_CONTEXT);
+    record.version = get_object_version(record.context);
+    mem_records.insert(mem, record);
+  }
+
+  // Kernel state is variable in size, so unlike mem objects it lives in a
+  // handle registry. What the driver reports is fixed at creation, the
+  // arguments that got a value are tracked in an atomic bitmap, so setting
+  // arguments and launching only take the shared lock of one shard.
+  struct kernel_arg {
+    cl_kernel_arg_address_qualifier address;
+    // 0 when the size is not known (structs, size_t, ...)
+    size_t size;
+  };
+
+  struct kernel_state {
+    kernel_state(cl_uint num_args, std::vector<kernel_arg> args)
+      : num_args(num_args), args(std::move(args)),
+        set(new std::atomic<uint64_t>[(num_args + 63) / 64]()), unset(num_args) {}
+
+    const cl_uint num_args;
+    // empty unless the driver reports argument info
+    const std::vector<kernel_arg> args;
+    // one bit per argument, set once it got a value
+    const std::unique_ptr<std::atomic<uint64_t>[]> set;
+    std::atomic<cl_uint> unset;
+  };
+
+  ocl_layer_utils::handle_registry<std::shared_ptr<kernel_state>> kernel_states;
+
+  size_t scalar_size(const std::string & name)
+  {
+    static const struct { const char * name; size_t size; } scalars[] = {
+      {"char", 1}, {"uchar", 1}, {"short", 2}, {"ushort", 2}, {"half", 2},
+      {"int", 4}, {"uint", 4}, {"float", 4},
+      {"long", 8}, {"ulong", 8}, {"double", 8},
+    };
+    for (const auto & scalar : scalars)
+      if (name == scalar.name)
+        return scalar.size;
+    return 0;
+  }
+
+  // Size of a private argument of the given type, or 0 if it can not be told
+  // from the type name alone.
+  size_t private_arg_size(const std::string & type_name)
+  {
+    if (type_name == "sampler_t")
+      return sizeof(cl_sampler);
+    if (type_name == "queue_t")
+      return sizeof(cl_command_queue);
+
+    // vector types are the scalar type followed by the number of elements
+    const size_t length = type_name.find_last_not_of("0123456789") + 1;
+    const size_t size = scalar_size(type_name.substr(0, length));
+    if (length == type_name.size() || size == 0)
+      return size;
+    const std::string width = type_name.substr(length);
+    if (width == "2" || width == "4" || width == "8" || width == "16")
+      return size * std::stoul(width);
+    if (width == "3")
+      return size * 4;
+    return 0;
+  }
+
+  std::vector<kernel_arg> get_kernel_args(cl_kernel kernel, cl_uint num_args)
+  {
+    std::vector<kernel_arg> args;
+    if (tdispatch->clGetKernelArgInfo == nullptr ||
+        get_object_version(kernel) < CL_MAKE_VERSION(1, 2, 0))
+      return args;
+    for (cl_uint i = 0; i < num_args; ++i) {
+      kernel_arg arg = {CL_KERNEL_ARG_ADDRESS_PRIVATE, 0};
+      size_t name_size = 0;
+      // fails unless the program was built with -cl-kernel-arg-info
+      if (tdispatch->clGetKernelArgInfo(kernel, i, CL_KERNEL_ARG_ADDRESS_QUALIFIER, sizeof(arg.address), &arg.address, nullptr) != CL_SUCCESS ||
+          tdispatch->clGetKernelArgInfo(kernel, i, CL_KERNEL_ARG_TYPE_NAME, 0, nullptr, &name_size) != CL_SUCCESS)
+        return {};
+      std::string type_name(name_size, '\0');
+      tdispatch->clGetKernelArgInfo(kernel, i, CL_KERNEL_ARG_TYPE_NAME, name_size, &type_name[0], nullptr);
+      type_name.resize(strlen(type_name.c_str()));
+      // pointers, images and pipes are all passed as memory objects
+      if (arg.address == CL_KERNEL_ARG_ADDRESS_GLOBAL || arg.address == CL_KERNEL_ARG_ADDRESS_CONSTANT)
+        arg.size = sizeof(cl_mem);
+      else if (arg.address == CL_KERNEL_ARG_ADDRESS_PRIVATE)
+        arg.size = private_arg_size(type_name);
+      args.push_back(arg);
+    }
+    return args;
+  }
+
+  void record_kernel(cl_kernel kernel)
+  {
+    if (kernel == nullptr)
+      return;
+    cl_uint num_args = 0;
+    if (tdispatch->clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(num_args), &num_args, nullptr) != CL_SUCCESS)
+      return;
+    kernel_states.on_create(kernel, std::make_shared<kernel_state>(num_args, get_kernel_args(kernel, num_args)));
+  }
+
+  // Calls read(kernel_state &) if kernel is tracked.
+  template<typename Read>
+  bool find_kernel(cl_kernel kernel, Read && read)
+  {
+    return kernel_states.find(kernel, [&read](const decltype(kernel_states)::entry & entry) {
+      read(*entry.payload);
+    });
+  }
+
+  void record_kernel_arg(cl_int result, cl_kernel kernel, cl_uint arg_index)
+  {
+    if (result != CL_SUCCESS)
+      return;
+    find_kernel(kernel, [arg_index](kernel_state & state) {
+      if (arg_index >= state.num_args)
+        return;
+      std::atomic<uint64_t> & word = state.set[arg_index / 64];
+      const uint64_t bit = UINT64_C(1) << (arg_index % 64);
+      // arguments are mostly set again, which needs no write
+      if (!(word.load(std::memory_order_relaxed) & bit) && !(word.fetch_or(bit) & bit))
+        state.unset.fetch_sub(1);
+    });
+  }
+
+  // Live SVM allocations sorted by base address, so the one containing a
+  // pointer is found by binary search. Allocations are rare compared to the
+  // calls using them, hence the flat array and the reader-writer lock.
+  class svm_registry {
+  public:
+    void insert(const layer::svm_allocation & allocation)
+    {
+      std::lock_guard<std::shared_timed_mutex> lock(mutex);
+      auto it = std::lower_bound(allocations.begin(), allocations.end(), allocation.base, base_less);
+      if (it != allocations.end() && it->base == allocation.base)
+        *it = allocation;
+      else
+        allocations.insert(it, allocation);
+    }
+
+    void erase(const void * base)
+    {
+      std::lock_guard<std::shared_timed_mutex> lock(mutex);
+      auto it = std::lower_bound(allocations.begin(), allocations.end(), static_cast<const char *>(base), base_less);
+      if (it != allocations.end() && it->base == base)
+        allocations.erase(it);
+    }
+
+    bool find(const void * ptr, layer::svm_allocation & allocation) const
+    {
+      const char * p = static_cast<const char *>(ptr);
+      std::shared_lock<std::shared_timed_mutex> lock(mutex);
+      auto it = std::upper_bound(allocations.begin(), allocations.end(), p,
+        [](const char * a, const layer::svm_allocation & b) { return a < b.base; });
+      if (it == allocations.begin())
+        return false;
+      --it;
+      if (static_cast<size_t>(p - it->base) >= it->size)
+        return false;
+      allocation = *it;
+      return true;
+    }
+
+  private:
+    static bool base_less(const layer::svm_allocation & a, const char * b)
+    {
+      return a.base < b;
+    }
+
+    mutable std::shared_timed_mutex mutex;
+    std::vector<layer::svm_allocation> allocations;
+  };
+
+  svm_registry svm_allocations;
+
+  cl_context svm_context(cl_command_queue command_queue)
+  {
+    cl_context context = nullptr;
+    tdispatch->clGetCommandQueueInfo(command_queue, CL_QUEUE_CONTEXT, sizeof(context), &context, nullptr);
+    return context;
+  }
+
+  cl_context svm_context(cl_kernel kernel)
+  {
+    cl_context context = nullptr;
+    tdispatch->clGetKernelInfo(kernel, CL_KERNEL_CONTEXT, sizeof(context), &context, nullptr);
+    return context;
+  }
+
+  bool fine_grain_system_svm(cl_command_queue command_queue)
+  {
+    cl_device_id device = nullptr;
+    cl_device_svm_capabilities capabilities = 0;
+    if (tdispatch->clGetCommandQueueInfo(command_queue, CL_QUEUE_DEVICE, sizeof(device), &device, nullptr) != CL_SUCCESS ||
+        tdispatch->clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES, sizeof(capabilities), &capabilities, nullptr) != CL_SUCCESS)
+      return false;
+    return (capabilities & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM) != 0;
+  }
+
+  template<typename T>
+  bool copy_value(const T & src, void * value, size_t size)
+  {
+    if (size != sizeof(T))
+      return false;
+    memcpy(value, &src, sizeof(T));
+    return true;
+  }
+}
+
+namespace layer {
+  bool find_mem_record(cl_mem mem, mem_record & record)
+  {
+    return mem != nullptr && mem_records.find(mem, record);
+  }
+
+  bool query_mem_record(const mem_record & record, cl_uint property, void * value, size_t size)
+  {
+    switch (property) {
+    case CL_MEM_TYPE:
+      return copy_value(record.type, value, size);
+    case CL_MEM_FLAGS:
+      return copy_value(record.flags, value, size);
+    case CL_MEM_SIZE:
+      return copy_value(record.size, value, size);
+    case CL_MEM_HOST_PTR:
+      return copy_value(record.host_ptr, value, size);
+    case CL_MEM_ASSOCIATED_MEMOBJECT:
+      return copy_value(record.parent, value, size);
+    case CL_MEM_OFFSET:
+      return copy_value(record.origin, value, size);
+    case CL_MEM_CONTEXT:
+      return copy_value(record.context, value, size);
+    default:
+      return false;
+    }
+  }
+
+  void post_clCreateBuffer(cl_mem result, cl_context, cl_mem_flags, size_t, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateBufferWithProperties(cl_mem result, cl_context, const cl_mem_properties *, cl_mem_flags, size_t, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateSubBuffer(cl_mem result, cl_mem, cl_mem_flags, cl_buffer_create_type, const void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateImage(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, const cl_image_desc *, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateImageWithProperties(cl_mem result, cl_context, const cl_mem_properties *, cl_mem_flags, const cl_image_format *, const cl_image_desc *, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateImage2D(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, size_t, size_t, size_t, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreateImage3D(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, size_t, size_t, size_t, size_t, size_t, void *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  void post_clCreatePipe(cl_mem result, cl_context, cl_mem_flags, cl_uint, cl_uint, const cl_pipe_properties *, cl_int *)
+  {
+    record_mem(result);
+  }
+
+  bool query_kernel_record(cl_kernel kernel, cl_uint property, void * value, size_t size)
+  {
+    if (property != CL_KERNEL_NUM_ARGS)
+      return false;
+    bool copied = false;
+    find_kernel(kernel, [&](const kernel_state & state) {
+      copied = copy_value(state.num_args, value, size);
+    });
+    return copied;
+  }
+
+  bool kernel_args_not_set(cl_kernel kernel)
+  {
+    bool not_set = false;
+    find_kernel(kernel, [&not_set](const kernel_state & state) {
+      not_set = state.unset.load() != 0;
+    });
+    return not_set;
+  }
+
+  bool kernel_arg_size_mismatch(cl_kernel kernel, cl_uint arg_index, size_t arg_size)
+  {
+    bool mismatch = false;
+    find_kernel(kernel, [&](const kernel_state & state) {
+      if (arg_index >= state.args.size())
+        return;
+      const kernel_arg & arg = state.args[arg_index];
+      if (arg.address == CL_KERNEL_ARG_ADDRESS_LOCAL)
+        mismatch = arg_size == 0;
+      else
+        mismatch = arg.size != 0 && arg.size != arg_size;
+    });
+    return mismatch;
+  }
+
+  void post_clRetainMemObject(cl_int result, cl_mem memobj)
+  {
+    if (result == CL_SUCCESS)
+      mem_records.retain(memobj);
+  }
+
+  // Done before the call: once the driver destroyed the object, another
+  // thread may be handed out the same handle for a new one.
+  void pre_clReleaseMemObject(cl_mem memobj)
+  {
+    mem_records.release(memobj);
+  }
+
+  void post_clCreateKernel(cl_kernel result, cl_program, const char *, cl_int *)
+  {
+    record_kernel(result);
+  }
+
+  void post_clCreateKernelsInProgram(cl_int result, cl_program program, cl_uint, cl_kernel * kernels, cl_uint * num_kernels_ret)
+  {
+    if (result != CL_SUCCESS || kernels == nullptr)
+      return;
+    cl_uint num_kernels = 0;
+    if (num_kernels_ret != nullptr)
+      num_kernels = *num_kernels_ret;
+    else {
+      size_t count = 0;
+      if (get_object_version(program) < CL_MAKE_VERSION(1, 2, 0) ||
+          tdispatch->clGetProgramInfo(program, CL_PROGRAM_NUM_KERNELS, sizeof(count), &count, nullptr) != CL_SUCCESS)
+        return;
+      num_kernels = static_cast<cl_uint>(count);
+    }
+    for (cl_uint i = 0; i < num_kernels; ++i)
+      record_kernel(kernels[i]);
+  }
+
+  // Clones inherit the argument values of their source kernel.
+  void post_clCloneKernel(cl_kernel result, cl_kernel source_kernel, cl_int *)
+  {
+    if (result == nullptr)
+      return;
+    std::shared_ptr<kernel_state> clone;
+    find_kernel(source_kernel, [&clone](const kernel_state & state) {
+      clone = std::make_shared<kernel_state>(state.num_args, state.args);
+      for (cl_uint i = 0; i < (state.num_args + 63) / 64; ++i)
+        clone->set[i] = state.set[i].load();
+      clone->unset = state.unset.load();
+    });
+    if (clone)
+      kernel_states.on_create(result, std::move(clone));
+    else
+      kernel_states.erase(result);
+  }
+
+  void post_clSetKernelArg(cl_int result, cl_kernel kernel, cl_uint arg_index, size_t, const void *)
+  {
+    record_kernel_arg(result, kernel, arg_index);
+  }
+
+  void post_clSetKernelArgSVMPointer(cl_int result, cl_kernel kernel, cl_uint arg_index, const void *)
+  {
+    record_kernel_arg(result, kernel, arg_index);
+  }
+
+  void post_clRetainKernel(cl_int result, cl_kernel kernel)
+  {
+    if (result == CL_SUCCESS)
+      kernel_states.on_retain(kernel);
+  }
+
+  void pre_clReleaseKernel(cl_kernel kernel)
+  {
+    kernel_states.on_release(kernel);
+  }
+
+  bool find_svm_allocation(const void * ptr, svm_allocation & allocation)
+  {
+    return ptr != nullptr && svm_allocations.find(ptr, allocation);
+  }
+
+  bool svm_not_allocated(const void * ptr)
+  {
+    svm_allocation allocation;
+    return ptr != nullptr &&
+      !(svm_allocations.find(ptr, allocation) && allocation.base == ptr);
+  }
+
+  bool any_svm_not_allocated(const void * const * ptrs, cl_uint num_ptrs)
+  {
+    for (cl_uint i = 0; i < num_ptrs; ++i)
+      if (svm_not_allocated(ptrs[i]))
+        return true;
+    return false;
+  }
+
+  bool svm_range_not_allocated(const void * ptr, size_t size)
+  {
+    svm_allocation allocation;
+    if (ptr == nullptr)
+      return false;
+    if (!svm_allocations.find(ptr, allocation))
+      return true;
+    return size > allocation.size - (static_cast<const char *>(ptr) - allocation.base);
+  }
+
+  bool any_svm_range_not_allocated(const void * const * ptrs, const size_t * sizes, cl_uint num_ptrs, cl_command_queue command_queue)
+  {
+    if (sizes == nullptr || fine_grain_system_svm(command_queue))
+      return false;
+    for (cl_uint i = 0; i < num_ptrs; ++i)
+      if (sizes[i] != 0 && svm_range_not_allocated(ptrs[i], sizes[i]))
+        return true;
+    return false;
+  }
+
+  bool svm_range_out_of_bounds(const void * ptr, size_t size)
+  {
+    svm_allocation allocation;
+    if (!find_svm_allocation(ptr, allocation))
+      return false;
+    return size > allocation.size - (static_cast<const char *>(ptr) - allocation.base);
+  }
+
+  bool svm_not_in(const void * ptr, cl_context context)
+  {
+    svm_allocation allocation;
+    return find_svm_allocation(ptr, allocation) && allocation.context != context;
+  }
+
+  bool svm_not_in(const void * ptr, cl_command_queue command_queue)
+  {
+    svm_allocation allocation;
+    return find_svm_allocation(ptr, allocation) && allocation.context != svm_context(command_queue);
+  }
+
+  bool svm_not_in(const void * ptr, cl_kernel kernel)
+  {
+    svm_allocation allocation;
+    return find_svm_allocation(ptr, allocation) && allocation.context != svm_context(kernel);
+  }
+
+  bool any_svm_not_in(const void * const * ptrs, cl_uint num_ptrs, cl_command_queue command_queue)
+  {
+    for (cl_uint i = 0; i < num_ptrs; ++i)
+      if (svm_not_in(ptrs[i], command_queue))
+        return true;
+    return false;
+  }
+
+  void post_clSVMAlloc(void * result, cl_context context, cl_svm_mem_flags, size_t size, cl_uint)
+  {
+    if (result != nullptr)
+      svm_allocations.insert({static_cast<const char *>(result), size, context});
+  }
+
+  // Both are done before the call, see pre_clReleaseMemObject.
+  void pre_clSVMFree(cl_context, void * svm_pointer)
+  {
+    if (svm_pointer != nullptr)
+      svm_allocations.erase(svm_pointer);
+  }
+
+  void pre_clEnqueueSVMFree(cl_command_queue, cl_uint num_svm_pointers, void * svm_pointers[], void (CL_CALLBACK *)(cl_command_queue, cl_uint, void *[], void *), void *, cl_uint, const cl_event *, cl_event *)
+  {
+    for (cl_uint i = 0; svm_pointers != nullptr && i < num_svm_pointers; ++i)
+      if (svm_pointers[i] != nullptr)
+        svm_allocations.erase(svm_pointers[i]);
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <CL/cl.h>
+#include <cstddef>
+
+// Shadow copies of object properties that cannot change after creation.
+//
+// They are recorded once, when the objects are created through the layer, so
+// that validating a call does not have to query the driver again. Objects the
+// layer did not see being created (or that were released by the application)
+// are not shadowed and callers fall back to querying the driver.
+namespace layer {
+  struct mem_record {
+    cl_mem_object_type type;
+    cl_mem_flags flags;
+    size_t size;
+    void * host_ptr;
+    cl_mem parent;
+    size_t origin;
+    cl_context context;
+    cl_version version;
+  };
+
+  // Lock-free, returns false if mem is not shadowed.
+  bool find_mem_record(cl_mem mem, mem_record & record);
+
+  // Copies the shadowed value of a cl_mem_info property to value, returns
+  // false if the property is not shadowed or size does not match.
+  bool query_mem_record(const mem_record & record, cl_uint property, void * value, size_t size);
+
+  // Copies the shadowed value of a cl_kernel_info property to value, returns
+  // false if kernel or the property is not shadowed or size does not match.
+  bool query_kernel_record(cl_kernel kernel, cl_uint property, void * value, size_t size);
+
+  // True if kernel is shadowed and some of its arguments were never given a
+  // value by clSetKernelArg or clSetKernelArgSVMPointer.
+  bool kernel_args_not_set(cl_kernel kernel);
+
+  // True if the declaration of argument arg_index of kernel is known and
+  // arg_size is not a valid size for it. Argument declarations are only
+  // known when the driver reports them through clGetKernelArgInfo.
+  bool kernel_arg_size_mismatch(cl_kernel kernel, cl_uint arg_index, size_t arg_size);
+
+  // Live allocations made by clSVMAlloc, indexed by address.
+  struct svm_allocation {
+    const char * base;
+    size_t size;
+    cl_context context;
+  };
+
+  // Finds the live allocation containing ptr, in O(log n).
+  bool find_svm_allocation(const void * ptr, svm_allocation & allocation);
+
+  // True if ptr is not NULL and is not the start of a live allocation.
+  bool svm_not_allocated(const void * ptr);
+  bool any_svm_not_allocated(const void * const * ptrs, cl_uint num_ptrs);
+
+  // True if ptr is not NULL and [ptr, ptr + size) is not contained within a
+  // live allocation. A size of 0 only requires ptr to be contained.
+  bool svm_range_not_allocated(const void * ptr, size_t size);
+  // Ranges of size 0 stand for the whole allocation and are not checked,
+  // nor are any ranges on devices with fine-grained system SVM, where
+  // every host pointer is an SVM pointer.
+  bool any_svm_range_not_allocated(const void * const * ptrs, const size_t * sizes, cl_uint num_ptrs, cl_command_queue command_queue);
+
+  // True if ptr points into a live allocation and [ptr, ptr + size) runs
+  // past its end. Pointers outside of allocations may be host memory and
+  // are not reported.
+  bool svm_range_out_of_bounds(const void * ptr, size_t size);
+
+  // True if ptr points into a live allocation made from another context.
+  bool svm_not_in(const void * ptr, cl_context context);
+  bool svm_not_in(const void * ptr, cl_command_queue command_queue);
+  bool svm_not_in(const void * ptr, cl_kernel kernel);
+  bool any_svm_not_in(const void * const * ptrs, cl_uint num_ptrs, cl_command_queue command_queue);
+
+  // Pre-dispatch hooks, called by the generated entry points with the
+  // arguments of the call right before forwarding it.
+  void pre_clReleaseMemObject(cl_mem memobj);
+  void pre_clReleaseKernel(cl_kernel kernel);
+  void pre_clSVMFree(cl_context, void * svm_pointer);
+  void pre_clEnqueueSVMFree(cl_command_queue, cl_uint num_svm_pointers, void * svm_pointers[], void (CL_CALLBACK *)(cl_command_queue, cl_uint, void *[], void *), void *, cl_uint, const cl_event *, cl_event *);
+
+  // Post-dispatch hooks, called by the generated entry points with the
+  // result of the call followed by its arguments.
+  void post_clCreateBuffer(cl_mem result, cl_context, cl_mem_flags, size_t, void *, cl_int *);
+  void post_clCreateBufferWithProperties(cl_mem result, cl_context, const cl_mem_properties *, cl_mem_flags, size_t, void *, cl_int *);
+  void post_clCreateSubBuffer(cl_mem result, cl_mem, cl_mem_flags, cl_buffer_create_type, const void *, cl_int *);
+  void post_clCreateImage(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, const cl_image_desc *, void *, cl_int *);
+  void post_clCreateImageWithProperties(cl_mem result, cl_context, const cl_mem_properties *, cl_mem_flags, const cl_image_format *, const cl_image_desc *, void *, cl_int *);
+  void post_clCreateImage2D(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, size_t, size_t, size_t, void *, cl_int *);
+  void post_clCreateImage3D(cl_mem result, cl_context, cl_mem_flags, const cl_image_format *, size_t, size_t, size_t, size_t, size_t, void *, cl_int *);
+  void post_clCreatePipe(cl_mem result, cl_context, cl_mem_flags, cl_uint, cl_uint, const cl_pipe_properties *, cl_int *);
+  void post_clRetainMemObject(cl_int result, cl_mem memobj);
+  void post_clCreateKernel(cl_kernel result, cl_program, const char *, cl_int *);
+  void post_clCreateKernelsInProgram(cl_int result, cl_program, cl_uint, cl_kernel * kernels, cl_uint * num_kernels_ret);
+  void post_clCloneKernel(cl_kernel result, cl_kernel source_kernel, cl_int *);
+  void post_clSetKernelArg(cl_int result, cl_kernel kernel, cl_uint arg_index, size_t, const void *);
+  void post_clSetKernelArgSVMPointer(cl_int result, cl_kernel kernel, cl_uint arg_index, const void *);
+  void post_clRetainKernel(cl_int result, cl_kernel kernel);
+  void post_clSVMAlloc(void * result, cl_context context, cl_svm_mem_flags, size_t size, cl_uint);
+}
@@ -1,6 +1,6 @@
 // auxilary functions
 
-bool is_3D_image_fits(
+inline bool is_3D_image_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -37,7 +37,7 @@ bool is_3D_image_fits(
   return false;
 }
 
-bool is_2D_image_fits(
+inline bool is_2D_image_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -67,7 +67,7 @@ bool is_2D_image_fits(
   return false;
 }
 
-bool is_1D_image_fits(
+inline bool is_1D_image_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -90,7 +90,7 @@ bool is_1D_image_fits(
   return false;
 }
 
-bool is_2D_array_fits(
+inline bool is_2D_array_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -127,7 +127,7 @@ bool is_2D_array_fits(
   return false;
 }
 
-bool is_1D_array_fits(
+inline bool is_1D_array_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -157,7 +157,7 @@ bool is_1D_array_fits(
   return false;
 }
 
-bool is_1D_buffer_fits(
+inline bool is_1D_buffer_fits(
   const cl_image_desc * const image_desc,
   cl_context context)
 {
@@ -180,7 +180,7 @@ bool is_1D_buffer_fits(
   return false;
 }
 
-cl_uint max_pitch_al(cl_context context)
+inline cl_uint max_pitch_al(cl_context context)
 {
   std::vector<cl_device_id> devices = get_devices(context);
   size_t nd = devices.size();
@@ -205,7 +205,7 @@ cl_uint max_pitch_al(cl_context context)
   return res;
 }
 
-cl_uint max_base_al(cl_context context)
+inline cl_uint max_base_al(cl_context context)
 {
   std::vector<cl_device_id> devices = get_devices(context);
   size_t nd = devices.size();
@@ -230,7 +230,7 @@ cl_uint max_base_al(cl_context context)
   return res;
 }
 
-size_t pixel_size(const cl_image_format * image_format)
+inline size_t pixel_size(const cl_image_format * image_format)
 {
   size_t channels = 0;
   switch (image_format->image_channel_order) {
@@ -310,7 +310,7 @@ size_t pixel_size(const cl_image_format * image_format)
   return channels * channel_size;
 }
 
-size_t pixel_size(const cl_mem image)
+inline size_t pixel_size(const cl_mem image)
 {
   cl_image_format format;
   tdispatch->clGetImageInfo(
@@ -325,7 +325,7 @@ size_t pixel_size(const cl_mem image)
 
 // check if the descriptor of image being created is compatible with
 // one of the image from which the current image is being created
-bool is_compatible_image(const cl_image_desc * const image_desc, const cl_image_format * image_format)
+inline bool is_compatible_image(const cl_image_desc * const image_desc, const cl_image_format * image_format)
 {
   cl_image_format format;
   tdispatch->clGetImageInfo(
@@ -447,8 +447,11 @@ bool is_compatible_image(const cl_image_desc * const image_desc, const cl_image_
   return true;
 }
 
-size_t buffer_size(cl_mem buffer)
+inline size_t buffer_size(cl_mem buffer)
 {
+  layer::mem_record record;
+  if (layer::find_mem_record(buffer, record))
+    return record.size;
   size_t size = 0;
   tdispatch->clGetMemObjectInfo(
     buffer,
@@ -469,7 +472,7 @@ size_t buffer_size(cl_mem buffer)
 // 5.2.1
 
 // check validity of structure
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const void * buffer_create_info,
   cl_buffer_create_type buffer_create_type)
@@ -486,7 +489,7 @@ bool struct_violation(
 }
 
 // check if out-of-bounds
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const void * buffer_create_info,
   cl_mem buffer)
@@ -506,7 +509,7 @@ bool struct_violation(
 }
 
 // check if size = 0
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const void * buffer_create_info)
 {
@@ -520,7 +523,7 @@ bool struct_violation(
 // check if there are no devices in context associated with buffer
 // for which the origin field of the cl_buffer_region structure
 // passed in buffer_create_info is aligned to the CL_DEVICE_MEM_BASE_ADDR_ALIGN value
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const void * buffer_create_info,
   cl_buffer_create_type buffer_create_type,
@@ -547,7 +550,7 @@ bool struct_violation(
 // 5.3.1.1. Image Format Descriptor
 
 // check image_format violation
-bool struct_violation(
+inline bool struct_violation(
   cl_version version,
   const cl_image_format * const image_format)
 {
@@ -569,7 +572,7 @@ bool struct_violation(
 }
 
 // check correctness of 2D image creation from buffer
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_format * const image_format,
   cl_context context,
@@ -622,7 +625,7 @@ bool struct_violation(
 }
 
 // check correctness of 2D image creation from 2D image
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_format * const image_format,
   const cl_image_desc * const image_desc)
@@ -640,7 +643,7 @@ bool struct_violation(
 }
 
 // check if there are no devices that support image_format in the context
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_format * const image_format,
   cl_context context,
@@ -675,7 +678,7 @@ bool struct_violation(
 
 // check if there are no devices that support image_format in the context
 // for clCreateImage2D and clCreateImage3D
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_format * const image_format,
   cl_context context,
@@ -709,7 +712,7 @@ bool struct_violation(
 }
 
 // check if 2D image does not fit
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_context context,
   size_t image_width,
@@ -723,7 +726,7 @@ bool struct_violation(
 }
 
 // check if 3D image does not fit
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_context context,
   size_t image_width,
@@ -741,7 +744,7 @@ bool struct_violation(
 // 5.3.1.2. Image Descriptor
 
 // check all besides checked below
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_desc * const image_desc,
   const cl_image_format * image_format, 
@@ -838,7 +841,7 @@ bool struct_violation(
 }
 
 // check image sizes to fit into some device of the context
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_desc * const image_desc, 
   cl_context context)
@@ -868,7 +871,7 @@ bool struct_violation(
 }
 
 // check memory flags
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_desc * const image_desc,
   cl_mem_flags flags)
@@ -914,7 +917,7 @@ bool struct_violation(
 // check size of host_ptr
 // rely on correctness of image_row_pitch and image_slice_pitch
 // sizes from Table 15 of OpenCL 3.0 specification are used
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_image_desc * const image_desc, 
   void * host_ptr,
@@ -998,7 +1001,7 @@ bool struct_violation(
 }
 
 // check impossibility of 2D image creation from a buffer
-bool struct_violation(
+inline bool struct_violation(
   cl_version version,
   const cl_image_format * const,
   const cl_image_desc * const image_desc,
@@ -1024,7 +1027,7 @@ bool struct_violation(
 // 5.3.3
 
 // check if image format for image is not supported by device associated with queue
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_mem image,
   cl_command_queue queue)
@@ -1066,7 +1069,7 @@ bool struct_violation(
 }
 
 // check if two images have the same format
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_mem image1,
   cl_mem image2)
@@ -1087,7 +1090,7 @@ bool struct_violation(
 // 5.3.4
 
 // check the correct size of fill_color for clEnqueueFillImage
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_mem image,
   const void* fill_color)
@@ -1136,7 +1139,7 @@ bool struct_violation(
 }
 
 // check fine-grained SVM for clSetKernelExecInfo
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_kernel kernel,
   cl_kernel_exec_info param_name,
@@ -1159,7 +1162,7 @@ bool struct_violation(
 }
 
 // check total number of workitems in group for clEnqueueNDRangeKernel
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_kernel kernel,
   cl_command_queue command_queue,
@@ -1188,7 +1191,7 @@ bool struct_violation(
 }
 
 // check non-uniform workgroups for clEnqueueNDRangeKernel
-bool struct_violation(
+inline bool struct_violation(
   cl_version version,
   cl_command_queue command_queue,
   cl_kernel kernel,
@@ -1221,7 +1224,7 @@ bool struct_violation(
 }
 
 // check subgroups for clEnqueueNDRangeKernel
-bool struct_violation(
+inline bool struct_violation(
   cl_version version,
   cl_command_queue command_queue,
   cl_kernel kernel,
@@ -1265,7 +1268,7 @@ bool struct_violation(
 }
 
 // check max local_work_size
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_command_queue command_queue,
   cl_uint work_dim,
@@ -1298,7 +1301,7 @@ bool struct_violation(
 }
 
 // check workgroups for clEnqueueTask
-bool struct_violation(
+inline bool struct_violation(
   cl_version version,
   cl_command_queue command_queue,
   cl_kernel kernel)
@@ -1354,7 +1357,7 @@ bool struct_violation(
 
 // check many devices in kernel
 // for clGetKernelWorkGroupInfo and clGetKernelSubGroupInfo
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_kernel kernel,
   cl_device_id device)
@@ -1370,7 +1373,7 @@ bool struct_violation(
 }
 
 // check subgroups non-supported for clGetKernelSubGroupInfo
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   cl_device_id device,
   cl_kernel kernel)
@@ -1386,7 +1389,7 @@ bool struct_violation(
 }
 
 // check memory objects for clEnqueueNativeKernel
-bool struct_violation(
+inline bool struct_violation(
   cl_version,
   const cl_mem * mem_list,
   cl_uint num_mem_objects)
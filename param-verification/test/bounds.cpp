@@ -85,6 +85,29 @@ int main(int argc, char* argv[]) {
                                                 &status);
   EXPECT_SUCCESS(status);
 
+  // Bounds of buffers are checked against the size recorded at creation
+  cl_buffer_region sub_region = { 0, 32 };
+  cl_mem sub_buffer = clCreateSubBuffer(buffer,
+                                        CL_MEM_READ_WRITE,
+                                        CL_BUFFER_CREATE_TYPE_REGION,
+                                        &sub_region,
+                                        &status);
+  EXPECT_SUCCESS(status);
+
+  cl_uint pattern = 0;
+  status = clEnqueueFillBuffer(queue, sub_buffer, &pattern, sizeof(pattern), 16, 32, 0, nullptr, nullptr); // the region being filled specified by (offset, size) is out of bounds
+  EXPECT_ERROR(status, CL_INVALID_VALUE);
+
+  status = clEnqueueFillBuffer(queue, buffer, &pattern, sizeof(pattern), 16, 32, 0, nullptr, nullptr);
+  EXPECT_SUCCESS(status);
+
+  // Still tracked after an additional retain and release
+  EXPECT_SUCCESS(clRetainMemObject(sub_buffer));
+  EXPECT_SUCCESS(clReleaseMemObject(sub_buffer));
+  status = clEnqueueFillBuffer(queue, sub_buffer, &pattern, sizeof(pattern), 0, 64, 0, nullptr, nullptr); // the region being filled specified by (offset, size) is out of bounds
+  EXPECT_ERROR(status, CL_INVALID_VALUE);
+  EXPECT_SUCCESS(clReleaseMemObject(sub_buffer));
+
   auto enqueue_copy = [&](
       std::array<size_t, 3> src_origin,
       std::array<size_t, 3> dst_origin,
@@ -0,0 +1,59 @@
+#include "param_verification_test.hpp"
+
+int main(int argc, char* argv[]) {
+  cl_platform_id platform;
+  cl_device_id device;
+  cl_int status;
+  param_verification_test::setup(argc, argv, CL_MAKE_VERSION(1, 2, 0), platform, device);
+
+  cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, (cl_context_properties) platform, 0};
+  cl_context context = clCreateContext(properties, 1, &device, nullptr, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  // The context family and clGetDeviceInfo are disabled, their calls go
+  // straight to the ICD
+  size_t size;
+  EXPECT_SUCCESS(clGetContextInfo(context,
+                                  123456,
+                                  0,
+                                  nullptr,
+                                  &size));
+  EXPECT_SUCCESS(clGetDeviceInfo(device,
+                                 123456,
+                                 0,
+                                 nullptr,
+                                 &size));
+
+  EXPECT_ERROR(clGetPlatformInfo(platform,
+                                 123456,
+                                 0,
+                                 nullptr,
+                                 &size), CL_INVALID_VALUE); // param_name is not valid
+
+  // clSetKernelArg is disabled too, it is not checked but still keeps track
+  // of the arguments that were set
+  cl_command_queue queue = clCreateCommandQueue(context, device, 0, &status);
+  EXPECT_SUCCESS(status);
+  cl_mem buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 64, nullptr, &status);
+  EXPECT_SUCCESS(status);
+  const char* source = "kernel void test(global float* a, int4 b) {}";
+  cl_program program = clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+  EXPECT_SUCCESS(status);
+  EXPECT_SUCCESS(clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr));
+  cl_kernel kernel = clCreateKernel(program, "test", &status);
+  EXPECT_SUCCESS(status);
+  cl_int4 vector = {{0, 0, 0, 0}};
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(buffer), &buffer));
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 1, sizeof(vector), &vector));
+  (void)clSetKernelArg(kernel, 2, sizeof(vector), &vector); // arg_index is not reported
+  size_t global_work_size = 16;
+  EXPECT_SUCCESS(clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &global_work_size, nullptr, 0, nullptr, nullptr));
+
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseProgram(program));
+  EXPECT_SUCCESS(clReleaseMemObject(buffer));
+  EXPECT_SUCCESS(clReleaseCommandQueue(queue));
+  EXPECT_SUCCESS(clReleaseContext(context));
+
+  return param_verification_test::finalize();
+}
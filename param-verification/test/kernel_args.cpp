@@ -0,0 +1,104 @@
+#include "param_verification_test.hpp"
+
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+  cl_platform_id platform;
+  cl_device_id device;
+  cl_int status;
+  param_verification_test::setup(argc, argv, CL_MAKE_VERSION(2, 1, 0), platform, device);
+
+  cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, (cl_context_properties) platform, 0};
+  cl_context context = clCreateContext(properties, 1, &device, nullptr, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  cl_command_queue queue = clCreateCommandQueue(context,
+                                                device,
+                                                0,
+                                                &status);
+  EXPECT_SUCCESS(status);
+
+  cl_mem buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 64, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  const char* source = "kernel void test(global float* a, int4 b) {}";
+  cl_program program = clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+  EXPECT_SUCCESS(status);
+  EXPECT_SUCCESS(clBuildProgram(program, 1, &device, "-cl-kernel-arg-info", nullptr, nullptr));
+
+  cl_kernel kernel = clCreateKernel(program, "test", &status);
+  EXPECT_SUCCESS(status);
+
+  // CL_INVALID_ARG_SIZE if arg_size does not match the size of the data type
+  cl_int scalar = 0;
+  EXPECT_ERROR(clSetKernelArg(kernel, 1, sizeof(scalar), &scalar), CL_INVALID_ARG_SIZE); // arg_size does not match the size of the data type for the argument
+  EXPECT_ERROR(clSetKernelArg(kernel, 0, sizeof(scalar), &scalar), CL_INVALID_ARG_SIZE); // arg_size does not match the size of the data type for the argument
+
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(buffer), &buffer));
+
+  // CL_INVALID_KERNEL_ARGS if the kernel argument values have not been specified
+  size_t global_work_size = 16;
+  EXPECT_ERROR(clEnqueueNDRangeKernel(queue,
+                                      kernel,
+                                      1,
+                                      nullptr,
+                                      &global_work_size,
+                                      nullptr,
+                                      0,
+                                      nullptr,
+                                      nullptr), CL_INVALID_KERNEL_ARGS); // the kernel argument values have not been specified
+
+  // Clones start with the arguments set on their source kernel
+  cl_kernel clone = clCloneKernel(kernel, &status);
+  EXPECT_SUCCESS(status);
+
+  cl_int4 vector = {{0, 0, 0, 0}};
+  EXPECT_SUCCESS(clSetKernelArg(kernel, 1, sizeof(vector), &vector));
+  EXPECT_SUCCESS(clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &global_work_size, nullptr, 0, nullptr, nullptr));
+
+  EXPECT_ERROR(clEnqueueNDRangeKernel(queue,
+                                      clone,
+                                      1,
+                                      nullptr,
+                                      &global_work_size,
+                                      nullptr,
+                                      0,
+                                      nullptr,
+                                      nullptr), CL_INVALID_KERNEL_ARGS); // the kernel argument values have not been specified
+  EXPECT_SUCCESS(clSetKernelArg(clone, 1, sizeof(vector), &vector));
+  EXPECT_SUCCESS(clEnqueueNDRangeKernel(queue, clone, 1, nullptr, &global_work_size, nullptr, 0, nullptr, nullptr));
+
+  // Kernels get their arguments from several threads at once
+  std::vector<cl_kernel> kernels(4);
+  std::vector<cl_int> results(kernels.size(), CL_SUCCESS);
+  std::vector<std::thread> threads;
+  for (auto& k : kernels) {
+    k = clCreateKernel(program, "test", &status);
+    EXPECT_SUCCESS(status);
+  }
+  for (size_t i = 0; i < kernels.size(); ++i)
+    threads.emplace_back([&, i]() {
+      for (int repeat = 0; repeat < 100 && results[i] == CL_SUCCESS; ++repeat) {
+        results[i] = clSetKernelArg(kernels[i], 0, sizeof(buffer), &buffer);
+        if (results[i] == CL_SUCCESS)
+          results[i] = clSetKernelArg(kernels[i], 1, sizeof(vector), &vector);
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    EXPECT_SUCCESS(results[i]);
+    EXPECT_SUCCESS(clEnqueueNDRangeKernel(queue, kernels[i], 1, nullptr, &global_work_size, nullptr, 0, nullptr, nullptr));
+    EXPECT_SUCCESS(clReleaseKernel(kernels[i]));
+  }
+
+  EXPECT_SUCCESS(clReleaseKernel(clone));
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseProgram(program));
+  EXPECT_SUCCESS(clReleaseMemObject(buffer));
+  EXPECT_SUCCESS(clReleaseCommandQueue(queue));
+  EXPECT_SUCCESS(clReleaseContext(context));
+
+  return param_verification_test::finalize();
+}
@@ -0,0 +1,27 @@
+#include "param_verification_test.hpp"
+
+int main(int argc, char* argv[]) {
+  cl_platform_id platform;
+  cl_device_id device;
+  cl_int status;
+  param_verification_test::setup(argc, argv, CL_MAKE_VERSION(1, 2, 0), platform, device);
+
+  cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, (cl_context_properties) platform, 0};
+  cl_context context = clCreateContext(properties, 1, &device, nullptr, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  // Only the first 10 occurrences of a violation are logged, the rest are
+  // counted and summarized at exit
+  size_t size;
+  for (int i = 0; i < 13; ++i) {
+    EXPECT_ERROR(clGetContextInfo(context,
+                                  123456,
+                                  0,
+                                  nullptr,
+                                  &size), CL_INVALID_VALUE); // param_name is not valid
+  }
+
+  EXPECT_SUCCESS(clReleaseContext(context));
+
+  return param_verification_test::finalize();
+}
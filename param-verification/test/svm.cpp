@@ -0,0 +1,60 @@
+#include "param_verification_test.hpp"
+
+int main(int argc, char* argv[]) {
+  cl_platform_id platform;
+  cl_device_id device;
+  cl_int status;
+  param_verification_test::setup(argc, argv, CL_MAKE_VERSION(2, 0, 0), platform, device);
+
+  cl_context_properties properties[] = {CL_CONTEXT_PLATFORM, (cl_context_properties) platform, 0};
+  cl_context context = clCreateContext(properties, 1, &device, nullptr, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  cl_command_queue queue = clCreateCommandQueueWithProperties(context, device, nullptr, &status);
+  EXPECT_SUCCESS(status);
+
+  const char* source = "kernel void test(global float* a, int4 b) {}";
+  cl_program program = clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+  EXPECT_SUCCESS(status);
+  EXPECT_SUCCESS(clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr));
+
+  cl_kernel kernel = clCreateKernel(program, "test", &status);
+  EXPECT_SUCCESS(status);
+
+  char* svm = static_cast<char*>(clSVMAlloc(context, CL_MEM_READ_WRITE, 64, 0));
+
+  // Ranges are checked against the size of the allocation they point into
+  cl_int pattern = 0;
+  EXPECT_ERROR(clEnqueueSVMMemFill(queue,
+                                   svm + 32,
+                                   &pattern,
+                                   sizeof(pattern),
+                                   64,
+                                   0,
+                                   nullptr,
+                                   nullptr), CL_INVALID_VALUE); // the region specified by svm_ptr and size is out of bounds of an SVM allocation
+  EXPECT_SUCCESS(clEnqueueSVMMemFill(queue, svm + 32, &pattern, sizeof(pattern), 32, 0, nullptr, nullptr));
+
+  // A size of 0 migrates the whole allocation
+  const void* migrated[] = {svm + 32, svm};
+  size_t sizes[] = {64, 0};
+  EXPECT_ERROR(clEnqueueSVMMigrateMem(queue, 1, migrated, sizes, 0, 0, nullptr, nullptr), CL_INVALID_VALUE); // the range [svm_pointers[i], svm_pointers[i]+sizes[i]) is not contained within an existing clSVMAlloc allocation
+  EXPECT_SUCCESS(clEnqueueSVMMigrateMem(queue, 1, migrated + 1, sizes + 1, 0, 0, nullptr, nullptr));
+
+  EXPECT_SUCCESS(clSetKernelArgSVMPointer(kernel, 0, svm + 16));
+
+  // Interior pointers can not be freed
+  clSVMFree(context, svm + 16); // svm_pointer is not a pointer returned by clSVMAlloc or was already freed
+  clSVMFree(context, svm);
+
+  // Freed allocations can not be used anymore
+  EXPECT_ERROR(clSetKernelArgSVMPointer(kernel, 0, svm), CL_INVALID_ARG_VALUE); // arg_value does not point into a live SVM allocation
+  clSVMFree(context, svm); // svm_pointer is not a pointer returned by clSVMAlloc or was already freed
+
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseProgram(program));
+  EXPECT_SUCCESS(clReleaseCommandQueue(queue));
+  EXPECT_SUCCESS(clReleaseContext(context));
+
+  return param_verification_test::finalize();
+}
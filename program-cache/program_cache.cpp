@@ -0,0 +1,983 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Keeps the binaries of built programs on disk and reuses them in later
+// runs. Building a program created from source or IL looks its binaries up
+// by a hash of the source or IL, the build options, the specialization
+// constants and the name and versions of each device, its driver and its
+// platform. When every device has one, a program is created from the
+// binaries with clCreateProgramWithBinary and built in place of the
+// original, which forwards the queries about its build and the creation of
+// kernels to it. Otherwise the original is built and its binaries stored.
+// Builds that may read headers from the file system, with an #include in
+// their source or -I in their options, are not cached, the key does not
+// cover the headers.
+//
+// Programs linked from objects compiled through the layer are cached the
+// same way, by the hashes of the compilations and the link options.
+//
+// With speculative_build enabled, programs start building on a pool of
+// worker threads as soon as they are created, with the options their
+// source or IL was last built with, remembered next to the binaries, or
+// without options. These build programs of the layer, created from the
+// same source or IL, which the application does not see until it builds
+// its own: clBuildProgram with the same options waits for that build and
+// substitutes its program as for a cache hit, other options build the
+// program again. Builds still queued at exit are cancelled.
+
+#include "handle_registry.hpp"
+#include "layer_support.hpp"
+#include "program_cache_store.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ocl_layer_utils::handle_registry;
+using program_cache::cache_key;
+using program_cache::key_builder;
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  std::string directory = program_cache::store::default_directory();
+  // In MiB.
+  unsigned max_size = 256;
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::none, "cl_program_cache.log"};
+  bool speculative_build = false;
+  unsigned build_threads = 2;
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("program_cache", settings_from_file);
+
+  auto settings = layer_settings{};
+  parser.get_filename("directory", settings.directory);
+  if (settings.directory.empty())
+    settings.directory = program_cache::store::default_directory();
+  parser.get_unsigned("max_size", settings.max_size);
+  settings.report.load(parser);
+  parser.get_bool("speculative_build", settings.speculative_build);
+  parser.get_unsigned("build_threads", settings.build_threads);
+  return settings;
+}
+
+layer_settings settings;
+
+// A build started when the program was created.
+struct speculation {
+  // What build_inputs() returned for the options it was started with.
+  std::string inputs;
+  // The program built, null if the build failed or was cancelled.
+  std::shared_future<cl_program> result;
+  // Whether result was built from the cached binaries, set before result.
+  bool hit = false;
+  std::atomic<bool> cancelled{false};
+};
+
+// Programs created from source or IL.
+struct program_info {
+  enum class origin { source, il };
+
+  origin kind;
+  std::string code;
+  cl_context context;
+  std::map<cl_uint, std::string> spec_constants;
+  // Built from the cached binaries in place of this program.
+  cl_program substitute = nullptr;
+  // Hash of the last compilation of the program, empty if it was not
+  // compiled through the layer.
+  std::string compile_digest;
+  std::shared_ptr<speculation> speculative;
+};
+
+// Threads running speculative builds, never joined.
+class worker_pool {
+public:
+  void start(unsigned threads) {
+    for (unsigned i = 0; i < threads; ++i)
+      std::thread(&worker_pool::run, this).detach();
+  }
+
+  void submit(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(std::move(job));
+    wake_.notify_one();
+  }
+
+  // Has the jobs still queued skip their work, and waits for those
+  // running, which may still call the implementation.
+  void cancel() {
+    cancelled_ = true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return jobs_.empty() && busy_ == 0; });
+  }
+  bool cancelled() const { return cancelled_; }
+
+private:
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock, [this] { return !jobs_.empty(); });
+      std::function<void()> job = std::move(jobs_.front());
+      jobs_.pop_front();
+      ++busy_;
+      lock.unlock();
+      job();
+      lock.lock();
+      if (--busy_ == 0 && jobs_.empty())
+        idle_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_, idle_;
+  std::deque<std::function<void()>> jobs_;
+  unsigned busy_ = 0;
+  std::atomic<bool> cancelled_{false};
+};
+
+class cache_state {
+public:
+  void open(const layer_settings &current) {
+    store_.reset(new program_cache::store(
+        current.directory, static_cast<uint64_t>(current.max_size) * 1024 * 1024));
+    if (current.directory.empty())
+      std::cerr << "program_cache found no cache directory, set program_cache.directory. "
+                << "Programs are built from source." << std::endl;
+    else if (!store_->is_open())
+      std::cerr << "program_cache failed to open the cache directory: " << current.directory
+                << ". Programs are built from source." << std::endl;
+  }
+
+  program_cache::store &store() { return *store_; }
+
+  void set_output(std::ostream *output) { output_ = output; }
+
+  // Name and versions of the device, its driver and its platform, fields
+  // that cannot be queried are left empty.
+  std::string identity(cl_device_id device);
+
+  // The options code was last built with, empty if it never was.
+  std::string last_options(const std::string &code_digest);
+  void remember_options(const std::string &code_digest, const std::string &options);
+
+  void report();
+
+  handle_registry<program_info> programs;
+  // Substitutes, with the program they stand in for.
+  handle_registry<cl_program> originals;
+
+  std::atomic<uint64_t> lookups{0}, hits{0}, stored{0}, bypassed{0};
+  std::atomic<uint64_t> speculated{0}, reused{0}, discarded{0};
+  worker_pool workers;
+
+private:
+  std::unique_ptr<program_cache::store> store_;
+  std::mutex mutex_;
+  std::map<cl_device_id, std::string> identities_;
+  std::map<std::string, std::string> options_;
+  std::ostream *output_ = nullptr;
+};
+
+cache_state &state() {
+  return ocl_layer_utils::never_destroyed<cache_state>();
+}
+
+template <typename Query, typename Object, typename Param>
+std::string query_string(Query query, Object object, Param param_name) {
+  size_t size = 0;
+  if (query(object, param_name, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+    return std::string();
+  std::vector<char> value(size);
+  if (query(object, param_name, size, value.data(), nullptr) != CL_SUCCESS)
+    return std::string();
+  return std::string(value.data(), value.size() - 1);
+}
+
+std::string cache_state::identity(cl_device_id device) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = identities_.find(device);
+  if (it != identities_.end())
+    return it->second;
+
+  key_builder fields;
+  for (cl_device_info param : {CL_DEVICE_NAME, CL_DEVICE_VENDOR, CL_DEVICE_VERSION,
+                               CL_DRIVER_VERSION})
+    fields.add(query_string(tdispatch->clGetDeviceInfo, device, param));
+  cl_platform_id platform = nullptr;
+  tdispatch->clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, nullptr);
+  for (cl_platform_info param : {CL_PLATFORM_NAME, CL_PLATFORM_VERSION})
+    fields.add(platform ? query_string(tdispatch->clGetPlatformInfo, platform, param)
+                        : std::string());
+  return identities_[device] = fields.finish().hex();
+}
+
+cache_key options_key(const std::string &code_digest) {
+  return key_builder().add("options").add(code_digest).finish();
+}
+
+std::string cache_state::last_options(const std::string &code_digest) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = options_.find(code_digest);
+    if (it != options_.end())
+      return it->second;
+  }
+  std::string options;
+  store_->load(options_key(code_digest), options, false);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return options_.emplace(code_digest, options).first->second;
+}
+
+void cache_state::remember_options(const std::string &code_digest, const std::string &options) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string &last = options_[code_digest];
+    if (last == options)
+      return;
+    last = options;
+  }
+  store_->save(options_key(code_digest), options);
+}
+
+void cache_state::report() {
+  if (!output_)
+    return;
+  const uint64_t total = lookups, found = hits;
+  const program_cache::store::statistics shared = store_->stats();
+  std::ostream &out = *output_;
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << "program_cache report\n"
+      << "lookups: " << total << '\n'
+      << "hits: " << found << " (" << std::fixed << std::setprecision(1)
+      << (total ? 100.0 * static_cast<double>(found) / static_cast<double>(total) : 0.0)
+      << "%)\n"
+      << "misses: " << total - found << '\n'
+      << "stored: " << stored << '\n'
+      << "bypassed: " << bypassed << '\n'
+      << "cache: " << shared.entries << " entries, " << shared.bytes << " bytes, "
+      << shared.hits << " hits and " << shared.misses << " misses over all processes\n";
+  if (settings.speculative_build)
+    out << "speculative builds: " << speculated << " started, " << reused << " reused, "
+        << discarded << " discarded\n";
+  out.flush();
+  out.flags(flags);
+  out.precision(precision);
+}
+
+// What a cached binary stands in for, the compilation or build inputs.
+std::vector<cache_key> keys_for(const std::string &inputs,
+                                const std::vector<cl_device_id> &devices) {
+  std::vector<cache_key> keys;
+  for (cl_device_id device : devices)
+    keys.push_back(key_builder().add(inputs).add(state().identity(device)).finish());
+  return keys;
+}
+
+std::string code_digest(const program_info &info) {
+  return key_builder()
+      .add(info.kind == program_info::origin::source ? "source" : "il")
+      .add(info.code)
+      .finish()
+      .hex();
+}
+
+std::string build_inputs(const program_info &info, const char *options) {
+  key_builder inputs;
+  inputs.add(info.kind == program_info::origin::source ? "build source" : "build il")
+      .add(info.code)
+      .add(options ? options : "");
+  for (const auto &constant : info.spec_constants)
+    inputs.add(&constant.first, sizeof(constant.first)).add(constant.second);
+  return inputs.finish().hex();
+}
+
+// Whether building code with options may read headers from the file
+// system, which the cache key does not cover.
+bool reads_headers(const program_info &info, const char *options) {
+  if (options && std::strstr(options, "-I") != nullptr)
+    return true;
+  if (info.kind != program_info::origin::source)
+    return false;
+  for (size_t hash = info.code.find('#'); hash != std::string::npos;
+       hash = info.code.find('#', hash + 1)) {
+    const size_t directive = info.code.find_first_not_of(" \t", hash + 1);
+    if (directive != std::string::npos && info.code.compare(directive, 7, "include") == 0)
+      return true;
+  }
+  return false;
+}
+
+std::vector<cl_device_id> program_devices(cl_program program) {
+  cl_uint count = 0;
+  if (tdispatch->clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(count), &count,
+                                  nullptr) != CL_SUCCESS)
+    return {};
+  std::vector<cl_device_id> devices(count);
+  if (tdispatch->clGetProgramInfo(program, CL_PROGRAM_DEVICES, count * sizeof(cl_device_id),
+                                  devices.data(), nullptr) != CL_SUCCESS)
+    return {};
+  return devices;
+}
+
+std::vector<cl_device_id> context_devices(cl_context context) {
+  size_t size = 0;
+  if (tdispatch->clGetContextInfo(context, CL_CONTEXT_DEVICES, 0, nullptr, &size) != CL_SUCCESS)
+    return {};
+  std::vector<cl_device_id> devices(size / sizeof(cl_device_id));
+  if (tdispatch->clGetContextInfo(context, CL_CONTEXT_DEVICES, size, devices.data(), nullptr) !=
+      CL_SUCCESS)
+    return {};
+  return devices;
+}
+
+// Loads the binaries of all devices and builds a program from them, null
+// unless every device had one. Speculative builds pass counted false, they
+// are counted once the application uses them.
+cl_program load_program(cl_context context, const std::vector<cl_device_id> &devices,
+                        const std::vector<cache_key> &keys, const char *options,
+                        bool counted = true) {
+  if (counted)
+    ++state().lookups;
+  std::vector<std::string> binaries(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i)
+    if (!state().store().load(keys[i], binaries[i], counted))
+      return nullptr;
+
+  std::vector<size_t> lengths;
+  std::vector<const unsigned char *> pointers;
+  for (const std::string &binary : binaries) {
+    lengths.push_back(binary.size());
+    pointers.push_back(reinterpret_cast<const unsigned char *>(binary.data()));
+  }
+  std::vector<cl_int> status(devices.size());
+  cl_int error = CL_SUCCESS;
+  cl_program program = tdispatch->clCreateProgramWithBinary(
+      context, static_cast<cl_uint>(devices.size()), devices.data(), lengths.data(),
+      pointers.data(), status.data(), &error);
+  if (error != CL_SUCCESS)
+    return nullptr;
+  if (std::any_of(status.begin(), status.end(), [](cl_int s) { return s != CL_SUCCESS; }) ||
+      tdispatch->clBuildProgram(program, static_cast<cl_uint>(devices.size()), devices.data(),
+                                options, nullptr, nullptr) != CL_SUCCESS) {
+    tdispatch->clReleaseProgram(program);
+    return nullptr;
+  }
+  if (counted)
+    ++state().hits;
+  return program;
+}
+
+// Stores the binaries of the devices the program was built for
+// successfully.
+void store_program(cl_program program, const std::vector<cl_device_id> &devices,
+                   const std::vector<cache_key> &keys) {
+  const std::vector<cl_device_id> built_for = program_devices(program);
+  std::vector<size_t> sizes(built_for.size());
+  if (built_for.empty() ||
+      tdispatch->clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizes.size() * sizeof(size_t),
+                                  sizes.data(), nullptr) != CL_SUCCESS)
+    return;
+  std::vector<std::string> binaries(built_for.size());
+  std::vector<unsigned char *> pointers;
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    binaries[i].resize(sizes[i]);
+    pointers.push_back(sizes[i] ? reinterpret_cast<unsigned char *>(&binaries[i][0]) : nullptr);
+  }
+  if (tdispatch->clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                                  pointers.size() * sizeof(unsigned char *), pointers.data(),
+                                  nullptr) != CL_SUCCESS)
+    return;
+
+  for (size_t i = 0; i < devices.size(); ++i) {
+    cl_build_status status = CL_BUILD_NONE;
+    const auto it = std::find(built_for.begin(), built_for.end(), devices[i]);
+    if (it == built_for.end() ||
+        tdispatch->clGetProgramBuildInfo(program, devices[i], CL_PROGRAM_BUILD_STATUS,
+                                         sizeof(status), &status, nullptr) != CL_SUCCESS ||
+        status != CL_BUILD_SUCCESS)
+      continue;
+    const std::string &binary = binaries[it - built_for.begin()];
+    if (!binary.empty() && state().store().save(keys[i], binary))
+      ++state().stored;
+  }
+}
+
+// Stores the binaries once a build or link notifies the application that
+// it completed.
+struct pending_build {
+  void(CL_CALLBACK *pfn_notify)(cl_program, void *);
+  void *user_data;
+  std::vector<cl_device_id> devices;
+  std::vector<cache_key> keys;
+};
+
+void CL_CALLBACK on_build_complete(cl_program program, void *user_data) {
+  std::unique_ptr<pending_build> pending(static_cast<pending_build *>(user_data));
+  store_program(program, pending->devices, pending->keys);
+  pending->pfn_notify(program, pending->user_data);
+}
+
+// Takes the speculative build of program, if it has one, the build is no
+// longer available to clBuildProgram.
+std::shared_ptr<speculation> take_speculation(cl_program program) {
+  std::shared_ptr<speculation> speculative;
+  state().programs.update(program,
+                          [&](program_info &info) { speculative.swap(info.speculative); });
+  return speculative;
+}
+
+// Cancels a speculative build no one will use, the workers release its
+// program once it is built.
+void discard(const std::shared_ptr<speculation> &speculative) {
+  speculative->cancelled = true;
+  state().workers.submit([speculative] {
+    if (cl_program built = speculative->result.get())
+      tdispatch->clReleaseProgram(built);
+  });
+}
+
+// The program the queries and kernels of program are forwarded to.
+cl_program target_of(cl_program program) {
+  cl_program target = program;
+  state().programs.find(program, [&target](const handle_registry<program_info>::entry &entry) {
+    if (entry.payload.substitute)
+      target = entry.payload.substitute;
+  });
+  return target;
+}
+
+void set_substitute(cl_program program, cl_program substitute) {
+  cl_program previous = nullptr;
+  // Speculative builds may complete after the program was released.
+  if (!state().programs.update(program, [&](program_info &info) {
+        previous = info.substitute;
+        info.substitute = substitute;
+      })) {
+    if (substitute)
+      tdispatch->clReleaseProgram(substitute);
+    return;
+  }
+  if (previous) {
+    state().originals.erase(previous);
+    tdispatch->clReleaseProgram(previous);
+  }
+  if (substitute)
+    state().originals.on_create(substitute, program);
+}
+
+cl_program register_program(cl_program program, program_info::origin kind, std::string code,
+                            cl_context context) {
+  if (program) {
+    program_info info;
+    info.kind = kind;
+    info.code = std::move(code);
+    info.context = context;
+    state().programs.on_create(program, std::move(info));
+  }
+  return program;
+}
+
+// Builds a program created from source or IL from the cached binaries, or
+// builds it and stores its binaries.
+cl_int build_tracked(cl_program program, cl_context context, const std::string &inputs,
+                     const std::vector<cl_device_id> &devices, cl_uint num_devices,
+                     const cl_device_id *device_list, const char *options,
+                     void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+                     void *user_data) {
+  if (!state().store().is_open())
+    return tdispatch->clBuildProgram(program, num_devices, device_list, options, pfn_notify,
+                                     user_data);
+
+  const std::vector<cache_key> keys = keys_for(inputs, devices);
+  if (cl_program substitute = load_program(context, devices, keys, options)) {
+    set_substitute(program, substitute);
+    if (pfn_notify)
+      pfn_notify(program, user_data);
+    return CL_SUCCESS;
+  }
+
+  // A rebuild that misses replaces what an earlier hit built.
+  set_substitute(program, nullptr);
+  if (!pfn_notify) {
+    const cl_int result =
+        tdispatch->clBuildProgram(program, num_devices, device_list, options, nullptr, nullptr);
+    if (result == CL_SUCCESS)
+      store_program(program, devices, keys);
+    return result;
+  }
+  // The callback only runs for builds that were started.
+  std::unique_ptr<pending_build> pending(new pending_build{pfn_notify, user_data, devices, keys});
+  const cl_int result = tdispatch->clBuildProgram(program, num_devices, device_list, options,
+                                                  on_build_complete, pending.get());
+  if (result == CL_SUCCESS)
+    pending.release();
+  return result;
+}
+
+// Builds a program of the layer from the code of info, from the cached
+// binaries if there are any. Null if the build failed. Nothing is counted
+// or stored until the application uses the program.
+cl_program build_private(speculation &speculative, const program_info &info,
+                         const std::vector<cl_device_id> &devices, const std::string &options) {
+  if (state().store().is_open()) {
+    const std::vector<cache_key> keys = keys_for(speculative.inputs, devices);
+    if (cl_program loaded = load_program(info.context, devices, keys, options.c_str(), false)) {
+      speculative.hit = true;
+      return loaded;
+    }
+  }
+
+  cl_int error = CL_SUCCESS;
+  cl_program built = nullptr;
+  if (info.kind == program_info::origin::source) {
+    const char *code = info.code.data();
+    const size_t length = info.code.size();
+    built = tdispatch->clCreateProgramWithSource(info.context, 1, &code, &length, &error);
+  } else {
+    built = tdispatch->clCreateProgramWithIL(info.context, info.code.data(), info.code.size(),
+                                             &error);
+  }
+  if (!built)
+    return nullptr;
+  if (tdispatch->clBuildProgram(built, static_cast<cl_uint>(devices.size()), devices.data(),
+                                options.c_str(), nullptr, nullptr) != CL_SUCCESS) {
+    tdispatch->clReleaseProgram(built);
+    return nullptr;
+  }
+  return built;
+}
+
+// Starts building the code of program on the workers for all its devices.
+// The workers hold a reference to the context until the build completes.
+cl_program speculate(cl_program program) {
+  if (!program || !settings.speculative_build)
+    return program;
+  program_info info;
+  state().programs.find(program, [&info](const handle_registry<program_info>::entry &entry) {
+    info = entry.payload;
+  });
+  const std::string options = state().last_options(code_digest(info));
+  if (reads_headers(info, options.c_str()))
+    return program;
+  const std::string inputs = build_inputs(info, options.c_str());
+  const std::vector<cl_device_id> devices = program_devices(program);
+  if (devices.empty())
+    return program;
+
+  auto speculative = std::make_shared<speculation>();
+  speculative->inputs = inputs;
+  tdispatch->clRetainContext(info.context);
+  auto build = std::make_shared<std::packaged_task<cl_program()>>([=] {
+    cl_program built = nullptr;
+    if (!speculative->cancelled && !state().workers.cancelled())
+      built = build_private(*speculative, info, devices, options);
+    tdispatch->clReleaseContext(info.context);
+    return built;
+  });
+  speculative->result = build->get_future().share();
+  state().programs.update(program, [&](program_info &entry) { entry.speculative = speculative; });
+  ++state().speculated;
+  state().workers.submit([build] { (*build)(); });
+  return program;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource_wrap(
+    cl_context context,
+    cl_uint count,
+    const char **strings,
+    const size_t *lengths,
+    cl_int *errcode_ret) {
+  cl_program program =
+      tdispatch->clCreateProgramWithSource(context, count, strings, lengths, errcode_ret);
+  std::string source;
+  for (cl_uint i = 0; program && i < count; ++i)
+    if (lengths && lengths[i])
+      source.append(strings[i], lengths[i]);
+    else
+      source.append(strings[i]);
+  return speculate(
+      register_program(program, program_info::origin::source, std::move(source), context));
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithIL_wrap(
+    cl_context context,
+    const void *il,
+    size_t length,
+    cl_int *errcode_ret) {
+  cl_program program = tdispatch->clCreateProgramWithIL(context, il, length, errcode_ret);
+  return speculate(register_program(program, program_info::origin::il,
+                                    program ? std::string(static_cast<const char *>(il), length)
+                                            : std::string(),
+                                    context));
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainProgram_wrap(
+    cl_program program) {
+  const cl_int result = tdispatch->clRetainProgram(program);
+  if (result == CL_SUCCESS)
+    state().programs.on_retain(program);
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram_wrap(
+    cl_program program) {
+  handle_registry<program_info>::entry released = {};
+  state().programs.on_release(program, &released);
+  if (released.payload.speculative)
+    discard(released.payload.speculative);
+  if (released.payload.substitute) {
+    state().originals.erase(released.payload.substitute);
+    tdispatch->clReleaseProgram(released.payload.substitute);
+  }
+  return tdispatch->clReleaseProgram(program);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetProgramSpecializationConstant_wrap(
+    cl_program program,
+    cl_uint spec_id,
+    size_t spec_size,
+    const void *spec_value) {
+  const cl_int result =
+      tdispatch->clSetProgramSpecializationConstant(program, spec_id, spec_size, spec_value);
+  if (result == CL_SUCCESS)
+    state().programs.update(program, [&](program_info &info) {
+      info.spec_constants[spec_id].assign(static_cast<const char *>(spec_value), spec_size);
+    });
+  return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  const std::shared_ptr<speculation> speculative = take_speculation(program);
+  bool tracked = false, uncached = false;
+  std::string inputs, digest;
+  cl_context context = nullptr;
+  state().programs.find(program, [&](const handle_registry<program_info>::entry &entry) {
+    tracked = true;
+    uncached = reads_headers(entry.payload, options);
+    inputs = build_inputs(entry.payload, options);
+    digest = code_digest(entry.payload);
+    context = entry.payload.context;
+  });
+  const std::vector<cl_device_id> devices =
+      device_list ? std::vector<cl_device_id>(device_list, device_list + num_devices)
+                  : program_devices(program);
+  if (!tracked || devices.empty())
+    return tdispatch->clBuildProgram(program, num_devices, device_list, options, pfn_notify,
+                                     user_data);
+  if (uncached) {
+    ++state().bypassed;
+    if (speculative) {
+      discard(speculative);
+      ++state().discarded;
+    }
+    set_substitute(program, nullptr);
+    return tdispatch->clBuildProgram(program, num_devices, device_list, options, pfn_notify,
+                                     user_data);
+  }
+
+  if (settings.speculative_build)
+    state().remember_options(digest, options ? options : "");
+  if (speculative) {
+    cl_program built = nullptr;
+    if (speculative->inputs == inputs && (!device_list || devices == program_devices(program)))
+      built = speculative->result.get();
+    else
+      discard(speculative);
+    if (built) {
+      ++state().reused;
+      if (state().store().is_open()) {
+        ++state().lookups;
+        state().store().count(speculative->hit);
+        if (speculative->hit)
+          ++state().hits;
+        else
+          store_program(built, devices, keys_for(inputs, devices));
+      }
+      set_substitute(program, built);
+      if (pfn_notify)
+        pfn_notify(program, user_data);
+      return CL_SUCCESS;
+    }
+    // Failed builds are built again, for the application to get the log.
+    ++state().discarded;
+  }
+  return build_tracked(program, context, inputs, devices, num_devices, device_list, options,
+                       pfn_notify, user_data);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
+    cl_program program,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_headers,
+    const cl_program *input_headers,
+    const char **header_include_names,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data) {
+  if (const std::shared_ptr<speculation> speculative = take_speculation(program)) {
+    discard(speculative);
+    ++state().discarded;
+  }
+  const cl_int result = tdispatch->clCompileProgram(
+      program, num_devices, device_list, options, num_input_headers, input_headers,
+      header_include_names, pfn_notify, user_data);
+  if (result != CL_SUCCESS)
+    return result;
+
+  key_builder digest;
+  bool complete = true;
+  digest.add("compile");
+  for (cl_uint i = 0; i < num_input_headers; ++i) {
+    bool found = state().programs.find(
+        input_headers[i], [&](const handle_registry<program_info>::entry &entry) {
+          digest.add(header_include_names[i]).add(entry.payload.code);
+        });
+    complete = complete && found;
+  }
+  state().programs.update(program, [&](program_info &info) {
+    // Headers passed in are part of the digest, the others would be read
+    // from the file system.
+    if ((options && std::strstr(options, "-I") != nullptr) ||
+        (num_input_headers == 0 && reads_headers(info, nullptr)))
+      complete = false;
+    digest.add(info.code).add(options ? options : "");
+    for (const auto &constant : info.spec_constants)
+      digest.add(&constant.first, sizeof(constant.first)).add(constant.second);
+    info.compile_digest = complete ? digest.finish().hex() : std::string();
+  });
+  set_substitute(program, nullptr);
+  return result;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
+    cl_context context,
+    cl_uint num_devices,
+    const cl_device_id *device_list,
+    const char *options,
+    cl_uint num_input_programs,
+    const cl_program *input_programs,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data,
+    cl_int *errcode_ret) {
+  // Libraries are linked again into programs, only those are cached.
+  const std::string link_options = options ? options : "";
+  bool cacheable = state().store().is_open() && input_programs &&
+                   link_options.find("-create-library") == std::string::npos &&
+                   link_options.find("-enable-link-options") == std::string::npos;
+  key_builder inputs;
+  inputs.add("link").add(link_options);
+  for (cl_uint i = 0; cacheable && i < num_input_programs; ++i) {
+    std::string digest;
+    state().programs.find(input_programs[i],
+                          [&digest](const handle_registry<program_info>::entry &entry) {
+                            digest = entry.payload.compile_digest;
+                          });
+    cacheable = !digest.empty();
+    inputs.add(digest);
+  }
+  const std::vector<cl_device_id> devices =
+      device_list ? std::vector<cl_device_id>(device_list, device_list + num_devices)
+                  : context_devices(context);
+  if (!cacheable || devices.empty())
+    return tdispatch->clLinkProgram(context, num_devices, device_list, options,
+                                    num_input_programs, input_programs, pfn_notify, user_data,
+                                    errcode_ret);
+
+  const std::vector<cache_key> keys = keys_for(inputs.finish().hex(), devices);
+  if (cl_program linked = load_program(context, devices, keys, options)) {
+    if (errcode_ret)
+      *errcode_ret = CL_SUCCESS;
+    if (pfn_notify)
+      pfn_notify(linked, user_data);
+    return linked;
+  }
+
+  if (!pfn_notify) {
+    cl_int error = CL_SUCCESS;
+    cl_program linked =
+        tdispatch->clLinkProgram(context, num_devices, device_list, options, num_input_programs,
+                                 input_programs, nullptr, nullptr, &error);
+    if (linked && error == CL_SUCCESS)
+      store_program(linked, devices, keys);
+    if (errcode_ret)
+      *errcode_ret = error;
+    return linked;
+  }
+  std::unique_ptr<pending_build> pending(new pending_build{pfn_notify, user_data, devices, keys});
+  cl_program linked =
+      tdispatch->clLinkProgram(context, num_devices, device_list, options, num_input_programs,
+                               input_programs, on_build_complete, pending.get(), errcode_ret);
+  if (linked)
+    pending.release();
+  return linked;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo_wrap(
+    cl_program program,
+    cl_program_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  // What the application created stays its own, what was built is the
+  // substitute's.
+  switch (param_name) {
+  case CL_PROGRAM_REFERENCE_COUNT:
+  case CL_PROGRAM_CONTEXT:
+  case CL_PROGRAM_NUM_DEVICES:
+  case CL_PROGRAM_DEVICES:
+  case CL_PROGRAM_SOURCE:
+  case CL_PROGRAM_IL:
+    break;
+  default:
+    program = target_of(program);
+  }
+  return tdispatch->clGetProgramInfo(program, param_name, param_value_size, param_value,
+                                     param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo_wrap(
+    cl_program program,
+    cl_device_id device,
+    cl_program_build_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  return tdispatch->clGetProgramBuildInfo(target_of(program), device, param_name,
+                                          param_value_size, param_value, param_value_size_ret);
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel_wrap(
+    cl_program program,
+    const char *kernel_name,
+    cl_int *errcode_ret) {
+  return tdispatch->clCreateKernel(target_of(program), kernel_name, errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram_wrap(
+    cl_program program,
+    cl_uint num_kernels,
+    cl_kernel *kernels,
+    cl_uint *num_kernels_ret) {
+  return tdispatch->clCreateKernelsInProgram(target_of(program), num_kernels, kernels,
+                                             num_kernels_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo_wrap(
+    cl_kernel kernel,
+    cl_kernel_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  const cl_int result = tdispatch->clGetKernelInfo(kernel, param_name, param_value_size,
+                                                   param_value, param_value_size_ret);
+  if (result == CL_SUCCESS && param_name == CL_KERNEL_PROGRAM && param_value)
+    state().originals.find(*static_cast<cl_program *>(param_value),
+                           [param_value](const handle_registry<cl_program>::entry &entry) {
+                             *static_cast<cl_program *>(param_value) = entry.payload;
+                           });
+  return result;
+}
+
+void init_dispatch() {
+  dispatch.clCreateProgramWithSource = &clCreateProgramWithSource_wrap;
+  dispatch.clCreateProgramWithIL = &clCreateProgramWithIL_wrap;
+  dispatch.clRetainProgram = &clRetainProgram_wrap;
+  dispatch.clReleaseProgram = &clReleaseProgram_wrap;
+  dispatch.clSetProgramSpecializationConstant = &clSetProgramSpecializationConstant_wrap;
+  dispatch.clBuildProgram = &clBuildProgram_wrap;
+  dispatch.clCompileProgram = &clCompileProgram_wrap;
+  dispatch.clLinkProgram = &clLinkProgram_wrap;
+  dispatch.clGetProgramInfo = &clGetProgramInfo_wrap;
+  dispatch.clGetProgramBuildInfo = &clGetProgramBuildInfo_wrap;
+  dispatch.clCreateKernel = &clCreateKernel_wrap;
+  dispatch.clCreateKernelsInProgram = &clCreateKernelsInProgram_wrap;
+  dispatch.clGetKernelInfo = &clGetKernelInfo_wrap;
+}
+
+void report_at_exit() {
+  state().workers.cancel();
+  state().report();
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().open(settings);
+        state().set_output(settings.report.open("program_cache"));
+        if (settings.speculative_build)
+          state().workers.start(std::max(settings.build_threads, 1u));
+
+        // Everything that is not about programs goes straight to the target.
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(report_at_exit);
+      });
+}
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#include "program_cache_store.hpp"
+
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace program_cache {
+
+namespace {
+
+using ocl_layer_utils::fnv1a;
+
+uint32_t rotate_right(uint32_t value, unsigned bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+const uint32_t sha256_round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+void sha256_block(uint32_t state[8], const uint8_t block[64]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i)
+    w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16 |
+           uint32_t(block[4 * i + 2]) << 8 | uint32_t(block[4 * i + 3]);
+  for (int i = 16; i < 64; ++i) {
+    const uint32_t s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    const uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+    const uint32_t choice = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + choice + sha256_round_constants[i] + w[i];
+    const uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+    const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + majority;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+struct blob_header {
+  static constexpr uint64_t magic_value = 0x31424c4243504c43ull; // "CLPCBLB1"
+
+  uint64_t magic;
+  uint64_t key_high, key_low;
+  uint64_t size;
+  // FNV-1a of the contents, catches blobs that were truncated or
+  // overwritten. The key catches blobs left behind by another entry.
+  uint64_t checksum;
+};
+
+} // namespace
+
+std::array<uint8_t, 32> sha256(const void *data, size_t size) {
+  uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  size_t remaining = size;
+  for (; remaining >= 64; remaining -= 64, bytes += 64)
+    sha256_block(state, bytes);
+
+  // The message is padded with a one bit, zeros and its length in bits.
+  uint8_t tail[128] = {};
+  std::memcpy(tail, bytes, remaining);
+  tail[remaining] = 0x80;
+  const size_t tail_size = remaining < 56 ? 64 : 128;
+  const uint64_t bits = static_cast<uint64_t>(size) * 8;
+  for (int i = 0; i < 8; ++i)
+    tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+  for (size_t offset = 0; offset < tail_size; offset += 64)
+    sha256_block(state, tail + offset);
+
+  std::array<uint8_t, 32> digest;
+  for (int i = 0; i < 32; ++i)
+    digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - 8 * (i % 4)));
+  return digest;
+}
+
+std::string cache_key::hex() const {
+  std::ostringstream out;
+  out << std::hex << std::setfill('0') << std::setw(16) << high << std::setw(16) << low;
+  return out.str();
+}
+
+key_builder &key_builder::add(const void *data, size_t size) {
+  const uint64_t length = size;
+  for (int i = 0; i < 8; ++i)
+    material_ += static_cast<char>(length >> (8 * i));
+  material_.append(static_cast<const char *>(data), size);
+  return *this;
+}
+
+cache_key key_builder::finish() const {
+  const std::array<uint8_t, 32> digest = sha256(material_.data(), material_.size());
+  cache_key key;
+  for (int i = 0; i < 8; ++i) {
+    key.high = key.high << 8 | digest[i];
+    key.low = key.low << 8 | digest[8 + i];
+  }
+  // The all zero key marks empty slots in the index.
+  if (key.high == 0 && key.low == 0)
+    key.low = 1;
+  return key;
+}
+
+#if !defined(_WIN32)
+
+namespace {
+
+// Creates directory and its missing parents.
+bool make_directories(const std::string &directory) {
+  for (size_t end = directory.find('/', 1);; end = directory.find('/', end + 1)) {
+    const std::string parent = directory.substr(0, end);
+    if (!parent.empty() && mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if (end == std::string::npos)
+      return true;
+  }
+}
+
+// Holds flock on the index and the mutex of the store, flock alone does not
+// serialize the threads of one process, which share the descriptor.
+class index_lock {
+public:
+  index_lock(std::mutex &mutex, int fd, int operation) : lock_(mutex), fd_(fd) {
+    while (flock(fd_, operation) != 0 && errno == EINTR)
+      ;
+  }
+  ~index_lock() { flock(fd_, LOCK_UN); }
+
+  index_lock(const index_lock &) = delete;
+  index_lock &operator=(const index_lock &) = delete;
+
+private:
+  std::lock_guard<std::mutex> lock_;
+  int fd_;
+};
+
+bool read_blob(const std::string &path, const cache_key &key, std::string &data) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  blob_header header;
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      header.magic != blob_header::magic_value || header.key_high != key.high ||
+      header.key_low != key.low)
+    return false;
+  std::string contents(header.size, '\0');
+  if (!file.read(&contents[0], static_cast<std::streamsize>(contents.size())) ||
+      fnv1a(contents) != header.checksum)
+    return false;
+  data.swap(contents);
+  return true;
+}
+
+} // namespace
+
+store::store(const std::string &directory, uint64_t max_size)
+    : directory_(directory), max_size_(max_size) {
+  // Relative to the root of the file system otherwise.
+  if (directory_.empty() || !make_directories(directory_ + "/blobs-v1"))
+    return;
+  fd_ = open((directory_ + "/index-v1").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0)
+    return;
+
+  const size_t size = sizeof(index_header) + index_capacity * sizeof(index_slot);
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (flock(fd_, LOCK_EX) != 0 && errno == EINTR)
+    ;
+  struct stat status;
+  bool usable = fstat(fd_, &status) == 0 &&
+                (static_cast<size_t>(status.st_size) == size ||
+                 ftruncate(fd_, static_cast<off_t>(size)) == 0);
+  void *mapping =
+      usable ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0) : MAP_FAILED;
+  if (mapping != MAP_FAILED) {
+    header_ = static_cast<index_header *>(mapping);
+    slots_ = reinterpret_cast<index_slot *>(header_ + 1);
+    // Indexes of other versions, or of no version at all when the file was
+    // just created, start over. Their blobs are left to be overwritten.
+    if (header_->magic != index_header::magic_value ||
+        header_->version != index_header::version_value || header_->capacity != index_capacity) {
+      std::memset(mapping, 0, size);
+      header_->magic = index_header::magic_value;
+      header_->version = index_header::version_value;
+      header_->capacity = index_capacity;
+    }
+  }
+  flock(fd_, LOCK_UN);
+}
+
+store::~store() {
+  if (header_)
+    munmap(header_, sizeof(index_header) + index_capacity * sizeof(index_slot));
+  if (fd_ >= 0)
+    close(fd_);
+}
+
+std::string store::blob_path(const cache_key &key) const {
+  return directory_ + "/blobs-v1/" + key.hex();
+}
+
+index_slot *store::find(const cache_key &key) const {
+  for (uint32_t i = 0, slot = key.low % index_capacity; i < index_capacity;
+       ++i, slot = (slot + 1) % index_capacity) {
+    index_slot &candidate = slots_[slot];
+    if (candidate.key_high == key.high && candidate.key_low == key.low)
+      return &candidate;
+    if (candidate.key_high == 0 && candidate.key_low == 0)
+      return nullptr;
+  }
+  return nullptr;
+}
+
+// Shifts the slots that follow back over the removed one, so that lookups
+// need no tombstones.
+void store::remove(index_slot *slot) {
+  header_->entries -= 1;
+  header_->bytes -= slot->size;
+  uint32_t hole = static_cast<uint32_t>(slot - slots_);
+  for (uint32_t next = (hole + 1) % index_capacity;; next = (next + 1) % index_capacity) {
+    const index_slot &candidate = slots_[next];
+    if (candidate.key_high == 0 && candidate.key_low == 0)
+      break;
+    const uint32_t home = candidate.key_low % index_capacity;
+    const bool stays = hole <= next ? hole < home && home <= next : hole < home || home <= next;
+    if (!stays) {
+      slots_[hole] = candidate;
+      hole = next;
+    }
+  }
+  slots_[hole] = index_slot{};
+}
+
+// Keeps the index at most three quarters full, for short probe sequences.
+void store::evict(uint64_t incoming) {
+  while (header_->entries > 0 && (header_->entries + 1 > index_capacity / 4 * 3 ||
+                                  header_->bytes + incoming > max_size_)) {
+    index_slot *oldest = nullptr;
+    for (uint32_t i = 0; i < index_capacity; ++i) {
+      index_slot &candidate = slots_[i];
+      if ((candidate.key_high != 0 || candidate.key_low != 0) &&
+          (!oldest || candidate.last_used < oldest->last_used))
+        oldest = &candidate;
+    }
+    cache_key key;
+    key.high = oldest->key_high;
+    key.low = oldest->key_low;
+    std::remove(blob_path(key).c_str());
+    remove(oldest);
+  }
+}
+
+bool store::load(const cache_key &key, std::string &data, bool counted) {
+  if (!is_open())
+    return false;
+  const uint64_t count = counted ? 1 : 0;
+  {
+    index_lock lock(mutex_, fd_, LOCK_EX);
+    index_slot *slot = find(key);
+    if (!slot) {
+      header_->misses += count;
+      return false;
+    }
+    slot->last_used = ++header_->clock;
+    header_->hits += count;
+  }
+
+  // Blobs are replaced by rename, an open file stays whole even if the
+  // entry is evicted meanwhile.
+  if (read_blob(blob_path(key), key, data))
+    return true;
+  index_lock lock(mutex_, fd_, LOCK_EX);
+  header_->hits -= count;
+  header_->misses += count;
+  if (index_slot *slot = find(key)) {
+    std::remove(blob_path(key).c_str());
+    remove(slot);
+  }
+  return false;
+}
+
+void store::count(bool hit) {
+  if (!is_open())
+    return;
+  index_lock lock(mutex_, fd_, LOCK_EX);
+  if (hit)
+    ++header_->hits;
+  else
+    ++header_->misses;
+}
+
+bool store::save(const cache_key &key, const std::string &data) {
+  if (!is_open() || data.size() > max_size_)
+    return false;
+
+  static std::atomic<unsigned> temporaries{0};
+  const std::string path = blob_path(key);
+  const std::string temporary =
+      path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(temporaries++);
+  {
+    std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+    const blob_header header = {blob_header::magic_value, key.high, key.low, data.size(),
+                                fnv1a(data)};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.close();
+    if (!file) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+
+  index_lock lock(mutex_, fd_, LOCK_EX);
+  if (index_slot *existing = find(key))
+    remove(existing);
+  evict(data.size());
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  uint32_t slot = key.low % index_capacity;
+  while (slots_[slot].key_high != 0 || slots_[slot].key_low != 0)
+    slot = (slot + 1) % index_capacity;
+  slots_[slot] = index_slot{key.high, key.low, data.size(), ++header_->clock};
+  header_->entries += 1;
+  header_->bytes += data.size();
+  return true;
+}
+
+store::statistics store::stats() const {
+  statistics result;
+  if (!is_open())
+    return result;
+  index_lock lock(mutex_, fd_, LOCK_SH);
+  result.entries = header_->entries;
+  result.bytes = header_->bytes;
+  result.hits = header_->hits;
+  result.misses = header_->misses;
+  return result;
+}
+
+std::string store::default_directory() {
+  std::string base;
+  if (!ocl_layer_utils::detail::get_environment("XDG_CACHE_HOME", base) || base.empty()) {
+    if (!ocl_layer_utils::detail::get_environment("HOME", base) || base.empty())
+      return std::string();
+    base += "/.cache";
+  }
+  return base + "/opencl-layers/program-cache";
+}
+
+#else
+
+store::store(const std::string &directory, uint64_t max_size)
+    : directory_(directory), max_size_(max_size) {}
+
+store::~store() {}
+
+bool store::load(const cache_key &, std::string &, bool) { return false; }
+
+void store::count(bool) {}
+
+bool store::save(const cache_key &, const std::string &) { return false; }
+
+store::statistics store::stats() const { return statistics(); }
+
+std::string store::default_directory() {
+  std::string base;
+  if (!ocl_layer_utils::detail::get_environment("LOCALAPPDATA", base) || base.empty())
+    return std::string();
+  return base + "\\opencl-layers\\program-cache";
+}
+
+#endif
+
+} // namespace program_cache
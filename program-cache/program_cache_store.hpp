@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace program_cache {
+
+std::array<uint8_t, 32> sha256(const void *data, size_t size);
+
+// First 128 bits of the SHA-256 of everything a cached binary depends on.
+struct cache_key {
+  uint64_t high = 0, low = 0;
+
+  bool operator==(const cache_key &other) const {
+    return high == other.high && low == other.low;
+  }
+
+  std::string hex() const;
+};
+
+// Builds a cache_key from a sequence of fields. Every field is hashed
+// along with its size, so that moving bytes from one field to the next
+// changes the key.
+class key_builder {
+public:
+  key_builder &add(const void *data, size_t size);
+  key_builder &add(const std::string &field) { return add(field.data(), field.size()); }
+
+  cache_key finish() const;
+
+private:
+  std::string material_;
+};
+
+// Layout of the index file: this header followed by capacity slots, an
+// open addressing hash table of the binaries in the blob directory.
+struct index_header {
+  static constexpr uint64_t magic_value = 0x3158444943504c43ull; // "CLPCIDX1"
+  static constexpr uint32_t version_value = 1;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint64_t entries;
+  uint64_t bytes;
+  // Lookups over all the processes that used the cache.
+  uint64_t hits;
+  uint64_t misses;
+  // Ticks on every use of an entry, for least recently used eviction.
+  uint64_t clock;
+  uint64_t reserved;
+};
+
+struct index_slot {
+  // Both zero for empty slots.
+  uint64_t key_high, key_low;
+  uint64_t size;
+  uint64_t last_used;
+};
+
+// Binaries shared by all the processes using the same directory.
+//
+// Each binary is stored in a file of its own under blobs-v1, written to a
+// temporary file first and renamed into place, so readers only ever see
+// whole files. A memory mapped index keeps track of their sizes and uses,
+// updated under an exclusive lock on the file, and evicts the least
+// recently used binaries past max_size bytes or when the index fills up.
+// A blob that does not match its key is treated as a miss.
+//
+// Only supported on POSIX systems, elsewhere is_open() is always false.
+class store {
+public:
+  static constexpr uint32_t index_capacity = 4096;
+
+  store(const std::string &directory, uint64_t max_size);
+  ~store();
+
+  store(const store &) = delete;
+  store &operator=(const store &) = delete;
+
+  // False if the directory or the index could not be created.
+  bool is_open() const { return header_ != nullptr; }
+
+  // Reads the binary stored for key into data. Lookups of data kept next to
+  // the binaries pass counted false to stay out of the hit rate.
+  bool load(const cache_key &key, std::string &data, bool counted = true);
+
+  // Counts a lookup made earlier with counted false.
+  void count(bool hit);
+
+  // Stores data for key, replacing what was stored before.
+  bool save(const cache_key &key, const std::string &data);
+
+  struct statistics {
+    uint64_t entries = 0, bytes = 0, hits = 0, misses = 0;
+  };
+  statistics stats() const;
+
+  // The directory used if none is configured, in the cache directory of
+  // the user. Empty if the environment does not name one.
+  static std::string default_directory();
+
+private:
+  std::string blob_path(const cache_key &key) const;
+  index_slot *find(const cache_key &key) const;
+  void remove(index_slot *slot);
+  void evict(uint64_t incoming);
+
+  std::string directory_;
+  uint64_t max_size_;
+  mutable std::mutex mutex_;
+  int fd_ = -1;
+  index_header *header_ = nullptr;
+  index_slot *slots_ = nullptr;
+};
+
+} // namespace program_cache
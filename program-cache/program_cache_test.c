@@ -0,0 +1,128 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+int notified = 0;
+
+void CL_CALLBACK notify(cl_program program, void *user_data)
+{
+    (void)program;
+    (void)user_data;
+    ++notified;
+}
+
+cl_program build(cl_context context, const char *source, const char *options, int with_callback)
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_program program = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+    checkErr(CL_err, "clCreateProgramWithSource");
+    CL_err = clBuildProgram(program, 0, NULL, options, with_callback ? notify : NULL, NULL);
+    checkErr(CL_err, "clBuildProgram");
+    return program;
+}
+
+cl_program compile_and_link(cl_context context, const char *source)
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_program object = NULL, program = NULL;
+    object = clCreateProgramWithSource(context, 1, &source, NULL, &CL_err);
+    checkErr(CL_err, "clCreateProgramWithSource");
+    CL_err = clCompileProgram(object, 0, NULL, "-DM=1", 0, NULL, NULL, NULL, NULL);
+    checkErr(CL_err, "clCompileProgram");
+    program = clLinkProgram(context, 0, NULL, "", 1, &object, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clLinkProgram");
+    clReleaseProgram(object);
+    return program;
+}
+
+void print_binary(cl_program program, const char *name)
+{
+    cl_int CL_err = CL_SUCCESS;
+    size_t size = 0;
+    char binary[256] = {0};
+    unsigned char *binaries[1] = {(unsigned char *)binary};
+    CL_err = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, NULL);
+    checkErr(CL_err, "clGetProgramInfo(CL_PROGRAM_BINARY_SIZES)");
+    if (size >= sizeof(binary))
+        checkErr(CL_OUT_OF_RESOURCES, "binary size");
+    CL_err = clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, NULL);
+    checkErr(CL_err, "clGetProgramInfo(CL_PROGRAM_BINARIES)");
+    printf("%s binary: %s\n", name, binary);
+}
+
+// Builds the same program twice with each set of options, the second build
+// of each is served from the cache, and links a compiled program twice.
+// Programs that may include headers from the file system are not cached.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL;
+    cl_device_id device = NULL;
+    cl_context context = NULL;
+    cl_program programs[4];
+    cl_program linked[2];
+    cl_program uncached[2];
+    cl_program kernel_program = NULL;
+    cl_kernel kernel = NULL;
+    char options[64] = {0};
+    const char *source = "kernel void saxpy() {}";
+    const char *source_with_header = "#include \"saxpy.h\"\nkernel void saxpy() {}";
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+    CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+    checkErr(CL_err, "clGetDeviceIDs");
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &CL_err);
+    checkErr(CL_err, "clCreateContext");
+
+    programs[0] = build(context, source, "-DN=1", 0);
+    programs[1] = build(context, source, "-DN=1", 0);
+    programs[2] = build(context, source, "-DN=2", 0);
+    programs[3] = build(context, source, "-DN=2", 1);
+    printf("Build notified: %d\n", notified);
+    print_binary(programs[1], "Program");
+    print_binary(programs[3], "Program");
+
+    CL_err = clGetProgramBuildInfo(programs[1], device, CL_PROGRAM_BUILD_OPTIONS, sizeof(options), options, NULL);
+    checkErr(CL_err, "clGetProgramBuildInfo(CL_PROGRAM_BUILD_OPTIONS)");
+    printf("Build options: %s\n", options);
+    kernel = clCreateKernel(programs[1], "saxpy", &CL_err);
+    checkErr(CL_err, "clCreateKernel");
+    CL_err = clGetKernelInfo(kernel, CL_KERNEL_PROGRAM, sizeof(kernel_program), &kernel_program, NULL);
+    checkErr(CL_err, "clGetKernelInfo(CL_KERNEL_PROGRAM)");
+    printf("Kernel program matches: %s\n", kernel_program == programs[1] ? "yes" : "no");
+
+    linked[0] = compile_and_link(context, source);
+    linked[1] = compile_and_link(context, source);
+    print_binary(linked[1], "Linked");
+
+    // Headers are not part of the key, these are always built
+    uncached[0] = build(context, source_with_header, "", 0);
+    uncached[1] = build(context, source, "-I.", 0);
+
+    clReleaseKernel(kernel);
+    for (i = 0; i < 2; ++i)
+        clReleaseProgram(linked[i]);
+    for (i = 0; i < 2; ++i)
+        clReleaseProgram(uncached[i]);
+    for (i = 0; i < 4; ++i)
+        clReleaseProgram(programs[i]);
+    clReleaseContext(context);
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "program_cache_store.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using program_cache::cache_key;
+using program_cache::key_builder;
+using program_cache::store;
+
+std::string hex(const std::array<uint8_t, 32> &digest) {
+  static const char digits[] = "0123456789abcdef";
+  std::string result;
+  for (uint8_t byte : digest) {
+    result += digits[byte >> 4];
+    result += digits[byte & 0xf];
+  }
+  return result;
+}
+
+cache_key key_of(const std::string &name) { return key_builder().add(name).finish(); }
+
+std::string payload_of(const std::string &name, size_t size) {
+  std::string result;
+  while (result.size() < size)
+    result += name;
+  result.resize(size);
+  return result;
+}
+
+bool check(bool condition, const char *message) {
+  if (!condition)
+    std::cerr << "error: " << message << std::endl;
+  return condition;
+}
+
+// Each child process stores binaries of its own while the others do the
+// same, then reads them back.
+int run_child(const std::string &directory, int child) {
+  store cache(directory, 1024 * 1024);
+  if (!cache.is_open())
+    return EXIT_FAILURE;
+  for (int i = 0; i < 50; ++i) {
+    const std::string name = "child " + std::to_string(child) + " item " + std::to_string(i);
+    if (!cache.save(key_of(name), payload_of(name, 100 + i)))
+      return EXIT_FAILURE;
+  }
+  for (int i = 0; i < 50; ++i) {
+    const std::string name = "child " + std::to_string(child) + " item " + std::to_string(i);
+    std::string data;
+    if (!cache.load(key_of(name), data) || data != payload_of(name, 100 + i))
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+// Checks the hash against known answers, then has several processes share
+// a cache, and checks that the least recently used binaries are evicted and
+// that damaged ones are dropped.
+int main(int argc, char *argv[]) {
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <directory>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string directory = argv[1];
+  if (std::system(("rm -rf '" + directory + "'").c_str()) != 0)
+    return EXIT_FAILURE;
+
+  const std::string abc = "abc";
+  const std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  if (!check(hex(program_cache::sha256(abc.data(), abc.size())) ==
+                 "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+             "wrong digest of abc") ||
+      !check(hex(program_cache::sha256(two_blocks.data(), two_blocks.size())) ==
+                 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+             "wrong digest of a two block message"))
+    return EXIT_FAILURE;
+  if (!check(!(key_builder().add("ab").add("c").finish() ==
+               key_builder().add("a").add("bc").finish()),
+             "keys do not depend on where fields end"))
+    return EXIT_FAILURE;
+
+  const std::string shared = directory + "/shared";
+  std::vector<pid_t> children;
+  for (int child = 0; child < 4; ++child) {
+    const pid_t pid = fork();
+    if (pid == 0)
+      _exit(run_child(shared, child));
+    children.push_back(pid);
+  }
+  for (pid_t pid : children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!check(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS,
+               "a process sharing the cache failed"))
+      return EXIT_FAILURE;
+  }
+  {
+    store cache(shared, 1024 * 1024);
+    const store::statistics stats = cache.stats();
+    if (!check(stats.entries == 200 && stats.hits == 200 && stats.misses == 0,
+               "the index lost track of binaries stored concurrently"))
+      return EXIT_FAILURE;
+  }
+
+  // Four binaries of 1000 bytes fit, the fifth evicts the least recently
+  // used one.
+  const std::string small = directory + "/small";
+  store cache(small, 4096);
+  for (int i = 0; i < 4; ++i)
+    cache.save(key_of("item " + std::to_string(i)), payload_of("item", 1000));
+  std::string data;
+  cache.load(key_of("item 0"), data);
+  cache.save(key_of("item 4"), payload_of("item", 1000));
+  if (!check(cache.load(key_of("item 0"), data) && !cache.load(key_of("item 1"), data) &&
+                 cache.load(key_of("item 4"), data) && cache.stats().entries == 4 &&
+                 cache.stats().bytes == 4000,
+             "the least recently used binary was not evicted"))
+    return EXIT_FAILURE;
+  if (!check(!cache.save(key_of("large"), payload_of("large", 5000)),
+             "a binary larger than the cache was stored"))
+    return EXIT_FAILURE;
+
+  {
+    std::ofstream blob(small + "/blobs-v1/" + key_of("item 2").hex(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    blob << "damaged";
+  }
+  if (!check(!cache.load(key_of("item 2"), data) && cache.stats().entries == 3,
+             "a damaged binary was not dropped"))
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
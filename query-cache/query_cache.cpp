@@ -0,0 +1,532 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Answers clGetPlatformInfo, clGetDeviceInfo and clGetDeviceIDs from
+// memory after asking the implementation once. Platform and device
+// properties do not change while a process runs, except for the few in
+// volatile_params and the ones listed in the uncached setting, which are
+// always passed through. Only root devices are cached, the handles of
+// released sub-devices may be reused for other ones.
+//
+// The values can be kept in a snapshot file from one run to the next. The
+// platforms and devices of a run are matched with the ones of the snapshot
+// by their names, versions and driver versions, so a few queries per handle
+// still reach the implementation.
+
+#include "layer_support.hpp"
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct _cl_icd_dispatch dispatch = {};
+const struct _cl_icd_dispatch *tdispatch;
+
+struct layer_settings {
+  static layer_settings load(const std::map<std::string, std::string> &settings_from_file);
+
+  // Parameters to pass through on top of volatile_params.
+  std::vector<cl_uint> uncached;
+  // Empty to not keep a snapshot.
+  std::string snapshot_filename;
+  ocl_layer_utils::report_destination report = {
+      ocl_layer_utils::report_destination::sink_type::none, "cl_query_cache.log"};
+};
+
+layer_settings layer_settings::load(const std::map<std::string, std::string> &settings_from_file) {
+  const auto parser = ocl_layer_utils::settings_parser("query_cache", settings_from_file);
+
+  auto settings = layer_settings{};
+  std::vector<std::string> uncached;
+  parser.get_list("uncached", uncached);
+  for (const std::string &param : uncached) {
+    char *end = nullptr;
+    const unsigned long value = std::strtoul(param.c_str(), &end, 0);
+    if (end == param.c_str() || *end != '\0') {
+      std::cerr << "query_cache ignores uncached parameter that is not a number: " << param
+                << std::endl;
+      continue;
+    }
+    settings.uncached.push_back(static_cast<cl_uint>(value));
+  }
+  parser.get_filename("snapshot_filename", settings.snapshot_filename);
+  settings.report.load(parser);
+  return settings;
+}
+
+layer_settings settings;
+
+// Parameters whose value may change while the process runs. Vendor
+// parameters are given by value, their headers are not included.
+const cl_uint volatile_params[] = {
+    CL_DEVICE_REFERENCE_COUNT,
+    CL_DEVICE_AVAILABLE,
+    0x4039, // CL_DEVICE_GLOBAL_FREE_MEMORY_AMD
+};
+
+// Parameters holding handles, which are only valid in this process.
+const cl_uint handle_params[] = {
+    CL_DEVICE_PLATFORM,
+    CL_DEVICE_PARENT_DEVICE,
+};
+
+bool cached(cl_uint param_name) {
+  const auto end = std::end(volatile_params);
+  return std::find(std::begin(volatile_params), end, param_name) == end &&
+         std::find(settings.uncached.begin(), settings.uncached.end(), param_name) ==
+             settings.uncached.end();
+}
+
+bool persisted(cl_uint param_name) {
+  const auto end = std::end(handle_params);
+  return std::find(std::begin(handle_params), end, param_name) == end;
+}
+
+std::string hex(const std::vector<char> &bytes) {
+  std::ostringstream out;
+  out << std::hex << std::setfill('0');
+  for (char c : bytes)
+    out << std::setw(2) << static_cast<unsigned>(static_cast<unsigned char>(c));
+  return out.str();
+}
+
+bool unhex(const std::string &text, std::vector<char> &bytes) {
+  if (text.size() % 2)
+    return false;
+  bytes.clear();
+  for (size_t i = 0; i < text.size(); i += 2) {
+    char *end = nullptr;
+    const std::string digits = text.substr(i, 2);
+    const unsigned long value = std::strtoul(digits.c_str(), &end, 16);
+    if (end != digits.c_str() + 2)
+      return false;
+    bytes.push_back(static_cast<char>(value));
+  }
+  return true;
+}
+
+class query_cache {
+public:
+  // Answers a clGetPlatformInfo or clGetDeviceInfo call, returns false if
+  // it has to be passed through.
+  bool get_info(const void *handle, bool is_device, cl_uint param_name,
+                size_t param_value_size, void *param_value, size_t *param_value_size_ret,
+                cl_int &result);
+
+  // Answers a clGetDeviceIDs call, returns false if it has to be passed
+  // through.
+  bool get_device_ids(cl_platform_id platform, cl_device_type device_type, cl_uint num_entries,
+                      cl_device_id *devices, cl_uint *num_devices, cl_int &result);
+
+  void load_snapshot(const std::string &filename);
+  void save_snapshot(const std::string &filename);
+
+  void set_output(std::ostream *output) { output_ = output; }
+  void report();
+
+private:
+  struct handle_values {
+    // Empty until the handle was matched with the snapshot.
+    std::string identity;
+    std::map<cl_uint, std::vector<char>> values;
+  };
+
+  struct device_ids {
+    cl_int status;
+    std::vector<cl_device_id> devices;
+  };
+
+  // Asks the implementation, with mutex_ held.
+  cl_int fetch(const void *handle, bool is_device, cl_uint param_name,
+               std::vector<char> &value);
+  cl_int fetch_device_ids(cl_platform_id platform, cl_device_type device_type,
+                          device_ids &ids);
+
+  // Looks up or fetches a value, with mutex_ held.
+  const std::vector<char> *value_of(const void *handle, bool is_device, cl_uint param_name);
+  std::string string_of(const void *handle, bool is_device, cl_uint param_name);
+
+  // Devices of platform of any type, with mutex_ held.
+  const std::vector<cl_device_id> &all_devices(cl_platform_id platform);
+
+  // Computes the identity of handle and fills in its values from the
+  // snapshot, with mutex_ held.
+  void bind(const void *handle, bool is_device);
+
+  std::mutex mutex_;
+  std::map<const void *, handle_values> handles_;
+  std::set<const void *> root_devices_;
+  std::map<cl_device_id, cl_platform_id> device_platforms_;
+  std::map<std::pair<cl_platform_id, cl_device_type>, device_ids> device_ids_;
+  // Values of the snapshot by identity, and of the handles of this run.
+  std::map<std::string, std::map<cl_uint, std::vector<char>>> snapshot_;
+  uint64_t queries_ = 0, hits_ = 0, driver_calls_ = 0, loaded_ = 0, matched_ = 0;
+  std::ostream *output_ = nullptr;
+};
+
+query_cache &state() {
+  return ocl_layer_utils::never_destroyed<query_cache>();
+}
+
+cl_int query_cache::fetch(const void *handle, bool is_device, cl_uint param_name,
+                          std::vector<char> &value) {
+  const auto get = [handle, is_device, param_name](size_t size, void *data, size_t *size_ret) {
+    return is_device
+               ? tdispatch->clGetDeviceInfo(static_cast<cl_device_id>(const_cast<void *>(handle)),
+                                            param_name, size, data, size_ret)
+               : tdispatch->clGetPlatformInfo(
+                     static_cast<cl_platform_id>(const_cast<void *>(handle)), param_name, size,
+                     data, size_ret);
+  };
+  size_t size = 0;
+  ++driver_calls_;
+  cl_int result = get(0, nullptr, &size);
+  if (result != CL_SUCCESS)
+    return result;
+  value.assign(size, 0);
+  if (size == 0)
+    return CL_SUCCESS;
+  ++driver_calls_;
+  return get(size, value.data(), nullptr);
+}
+
+cl_int query_cache::fetch_device_ids(cl_platform_id platform, cl_device_type device_type,
+                                     device_ids &ids) {
+  cl_uint count = 0;
+  ++driver_calls_;
+  ids.status = tdispatch->clGetDeviceIDs(platform, device_type, 0, nullptr, &count);
+  ids.devices.assign(count, nullptr);
+  if (ids.status != CL_SUCCESS || count == 0)
+    return ids.status;
+  ++driver_calls_;
+  ids.status = tdispatch->clGetDeviceIDs(platform, device_type, count, ids.devices.data(),
+                                         nullptr);
+  for (cl_device_id device : ids.devices) {
+    root_devices_.insert(device);
+    device_platforms_[device] = platform;
+  }
+  return ids.status;
+}
+
+const std::vector<char> *query_cache::value_of(const void *handle, bool is_device,
+                                               cl_uint param_name) {
+  handle_values &entry = handles_[handle];
+  auto it = entry.values.find(param_name);
+  if (it != entry.values.end())
+    return &it->second;
+  std::vector<char> value;
+  if (fetch(handle, is_device, param_name, value) != CL_SUCCESS)
+    return nullptr;
+  return &entry.values.emplace(param_name, std::move(value)).first->second;
+}
+
+std::string query_cache::string_of(const void *handle, bool is_device, cl_uint param_name) {
+  const std::vector<char> *value = value_of(handle, is_device, param_name);
+  return value ? std::string(value->data(), strnlen(value->data(), value->size()))
+               : std::string();
+}
+
+const std::vector<cl_device_id> &query_cache::all_devices(cl_platform_id platform) {
+  auto all = device_ids_.find(std::make_pair(platform, CL_DEVICE_TYPE_ALL));
+  if (all == device_ids_.end()) {
+    all = device_ids_.emplace(std::make_pair(platform, CL_DEVICE_TYPE_ALL), device_ids{}).first;
+    fetch_device_ids(platform, CL_DEVICE_TYPE_ALL, all->second);
+  }
+  return all->second.devices;
+}
+
+void query_cache::bind(const void *handle, bool is_device) {
+  std::string identity;
+  if (!is_device) {
+    // The platform version does not have to change with the driver, the
+    // driver versions of its devices do.
+    const auto platform = static_cast<cl_platform_id>(const_cast<void *>(handle));
+    identity = "platform:" + string_of(handle, false, CL_PLATFORM_NAME) + '\n' +
+               string_of(handle, false, CL_PLATFORM_VENDOR) + '\n' +
+               string_of(handle, false, CL_PLATFORM_VERSION);
+    for (cl_device_id device : all_devices(platform))
+      identity += '\n' + string_of(device, true, CL_DRIVER_VERSION);
+  } else {
+    const auto device = static_cast<cl_device_id>(const_cast<void *>(handle));
+    const cl_platform_id platform = device_platforms_[device];
+    if (handles_[platform].identity.empty())
+      bind(platform, false);
+    // Devices with the same names are told apart by their position.
+    const auto &devices = all_devices(platform);
+    identity = "device:" + handles_[platform].identity + '\n' +
+               std::to_string(std::find(devices.begin(), devices.end(), device) -
+                              devices.begin()) +
+               '\n' + string_of(handle, true, CL_DEVICE_NAME) + '\n' +
+               string_of(handle, true, CL_DEVICE_VERSION) + '\n' +
+               string_of(handle, true, CL_DRIVER_VERSION);
+  }
+  std::ostringstream hashed;
+  hashed << (is_device ? "device-" : "platform-") << std::hex << std::setw(16)
+         << std::setfill('0') << ocl_layer_utils::fnv1a(identity);
+
+  handle_values &entry = handles_[handle];
+  entry.identity = hashed.str();
+  auto found = snapshot_.find(entry.identity);
+  if (found == snapshot_.end())
+    return;
+  ++matched_;
+  // Values fetched to match the handle take precedence.
+  for (const auto &value : found->second)
+    entry.values.insert(value);
+}
+
+bool query_cache::get_info(const void *handle, bool is_device, cl_uint param_name,
+                           size_t param_value_size, void *param_value,
+                           size_t *param_value_size_ret, cl_int &result) {
+  if (!handle || !cached(param_name))
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_device && !root_devices_.count(handle))
+    return false;
+  ++queries_;
+  if (handles_[handle].identity.empty())
+    bind(handle, is_device);
+  const handle_values &entry = handles_[handle];
+  auto it = entry.values.find(param_name);
+  if (it != entry.values.end()) {
+    ++hits_;
+  } else {
+    // Errors are left for the implementation to report.
+    const std::vector<char> *value = value_of(handle, is_device, param_name);
+    if (!value)
+      return false;
+    it = entry.values.find(param_name);
+  }
+  const std::vector<char> &value = it->second;
+  if (param_value && param_value_size < value.size()) {
+    result = CL_INVALID_VALUE;
+    return true;
+  }
+  if (param_value && !value.empty())
+    std::memcpy(param_value, value.data(), value.size());
+  if (param_value_size_ret)
+    *param_value_size_ret = value.size();
+  result = CL_SUCCESS;
+  return true;
+}
+
+bool query_cache::get_device_ids(cl_platform_id platform, cl_device_type device_type,
+                                 cl_uint num_entries, cl_device_id *devices,
+                                 cl_uint *num_devices, cl_int &result) {
+  if (!platform || (num_entries == 0 && devices) || (!devices && !num_devices))
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++queries_;
+  const auto key = std::make_pair(platform, device_type);
+  auto it = device_ids_.find(key);
+  if (it != device_ids_.end()) {
+    ++hits_;
+  } else {
+    it = device_ids_.emplace(key, device_ids{}).first;
+    fetch_device_ids(platform, device_type, it->second);
+  }
+  const device_ids &ids = it->second;
+  result = ids.status;
+  if (num_devices)
+    *num_devices = static_cast<cl_uint>(ids.devices.size());
+  if (result == CL_SUCCESS && devices)
+    std::copy_n(ids.devices.begin(), std::min<size_t>(num_entries, ids.devices.size()), devices);
+  return true;
+}
+
+// One value per line, separated by tabs:
+//
+//   v1 <identity> <parameter> <hex encoded value>
+void query_cache::load_snapshot(const std::string &filename) {
+  std::ifstream file(filename);
+  for (std::string line; std::getline(file, line);) {
+    std::istringstream fields(line);
+    std::string version, identity, param, value;
+    std::vector<char> bytes;
+    if (!std::getline(fields, version, '\t') || version != "v1" ||
+        !std::getline(fields, identity, '\t') || !std::getline(fields, param, '\t') ||
+        !std::getline(fields, value) || !unhex(value, bytes))
+      continue;
+    snapshot_[identity][static_cast<cl_uint>(std::strtoul(param.c_str(), nullptr, 10))] =
+        std::move(bytes);
+    ++loaded_;
+  }
+}
+
+void query_cache::save_snapshot(const std::string &filename) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &handle : handles_) {
+    if (handle.second.identity.empty())
+      continue;
+    auto &values = snapshot_[handle.second.identity];
+    for (const auto &value : handle.second.values)
+      if (persisted(value.first))
+        values[value.first] = value.second;
+  }
+  // Written next to the snapshot and renamed, so that processes exiting at
+  // the same time do not mix their lines.
+#if defined(_WIN32)
+  const std::string temporary = filename + ".tmp." + std::to_string(_getpid());
+#else
+  const std::string temporary = filename + ".tmp." + std::to_string(getpid());
+#endif
+  {
+    std::ofstream file(temporary);
+    if (!file.good())
+      return;
+    for (const auto &identity : snapshot_)
+      for (const auto &value : identity.second)
+        file << "v1\t" << identity.first << '\t' << value.first << '\t' << hex(value.second)
+             << '\n';
+    if (!file.good()) {
+      file.close();
+      std::remove(temporary.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    // Windows does not replace existing files.
+    std::remove(filename.c_str());
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+      std::remove(temporary.c_str());
+  }
+}
+
+void query_cache::report() {
+  if (!output_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostream &out = *output_;
+  out << "query_cache report\n"
+      << "queries: " << queries_ << '\n'
+      << "hits: " << hits_ << " (" << std::fixed << std::setprecision(1)
+      << (queries_ ? 100.0 * static_cast<double>(hits_) / static_cast<double>(queries_) : 0.0)
+      << "%)\n"
+      << "misses: " << queries_ - hits_ << '\n'
+      << "driver calls: " << driver_calls_ << '\n';
+  if (!settings.snapshot_filename.empty())
+    out << "snapshot: " << loaded_ << " values loaded, " << matched_ << " handles matched\n";
+  out.flush();
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetPlatformInfo_wrap(
+    cl_platform_id platform,
+    cl_platform_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  cl_int result = CL_SUCCESS;
+  if (state().get_info(platform, false, param_name, param_value_size, param_value,
+                       param_value_size_ret, result))
+    return result;
+  return tdispatch->clGetPlatformInfo(platform, param_name, param_value_size, param_value,
+                                      param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceInfo_wrap(
+    cl_device_id device,
+    cl_device_info param_name,
+    size_t param_value_size,
+    void *param_value,
+    size_t *param_value_size_ret) {
+  cl_int result = CL_SUCCESS;
+  if (state().get_info(device, true, param_name, param_value_size, param_value,
+                       param_value_size_ret, result))
+    return result;
+  return tdispatch->clGetDeviceInfo(device, param_name, param_value_size, param_value,
+                                    param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDs_wrap(
+    cl_platform_id platform,
+    cl_device_type device_type,
+    cl_uint num_entries,
+    cl_device_id *devices,
+    cl_uint *num_devices) {
+  cl_int result = CL_SUCCESS;
+  if (state().get_device_ids(platform, device_type, num_entries, devices, num_devices, result))
+    return result;
+  return tdispatch->clGetDeviceIDs(platform, device_type, num_entries, devices, num_devices);
+}
+
+void init_dispatch() {
+  dispatch.clGetPlatformInfo = &clGetPlatformInfo_wrap;
+  dispatch.clGetDeviceInfo = &clGetDeviceInfo_wrap;
+  dispatch.clGetDeviceIDs = &clGetDeviceIDs_wrap;
+}
+
+void save_at_exit() {
+  if (!settings.snapshot_filename.empty())
+    state().save_snapshot(settings.snapshot_filename);
+  state().report();
+}
+
+} // namespace
+
+CL_API_ENTRY cl_int CL_API_CALL
+clGetLayerInfo(
+    cl_layer_info  param_name,
+    size_t         param_value_size,
+    void          *param_value,
+    size_t        *param_value_size_ret) {
+  return ocl_layer_utils::get_layer_info(param_name, param_value_size, param_value,
+                                         param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clInitLayer(
+    cl_uint                         num_entries,
+    const struct _cl_icd_dispatch  *target_dispatch,
+    cl_uint                        *num_entries_out,
+    const struct _cl_icd_dispatch **layer_dispatch_ret) {
+  return ocl_layer_utils::init_layer(
+      dispatch, num_entries, target_dispatch, num_entries_out, layer_dispatch_ret, [=] {
+        settings = layer_settings::load(ocl_layer_utils::load_settings());
+        state().set_output(settings.report.open("query_cache"));
+        if (!settings.snapshot_filename.empty())
+          state().load_snapshot(settings.snapshot_filename);
+
+        tdispatch = target_dispatch;
+        dispatch = *target_dispatch;
+        init_dispatch();
+        atexit(save_at_exit);
+      });
+}
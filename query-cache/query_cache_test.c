@@ -0,0 +1,62 @@
+#ifdef __APPLE__ //Mac OSX has a different name for the header file
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stdio.h>  // printf
+#include <stdlib.h> // exit
+
+void checkErr(cl_int err, const char * name)
+{
+    if (err != CL_SUCCESS)
+    {
+        printf("ERROR: %s (%i)\n", name, err);
+        exit( err );
+    }
+}
+
+// Queries the same platform and device properties over and over, like
+// libraries deciding on code paths do, for the layer to answer from memory.
+int main()
+{
+    cl_int CL_err = CL_SUCCESS;
+    cl_platform_id platform = NULL, device_platform = NULL;
+    cl_device_id device = NULL;
+    cl_uint num_devices = 0, compute_units = 0, reference_count = 0;
+    char name[256], extensions[1024];
+    size_t size = 0;
+    int i;
+
+    CL_err = clGetPlatformIDs(1, &platform, NULL);
+    checkErr(CL_err, "clGetPlatformIDs");
+
+    for (i = 0; i < 10; ++i)
+    {
+        CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, NULL, &num_devices);
+        checkErr(CL_err, "clGetDeviceIDs(num_devices)");
+        CL_err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, NULL);
+        checkErr(CL_err, "clGetDeviceIDs");
+        CL_err = clGetPlatformInfo(platform, CL_PLATFORM_EXTENSIONS, 0, NULL, &size);
+        checkErr(CL_err, "clGetPlatformInfo(CL_PLATFORM_EXTENSIONS, size)");
+        CL_err = clGetPlatformInfo(platform, CL_PLATFORM_EXTENSIONS, sizeof(extensions), extensions, NULL);
+        checkErr(CL_err, "clGetPlatformInfo(CL_PLATFORM_EXTENSIONS)");
+        CL_err = clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name), name, NULL);
+        checkErr(CL_err, "clGetDeviceInfo(CL_DEVICE_NAME)");
+        CL_err = clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, NULL);
+        checkErr(CL_err, "clGetDeviceInfo(CL_DEVICE_MAX_COMPUTE_UNITS)");
+        CL_err = clGetDeviceInfo(device, CL_DEVICE_REFERENCE_COUNT, sizeof(reference_count), &reference_count, NULL);
+        checkErr(CL_err, "clGetDeviceInfo(CL_DEVICE_REFERENCE_COUNT)");
+    }
+    printf("Devices: %u\n", num_devices);
+    printf("Device name: %s\n", name);
+    printf("Compute units: %u\n", compute_units);
+
+    CL_err = clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(device_platform), &device_platform, NULL);
+    checkErr(CL_err, "clGetDeviceInfo(CL_DEVICE_PLATFORM)");
+    printf("Device platform matches: %s\n", device_platform == platform ? "yes" : "no");
+    CL_err = clGetDeviceInfo(device, CL_DEVICE_NAME, 2, name, NULL);
+    printf("Name into a short buffer: %s\n", CL_err == CL_INVALID_VALUE ? "CL_INVALID_VALUE" : "accepted");
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#ifndef __ICD_PRINT_ARGS_H
+#define __ICD_PRINT_ARGS_H
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Arguments of a call, encoded one after the other as a tag byte followed
+ * by the value:
+ *
+ *   'u' unsigned LEB128 integer       'i' zigzag LEB128 integer
+ *   'h' handle, 64 bits               'p' pointer, 64 bits
+ *   's' LEB128 length, bytes          'b' LEB128 size, bytes of a struct
+ *   'n' NULL array, string or struct
+ *   'a' element tag, LEB128 element count, LEB128 number of elements
+ *       that follow (at most PRINT_ARGS_MAX_ELEMENTS), untagged elements
+ *
+ * Strings are cut after PRINT_ARGS_MAX_STRING bytes. Arguments that do not
+ * fit in the buffer anymore are dropped. */
+#define PRINT_ARGS_MAX_ELEMENTS 64
+#define PRINT_ARGS_MAX_STRING 256
+
+struct print_args {
+    size_t size;
+    unsigned char data[2048];
+};
+
+static inline int _args_room(const struct print_args *a, size_t n) {
+    return sizeof(a->data) - a->size >= n;
+}
+
+static inline void _args_varint(struct print_args *a, uint64_t v) {
+    while (v >= 0x80) {
+        a->data[a->size++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    a->data[a->size++] = (unsigned char)v;
+}
+
+static inline void _args_u64(struct print_args *a, uint64_t v) {
+    memcpy(&a->data[a->size], &v, sizeof(v));
+    a->size += sizeof(v);
+}
+
+static inline void _put_uint(struct print_args *a, uint64_t v) {
+    if (_args_room(a, 11)) {
+        a->data[a->size++] = 'u';
+        _args_varint(a, v);
+    }
+}
+
+static inline void _put_int(struct print_args *a, int64_t v) {
+    if (_args_room(a, 11)) {
+        a->data[a->size++] = 'i';
+        _args_varint(a, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+    }
+}
+
+static inline void _put_handle(struct print_args *a, const void *v) {
+    if (_args_room(a, 9)) {
+        a->data[a->size++] = 'h';
+        _args_u64(a, (uint64_t)(uintptr_t)v);
+    }
+}
+
+static inline void _put_pointer(struct print_args *a, const void *v) {
+    if (_args_room(a, 9)) {
+        a->data[a->size++] = 'p';
+        _args_u64(a, (uint64_t)(uintptr_t)v);
+    }
+}
+
+/* Function pointers can not be converted to object pointers in ISO C, the
+ * caller converts them to an integer. Recorded as pointers. */
+static inline void _put_function(struct print_args *a, uint64_t v) {
+    if (_args_room(a, 9)) {
+        a->data[a->size++] = 'p';
+        _args_u64(a, v);
+    }
+}
+
+static inline void _put_null(struct print_args *a) {
+    if (_args_room(a, 1))
+        a->data[a->size++] = 'n';
+}
+
+static inline void _put_string(struct print_args *a, const char *s) {
+    size_t n = 0;
+    if (s == NULL) {
+        _put_null(a);
+        return;
+    }
+    while (n < PRINT_ARGS_MAX_STRING && s[n] != '\0')
+        ++n;
+    if (_args_room(a, 11 + n)) {
+        a->data[a->size++] = 's';
+        _args_varint(a, n);
+        memcpy(&a->data[a->size], s, n);
+        a->size += n;
+    }
+}
+
+static inline void _put_struct(struct print_args *a, const void *s, size_t n) {
+    if (s == NULL) {
+        _put_null(a);
+        return;
+    }
+    if (_args_room(a, 11 + n)) {
+        a->data[a->size++] = 'b';
+        _args_varint(a, n);
+        memcpy(&a->data[a->size], s, n);
+        a->size += n;
+    }
+}
+
+/* Writes the header of an array of count elements of the given tag, and
+ * returns how many of them should follow. Elements take at most 10 bytes. */
+static inline size_t _put_array(struct print_args *a, char tag, const void *array, uint64_t count) {
+    size_t captured = count < PRINT_ARGS_MAX_ELEMENTS ? (size_t)count : PRINT_ARGS_MAX_ELEMENTS;
+    if (array == NULL) {
+        _put_null(a);
+        return 0;
+    }
+    if (!_args_room(a, 22 + captured * 10))
+        captured = 0;
+    if (!_args_room(a, 22))
+        return 0;
+    a->data[a->size++] = 'a';
+    a->data[a->size++] = (unsigned char)tag;
+    _args_varint(a, count);
+    _args_varint(a, captured);
+    return captured;
+}
+
+#define PRINT_PUT_UINT_ARRAY(a, array, count) \
+    do { \
+        size_t _n = _put_array(a, 'u', array, count), _i; \
+        for (_i = 0; _i < _n; ++_i) \
+            _args_varint(a, (uint64_t)(array)[_i]); \
+    } while (0)
+
+#define PRINT_PUT_HANDLE_ARRAY(a, tag, array, count) \
+    do { \
+        size_t _n = _put_array(a, tag, array, count), _i; \
+        for (_i = 0; _i < _n; ++_i) \
+            _args_u64(a, (uint64_t)(uintptr_t)(array)[_i]); \
+    } while (0)
+
+/* Zero terminated lists of properties, made of key value pairs. */
+#define PRINT_PUT_PROPERTIES(a, list) \
+    do { \
+        uint64_t _count = 0; \
+        if ((list) != NULL) \
+            while (_count < 2 * PRINT_ARGS_MAX_ELEMENTS && (list)[_count] != 0) \
+                _count += 2; \
+        PRINT_PUT_UINT_ARRAY(a, list, _count); \
+    } while (0)
+
+/* Zero terminated lists of single values. */
+#define PRINT_PUT_ZERO_TERMINATED(a, list) \
+    do { \
+        uint64_t _count = 0; \
+        if ((list) != NULL) \
+            while (_count < PRINT_ARGS_MAX_ELEMENTS && (list)[_count] != 0) \
+                ++_count; \
+        PRINT_PUT_UINT_ARRAY(a, list, _count); \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ICD_PRINT_ARGS_H */
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Generates the argument capture of the print layer from the command
+// descriptions of cl-avl.xml:
+//
+//   icd_print_layer_args.h        declarations of _capture_<command>
+//   icd_print_layer_args.c        their definitions, see icd_print_args.h
+//   icd_print_layer_arg_names.inc parameter names, for the trace decoder
+//
+// The wrappers calling _capture_<command> stay in icd_print_layer_generated.c,
+// cl-avl.xml does not describe the sharing extensions they also cover.
+
+#include "rapidxml.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace rapidxml;
+
+namespace {
+
+const std::set<std::string> handle_types = {
+    "cl_platform_id", "cl_device_id", "cl_context", "cl_command_queue", "cl_mem",
+    "cl_program",     "cl_kernel",    "cl_event",   "cl_sampler"};
+
+const std::set<std::string> property_types = {
+    "cl_context_properties", "cl_queue_properties", "cl_mem_properties",
+    "cl_sampler_properties", "cl_pipe_properties"};
+
+const std::set<std::string> struct_types = {"cl_image_format", "cl_image_desc"};
+
+// Coordinates of image and rectangular buffer commands have 3 elements.
+const std::set<std::string> coordinates = {
+    "origin",     "region",     "src_origin",    "dst_origin",
+    "host_origin", "buffer_origin", "src_offset", "dst_offset"};
+
+struct param {
+    std::string name;
+    std::string type;
+    // Declaration as written in C, e.g. `const size_t* global_work_size`.
+    std::string declaration;
+    bool is_const;
+    int pointers;
+    bool is_callback;
+};
+
+param parse_param(xml_node<> * param_node)
+{
+    param p;
+    p.name = param_node->first_node("name")->value();
+    xml_node<> * type_node = param_node->first_node("type");
+    p.type = type_node != nullptr ? type_node->value() : "";
+    // read all the contents as text omitting tags
+    std::string before_name, after_name;
+    bool seen_name = false;
+    for (xml_node<> * node = param_node->first_node(); node != nullptr; node = node->next_sibling()) {
+        if (!p.declaration.empty() && p.declaration.back() != ' ' && p.declaration.back() != '(')
+            p.declaration += ' ';
+        p.declaration += node->value();
+        if (strcmp(node->name(), "name") == 0)
+            seen_name = true;
+        else
+            (seen_name ? after_name : before_name) += std::string(node->value()) + " ";
+    }
+    p.declaration = std::regex_replace(p.declaration, std::regex("[ ]+"), " ");
+    p.is_callback = before_name.find("CL_CALLBACK") != std::string::npos;
+    p.is_const = std::regex_search(before_name, std::regex("^ *const\\b"));
+    p.pointers = static_cast<int>(std::count(before_name.begin(), before_name.end(), '*'));
+    if (after_name.find("[]") != std::string::npos && !p.is_callback)
+        ++p.pointers;
+    if (p.type.empty() && before_name.compare(0, 4, "void") == 0)
+        p.type = "void";
+    return p;
+}
+
+// Expression giving the number of elements of array, or an
+// empty string if it is not known.
+std::string array_length(const std::vector<param> & params, size_t index)
+{
+    const param & array = params[index];
+    if (coordinates.count(array.name) != 0)
+        return "3";
+    // work_dim is only checked by the implementation, after the arguments
+    // are captured.
+    if (array.name.find("work_") != std::string::npos)
+        return "(work_dim < 3 ? work_dim : 3)";
+    // the closest count that precedes the array
+    for (size_t i = index; i-- > 0;)
+        if (params[i].pointers == 0 && (params[i].name.compare(0, 4, "num_") == 0 || params[i].name == "count"))
+            return params[i].name;
+    return "";
+}
+
+std::string render_capture(const std::vector<param> & params, size_t index)
+{
+    const param & p = params[index];
+    const std::string & n = p.name;
+    if (p.is_callback)
+        return "_put_function(a, (uint64_t)(uintptr_t)" + n + ");";
+    if (p.pointers == 0) {
+        if (handle_types.count(p.type) != 0)
+            return "_put_handle(a, " + n + ");";
+        if (p.type == "cl_int")
+            return "_put_int(a, " + n + ");";
+        return "_put_uint(a, (uint64_t)" + n + ");";
+    }
+    // outputs and opaque pointers are only identified by their address
+    if (p.pointers == 1 && p.is_const) {
+        if (p.type == "char")
+            return "_put_string(a, " + n + ");";
+        if (struct_types.count(p.type) != 0)
+            return "_put_struct(a, " + n + ", sizeof(*" + n + "));";
+        if (property_types.count(p.type) != 0)
+            return "PRINT_PUT_PROPERTIES(a, " + n + ");";
+        if (p.type == "cl_device_partition_property")
+            return "PRINT_PUT_ZERO_TERMINATED(a, " + n + ");";
+        const std::string length = array_length(params, index);
+        if (!length.empty() && handle_types.count(p.type) != 0)
+            return "PRINT_PUT_HANDLE_ARRAY(a, 'h', " + n + ", " + length + ");";
+        if (!length.empty() && p.type != "void")
+            return "PRINT_PUT_UINT_ARRAY(a, " + n + ", " + length + ");";
+    }
+    if (p.pointers == 2 && p.type == "void" && p.declaration.find("[]") != std::string::npos) {
+        const std::string length = array_length(params, index);
+        if (!length.empty())
+            return "PRINT_PUT_HANDLE_ARRAY(a, 'p', " + n + ", " + length + ");";
+    }
+    return "_put_pointer(a, (const void *)" + n + ");";
+}
+
+const char * const license =
+    "/*\n"
+    " * Generated by CLPrintLayerGenerator from cl-avl.xml, do not edit.\n"
+    " */\n\n";
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <path to cl-avl.xml> <output directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream theFile(argv[1]);
+    if (!theFile) {
+        std::cerr << "Error: failed to open '" << argv[1] << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(theFile)), std::istreambuf_iterator<char>());
+    buffer.push_back('\0');
+    xml_document<> doc;
+    doc.parse<0>(&buffer[0]);
+    xml_node<> * root_node = doc.first_node("registry");
+
+    std::stringstream header, source, names;
+    header << license
+           << "#ifndef __ICD_PRINT_LAYER_ARGS_H\n"
+           << "#define __ICD_PRINT_LAYER_ARGS_H\n"
+           << "#include \"icd_print_args.h\"\n"
+           << "#include <CL/cl_layer.h>\n\n"
+           << "#ifdef __cplusplus\n"
+           << "extern \"C\" {\n"
+           << "#endif\n\n";
+    source << license
+           << "#include \"icd_print_layer_args.h\"\n\n";
+    names << license;
+
+    for (xml_node<> * commands_node = root_node->first_node("commands");
+        commands_node != nullptr;
+        commands_node = commands_node->next_sibling("commands"))
+    {
+        for (xml_node<> * command_node = commands_node->first_node("command");
+            command_node != nullptr;
+            command_node = command_node->next_sibling("command"))
+        {
+            const std::string name = command_node->first_node("proto")->first_node("name")->value();
+            std::vector<param> params;
+            for (xml_node<> * param_node = command_node->first_node("param");
+                param_node != nullptr;
+                param_node = param_node->next_sibling("param"))
+                params.push_back(parse_param(param_node));
+            // Calls without arguments are recorded with PRINT_CALL.
+            if (params.empty())
+                continue;
+
+            std::string signature = "void _capture_" + name + "(\n    struct print_args * a";
+            for (const param & p : params)
+                signature += ",\n    " + p.declaration;
+            signature += ")";
+
+            header << signature << ";\n\n";
+            source << signature << "\n{\n";
+            for (size_t i = 0; i < params.size(); ++i)
+                source << "    " << render_capture(params, i) << "\n";
+            source << "}\n\n";
+
+            names << "{\"" << name << "\", {";
+            const char * separator = "";
+            for (const param & p : params) {
+                names << separator << '"' << p.name << '"';
+                separator = ", ";
+            }
+            names << "}},\n";
+        }
+    }
+
+    header << "#ifdef __cplusplus\n"
+           << "}\n"
+           << "#endif\n\n"
+           << "#endif /* __ICD_PRINT_LAYER_ARGS_H */\n";
+
+    const std::string directory = argv[2];
+    for (const auto & output : {std::make_pair("icd_print_layer_args.h", &header),
+                                std::make_pair("icd_print_layer_args.c", &source),
+                                std::make_pair("icd_print_layer_arg_names.inc", &names)}) {
+        std::ofstream file(directory + "/" + output.first);
+        file << output.second->str();
+        if (!file) {
+            std::cerr << "Error: failed to write '" << directory << "/" << output.first << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -53,6 +53,7 @@ clInitLayer(
   if (!target_dispatch || !layer_dispatch_ret ||!num_entries_out || num_entries < sizeof(dispatch)/sizeof(dispatch.clGetPlatformIDs))
     return CL_INVALID_VALUE;
 
+  _init_trace();
   _init_dispatch();
 
   tdispatch = target_dispatch;
@@ -18,8 +18,10 @@
 
 #ifndef __ICD_PRINT_LAYER_H
 #define __ICD_PRINT_LAYER_H
+#include <stddef.h>
 #include <stdio.h>
 #include <CL/cl_layer.h>
+#include "icd_print_layer_args.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +33,35 @@ extern const struct _cl_icd_dispatch *tdispatch;
 
 extern void _init_dispatch(void);
 
+/* Reads the settings and opens the trace, if any. */
+extern void _init_trace(void);
+
+/* Prints name, or records a call to the entry point with index id in
+ * struct _cl_icd_dispatch in the binary trace, along with its arguments
+ * if args is not NULL. */
+extern void _trace_call(unsigned id, const char *name, const struct print_args *args);
+
+/* Returns an empty buffer to capture the arguments of a call in, or NULL
+ * when arguments are not recorded. */
+extern struct print_args *_trace_args(void);
+
+/* Records the return from the entry point with index id in the binary
+ * trace. */
+extern void _trace_return(unsigned id);
+
+#define PRINT_LAYER_ID(name) \
+    ((unsigned)(offsetof(struct _cl_icd_dispatch, name) / sizeof(void *)))
+#define PRINT_CALL(name) _trace_call(PRINT_LAYER_ID(name), #name, NULL)
+/* Captures the arguments with _capture_<name>, generated from cl-avl.xml. */
+#define PRINT_CALL_ARGS(name, ...) \
+    do { \
+        struct print_args *_args = _trace_args(); \
+        if (_args != NULL) \
+            _capture_##name(_args, __VA_ARGS__); \
+        _trace_call(PRINT_LAYER_ID(name), #name, _args); \
+    } while (0)
+#define PRINT_RETURN(name) _trace_return(PRINT_LAYER_ID(name))
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,11 +25,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetPlatformIDs_wrap(
     cl_platform_id* platforms,
     cl_uint* num_platforms)
 {
-printf("clGetPlatformIDs\n");
-return tdispatch->clGetPlatformIDs(
+PRINT_CALL_ARGS(clGetPlatformIDs, num_entries, platforms, num_platforms);
+cl_int result = tdispatch->clGetPlatformIDs(
             num_entries,
             platforms,
             num_platforms);
+PRINT_RETURN(clGetPlatformIDs);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -40,13 +42,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetPlatformInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetPlatformInfo\n");
-return tdispatch->clGetPlatformInfo(
+PRINT_CALL_ARGS(clGetPlatformInfo, platform, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetPlatformInfo(
             platform,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetPlatformInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -57,13 +61,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDs_wrap(
     cl_device_id* devices,
     cl_uint* num_devices)
 {
-printf("clGetDeviceIDs\n");
-return tdispatch->clGetDeviceIDs(
+PRINT_CALL_ARGS(clGetDeviceIDs, platform, device_type, num_entries, devices, num_devices);
+cl_int result = tdispatch->clGetDeviceIDs(
             platform,
             device_type,
             num_entries,
             devices,
             num_devices);
+PRINT_RETURN(clGetDeviceIDs);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -74,13 +80,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetDeviceInfo\n");
-return tdispatch->clGetDeviceInfo(
+PRINT_CALL_ARGS(clGetDeviceInfo, device, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetDeviceInfo(
             device,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetDeviceInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -92,14 +100,16 @@ static CL_API_ENTRY cl_context CL_API_CALL clCreateContext_wrap(
     void* user_data,
     cl_int* errcode_ret)
 {
-printf("clCreateContext\n");
-return tdispatch->clCreateContext(
+PRINT_CALL_ARGS(clCreateContext, properties, num_devices, devices, pfn_notify, user_data, errcode_ret);
+cl_context result = tdispatch->clCreateContext(
             properties,
             num_devices,
             devices,
             pfn_notify,
             user_data,
             errcode_ret);
+PRINT_RETURN(clCreateContext);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -110,31 +120,37 @@ static CL_API_ENTRY cl_context CL_API_CALL clCreateContextFromType_wrap(
     void* user_data,
     cl_int* errcode_ret)
 {
-printf("clCreateContextFromType\n");
-return tdispatch->clCreateContextFromType(
+PRINT_CALL_ARGS(clCreateContextFromType, properties, device_type, pfn_notify, user_data, errcode_ret);
+cl_context result = tdispatch->clCreateContextFromType(
             properties,
             device_type,
             pfn_notify,
             user_data,
             errcode_ret);
+PRINT_RETURN(clCreateContextFromType);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainContext_wrap(
     cl_context context)
 {
-printf("clRetainContext\n");
-return tdispatch->clRetainContext(
+PRINT_CALL_ARGS(clRetainContext, context);
+cl_int result = tdispatch->clRetainContext(
             context);
+PRINT_RETURN(clRetainContext);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseContext_wrap(
     cl_context context)
 {
-printf("clReleaseContext\n");
-return tdispatch->clReleaseContext(
+PRINT_CALL_ARGS(clReleaseContext, context);
+cl_int result = tdispatch->clReleaseContext(
             context);
+PRINT_RETURN(clReleaseContext);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -145,31 +161,37 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetContextInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetContextInfo\n");
-return tdispatch->clGetContextInfo(
+PRINT_CALL_ARGS(clGetContextInfo, context, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetContextInfo(
             context,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetContextInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue_wrap(
     cl_command_queue command_queue)
 {
-printf("clRetainCommandQueue\n");
-return tdispatch->clRetainCommandQueue(
+PRINT_CALL_ARGS(clRetainCommandQueue, command_queue);
+cl_int result = tdispatch->clRetainCommandQueue(
             command_queue);
+PRINT_RETURN(clRetainCommandQueue);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue_wrap(
     cl_command_queue command_queue)
 {
-printf("clReleaseCommandQueue\n");
-return tdispatch->clReleaseCommandQueue(
+PRINT_CALL_ARGS(clReleaseCommandQueue, command_queue);
+cl_int result = tdispatch->clReleaseCommandQueue(
             command_queue);
+PRINT_RETURN(clReleaseCommandQueue);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -180,13 +202,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetCommandQueueInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetCommandQueueInfo\n");
-return tdispatch->clGetCommandQueueInfo(
+PRINT_CALL_ARGS(clGetCommandQueueInfo, command_queue, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetCommandQueueInfo(
             command_queue,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetCommandQueueInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -197,31 +221,37 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateBuffer\n");
-return tdispatch->clCreateBuffer(
+PRINT_CALL_ARGS(clCreateBuffer, context, flags, size, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateBuffer(
             context,
             flags,
             size,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainMemObject_wrap(
     cl_mem memobj)
 {
-printf("clRetainMemObject\n");
-return tdispatch->clRetainMemObject(
+PRINT_CALL_ARGS(clRetainMemObject, memobj);
+cl_int result = tdispatch->clRetainMemObject(
             memobj);
+PRINT_RETURN(clRetainMemObject);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject_wrap(
     cl_mem memobj)
 {
-printf("clReleaseMemObject\n");
-return tdispatch->clReleaseMemObject(
+PRINT_CALL_ARGS(clReleaseMemObject, memobj);
+cl_int result = tdispatch->clReleaseMemObject(
             memobj);
+PRINT_RETURN(clReleaseMemObject);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -233,14 +263,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetSupportedImageFormats_wrap(
     cl_image_format* image_formats,
     cl_uint* num_image_formats)
 {
-printf("clGetSupportedImageFormats\n");
-return tdispatch->clGetSupportedImageFormats(
+PRINT_CALL_ARGS(clGetSupportedImageFormats, context, flags, image_type, num_entries, image_formats, num_image_formats);
+cl_int result = tdispatch->clGetSupportedImageFormats(
             context,
             flags,
             image_type,
             num_entries,
             image_formats,
             num_image_formats);
+PRINT_RETURN(clGetSupportedImageFormats);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -251,13 +283,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetMemObjectInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetMemObjectInfo\n");
-return tdispatch->clGetMemObjectInfo(
+PRINT_CALL_ARGS(clGetMemObjectInfo, memobj, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetMemObjectInfo(
             memobj,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetMemObjectInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -268,31 +302,37 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetImageInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetImageInfo\n");
-return tdispatch->clGetImageInfo(
+PRINT_CALL_ARGS(clGetImageInfo, image, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetImageInfo(
             image,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetImageInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainSampler_wrap(
     cl_sampler sampler)
 {
-printf("clRetainSampler\n");
-return tdispatch->clRetainSampler(
+PRINT_CALL_ARGS(clRetainSampler, sampler);
+cl_int result = tdispatch->clRetainSampler(
             sampler);
+PRINT_RETURN(clRetainSampler);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseSampler_wrap(
     cl_sampler sampler)
 {
-printf("clReleaseSampler\n");
-return tdispatch->clReleaseSampler(
+PRINT_CALL_ARGS(clReleaseSampler, sampler);
+cl_int result = tdispatch->clReleaseSampler(
             sampler);
+PRINT_RETURN(clReleaseSampler);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -303,13 +343,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetSamplerInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetSamplerInfo\n");
-return tdispatch->clGetSamplerInfo(
+PRINT_CALL_ARGS(clGetSamplerInfo, sampler, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetSamplerInfo(
             sampler,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetSamplerInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -320,13 +362,15 @@ static CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource_wrap(
     const size_t* lengths,
     cl_int* errcode_ret)
 {
-printf("clCreateProgramWithSource\n");
-return tdispatch->clCreateProgramWithSource(
+PRINT_CALL_ARGS(clCreateProgramWithSource, context, count, strings, lengths, errcode_ret);
+cl_program result = tdispatch->clCreateProgramWithSource(
             context,
             count,
             strings,
             lengths,
             errcode_ret);
+PRINT_RETURN(clCreateProgramWithSource);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -339,8 +383,8 @@ static CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary_wrap(
     cl_int* binary_status,
     cl_int* errcode_ret)
 {
-printf("clCreateProgramWithBinary\n");
-return tdispatch->clCreateProgramWithBinary(
+PRINT_CALL_ARGS(clCreateProgramWithBinary, context, num_devices, device_list, lengths, binaries, binary_status, errcode_ret);
+cl_program result = tdispatch->clCreateProgramWithBinary(
             context,
             num_devices,
             device_list,
@@ -348,24 +392,30 @@ return tdispatch->clCreateProgramWithBinary(
             binaries,
             binary_status,
             errcode_ret);
+PRINT_RETURN(clCreateProgramWithBinary);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainProgram_wrap(
     cl_program program)
 {
-printf("clRetainProgram\n");
-return tdispatch->clRetainProgram(
+PRINT_CALL_ARGS(clRetainProgram, program);
+cl_int result = tdispatch->clRetainProgram(
             program);
+PRINT_RETURN(clRetainProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram_wrap(
     cl_program program)
 {
-printf("clReleaseProgram\n");
-return tdispatch->clReleaseProgram(
+PRINT_CALL_ARGS(clReleaseProgram, program);
+cl_int result = tdispatch->clReleaseProgram(
             program);
+PRINT_RETURN(clReleaseProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -377,14 +427,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clBuildProgram_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
     void* user_data)
 {
-printf("clBuildProgram\n");
-return tdispatch->clBuildProgram(
+PRINT_CALL_ARGS(clBuildProgram, program, num_devices, device_list, options, pfn_notify, user_data);
+cl_int result = tdispatch->clBuildProgram(
             program,
             num_devices,
             device_list,
             options,
             pfn_notify,
             user_data);
+PRINT_RETURN(clBuildProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -395,13 +447,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetProgramInfo\n");
-return tdispatch->clGetProgramInfo(
+PRINT_CALL_ARGS(clGetProgramInfo, program, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetProgramInfo(
             program,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetProgramInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -413,14 +467,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetProgramBuildInfo\n");
-return tdispatch->clGetProgramBuildInfo(
+PRINT_CALL_ARGS(clGetProgramBuildInfo, program, device, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetProgramBuildInfo(
             program,
             device,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetProgramBuildInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -429,11 +485,13 @@ static CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel_wrap(
     const char* kernel_name,
     cl_int* errcode_ret)
 {
-printf("clCreateKernel\n");
-return tdispatch->clCreateKernel(
+PRINT_CALL_ARGS(clCreateKernel, program, kernel_name, errcode_ret);
+cl_kernel result = tdispatch->clCreateKernel(
             program,
             kernel_name,
             errcode_ret);
+PRINT_RETURN(clCreateKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -443,30 +501,36 @@ static CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram_wrap(
     cl_kernel* kernels,
     cl_uint* num_kernels_ret)
 {
-printf("clCreateKernelsInProgram\n");
-return tdispatch->clCreateKernelsInProgram(
+PRINT_CALL_ARGS(clCreateKernelsInProgram, program, num_kernels, kernels, num_kernels_ret);
+cl_int result = tdispatch->clCreateKernelsInProgram(
             program,
             num_kernels,
             kernels,
             num_kernels_ret);
+PRINT_RETURN(clCreateKernelsInProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainKernel_wrap(
     cl_kernel kernel)
 {
-printf("clRetainKernel\n");
-return tdispatch->clRetainKernel(
+PRINT_CALL_ARGS(clRetainKernel, kernel);
+cl_int result = tdispatch->clRetainKernel(
             kernel);
+PRINT_RETURN(clRetainKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel_wrap(
     cl_kernel kernel)
 {
-printf("clReleaseKernel\n");
-return tdispatch->clReleaseKernel(
+PRINT_CALL_ARGS(clReleaseKernel, kernel);
+cl_int result = tdispatch->clReleaseKernel(
             kernel);
+PRINT_RETURN(clReleaseKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -476,12 +540,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg_wrap(
     size_t arg_size,
     const void* arg_value)
 {
-printf("clSetKernelArg\n");
-return tdispatch->clSetKernelArg(
+PRINT_CALL_ARGS(clSetKernelArg, kernel, arg_index, arg_size, arg_value);
+cl_int result = tdispatch->clSetKernelArg(
             kernel,
             arg_index,
             arg_size,
             arg_value);
+PRINT_RETURN(clSetKernelArg);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -492,13 +558,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetKernelInfo\n");
-return tdispatch->clGetKernelInfo(
+PRINT_CALL_ARGS(clGetKernelInfo, kernel, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetKernelInfo(
             kernel,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetKernelInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -510,14 +578,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetKernelWorkGroupInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetKernelWorkGroupInfo\n");
-return tdispatch->clGetKernelWorkGroupInfo(
+PRINT_CALL_ARGS(clGetKernelWorkGroupInfo, kernel, device, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetKernelWorkGroupInfo(
             kernel,
             device,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetKernelWorkGroupInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -525,10 +595,12 @@ static CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents_wrap(
     cl_uint num_events,
     const cl_event* event_list)
 {
-printf("clWaitForEvents\n");
-return tdispatch->clWaitForEvents(
+PRINT_CALL_ARGS(clWaitForEvents, num_events, event_list);
+cl_int result = tdispatch->clWaitForEvents(
             num_events,
             event_list);
+PRINT_RETURN(clWaitForEvents);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -539,31 +611,37 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetEventInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetEventInfo\n");
-return tdispatch->clGetEventInfo(
+PRINT_CALL_ARGS(clGetEventInfo, event, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetEventInfo(
             event,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetEventInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainEvent_wrap(
     cl_event event)
 {
-printf("clRetainEvent\n");
-return tdispatch->clRetainEvent(
+PRINT_CALL_ARGS(clRetainEvent, event);
+cl_int result = tdispatch->clRetainEvent(
             event);
+PRINT_RETURN(clRetainEvent);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseEvent_wrap(
     cl_event event)
 {
-printf("clReleaseEvent\n");
-return tdispatch->clReleaseEvent(
+PRINT_CALL_ARGS(clReleaseEvent, event);
+cl_int result = tdispatch->clReleaseEvent(
             event);
+PRINT_RETURN(clReleaseEvent);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -574,31 +652,37 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetEventProfilingInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetEventProfilingInfo\n");
-return tdispatch->clGetEventProfilingInfo(
+PRINT_CALL_ARGS(clGetEventProfilingInfo, event, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetEventProfilingInfo(
             event,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetEventProfilingInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clFlush_wrap(
     cl_command_queue command_queue)
 {
-printf("clFlush\n");
-return tdispatch->clFlush(
+PRINT_CALL_ARGS(clFlush, command_queue);
+cl_int result = tdispatch->clFlush(
             command_queue);
+PRINT_RETURN(clFlush);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clFinish_wrap(
     cl_command_queue command_queue)
 {
-printf("clFinish\n");
-return tdispatch->clFinish(
+PRINT_CALL_ARGS(clFinish, command_queue);
+cl_int result = tdispatch->clFinish(
             command_queue);
+PRINT_RETURN(clFinish);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -613,8 +697,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReadBuffer\n");
-return tdispatch->clEnqueueReadBuffer(
+PRINT_CALL_ARGS(clEnqueueReadBuffer, command_queue, buffer, blocking_read, offset, size, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueReadBuffer(
             command_queue,
             buffer,
             blocking_read,
@@ -624,6 +708,8 @@ return tdispatch->clEnqueueReadBuffer(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReadBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -638,8 +724,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueWriteBuffer\n");
-return tdispatch->clEnqueueWriteBuffer(
+PRINT_CALL_ARGS(clEnqueueWriteBuffer, command_queue, buffer, blocking_write, offset, size, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueWriteBuffer(
             command_queue,
             buffer,
             blocking_write,
@@ -649,6 +735,8 @@ return tdispatch->clEnqueueWriteBuffer(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueWriteBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -663,8 +751,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueCopyBuffer\n");
-return tdispatch->clEnqueueCopyBuffer(
+PRINT_CALL_ARGS(clEnqueueCopyBuffer, command_queue, src_buffer, dst_buffer, src_offset, dst_offset, size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueCopyBuffer(
             command_queue,
             src_buffer,
             dst_buffer,
@@ -674,6 +762,8 @@ return tdispatch->clEnqueueCopyBuffer(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueCopyBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -690,8 +780,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadImage_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReadImage\n");
-return tdispatch->clEnqueueReadImage(
+PRINT_CALL_ARGS(clEnqueueReadImage, command_queue, image, blocking_read, origin, region, row_pitch, slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueReadImage(
             command_queue,
             image,
             blocking_read,
@@ -703,6 +793,8 @@ return tdispatch->clEnqueueReadImage(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReadImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -719,8 +811,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteImage_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueWriteImage\n");
-return tdispatch->clEnqueueWriteImage(
+PRINT_CALL_ARGS(clEnqueueWriteImage, command_queue, image, blocking_write, origin, region, input_row_pitch, input_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueWriteImage(
             command_queue,
             image,
             blocking_write,
@@ -732,6 +824,8 @@ return tdispatch->clEnqueueWriteImage(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueWriteImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -746,8 +840,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImage_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueCopyImage\n");
-return tdispatch->clEnqueueCopyImage(
+PRINT_CALL_ARGS(clEnqueueCopyImage, command_queue, src_image, dst_image, src_origin, dst_origin, region, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueCopyImage(
             command_queue,
             src_image,
             dst_image,
@@ -757,6 +851,8 @@ return tdispatch->clEnqueueCopyImage(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueCopyImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -771,8 +867,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImageToBuffer_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueCopyImageToBuffer\n");
-return tdispatch->clEnqueueCopyImageToBuffer(
+PRINT_CALL_ARGS(clEnqueueCopyImageToBuffer, command_queue, src_image, dst_buffer, src_origin, region, dst_offset, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueCopyImageToBuffer(
             command_queue,
             src_image,
             dst_buffer,
@@ -782,6 +878,8 @@ return tdispatch->clEnqueueCopyImageToBuffer(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueCopyImageToBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -796,8 +894,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferToImage_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueCopyBufferToImage\n");
-return tdispatch->clEnqueueCopyBufferToImage(
+PRINT_CALL_ARGS(clEnqueueCopyBufferToImage, command_queue, src_buffer, dst_image, src_offset, dst_origin, region, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueCopyBufferToImage(
             command_queue,
             src_buffer,
             dst_image,
@@ -807,6 +905,8 @@ return tdispatch->clEnqueueCopyBufferToImage(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueCopyBufferToImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -822,8 +922,8 @@ static CL_API_ENTRY void* CL_API_CALL clEnqueueMapBuffer_wrap(
     cl_event* event,
     cl_int* errcode_ret)
 {
-printf("clEnqueueMapBuffer\n");
-return tdispatch->clEnqueueMapBuffer(
+PRINT_CALL_ARGS(clEnqueueMapBuffer, command_queue, buffer, blocking_map, map_flags, offset, size, num_events_in_wait_list, event_wait_list, event, errcode_ret);
+void* result = tdispatch->clEnqueueMapBuffer(
             command_queue,
             buffer,
             blocking_map,
@@ -834,6 +934,8 @@ return tdispatch->clEnqueueMapBuffer(
             event_wait_list,
             event,
             errcode_ret);
+PRINT_RETURN(clEnqueueMapBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -851,8 +953,8 @@ static CL_API_ENTRY void* CL_API_CALL clEnqueueMapImage_wrap(
     cl_event* event,
     cl_int* errcode_ret)
 {
-printf("clEnqueueMapImage\n");
-return tdispatch->clEnqueueMapImage(
+PRINT_CALL_ARGS(clEnqueueMapImage, command_queue, image, blocking_map, map_flags, origin, region, image_row_pitch, image_slice_pitch, num_events_in_wait_list, event_wait_list, event, errcode_ret);
+void* result = tdispatch->clEnqueueMapImage(
             command_queue,
             image,
             blocking_map,
@@ -865,6 +967,8 @@ return tdispatch->clEnqueueMapImage(
             event_wait_list,
             event,
             errcode_ret);
+PRINT_RETURN(clEnqueueMapImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -876,14 +980,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueUnmapMemObject_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueUnmapMemObject\n");
-return tdispatch->clEnqueueUnmapMemObject(
+PRINT_CALL_ARGS(clEnqueueUnmapMemObject, command_queue, memobj, mapped_ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueUnmapMemObject(
             command_queue,
             memobj,
             mapped_ptr,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueUnmapMemObject);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -898,8 +1004,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueNDRangeKernel\n");
-return tdispatch->clEnqueueNDRangeKernel(
+PRINT_CALL_ARGS(clEnqueueNDRangeKernel, command_queue, kernel, work_dim, global_work_offset, global_work_size, local_work_size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueNDRangeKernel(
             command_queue,
             kernel,
             work_dim,
@@ -909,6 +1015,8 @@ return tdispatch->clEnqueueNDRangeKernel(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueNDRangeKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -924,8 +1032,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueNativeKernel_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueNativeKernel\n");
-return tdispatch->clEnqueueNativeKernel(
+PRINT_CALL_ARGS(clEnqueueNativeKernel, command_queue, user_func, args, cb_args, num_mem_objects, mem_list, args_mem_loc, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueNativeKernel(
             command_queue,
             user_func,
             args,
@@ -936,6 +1044,8 @@ return tdispatch->clEnqueueNativeKernel(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueNativeKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -945,12 +1055,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetCommandQueueProperty_wrap(
     cl_bool enable,
     cl_command_queue_properties* old_properties)
 {
-printf("clSetCommandQueueProperty\n");
-return tdispatch->clSetCommandQueueProperty(
+PRINT_CALL_ARGS(clSetCommandQueueProperty, command_queue, properties, enable, old_properties);
+cl_int result = tdispatch->clSetCommandQueueProperty(
             command_queue,
             properties,
             enable,
             old_properties);
+PRINT_RETURN(clSetCommandQueueProperty);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -964,8 +1076,8 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateImage2D_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateImage2D\n");
-return tdispatch->clCreateImage2D(
+PRINT_CALL_ARGS(clCreateImage2D, context, flags, image_format, image_width, image_height, image_row_pitch, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateImage2D(
             context,
             flags,
             image_format,
@@ -974,6 +1086,8 @@ return tdispatch->clCreateImage2D(
             image_row_pitch,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateImage2D);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -989,8 +1103,8 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateImage3D_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateImage3D\n");
-return tdispatch->clCreateImage3D(
+PRINT_CALL_ARGS(clCreateImage3D, context, flags, image_format, image_width, image_height, image_depth, image_row_pitch, image_slice_pitch, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateImage3D(
             context,
             flags,
             image_format,
@@ -1001,6 +1115,8 @@ return tdispatch->clCreateImage3D(
             image_slice_pitch,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateImage3D);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1008,10 +1124,12 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarker_wrap(
     cl_command_queue command_queue,
     cl_event* event)
 {
-printf("clEnqueueMarker\n");
-return tdispatch->clEnqueueMarker(
+PRINT_CALL_ARGS(clEnqueueMarker, command_queue, event);
+cl_int result = tdispatch->clEnqueueMarker(
             command_queue,
             event);
+PRINT_RETURN(clEnqueueMarker);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1020,38 +1138,46 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueWaitForEvents_wrap(
     cl_uint num_events,
     const cl_event* event_list)
 {
-printf("clEnqueueWaitForEvents\n");
-return tdispatch->clEnqueueWaitForEvents(
+PRINT_CALL_ARGS(clEnqueueWaitForEvents, command_queue, num_events, event_list);
+cl_int result = tdispatch->clEnqueueWaitForEvents(
             command_queue,
             num_events,
             event_list);
+PRINT_RETURN(clEnqueueWaitForEvents);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrier_wrap(
     cl_command_queue command_queue)
 {
-printf("clEnqueueBarrier\n");
-return tdispatch->clEnqueueBarrier(
+PRINT_CALL_ARGS(clEnqueueBarrier, command_queue);
+cl_int result = tdispatch->clEnqueueBarrier(
             command_queue);
+PRINT_RETURN(clEnqueueBarrier);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clUnloadCompiler_wrap(
     void )
 {
-printf("clUnloadCompiler\n");
-return tdispatch->clUnloadCompiler(
+PRINT_CALL(clUnloadCompiler);
+cl_int result = tdispatch->clUnloadCompiler(
             );
+PRINT_RETURN(clUnloadCompiler);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress_wrap(
     const char* func_name)
 {
-printf("clGetExtensionFunctionAddress\n");
-return tdispatch->clGetExtensionFunctionAddress(
+PRINT_CALL(clGetExtensionFunctionAddress);
+void* result = tdispatch->clGetExtensionFunctionAddress(
             func_name);
+PRINT_RETURN(clGetExtensionFunctionAddress);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1061,12 +1187,14 @@ static CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue_wrap(
     cl_command_queue_properties properties,
     cl_int* errcode_ret)
 {
-printf("clCreateCommandQueue\n");
-return tdispatch->clCreateCommandQueue(
+PRINT_CALL_ARGS(clCreateCommandQueue, context, device, properties, errcode_ret);
+cl_command_queue result = tdispatch->clCreateCommandQueue(
             context,
             device,
             properties,
             errcode_ret);
+PRINT_RETURN(clCreateCommandQueue);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1077,13 +1205,15 @@ static CL_API_ENTRY cl_sampler CL_API_CALL clCreateSampler_wrap(
     cl_filter_mode filter_mode,
     cl_int* errcode_ret)
 {
-printf("clCreateSampler\n");
-return tdispatch->clCreateSampler(
+PRINT_CALL_ARGS(clCreateSampler, context, normalized_coords, addressing_mode, filter_mode, errcode_ret);
+cl_sampler result = tdispatch->clCreateSampler(
             context,
             normalized_coords,
             addressing_mode,
             filter_mode,
             errcode_ret);
+PRINT_RETURN(clCreateSampler);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1094,13 +1224,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueTask\n");
-return tdispatch->clEnqueueTask(
+PRINT_CALL_ARGS(clEnqueueTask, command_queue, kernel, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueTask(
             command_queue,
             kernel,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueTask);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1111,13 +1243,15 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateSubBuffer_wrap(
     const void* buffer_create_info,
     cl_int* errcode_ret)
 {
-printf("clCreateSubBuffer\n");
-return tdispatch->clCreateSubBuffer(
+PRINT_CALL_ARGS(clCreateSubBuffer, buffer, flags, buffer_create_type, buffer_create_info, errcode_ret);
+cl_mem result = tdispatch->clCreateSubBuffer(
             buffer,
             flags,
             buffer_create_type,
             buffer_create_info,
             errcode_ret);
+PRINT_RETURN(clCreateSubBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1126,11 +1260,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetMemObjectDestructorCallback_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_mem memobj, void* user_data),
     void* user_data)
 {
-printf("clSetMemObjectDestructorCallback\n");
-return tdispatch->clSetMemObjectDestructorCallback(
+PRINT_CALL_ARGS(clSetMemObjectDestructorCallback, memobj, pfn_notify, user_data);
+cl_int result = tdispatch->clSetMemObjectDestructorCallback(
             memobj,
             pfn_notify,
             user_data);
+PRINT_RETURN(clSetMemObjectDestructorCallback);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1138,10 +1274,12 @@ static CL_API_ENTRY cl_event CL_API_CALL clCreateUserEvent_wrap(
     cl_context context,
     cl_int* errcode_ret)
 {
-printf("clCreateUserEvent\n");
-return tdispatch->clCreateUserEvent(
+PRINT_CALL_ARGS(clCreateUserEvent, context, errcode_ret);
+cl_event result = tdispatch->clCreateUserEvent(
             context,
             errcode_ret);
+PRINT_RETURN(clCreateUserEvent);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1149,10 +1287,12 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetUserEventStatus_wrap(
     cl_event event,
     cl_int execution_status)
 {
-printf("clSetUserEventStatus\n");
-return tdispatch->clSetUserEventStatus(
+PRINT_CALL_ARGS(clSetUserEventStatus, event, execution_status);
+cl_int result = tdispatch->clSetUserEventStatus(
             event,
             execution_status);
+PRINT_RETURN(clSetUserEventStatus);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1162,12 +1302,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetEventCallback_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_event event, cl_int event_command_status, void *user_data),
     void* user_data)
 {
-printf("clSetEventCallback\n");
-return tdispatch->clSetEventCallback(
+PRINT_CALL_ARGS(clSetEventCallback, event, command_exec_callback_type, pfn_notify, user_data);
+cl_int result = tdispatch->clSetEventCallback(
             event,
             command_exec_callback_type,
             pfn_notify,
             user_data);
+PRINT_RETURN(clSetEventCallback);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1187,8 +1329,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBufferRect_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReadBufferRect\n");
-return tdispatch->clEnqueueReadBufferRect(
+PRINT_CALL_ARGS(clEnqueueReadBufferRect, command_queue, buffer, blocking_read, buffer_origin, host_origin, region, buffer_row_pitch, buffer_slice_pitch, host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueReadBufferRect(
             command_queue,
             buffer,
             blocking_read,
@@ -1203,6 +1345,8 @@ return tdispatch->clEnqueueReadBufferRect(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReadBufferRect);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1222,8 +1366,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBufferRect_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueWriteBufferRect\n");
-return tdispatch->clEnqueueWriteBufferRect(
+PRINT_CALL_ARGS(clEnqueueWriteBufferRect, command_queue, buffer, blocking_write, buffer_origin, host_origin, region, buffer_row_pitch, buffer_slice_pitch, host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueWriteBufferRect(
             command_queue,
             buffer,
             blocking_write,
@@ -1238,6 +1382,8 @@ return tdispatch->clEnqueueWriteBufferRect(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueWriteBufferRect);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1256,8 +1402,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferRect_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueCopyBufferRect\n");
-return tdispatch->clEnqueueCopyBufferRect(
+PRINT_CALL_ARGS(clEnqueueCopyBufferRect, command_queue, src_buffer, dst_buffer, src_origin, dst_origin, region, src_row_pitch, src_slice_pitch, dst_row_pitch, dst_slice_pitch, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueCopyBufferRect(
             command_queue,
             src_buffer,
             dst_buffer,
@@ -1271,6 +1417,8 @@ return tdispatch->clEnqueueCopyBufferRect(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueCopyBufferRect);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1281,31 +1429,37 @@ static CL_API_ENTRY cl_int CL_API_CALL clCreateSubDevices_wrap(
     cl_device_id* out_devices,
     cl_uint* num_devices_ret)
 {
-printf("clCreateSubDevices\n");
-return tdispatch->clCreateSubDevices(
+PRINT_CALL_ARGS(clCreateSubDevices, in_device, properties, num_devices, out_devices, num_devices_ret);
+cl_int result = tdispatch->clCreateSubDevices(
             in_device,
             properties,
             num_devices,
             out_devices,
             num_devices_ret);
+PRINT_RETURN(clCreateSubDevices);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clRetainDevice_wrap(
     cl_device_id device)
 {
-printf("clRetainDevice\n");
-return tdispatch->clRetainDevice(
+PRINT_CALL_ARGS(clRetainDevice, device);
+cl_int result = tdispatch->clRetainDevice(
             device);
+PRINT_RETURN(clRetainDevice);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseDevice_wrap(
     cl_device_id device)
 {
-printf("clReleaseDevice\n");
-return tdispatch->clReleaseDevice(
+PRINT_CALL_ARGS(clReleaseDevice, device);
+cl_int result = tdispatch->clReleaseDevice(
             device);
+PRINT_RETURN(clReleaseDevice);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1317,14 +1471,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateImage_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateImage\n");
-return tdispatch->clCreateImage(
+PRINT_CALL_ARGS(clCreateImage, context, flags, image_format, image_desc, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateImage(
             context,
             flags,
             image_format,
             image_desc,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1335,13 +1491,15 @@ static CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBuiltInKernels_wra
     const char* kernel_names,
     cl_int* errcode_ret)
 {
-printf("clCreateProgramWithBuiltInKernels\n");
-return tdispatch->clCreateProgramWithBuiltInKernels(
+PRINT_CALL_ARGS(clCreateProgramWithBuiltInKernels, context, num_devices, device_list, kernel_names, errcode_ret);
+cl_program result = tdispatch->clCreateProgramWithBuiltInKernels(
             context,
             num_devices,
             device_list,
             kernel_names,
             errcode_ret);
+PRINT_RETURN(clCreateProgramWithBuiltInKernels);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1356,8 +1514,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clCompileProgram_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
     void* user_data)
 {
-printf("clCompileProgram\n");
-return tdispatch->clCompileProgram(
+PRINT_CALL_ARGS(clCompileProgram, program, num_devices, device_list, options, num_input_headers, input_headers, header_include_names, pfn_notify, user_data);
+cl_int result = tdispatch->clCompileProgram(
             program,
             num_devices,
             device_list,
@@ -1367,6 +1525,8 @@ return tdispatch->clCompileProgram(
             header_include_names,
             pfn_notify,
             user_data);
+PRINT_RETURN(clCompileProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1381,8 +1541,8 @@ static CL_API_ENTRY cl_program CL_API_CALL clLinkProgram_wrap(
     void* user_data,
     cl_int* errcode_ret)
 {
-printf("clLinkProgram\n");
-return tdispatch->clLinkProgram(
+PRINT_CALL_ARGS(clLinkProgram, context, num_devices, device_list, options, num_input_programs, input_programs, pfn_notify, user_data, errcode_ret);
+cl_program result = tdispatch->clLinkProgram(
             context,
             num_devices,
             device_list,
@@ -1392,15 +1552,19 @@ return tdispatch->clLinkProgram(
             pfn_notify,
             user_data,
             errcode_ret);
+PRINT_RETURN(clLinkProgram);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 static CL_API_ENTRY cl_int CL_API_CALL clUnloadPlatformCompiler_wrap(
     cl_platform_id platform)
 {
-printf("clUnloadPlatformCompiler\n");
-return tdispatch->clUnloadPlatformCompiler(
+PRINT_CALL_ARGS(clUnloadPlatformCompiler, platform);
+cl_int result = tdispatch->clUnloadPlatformCompiler(
             platform);
+PRINT_RETURN(clUnloadPlatformCompiler);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1412,14 +1576,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetKernelArgInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetKernelArgInfo\n");
-return tdispatch->clGetKernelArgInfo(
+PRINT_CALL_ARGS(clGetKernelArgInfo, kernel, arg_index, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetKernelArgInfo(
             kernel,
             arg_index,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetKernelArgInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1434,8 +1600,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillBuffer_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueFillBuffer\n");
-return tdispatch->clEnqueueFillBuffer(
+PRINT_CALL_ARGS(clEnqueueFillBuffer, command_queue, buffer, pattern, pattern_size, offset, size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueFillBuffer(
             command_queue,
             buffer,
             pattern,
@@ -1445,6 +1611,8 @@ return tdispatch->clEnqueueFillBuffer(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueFillBuffer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1458,8 +1626,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillImage_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueFillImage\n");
-return tdispatch->clEnqueueFillImage(
+PRINT_CALL_ARGS(clEnqueueFillImage, command_queue, image, fill_color, origin, region, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueFillImage(
             command_queue,
             image,
             fill_color,
@@ -1468,6 +1636,8 @@ return tdispatch->clEnqueueFillImage(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueFillImage);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1480,8 +1650,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueMigrateMemObjects_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueMigrateMemObjects\n");
-return tdispatch->clEnqueueMigrateMemObjects(
+PRINT_CALL_ARGS(clEnqueueMigrateMemObjects, command_queue, num_mem_objects, mem_objects, flags, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueMigrateMemObjects(
             command_queue,
             num_mem_objects,
             mem_objects,
@@ -1489,6 +1659,8 @@ return tdispatch->clEnqueueMigrateMemObjects(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueMigrateMemObjects);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1498,12 +1670,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarkerWithWaitList_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueMarkerWithWaitList\n");
-return tdispatch->clEnqueueMarkerWithWaitList(
+PRINT_CALL_ARGS(clEnqueueMarkerWithWaitList, command_queue, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueMarkerWithWaitList(
             command_queue,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueMarkerWithWaitList);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1513,12 +1687,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrierWithWaitList_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueBarrierWithWaitList\n");
-return tdispatch->clEnqueueBarrierWithWaitList(
+PRINT_CALL_ARGS(clEnqueueBarrierWithWaitList, command_queue, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueBarrierWithWaitList(
             command_queue,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueBarrierWithWaitList);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1526,10 +1702,12 @@ static CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddressForPlatform_w
     cl_platform_id platform,
     const char* func_name)
 {
-printf("clGetExtensionFunctionAddressForPlatform\n");
-return tdispatch->clGetExtensionFunctionAddressForPlatform(
+PRINT_CALL(clGetExtensionFunctionAddressForPlatform);
+void* result = tdispatch->clGetExtensionFunctionAddressForPlatform(
             platform,
             func_name);
+PRINT_RETURN(clGetExtensionFunctionAddressForPlatform);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1539,12 +1717,14 @@ static CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithPropert
     const cl_queue_properties* properties,
     cl_int* errcode_ret)
 {
-printf("clCreateCommandQueueWithProperties\n");
-return tdispatch->clCreateCommandQueueWithProperties(
+PRINT_CALL_ARGS(clCreateCommandQueueWithProperties, context, device, properties, errcode_ret);
+cl_command_queue result = tdispatch->clCreateCommandQueueWithProperties(
             context,
             device,
             properties,
             errcode_ret);
+PRINT_RETURN(clCreateCommandQueueWithProperties);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1556,14 +1736,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreatePipe_wrap(
     const cl_pipe_properties* properties,
     cl_int* errcode_ret)
 {
-printf("clCreatePipe\n");
-return tdispatch->clCreatePipe(
+PRINT_CALL_ARGS(clCreatePipe, context, flags, pipe_packet_size, pipe_max_packets, properties, errcode_ret);
+cl_mem result = tdispatch->clCreatePipe(
             context,
             flags,
             pipe_packet_size,
             pipe_max_packets,
             properties,
             errcode_ret);
+PRINT_RETURN(clCreatePipe);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1574,13 +1756,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetPipeInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetPipeInfo\n");
-return tdispatch->clGetPipeInfo(
+PRINT_CALL_ARGS(clGetPipeInfo, pipe, param_name, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetPipeInfo(
             pipe,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetPipeInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1590,12 +1774,14 @@ static CL_API_ENTRY void* CL_API_CALL clSVMAlloc_wrap(
     size_t size,
     cl_uint alignment)
 {
-printf("clSVMAlloc\n");
-return tdispatch->clSVMAlloc(
+PRINT_CALL_ARGS(clSVMAlloc, context, flags, size, alignment);
+void* result = tdispatch->clSVMAlloc(
             context,
             flags,
             size,
             alignment);
+PRINT_RETURN(clSVMAlloc);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1603,10 +1789,11 @@ static CL_API_ENTRY void CL_API_CALL clSVMFree_wrap(
     cl_context context,
     void* svm_pointer)
 {
-printf("clSVMFree\n");
+PRINT_CALL_ARGS(clSVMFree, context, svm_pointer);
 tdispatch->clSVMFree(
             context,
             svm_pointer);
+PRINT_RETURN(clSVMFree);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1615,11 +1802,13 @@ static CL_API_ENTRY cl_sampler CL_API_CALL clCreateSamplerWithProperties_wrap(
     const cl_sampler_properties* sampler_properties,
     cl_int* errcode_ret)
 {
-printf("clCreateSamplerWithProperties\n");
-return tdispatch->clCreateSamplerWithProperties(
+PRINT_CALL_ARGS(clCreateSamplerWithProperties, context, sampler_properties, errcode_ret);
+cl_sampler result = tdispatch->clCreateSamplerWithProperties(
             context,
             sampler_properties,
             errcode_ret);
+PRINT_RETURN(clCreateSamplerWithProperties);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1628,11 +1817,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer_wrap(
     cl_uint arg_index,
     const void* arg_value)
 {
-printf("clSetKernelArgSVMPointer\n");
-return tdispatch->clSetKernelArgSVMPointer(
+PRINT_CALL_ARGS(clSetKernelArgSVMPointer, kernel, arg_index, arg_value);
+cl_int result = tdispatch->clSetKernelArgSVMPointer(
             kernel,
             arg_index,
             arg_value);
+PRINT_RETURN(clSetKernelArgSVMPointer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1642,12 +1833,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetKernelExecInfo_wrap(
     size_t param_value_size,
     const void* param_value)
 {
-printf("clSetKernelExecInfo\n");
-return tdispatch->clSetKernelExecInfo(
+PRINT_CALL_ARGS(clSetKernelExecInfo, kernel, param_name, param_value_size, param_value);
+cl_int result = tdispatch->clSetKernelExecInfo(
             kernel,
             param_name,
             param_value_size,
             param_value);
+PRINT_RETURN(clSetKernelExecInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1661,8 +1854,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMFree_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMFree\n");
-return tdispatch->clEnqueueSVMFree(
+PRINT_CALL_ARGS(clEnqueueSVMFree, command_queue, num_svm_pointers, svm_pointers, pfn_free_func, user_data, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMFree(
             command_queue,
             num_svm_pointers,
             svm_pointers,
@@ -1671,6 +1864,8 @@ return tdispatch->clEnqueueSVMFree(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMFree);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1684,8 +1879,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemcpy_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMMemcpy\n");
-return tdispatch->clEnqueueSVMMemcpy(
+PRINT_CALL_ARGS(clEnqueueSVMMemcpy, command_queue, blocking_copy, dst_ptr, src_ptr, size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMMemcpy(
             command_queue,
             blocking_copy,
             dst_ptr,
@@ -1694,6 +1889,8 @@ return tdispatch->clEnqueueSVMMemcpy(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMMemcpy);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1707,8 +1904,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemFill_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMMemFill\n");
-return tdispatch->clEnqueueSVMMemFill(
+PRINT_CALL_ARGS(clEnqueueSVMMemFill, command_queue, svm_ptr, pattern, pattern_size, size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMMemFill(
             command_queue,
             svm_ptr,
             pattern,
@@ -1717,6 +1914,8 @@ return tdispatch->clEnqueueSVMMemFill(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMMemFill);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1730,8 +1929,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMap_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMMap\n");
-return tdispatch->clEnqueueSVMMap(
+PRINT_CALL_ARGS(clEnqueueSVMMap, command_queue, blocking_map, flags, svm_ptr, size, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMMap(
             command_queue,
             blocking_map,
             flags,
@@ -1740,6 +1939,8 @@ return tdispatch->clEnqueueSVMMap(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMMap);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1750,13 +1951,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMUnmap_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMUnmap\n");
-return tdispatch->clEnqueueSVMUnmap(
+PRINT_CALL_ARGS(clEnqueueSVMUnmap, command_queue, svm_ptr, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMUnmap(
             command_queue,
             svm_ptr,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMUnmap);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1765,11 +1968,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetDefaultDeviceCommandQueue_wrap(
     cl_device_id device,
     cl_command_queue command_queue)
 {
-printf("clSetDefaultDeviceCommandQueue\n");
-return tdispatch->clSetDefaultDeviceCommandQueue(
+PRINT_CALL_ARGS(clSetDefaultDeviceCommandQueue, context, device, command_queue);
+cl_int result = tdispatch->clSetDefaultDeviceCommandQueue(
             context,
             device,
             command_queue);
+PRINT_RETURN(clSetDefaultDeviceCommandQueue);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1778,11 +1983,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceAndHostTimer_wrap(
     cl_ulong* device_timestamp,
     cl_ulong* host_timestamp)
 {
-printf("clGetDeviceAndHostTimer\n");
-return tdispatch->clGetDeviceAndHostTimer(
+PRINT_CALL_ARGS(clGetDeviceAndHostTimer, device, device_timestamp, host_timestamp);
+cl_int result = tdispatch->clGetDeviceAndHostTimer(
             device,
             device_timestamp,
             host_timestamp);
+PRINT_RETURN(clGetDeviceAndHostTimer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1790,10 +1997,12 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetHostTimer_wrap(
     cl_device_id device,
     cl_ulong* host_timestamp)
 {
-printf("clGetHostTimer\n");
-return tdispatch->clGetHostTimer(
+PRINT_CALL_ARGS(clGetHostTimer, device, host_timestamp);
+cl_int result = tdispatch->clGetHostTimer(
             device,
             host_timestamp);
+PRINT_RETURN(clGetHostTimer);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1803,12 +2012,14 @@ static CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithIL_wrap(
     size_t length,
     cl_int* errcode_ret)
 {
-printf("clCreateProgramWithIL\n");
-return tdispatch->clCreateProgramWithIL(
+PRINT_CALL_ARGS(clCreateProgramWithIL, context, il, length, errcode_ret);
+cl_program result = tdispatch->clCreateProgramWithIL(
             context,
             il,
             length,
             errcode_ret);
+PRINT_RETURN(clCreateProgramWithIL);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1816,10 +2027,12 @@ static CL_API_ENTRY cl_kernel CL_API_CALL clCloneKernel_wrap(
     cl_kernel source_kernel,
     cl_int* errcode_ret)
 {
-printf("clCloneKernel\n");
-return tdispatch->clCloneKernel(
+PRINT_CALL_ARGS(clCloneKernel, source_kernel, errcode_ret);
+cl_kernel result = tdispatch->clCloneKernel(
             source_kernel,
             errcode_ret);
+PRINT_RETURN(clCloneKernel);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1833,8 +2046,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetKernelSubGroupInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetKernelSubGroupInfo\n");
-return tdispatch->clGetKernelSubGroupInfo(
+PRINT_CALL_ARGS(clGetKernelSubGroupInfo, kernel, device, param_name, input_value_size, input_value, param_value_size, param_value, param_value_size_ret);
+cl_int result = tdispatch->clGetKernelSubGroupInfo(
             kernel,
             device,
             param_name,
@@ -1843,6 +2056,8 @@ return tdispatch->clGetKernelSubGroupInfo(
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetKernelSubGroupInfo);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1856,8 +2071,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueSVMMigrateMem\n");
-return tdispatch->clEnqueueSVMMigrateMem(
+PRINT_CALL_ARGS(clEnqueueSVMMigrateMem, command_queue, num_svm_pointers, svm_pointers, sizes, flags, num_events_in_wait_list, event_wait_list, event);
+cl_int result = tdispatch->clEnqueueSVMMigrateMem(
             command_queue,
             num_svm_pointers,
             svm_pointers,
@@ -1866,6 +2081,8 @@ return tdispatch->clEnqueueSVMMigrateMem(
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueSVMMigrateMem);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1875,12 +2092,14 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetProgramSpecializationConstant_wrap(
     size_t spec_size,
     const void* spec_value)
 {
-printf("clSetProgramSpecializationConstant\n");
-return tdispatch->clSetProgramSpecializationConstant(
+PRINT_CALL_ARGS(clSetProgramSpecializationConstant, program, spec_id, spec_size, spec_value);
+cl_int result = tdispatch->clSetProgramSpecializationConstant(
             program,
             spec_id,
             spec_size,
             spec_value);
+PRINT_RETURN(clSetProgramSpecializationConstant);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1889,11 +2108,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetProgramReleaseCallback_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_program program, void* user_data),
     void* user_data)
 {
-printf("clSetProgramReleaseCallback\n");
-return tdispatch->clSetProgramReleaseCallback(
+PRINT_CALL_ARGS(clSetProgramReleaseCallback, program, pfn_notify, user_data);
+cl_int result = tdispatch->clSetProgramReleaseCallback(
             program,
             pfn_notify,
             user_data);
+PRINT_RETURN(clSetProgramReleaseCallback);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1902,11 +2123,13 @@ static CL_API_ENTRY cl_int CL_API_CALL clSetContextDestructorCallback_wrap(
     void (CL_CALLBACK* pfn_notify)(cl_context context, void* user_data),
     void* user_data)
 {
-printf("clSetContextDestructorCallback\n");
-return tdispatch->clSetContextDestructorCallback(
+PRINT_CALL_ARGS(clSetContextDestructorCallback, context, pfn_notify, user_data);
+cl_int result = tdispatch->clSetContextDestructorCallback(
             context,
             pfn_notify,
             user_data);
+PRINT_RETURN(clSetContextDestructorCallback);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1918,14 +2141,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateBufferWithProperties_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateBufferWithProperties\n");
-return tdispatch->clCreateBufferWithProperties(
+PRINT_CALL_ARGS(clCreateBufferWithProperties, context, properties, flags, size, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateBufferWithProperties(
             context,
             properties,
             flags,
             size,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateBufferWithProperties);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1938,8 +2163,8 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateImageWithProperties_wrap(
     void* host_ptr,
     cl_int* errcode_ret)
 {
-printf("clCreateImageWithProperties\n");
-return tdispatch->clCreateImageWithProperties(
+PRINT_CALL_ARGS(clCreateImageWithProperties, context, properties, flags, image_format, image_desc, host_ptr, errcode_ret);
+cl_mem result = tdispatch->clCreateImageWithProperties(
             context,
             properties,
             flags,
@@ -1947,6 +2172,8 @@ return tdispatch->clCreateImageWithProperties(
             image_desc,
             host_ptr,
             errcode_ret);
+PRINT_RETURN(clCreateImageWithProperties);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1955,16 +2182,20 @@ return tdispatch->clCreateImageWithProperties(
 static CL_API_ENTRY cl_int CL_API_CALL clReleaseDeviceEXT_wrap(
     cl_device_id device)
 {
-printf("clReleaseDeviceEXT\n");
-return tdispatch->clReleaseDeviceEXT(
+PRINT_CALL(clReleaseDeviceEXT);
+cl_int result = tdispatch->clReleaseDeviceEXT(
             device);
+PRINT_RETURN(clReleaseDeviceEXT);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clRetainDeviceEXT_wrap(
     cl_device_id device)
 {
-printf("clRetainDeviceEXT\n");
-return tdispatch->clRetainDeviceEXT(
+PRINT_CALL(clRetainDeviceEXT);
+cl_int result = tdispatch->clRetainDeviceEXT(
             device);
+PRINT_RETURN(clRetainDeviceEXT);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clCreateSubDevicesEXT_wrap(
     cl_device_id in_device,
@@ -1973,13 +2204,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clCreateSubDevicesEXT_wrap(
     cl_device_id* out_devices,
     cl_uint* num_devices)
 {
-printf("clCreateSubDevicesEXT\n");
-return tdispatch->clCreateSubDevicesEXT(
+PRINT_CALL(clCreateSubDevicesEXT);
+cl_int result = tdispatch->clCreateSubDevicesEXT(
             in_device,
             properties,
             num_entries,
             out_devices,
             num_devices);
+PRINT_RETURN(clCreateSubDevicesEXT);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1996,8 +2229,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDsFromD3D10KHR_wrap(
     cl_device_id* devices,
     cl_uint* num_devices)
 {
-printf("clGetDeviceIDsFromD3D10KHR\n");
-return tdispatch->clGetDeviceIDsFromD3D10KHR(
+PRINT_CALL(clGetDeviceIDsFromD3D10KHR);
+cl_int result = tdispatch->clGetDeviceIDsFromD3D10KHR(
             platform,
             d3d_device_source,
             d3d_object,
@@ -2005,6 +2238,8 @@ return tdispatch->clGetDeviceIDsFromD3D10KHR(
             num_entries,
             devices,
             num_devices);
+PRINT_RETURN(clGetDeviceIDsFromD3D10KHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10BufferKHR_wrap(
     cl_context context,
@@ -2012,12 +2247,14 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10BufferKHR_wrap(
     ID3D10Buffer* resource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D10BufferKHR\n");
-return tdispatch->clCreateFromD3D10BufferKHR(
+PRINT_CALL(clCreateFromD3D10BufferKHR);
+cl_mem result = tdispatch->clCreateFromD3D10BufferKHR(
             context,
             flags,
             resource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D10BufferKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10Texture2DKHR_wrap(
     cl_context context,
@@ -2026,13 +2263,15 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10Texture2DKHR_wrap(
     UINT subresource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D10Texture2DKHR\n");
-return tdispatch->clCreateFromD3D10Texture2DKHR(
+PRINT_CALL(clCreateFromD3D10Texture2DKHR);
+cl_mem result = tdispatch->clCreateFromD3D10Texture2DKHR(
             context,
             flags,
             resource,
             subresource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D10Texture2DKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10Texture3DKHR_wrap(
     cl_context context,
@@ -2041,13 +2280,15 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D10Texture3DKHR_wrap(
     UINT subresource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D10Texture3DKHR\n");
-return tdispatch->clCreateFromD3D10Texture3DKHR(
+PRINT_CALL(clCreateFromD3D10Texture3DKHR);
+cl_mem result = tdispatch->clCreateFromD3D10Texture3DKHR(
             context,
             flags,
             resource,
             subresource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D10Texture3DKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D10ObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2057,14 +2298,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D10ObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueAcquireD3D10ObjectsKHR\n");
-return tdispatch->clEnqueueAcquireD3D10ObjectsKHR(
+PRINT_CALL(clEnqueueAcquireD3D10ObjectsKHR);
+cl_int result = tdispatch->clEnqueueAcquireD3D10ObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueAcquireD3D10ObjectsKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D10ObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2074,14 +2317,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D10ObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReleaseD3D10ObjectsKHR\n");
-return tdispatch->clEnqueueReleaseD3D10ObjectsKHR(
+PRINT_CALL(clEnqueueReleaseD3D10ObjectsKHR);
+cl_int result = tdispatch->clEnqueueReleaseD3D10ObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReleaseD3D10ObjectsKHR);
+return result;
 }
 
 #endif // defined(_WIN32)
@@ -2100,8 +2345,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDsFromD3D11KHR_wrap(
     cl_device_id* devices,
     cl_uint* num_devices)
 {
-printf("clGetDeviceIDsFromD3D11KHR\n");
-return tdispatch->clGetDeviceIDsFromD3D11KHR(
+PRINT_CALL(clGetDeviceIDsFromD3D11KHR);
+cl_int result = tdispatch->clGetDeviceIDsFromD3D11KHR(
             platform,
             d3d_device_source,
             d3d_object,
@@ -2109,6 +2354,8 @@ return tdispatch->clGetDeviceIDsFromD3D11KHR(
             num_entries,
             devices,
             num_devices);
+PRINT_RETURN(clGetDeviceIDsFromD3D11KHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11BufferKHR_wrap(
     cl_context context,
@@ -2116,12 +2363,14 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11BufferKHR_wrap(
     ID3D11Buffer* resource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D11BufferKHR\n");
-return tdispatch->clCreateFromD3D11BufferKHR(
+PRINT_CALL(clCreateFromD3D11BufferKHR);
+cl_mem result = tdispatch->clCreateFromD3D11BufferKHR(
             context,
             flags,
             resource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D11BufferKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11Texture2DKHR_wrap(
     cl_context context,
@@ -2130,13 +2379,15 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11Texture2DKHR_wrap(
     UINT subresource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D11Texture2DKHR\n");
-return tdispatch->clCreateFromD3D11Texture2DKHR(
+PRINT_CALL(clCreateFromD3D11Texture2DKHR);
+cl_mem result = tdispatch->clCreateFromD3D11Texture2DKHR(
             context,
             flags,
             resource,
             subresource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D11Texture2DKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11Texture3DKHR_wrap(
     cl_context context,
@@ -2145,13 +2396,15 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromD3D11Texture3DKHR_wrap(
     UINT subresource,
     cl_int* errcode_ret)
 {
-printf("clCreateFromD3D11Texture3DKHR\n");
-return tdispatch->clCreateFromD3D11Texture3DKHR(
+PRINT_CALL(clCreateFromD3D11Texture3DKHR);
+cl_mem result = tdispatch->clCreateFromD3D11Texture3DKHR(
             context,
             flags,
             resource,
             subresource,
             errcode_ret);
+PRINT_RETURN(clCreateFromD3D11Texture3DKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D11ObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2161,14 +2414,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireD3D11ObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueAcquireD3D11ObjectsKHR\n");
-return tdispatch->clEnqueueAcquireD3D11ObjectsKHR(
+PRINT_CALL(clEnqueueAcquireD3D11ObjectsKHR);
+cl_int result = tdispatch->clEnqueueAcquireD3D11ObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueAcquireD3D11ObjectsKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D11ObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2178,14 +2433,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseD3D11ObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReleaseD3D11ObjectsKHR\n");
-return tdispatch->clEnqueueReleaseD3D11ObjectsKHR(
+PRINT_CALL(clEnqueueReleaseD3D11ObjectsKHR);
+cl_int result = tdispatch->clEnqueueReleaseD3D11ObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReleaseD3D11ObjectsKHR);
+return result;
 }
 
 #endif // defined(_WIN32)
@@ -2205,8 +2462,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDsFromDX9MediaAdapterKHR_wrap
     cl_device_id* devices,
     cl_uint* num_devices)
 {
-printf("clGetDeviceIDsFromDX9MediaAdapterKHR\n");
-return tdispatch->clGetDeviceIDsFromDX9MediaAdapterKHR(
+PRINT_CALL(clGetDeviceIDsFromDX9MediaAdapterKHR);
+cl_int result = tdispatch->clGetDeviceIDsFromDX9MediaAdapterKHR(
             platform,
             num_media_adapters,
             media_adapter_type,
@@ -2215,6 +2472,8 @@ return tdispatch->clGetDeviceIDsFromDX9MediaAdapterKHR(
             num_entries,
             devices,
             num_devices);
+PRINT_RETURN(clGetDeviceIDsFromDX9MediaAdapterKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromDX9MediaSurfaceKHR_wrap(
     cl_context context,
@@ -2224,14 +2483,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromDX9MediaSurfaceKHR_wrap(
     cl_uint plane,
     cl_int* errcode_ret)
 {
-printf("clCreateFromDX9MediaSurfaceKHR\n");
-return tdispatch->clCreateFromDX9MediaSurfaceKHR(
+PRINT_CALL(clCreateFromDX9MediaSurfaceKHR);
+cl_mem result = tdispatch->clCreateFromDX9MediaSurfaceKHR(
             context,
             flags,
             adapter_type,
             surface_info,
             plane,
             errcode_ret);
+PRINT_RETURN(clCreateFromDX9MediaSurfaceKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9MediaSurfacesKHR_wrap(
     cl_command_queue command_queue,
@@ -2241,14 +2502,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireDX9MediaSurfacesKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueAcquireDX9MediaSurfacesKHR\n");
-return tdispatch->clEnqueueAcquireDX9MediaSurfacesKHR(
+PRINT_CALL(clEnqueueAcquireDX9MediaSurfacesKHR);
+cl_int result = tdispatch->clEnqueueAcquireDX9MediaSurfacesKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueAcquireDX9MediaSurfacesKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9MediaSurfacesKHR_wrap(
     cl_command_queue command_queue,
@@ -2258,14 +2521,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseDX9MediaSurfacesKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReleaseDX9MediaSurfacesKHR\n");
-return tdispatch->clEnqueueReleaseDX9MediaSurfacesKHR(
+PRINT_CALL(clEnqueueReleaseDX9MediaSurfacesKHR);
+cl_int result = tdispatch->clEnqueueReleaseDX9MediaSurfacesKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReleaseDX9MediaSurfacesKHR);
+return result;
 }
 
 #endif // defined(_WIN32)
@@ -2279,12 +2544,14 @@ static CL_API_ENTRY cl_event CL_API_CALL clCreateEventFromEGLSyncKHR_wrap(
     CLeglDisplayKHR display,
     cl_int* errcode_ret)
 {
-printf("clCreateEventFromEGLSyncKHR\n");
-return tdispatch->clCreateEventFromEGLSyncKHR(
+PRINT_CALL(clCreateEventFromEGLSyncKHR);
+cl_event result = tdispatch->clCreateEventFromEGLSyncKHR(
             context,
             sync,
             display,
             errcode_ret);
+PRINT_RETURN(clCreateEventFromEGLSyncKHR);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2298,14 +2565,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromEGLImageKHR_wrap(
     const cl_egl_image_properties_khr* properties,
     cl_int* errcode_ret)
 {
-printf("clCreateFromEGLImageKHR\n");
-return tdispatch->clCreateFromEGLImageKHR(
+PRINT_CALL(clCreateFromEGLImageKHR);
+cl_mem result = tdispatch->clCreateFromEGLImageKHR(
             context,
             egldisplay,
             eglimage,
             flags,
             properties,
             errcode_ret);
+PRINT_RETURN(clCreateFromEGLImageKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireEGLObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2315,14 +2584,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireEGLObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueAcquireEGLObjectsKHR\n");
-return tdispatch->clEnqueueAcquireEGLObjectsKHR(
+PRINT_CALL(clEnqueueAcquireEGLObjectsKHR);
+cl_int result = tdispatch->clEnqueueAcquireEGLObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueAcquireEGLObjectsKHR);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseEGLObjectsKHR_wrap(
     cl_command_queue command_queue,
@@ -2332,14 +2603,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseEGLObjectsKHR_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReleaseEGLObjectsKHR\n");
-return tdispatch->clEnqueueReleaseEGLObjectsKHR(
+PRINT_CALL(clEnqueueReleaseEGLObjectsKHR);
+cl_int result = tdispatch->clEnqueueReleaseEGLObjectsKHR(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReleaseEGLObjectsKHR);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2350,11 +2623,13 @@ static CL_API_ENTRY cl_event CL_API_CALL clCreateEventFromGLsyncKHR_wrap(
     cl_GLsync sync,
     cl_int* errcode_ret)
 {
-printf("clCreateEventFromGLsyncKHR\n");
-return tdispatch->clCreateEventFromGLsyncKHR(
+PRINT_CALL(clCreateEventFromGLsyncKHR);
+cl_event result = tdispatch->clCreateEventFromGLsyncKHR(
             context,
             sync,
             errcode_ret);
+PRINT_RETURN(clCreateEventFromGLsyncKHR);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2367,13 +2642,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetGLContextInfoKHR_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetGLContextInfoKHR\n");
-return tdispatch->clGetGLContextInfoKHR(
+PRINT_CALL(clGetGLContextInfoKHR);
+cl_int result = tdispatch->clGetGLContextInfoKHR(
             properties,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetGLContextInfoKHR);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLBuffer_wrap(
     cl_context context,
@@ -2381,12 +2658,14 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLBuffer_wrap(
     cl_GLuint bufobj,
     int* errcode_ret)
 {
-printf("clCreateFromGLBuffer\n");
-return tdispatch->clCreateFromGLBuffer(
+PRINT_CALL(clCreateFromGLBuffer);
+cl_mem result = tdispatch->clCreateFromGLBuffer(
             context,
             flags,
             bufobj,
             errcode_ret);
+PRINT_RETURN(clCreateFromGLBuffer);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture_wrap(
     cl_context context,
@@ -2396,14 +2675,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture_wrap(
     cl_GLuint texture,
     cl_int* errcode_ret)
 {
-printf("clCreateFromGLTexture\n");
-return tdispatch->clCreateFromGLTexture(
+PRINT_CALL(clCreateFromGLTexture);
+cl_mem result = tdispatch->clCreateFromGLTexture(
             context,
             flags,
             target,
             miplevel,
             texture,
             errcode_ret);
+PRINT_RETURN(clCreateFromGLTexture);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture2D_wrap(
     cl_context context,
@@ -2413,14 +2694,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture2D_wrap(
     cl_GLuint texture,
     cl_int* errcode_ret)
 {
-printf("clCreateFromGLTexture2D\n");
-return tdispatch->clCreateFromGLTexture2D(
+PRINT_CALL(clCreateFromGLTexture2D);
+cl_mem result = tdispatch->clCreateFromGLTexture2D(
             context,
             flags,
             target,
             miplevel,
             texture,
             errcode_ret);
+PRINT_RETURN(clCreateFromGLTexture2D);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture3D_wrap(
     cl_context context,
@@ -2430,14 +2713,16 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLTexture3D_wrap(
     cl_GLuint texture,
     cl_int* errcode_ret)
 {
-printf("clCreateFromGLTexture3D\n");
-return tdispatch->clCreateFromGLTexture3D(
+PRINT_CALL(clCreateFromGLTexture3D);
+cl_mem result = tdispatch->clCreateFromGLTexture3D(
             context,
             flags,
             target,
             miplevel,
             texture,
             errcode_ret);
+PRINT_RETURN(clCreateFromGLTexture3D);
+return result;
 }
 static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLRenderbuffer_wrap(
     cl_context context,
@@ -2445,23 +2730,27 @@ static CL_API_ENTRY cl_mem CL_API_CALL clCreateFromGLRenderbuffer_wrap(
     cl_GLuint renderbuffer,
     cl_int* errcode_ret)
 {
-printf("clCreateFromGLRenderbuffer\n");
-return tdispatch->clCreateFromGLRenderbuffer(
+PRINT_CALL(clCreateFromGLRenderbuffer);
+cl_mem result = tdispatch->clCreateFromGLRenderbuffer(
             context,
             flags,
             renderbuffer,
             errcode_ret);
+PRINT_RETURN(clCreateFromGLRenderbuffer);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clGetGLObjectInfo_wrap(
     cl_mem memobj,
     cl_gl_object_type* gl_object_type,
     cl_GLuint* gl_object_name)
 {
-printf("clGetGLObjectInfo\n");
-return tdispatch->clGetGLObjectInfo(
+PRINT_CALL(clGetGLObjectInfo);
+cl_int result = tdispatch->clGetGLObjectInfo(
             memobj,
             gl_object_type,
             gl_object_name);
+PRINT_RETURN(clGetGLObjectInfo);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clGetGLTextureInfo_wrap(
     cl_mem memobj,
@@ -2470,13 +2759,15 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetGLTextureInfo_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetGLTextureInfo\n");
-return tdispatch->clGetGLTextureInfo(
+PRINT_CALL(clGetGLTextureInfo);
+cl_int result = tdispatch->clGetGLTextureInfo(
             memobj,
             param_name,
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetGLTextureInfo);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireGLObjects_wrap(
     cl_command_queue command_queue,
@@ -2486,14 +2777,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueAcquireGLObjects_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueAcquireGLObjects\n");
-return tdispatch->clEnqueueAcquireGLObjects(
+PRINT_CALL(clEnqueueAcquireGLObjects);
+cl_int result = tdispatch->clEnqueueAcquireGLObjects(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueAcquireGLObjects);
+return result;
 }
 static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseGLObjects_wrap(
     cl_command_queue command_queue,
@@ -2503,14 +2796,16 @@ static CL_API_ENTRY cl_int CL_API_CALL clEnqueueReleaseGLObjects_wrap(
     const cl_event* event_wait_list,
     cl_event* event)
 {
-printf("clEnqueueReleaseGLObjects\n");
-return tdispatch->clEnqueueReleaseGLObjects(
+PRINT_CALL(clEnqueueReleaseGLObjects);
+cl_int result = tdispatch->clEnqueueReleaseGLObjects(
             command_queue,
             num_objects,
             mem_objects,
             num_events_in_wait_list,
             event_wait_list,
             event);
+PRINT_RETURN(clEnqueueReleaseGLObjects);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2526,8 +2821,8 @@ static CL_API_ENTRY cl_int CL_API_CALL clGetKernelSubGroupInfoKHR_wrap(
     void* param_value,
     size_t* param_value_size_ret)
 {
-printf("clGetKernelSubGroupInfoKHR\n");
-return tdispatch->clGetKernelSubGroupInfoKHR(
+PRINT_CALL(clGetKernelSubGroupInfoKHR);
+cl_int result = tdispatch->clGetKernelSubGroupInfoKHR(
             in_kernel,
             in_device,
             param_name,
@@ -2536,6 +2831,8 @@ return tdispatch->clGetKernelSubGroupInfoKHR(
             param_value_size,
             param_value,
             param_value_size_ret);
+PRINT_RETURN(clGetKernelSubGroupInfoKHR);
+return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#include "icd_print_layer.h"
+#include "icd_print_trace.hpp"
+
+#include "log_sink.hpp"
+#include "mapped_ring.hpp"
+#include "utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace {
+
+using print_layer::trace_record;
+
+constexpr size_t num_functions = sizeof(struct _cl_icd_dispatch) / sizeof(void *);
+
+// Written through the sink's stream buffer directly, records are handed
+// over whole to the calling thread's ring buffer, or to the memory mapped
+// ring.
+std::atomic<std::streambuf *> trace{nullptr};
+// Set when tracing to a memory mapped ring, which keeps the header and the
+// names of the functions out of the ring so that they are never lost.
+ocl_layer_utils::mapped_ring_buf *mapped_ring = nullptr;
+// Set when tracing to a log sink.
+ocl_layer_utils::log_sink_buf *file_sink = nullptr;
+bool capture_args = false;
+std::atomic<bool> named[num_functions];
+std::atomic<uint32_t> next_thread{1};
+
+uint64_t now() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t thread_number() {
+  static thread_local const uint32_t number = next_thread.fetch_add(1, std::memory_order_relaxed);
+  return number;
+}
+
+void write(std::streambuf &sink, const trace_record &record) {
+  sink.sputn(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+// Writes records that describe the rest of the trace.
+void write_metadata(std::streambuf &sink, const char *data, size_t size) {
+  if (mapped_ring != nullptr)
+    mapped_ring->pin(data, size);
+  else
+    sink.sputn(data, static_cast<std::streamsize>(size));
+}
+
+// Other threads may still be tracing calls, the sink is left in place.
+void flush_trace() {
+  file_sink->drain();
+}
+
+} // namespace
+
+extern "C" void _init_trace(void) {
+  const auto settings_from_file = ocl_layer_utils::load_settings();
+  const auto parser = ocl_layer_utils::settings_parser("simple_print", settings_from_file);
+
+  auto format = ocl_layer_utils::log_format::text;
+  parser.get_enumeration("log_format",
+                         std::map<std::string, ocl_layer_utils::log_format>{
+                             {"text", ocl_layer_utils::log_format::text},
+                             {"binary", ocl_layer_utils::log_format::binary}},
+                         format);
+  if (format != ocl_layer_utils::log_format::binary || trace.load() != nullptr)
+    return;
+
+  std::string filename = "cl_simple_print.trace";
+  parser.get_filename("log_filename", filename);
+  unsigned ring_size = 0;
+  parser.get_unsigned("log_ring_size", ring_size);
+
+  std::streambuf *sink;
+  if (ring_size != 0) {
+    auto ring = new ocl_layer_utils::mapped_ring_buf(filename, ring_size);
+    if (!ring->is_open()) {
+      fprintf(stderr, "simple_print failed to map %s, printing calls instead\n", filename.c_str());
+      delete ring;
+      return;
+    }
+    mapped_ring = ring;
+    sink = ring;
+  } else {
+    ocl_layer_utils::log_sink_options options;
+    options.format = format;
+    options.line_buffered = false;
+    unsigned buffer_size = static_cast<unsigned>(options.buffer_size);
+    parser.get_unsigned("log_buffer_size", buffer_size);
+    options.buffer_size = buffer_size < 1024 ? 1024 : buffer_size;
+
+    auto log_sink = new ocl_layer_utils::log_sink_buf(filename, options);
+    if (!log_sink->is_open()) {
+      fprintf(stderr, "simple_print failed to open %s, printing calls instead\n", filename.c_str());
+      delete log_sink;
+      return;
+    }
+    file_sink = log_sink;
+    sink = log_sink;
+  }
+  parser.get_bool("capture_args", capture_args);
+  const trace_record header{trace_record::magic_value, 0, print_layer::trace_version,
+                            trace_record::header_kind};
+  write_metadata(*sink, reinterpret_cast<const char *>(&header), sizeof(header));
+  trace.store(sink);
+  // Everything written to the ring is already in the file, it is left
+  // mapped for calls made by other threads while the process exits.
+  if (file_sink != nullptr)
+    atexit(flush_trace);
+}
+
+extern "C" struct print_args *_trace_args(void) {
+  static thread_local print_args args;
+  if (!capture_args || trace.load(std::memory_order_acquire) == nullptr)
+    return nullptr;
+  args.size = 0;
+  return &args;
+}
+
+extern "C" void _trace_call(unsigned id, const char *name, const struct print_args *args) {
+  std::streambuf *sink = trace.load(std::memory_order_acquire);
+  if (sink == nullptr) {
+    printf("%s\n", name);
+    return;
+  }
+
+  const uint32_t thread = thread_number();
+  if (!named[id].load(std::memory_order_relaxed) && !named[id].exchange(true)) {
+    // Handed over as a single write, so that the name stays in one piece.
+    const size_t length = std::strlen(name);
+    std::string record(sizeof(trace_record) + length, '\0');
+    const trace_record header{0, static_cast<uint32_t>(length), static_cast<uint16_t>(id),
+                              trace_record::name_kind};
+    std::memcpy(&record[0], &header, sizeof(header));
+    std::memcpy(&record[sizeof(header)], name, length);
+    write_metadata(*sink, record.data(), record.size());
+  }
+
+  const trace_record call{now(), thread, static_cast<uint16_t>(id), trace_record::call_kind};
+  if (args == nullptr) {
+    write(*sink, call);
+    return;
+  }
+  // The arguments directly follow their call.
+  char record[2 * sizeof(trace_record) + sizeof(args->data)];
+  const trace_record header{0, static_cast<uint32_t>(args->size), static_cast<uint16_t>(id),
+                            trace_record::args_kind};
+  std::memcpy(record, &call, sizeof(call));
+  std::memcpy(record + sizeof(call), &header, sizeof(header));
+  std::memcpy(record + 2 * sizeof(trace_record), args->data, args->size);
+  sink->sputn(record, static_cast<std::streamsize>(2 * sizeof(trace_record) + args->size));
+}
+
+extern "C" void _trace_return(unsigned id) {
+  std::streambuf *sink = trace.load(std::memory_order_acquire);
+  if (sink != nullptr)
+    write(*sink, trace_record{now(), thread_number(), static_cast<uint16_t>(id),
+                              trace_record::return_kind});
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace print_layer {
+
+// Binary traces are a sequence of native endian records. Records from
+// different threads are not ordered, decoders sort them by timestamp.
+struct trace_record {
+  static constexpr uint32_t magic_value = 0x54504c43; // "CLPT"
+
+  enum kind_type : uint16_t {
+    // First record of a trace, function holds the format version.
+    header_kind = 0,
+    // A call to function.
+    call_kind = 1,
+    // Names function, followed by thread bytes of name.
+    name_kind = 2,
+    // Return from the innermost call to function made by thread.
+    return_kind = 3,
+    // Arguments of the preceding call, followed by thread bytes encoded as
+    // described in icd_print_args.h.
+    args_kind = 4,
+  };
+
+  // Nanoseconds on a steady clock, magic_value in the header.
+  uint64_t timestamp;
+  // Numbered from 1 in order of their first traced call.
+  uint32_t thread;
+  // Index of the entry point in struct _cl_icd_dispatch.
+  uint16_t function;
+  uint16_t kind;
+};
+
+static_assert(sizeof(trace_record) == 16, "trace records are 16 bytes");
+
+constexpr uint16_t trace_version = 3;
+
+} // namespace print_layer
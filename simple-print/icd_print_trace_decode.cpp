@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2020 The Khronos Group Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * OpenCL is a trademark of Apple Inc. used under license by Khronos.
+ */
+
+// Renders a binary trace written by the print layer (simple_print.log_format
+// = binary) in its text format, one line per call in the order they were
+// made:
+//
+//   clGetPlatformIDs
+//
+// With --verbose lines are prefixed with the thread number, the time the
+// call was made and how long it took, in microseconds since the first call,
+// and the arguments captured with simple_print.capture_args are listed:
+//
+//   1 0.000 2.125 clGetPlatformIDs(num_entries=0, platforms=NULL, num_platforms=0x7ffd5c0e2a4c)
+//
+// With --chrome the calls are written as Chrome trace events instead, which
+// chrome://tracing and ui.perfetto.dev open as a timeline.
+//
+// Memory mapped rings (simple_print.log_ring_size) are read the same way,
+// they hold the last calls made before the process exited or was killed.
+// --last <n> only keeps the last n calls of any trace.
+
+#include "icd_print_trace.hpp"
+#include "mapped_ring.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using print_layer::trace_record;
+
+namespace {
+
+struct event {
+  trace_record record;
+  // Encoded arguments of calls, see icd_print_args.h.
+  std::string args;
+};
+
+const std::map<std::string, std::vector<std::string>> parameter_names = {
+#include "icd_print_layer_arg_names.inc"
+};
+
+// Reads the encoded arguments of a call back, returns false if they are
+// malformed.
+class args_reader {
+public:
+  explicit args_reader(const std::string &args) : args_(args) {}
+
+  bool done() const { return offset_ == args_.size(); }
+
+  bool read(std::string &value) {
+    char tag;
+    return byte(tag) && element(tag, value);
+  }
+
+private:
+  bool byte(char &c) {
+    if (offset_ == args_.size())
+      return false;
+    c = args_[offset_++];
+    return true;
+  }
+
+  bool varint(uint64_t &v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      char c;
+      if (!byte(c))
+        return false;
+      v |= static_cast<uint64_t>(c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool bytes(size_t n, std::string &out) {
+    if (args_.size() - offset_ < n)
+      return false;
+    out.assign(args_, offset_, n);
+    offset_ += n;
+    return true;
+  }
+
+  bool element(char tag, std::string &value) {
+    std::ostringstream out;
+    uint64_t v;
+    std::string data;
+    switch (tag) {
+    case 'u':
+      if (!varint(v))
+        return false;
+      out << v;
+      break;
+    case 'i':
+      if (!varint(v))
+        return false;
+      out << static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+      break;
+    case 'h':
+    case 'p':
+      if (!bytes(sizeof(v), data))
+        return false;
+      std::memcpy(&v, data.data(), sizeof(v));
+      if (v == 0)
+        out << "NULL";
+      else
+        out << "0x" << std::hex << v;
+      break;
+    case 's':
+      if (!varint(v) || !bytes(v, data))
+        return false;
+      out << '"' << data << '"';
+      break;
+    case 'b':
+      if (!varint(v) || !bytes(v, data))
+        return false;
+      out << '{' << std::hex << std::setfill('0');
+      for (size_t i = 0; i < data.size(); ++i)
+        out << (i == 0 ? "" : " ") << std::setw(2)
+            << static_cast<unsigned>(static_cast<unsigned char>(data[i]));
+      out << '}';
+      break;
+    case 'n':
+      out << "NULL";
+      break;
+    case 'a': {
+      char element_tag;
+      uint64_t count, captured;
+      if (!byte(element_tag) || element_tag == 'a' || !varint(count) || !varint(captured) ||
+          captured > count)
+        return false;
+      out << '[';
+      for (uint64_t i = 0; i < captured; ++i) {
+        if (!element(element_tag, data))
+          return false;
+        out << (i == 0 ? "" : ", ") << data;
+      }
+      out << ']';
+      if (captured < count)
+        out << "(+" << count - captured << " more)";
+      break;
+    }
+    default:
+      return false;
+    }
+    value = out.str();
+    return true;
+  }
+
+  const std::string &args_;
+  size_t offset_ = 0;
+};
+
+// Decodes the arguments of a call to function, naming them after the
+// parameters of function.
+std::vector<std::pair<std::string, std::string>> decode_args(const std::string &function,
+                                                             const std::string &args) {
+  std::vector<std::pair<std::string, std::string>> decoded;
+  auto it = parameter_names.find(function);
+  args_reader reader(args);
+  std::string value;
+  while (!reader.done()) {
+    if (!reader.read(value)) {
+      decoded.emplace_back("<malformed>", "");
+      break;
+    }
+    const size_t i = decoded.size();
+    decoded.emplace_back(it != parameter_names.end() && i < it->second.size()
+                             ? it->second[i]
+                             : "arg" + std::to_string(i),
+                         value);
+  }
+  return decoded;
+}
+
+std::string json_escape(const std::string &s) {
+  std::ostringstream out;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+    else
+      out << c;
+  }
+  return out.str();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  enum class output { text, verbose, chrome } format = output::text;
+  const char *filename = nullptr;
+  size_t last = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--verbose") == 0)
+      format = output::verbose;
+    else if (std::strcmp(argv[i], "--chrome") == 0)
+      format = output::chrome;
+    else if (std::strcmp(argv[i], "--last") == 0 && i + 1 < argc)
+      last = std::strtoul(argv[++i], nullptr, 10);
+    else
+      filename = argv[i];
+  }
+  if (filename == nullptr) {
+    std::cerr << "usage: " << argv[0] << " [--verbose | --chrome] [--last <n>] <trace>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (ocl_layer_utils::is_mapped_ring(contents)) {
+    std::string records;
+    if (!ocl_layer_utils::read_mapped_ring(contents, records)) {
+      std::cerr << "error: " << filename << " is a malformed ring" << std::endl;
+      return EXIT_FAILURE;
+    }
+    contents.swap(records);
+  }
+  trace_record record;
+  if (contents.size() < sizeof(record) ||
+      (std::memcpy(&record, contents.data(), sizeof(record)),
+       record.kind != trace_record::header_kind ||
+       record.timestamp != trace_record::magic_value)) {
+    std::cerr << "error: " << filename << " is not a print layer trace" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (record.function != print_layer::trace_version) {
+    std::cerr << "error: unsupported trace version " << record.function << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::map<uint16_t, std::string> names;
+  std::vector<event> events;
+  for (size_t offset = sizeof(record); offset < contents.size();) {
+    if (contents.size() - offset < sizeof(record)) {
+      std::cerr << "error: truncated record at offset " << offset << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::memcpy(&record, &contents[offset], sizeof(record));
+    offset += sizeof(record);
+    if (record.kind == trace_record::call_kind || record.kind == trace_record::return_kind) {
+      events.push_back(event{record, {}});
+    } else if (record.kind == trace_record::args_kind && !events.empty() &&
+               events.back().record.kind == trace_record::call_kind &&
+               events.back().record.function == record.function &&
+               contents.size() - offset >= record.thread) {
+      // Written together with their call, so the call is the last record.
+      events.back().args.assign(&contents[offset], record.thread);
+      offset += record.thread;
+    } else if (record.kind == trace_record::name_kind &&
+               contents.size() - offset >= record.thread) {
+      names[record.function].assign(&contents[offset], record.thread);
+      offset += record.thread;
+    } else {
+      std::cerr << "error: malformed record at offset " << offset - sizeof(record) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(), [](const event &a, const event &b) {
+    return a.record.timestamp < b.record.timestamp;
+  });
+
+  if (last != 0) {
+    size_t calls = 0;
+    auto first = events.end();
+    while (first != events.begin() && calls < last)
+      if ((--first)->record.kind == trace_record::call_kind)
+        ++calls;
+    events.erase(events.begin(), first);
+  }
+  // Drops returns from calls that are not part of the trace anymore, the
+  // ring may have overwritten them.
+  std::map<uint32_t, size_t> open_count;
+  std::vector<event> matched;
+  for (event &e : events) {
+    size_t &count = open_count[e.record.thread];
+    if (e.record.kind == trace_record::call_kind)
+      ++count;
+    else if (count == 0)
+      continue;
+    else
+      --count;
+    matched.push_back(std::move(e));
+  }
+  events.swap(matched);
+
+  const uint64_t start = events.empty() ? 0 : events.front().record.timestamp;
+  const auto name = [&names](uint16_t function) {
+    auto it = names.find(function);
+    return it != names.end() ? it->second : "<entry point " + std::to_string(function) + ">";
+  };
+  const auto microseconds = [start](uint64_t timestamp) { return (timestamp - start) / 1000.0; };
+  std::cout << std::fixed << std::setprecision(3);
+
+  if (format == output::chrome) {
+    // Calls and returns of a thread are in order, so they map directly to
+    // begin and end events.
+    std::cout << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char *separator = "\n";
+    for (const event &e : events) {
+      const trace_record &event = e.record;
+      const std::string function = name(event.function);
+      std::cout << separator << "{\"name\":\"" << function << "\",\"cat\":\"opencl\",\"ph\":\""
+                << (event.kind == trace_record::call_kind ? 'B' : 'E') << "\",\"ts\":"
+                << microseconds(event.timestamp) << ",\"pid\":1,\"tid\":" << event.thread;
+      if (!e.args.empty()) {
+        const char *arg_separator = "";
+        std::cout << ",\"args\":{";
+        for (const auto &arg : decode_args(function, e.args)) {
+          std::cout << arg_separator << '"' << arg.first << "\":\"" << json_escape(arg.second) << '"';
+          arg_separator = ",";
+        }
+        std::cout << '}';
+      }
+      std::cout << '}';
+      separator = ",\n";
+    }
+    std::cout << "\n]}\n";
+    return EXIT_SUCCESS;
+  }
+
+  // Pairs calls with their returns to tell how long they took.
+  std::vector<uint64_t> durations(events.size(), 0);
+  std::map<uint32_t, std::vector<size_t>> open_calls;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const trace_record &event = events[i].record;
+    auto &calls = open_calls[event.thread];
+    if (event.kind == trace_record::call_kind) {
+      calls.push_back(i);
+    } else if (!calls.empty() && events[calls.back()].record.function == event.function) {
+      durations[calls.back()] = event.timestamp - events[calls.back()].record.timestamp;
+      calls.pop_back();
+    }
+  }
+
+  for (size_t i = 0; i < events.size(); ++i) {
+    const trace_record &event = events[i].record;
+    if (event.kind != trace_record::call_kind)
+      continue;
+    const std::string function = name(event.function);
+    if (format == output::verbose)
+      std::cout << event.thread << ' ' << microseconds(event.timestamp) << ' '
+                << durations[i] / 1000.0 << ' ';
+    std::cout << function;
+    if (format == output::verbose && !events[i].args.empty()) {
+      const char *separator = "";
+      std::cout << '(';
+      for (const auto &arg : decode_args(function, events[i].args)) {
+        std::cout << separator << arg.first << '=' << arg.second;
+        separator = ", ";
+      }
+      std::cout << ')';
+    }
+    std::cout << '\n';
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// Measures the throughput of handle_registry against a single std::map
+// guarded by a mutex, the structure object_lifetime uses, for a lookup
+// heavy and a create/release heavy workload.
+//
+//   bench_handle_registry [threads] [operations per thread]
+
+#include "handle_registry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct locked_map {
+  std::mutex mutex;
+  std::map<const void *, int> entries;
+
+  void create(const void *handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[handle] = 1;
+  }
+  bool find(const void *handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.find(handle) != entries.end();
+  }
+  void release(const void *handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(handle);
+  }
+};
+
+struct registry {
+  ocl_layer_utils::handle_registry<int> handles;
+
+  void create(const void *handle) { handles.on_create(handle, 1); }
+  bool find(const void *handle) {
+    return handles.find(handle, [](const ocl_layer_utils::handle_registry<int>::entry &) {});
+  }
+  void release(const void *handle) { handles.on_release(handle); }
+};
+
+const void *fake_handle(size_t i) { return reinterpret_cast<const void *>((i + 1) * 64); }
+
+// Every thread owns 1024 handles. Each operation looks one up, and every
+// churn_period operations one is released and created again.
+template <typename Map>
+double run(size_t threads, size_t operations, size_t churn_period) {
+  Map map;
+  const size_t live = 1024;
+  for (size_t i = 0; i < threads * live; ++i)
+    map.create(fake_handle(i));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&map, t, operations, churn_period] {
+      size_t found = 0;
+      for (size_t i = 0; i < operations; ++i) {
+        const void *handle = fake_handle(t * live + i % live);
+        found += map.find(handle);
+        if (i % churn_period == 0) {
+          map.release(handle);
+          map.create(handle);
+        }
+      }
+      if (found == 0)
+        std::cerr << "no handle found" << std::endl;
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return threads * operations / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                  : std::max(1u, std::thread::hardware_concurrency());
+  const size_t operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+  std::cout << threads << " threads, " << operations << " operations per thread\n";
+  for (size_t churn_period : {1000, 4}) {
+    std::cout << "1 create/release every " << churn_period << " lookups:\n"
+              << "  std::map + mutex:  " << run<locked_map>(threads, operations, churn_period) / 1e6 << " Mops/s\n"
+              << "  handle_registry:   " << run<registry>(threads, operations, churn_period) / 1e6 << " Mops/s\n";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+#include "dispatch_mask.hpp"
+
+namespace ocl_layer_utils {
+
+dispatch_mask dispatch_mask::load(const settings_parser &parser) {
+  std::vector<std::string> enable, disable;
+  parser.get_list("enable", enable);
+  parser.get_list("disable", disable);
+
+  dispatch_mask mask;
+  mask.enable_.insert(enable.begin(), enable.end());
+  mask.disable_.insert(disable.begin(), disable.end());
+  return mask;
+}
+
+bool dispatch_mask::enabled(const char *function, const char *family) const {
+  if (disable_.count(function) != 0)
+    return false;
+  if (enable_.count(function) != 0)
+    return true;
+  if (disable_.count(family) != 0)
+    return false;
+  return enable_.empty() || enable_.count(family) != 0;
+}
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ocl_layer_utils {
+
+// Selects the entry points a layer intercepts, from the `enable` and
+// `disable` settings. Both are comma separated lists of entry point names
+// (clEnqueueNDRangeKernel) or API families (kernel). Names take precedence
+// over families; when `enable` is set, everything it does not list is
+// disabled.
+class dispatch_mask {
+public:
+  static dispatch_mask load(const settings_parser &parser);
+
+  // family is one of platform, context, queue, mem, image, svm, sampler,
+  // program, kernel or event.
+  bool enabled(const char *function, const char *family) const;
+
+private:
+  std::set<std::string> enable_;
+  std::set<std::string> disable_;
+};
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace ocl_layer_utils {
+
+// Concurrent map from OpenCL handles to a per-handle payload chosen by the
+// layer, with reference counts mirroring the ones of the objects.
+//
+// Layers call on_create, on_retain and on_release from the corresponding
+// entry points. Handles are spread over Shards independently locked shards,
+// lookups only take a shared lock on a single shard. Each registration gets
+// a new generation, so that a handle the driver hands out again after its
+// object died can be told apart from the one that was recorded earlier.
+template <typename Payload, size_t Shards = 64>
+class handle_registry {
+public:
+  static_assert(Shards != 0 && (Shards & (Shards - 1)) == 0,
+                "the number of shards must be a power of two");
+
+  struct entry {
+    Payload payload;
+    // Nonzero, unique among all the registrations of this registry.
+    uint64_t generation;
+    unsigned long refcount;
+  };
+
+  // Registers handle with a reference count of 1, replacing a previous
+  // registration of the same handle. Returns the new generation.
+  uint64_t on_create(const void *handle, Payload payload) {
+    const uint64_t generation = next_generation_.fetch_add(1, std::memory_order_relaxed);
+    shard &s = shard_of(handle);
+    std::lock_guard<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    if (it != s.entries.end())
+      it->second = entry{std::move(payload), generation, 1};
+    else
+      s.entries.emplace(handle, entry{std::move(payload), generation, 1});
+    return generation;
+  }
+
+  // Returns false if handle is not registered.
+  bool on_retain(const void *handle) {
+    shard &s = shard_of(handle);
+    std::lock_guard<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    if (it == s.entries.end())
+      return false;
+    ++it->second.refcount;
+    return true;
+  }
+
+  // Returns false if handle is not registered. When the last reference is
+  // released the handle is unregistered and, if released is not null, its
+  // entry is moved to *released.
+  bool on_release(const void *handle, entry *released = nullptr) {
+    shard &s = shard_of(handle);
+    std::lock_guard<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    if (it == s.entries.end())
+      return false;
+    if (--it->second.refcount == 0) {
+      if (released != nullptr)
+        *released = std::move(it->second);
+      s.entries.erase(it);
+    }
+    return true;
+  }
+
+  // Unregisters handle regardless of its reference count.
+  bool erase(const void *handle) {
+    shard &s = shard_of(handle);
+    std::lock_guard<std::shared_timed_mutex> lock(s.mutex);
+    return s.entries.erase(handle) != 0;
+  }
+
+  bool contains(const void *handle) const {
+    const shard &s = shard_of(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+    return s.entries.find(handle) != s.entries.end();
+  }
+
+  // True if handle is registered with the given generation.
+  bool contains(const void *handle, uint64_t generation) const {
+    const shard &s = shard_of(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    return it != s.entries.end() && it->second.generation == generation;
+  }
+
+  // Calls read(const entry &) under a shared lock of the shard of handle,
+  // returns false if handle is not registered.
+  template <typename Read>
+  bool find(const void *handle, Read &&read) const {
+    const shard &s = shard_of(handle);
+    std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    if (it == s.entries.end())
+      return false;
+    read(static_cast<const entry &>(it->second));
+    return true;
+  }
+
+  // Calls update(Payload &) under an exclusive lock of the shard of handle,
+  // returns false if handle is not registered.
+  template <typename Update>
+  bool update(const void *handle, Update &&update) {
+    shard &s = shard_of(handle);
+    std::lock_guard<std::shared_timed_mutex> lock(s.mutex);
+    auto it = s.entries.find(handle);
+    if (it == s.entries.end())
+      return false;
+    update(it->second.payload);
+    return true;
+  }
+
+  // Calls visit(const void *handle, const entry &) for every registered
+  // handle, locking one shard at a time. Handles registered or released
+  // concurrently may or may not be visited.
+  template <typename Visit>
+  void for_each(Visit &&visit) const {
+    for (const shard &s : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+      for (const auto &kv : s.entries)
+        visit(kv.first, static_cast<const entry &>(kv.second));
+    }
+  }
+
+  size_t size() const {
+    size_t result = 0;
+    for (const shard &s : shards_) {
+      std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+      result += s.entries.size();
+    }
+    return result;
+  }
+
+private:
+  struct alignas(64) shard {
+    mutable std::shared_timed_mutex mutex;
+    std::unordered_map<const void *, entry> entries;
+  };
+
+  static size_t index(const void *handle) {
+    // handles are at least pointer aligned, mix in the high bits as well
+    const auto key = reinterpret_cast<uintptr_t>(handle) >> 3;
+    return static_cast<size_t>((key ^ (key >> 17)) * UINT64_C(0x9E3779B97F4A7C15) >> 32) & (Shards - 1);
+  }
+
+  shard &shard_of(const void *handle) { return shards_[index(handle)]; }
+  const shard &shard_of(const void *handle) const { return shards_[index(handle)]; }
+
+  shard shards_[Shards];
+  std::atomic<uint64_t> next_generation_{1};
+};
+
+} // namespace ocl_layer_utils
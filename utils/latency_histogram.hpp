@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ocl_layer_utils {
+
+// Log-linear histogram of durations in nanoseconds, in the spirit of
+// HdrHistogram: every power of two is split into 32 buckets, so values are
+// reported within 1/32 (about 3%) of what was recorded, from 1 ns up to
+// the full 64-bit range, in a fixed 15 KiB.
+//
+// record() is meant to be called by a single thread, it does not use
+// atomic read-modify-write operations. Other threads may read the
+// histogram concurrently, typically to merge() it into a report, and see
+// a slightly stale but consistent enough view of it.
+class latency_histogram {
+public:
+  static constexpr unsigned sub_bucket_bits = 5;
+  static constexpr unsigned sub_buckets = 1u << sub_bucket_bits;
+  static constexpr unsigned num_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+  latency_histogram() {
+    for (auto &count : counts_)
+      count.store(0, std::memory_order_relaxed);
+  }
+
+  latency_histogram(const latency_histogram &) = delete;
+  latency_histogram &operator=(const latency_histogram &) = delete;
+
+  static unsigned bucket(uint64_t value) {
+    if (value < sub_buckets)
+      return static_cast<unsigned>(value);
+    const unsigned exponent = 63 - count_leading_zeros(value);
+    const unsigned shift = exponent - sub_bucket_bits;
+    return (shift + 1) * sub_buckets + static_cast<unsigned>((value >> shift) - sub_buckets);
+  }
+
+  // Largest value that falls in the given bucket.
+  static uint64_t highest_value(unsigned bucket) {
+    if (bucket < 2 * sub_buckets)
+      return bucket;
+    const unsigned shift = bucket / sub_buckets - 1;
+    const uint64_t mantissa = bucket % sub_buckets + sub_buckets;
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  void record(uint64_t value) {
+    bump(counts_[bucket(value)], 1);
+    bump(count_, 1);
+    bump(total_, value);
+    if (value > max_.load(std::memory_order_relaxed))
+      max_.store(value, std::memory_order_relaxed);
+  }
+
+  // Adds the counts of other to this histogram, which must not be recorded
+  // to concurrently.
+  void merge(const latency_histogram &other) {
+    for (unsigned i = 0; i < num_buckets; ++i)
+      bump(counts_[i], other.counts_[i].load(std::memory_order_relaxed));
+    bump(count_, other.count_.load(std::memory_order_relaxed));
+    bump(total_, other.total_.load(std::memory_order_relaxed));
+    const uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+    if (other_max > max_.load(std::memory_order_relaxed))
+      max_.store(other_max, std::memory_order_relaxed);
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t total() const { return total_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Smallest value that percentile percent of the recorded values are
+  // lower than or equal to, up to the precision of the buckets.
+  uint64_t value_at_percentile(double percentile) const {
+    const uint64_t total_count = count();
+    if (total_count == 0)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_count) + 0.5);
+    if (rank == 0)
+      rank = 1;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < num_buckets; ++i) {
+      seen += counts_[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        const uint64_t value = highest_value(i);
+        return value < max() ? value : max();
+      }
+    }
+    return max();
+  }
+
+private:
+  static void bump(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  static unsigned count_leading_zeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned zeros = 0;
+    for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1)
+      ++zeros;
+    return zeros;
+#endif
+  }
+
+  std::array<std::atomic<uint64_t>, num_buckets> counts_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> total_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,67 @@
+#include "layer_support.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace ocl_layer_utils {
+
+void report_destination::load(const settings_parser &parser) {
+  parser.get_enumeration("log_sink",
+                         std::map<std::string, sink_type>{{"none", sink_type::none},
+                                                          {"stdout", sink_type::standard_output},
+                                                          {"stderr", sink_type::standard_error},
+                                                          {"file", sink_type::file}},
+                         sink);
+  parser.get_filename("log_filename", filename);
+}
+
+std::ostream *report_destination::open(const char *layer) const {
+  switch (sink) {
+  case sink_type::none:
+    return nullptr;
+  case sink_type::standard_output:
+    return &std::cout;
+  case sink_type::standard_error:
+    return &std::cerr;
+  case sink_type::file: {
+    auto file = new std::ofstream(filename);
+    if (file->good())
+      return file;
+    delete file;
+    std::cerr << layer << " failed to open specified output stream: " << filename
+              << ". Falling back to stderr." << std::endl;
+    return &std::cerr;
+  }
+  }
+  return &std::cerr;
+}
+
+uint64_t fnv1a(const void *data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<const unsigned char *>(data)[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+cl_int get_layer_info(cl_layer_info param_name, size_t param_value_size, void *param_value,
+                      size_t *param_value_size_ret) {
+  switch (param_name) {
+  case CL_LAYER_API_VERSION:
+    if (param_value) {
+      if (param_value_size < sizeof(cl_layer_api_version))
+        return CL_INVALID_VALUE;
+      *((cl_layer_api_version *)param_value) = CL_LAYER_API_VERSION_100;
+    }
+    if (param_value_size_ret)
+      *param_value_size_ret = sizeof(cl_layer_api_version);
+    break;
+  default:
+    return CL_INVALID_VALUE;
+  }
+  return CL_SUCCESS;
+}
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <CL/cl_layer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Pieces shared by the layers that report what they did at exit.
+namespace ocl_layer_utils {
+
+// Where a layer writes its report, from its log_sink setting ('none',
+// 'stdout', 'stderr' or 'file') and its log_filename setting.
+struct report_destination {
+  enum class sink_type { none, standard_output, standard_error, file };
+
+  sink_type sink;
+  std::string filename;
+
+  void load(const settings_parser &parser);
+
+  // Null for 'none'. A file that can not be opened falls back to stderr,
+  // layer names the layer in the message saying so. Files are never
+  // closed, reports are written from exit handlers.
+  std::ostream *open(const char *layer) const;
+};
+
+// The instance of T shared by all threads, created on first use. It is
+// never destroyed: calls and callbacks may still reach a layer while the
+// process exits, after static destructors ran.
+template <typename T>
+T &never_destroyed() {
+  static T *instance = new T;
+  return *instance;
+}
+
+// 64-bit FNV-1a hash of size bytes at data.
+uint64_t fnv1a(const void *data, size_t size);
+
+inline uint64_t fnv1a(const std::string &data) {
+  return fnv1a(data.data(), data.size());
+}
+
+// clGetLayerInfo of layers implementing version 1.0 of the layer API.
+cl_int get_layer_info(cl_layer_info param_name, size_t param_value_size, void *param_value,
+                      size_t *param_value_size_ret);
+
+// clInitLayer: checks the arguments, calls init(), which loads the
+// settings and fills in dispatch, and returns dispatch as the table of the
+// layer.
+template <typename Init>
+cl_int init_layer(struct _cl_icd_dispatch &dispatch, cl_uint num_entries,
+                  const struct _cl_icd_dispatch *target_dispatch, cl_uint *num_entries_out,
+                  const struct _cl_icd_dispatch **layer_dispatch_ret, Init init) {
+  const cl_uint size = sizeof(dispatch) / sizeof(dispatch.clGetPlatformIDs);
+  if (!target_dispatch || !layer_dispatch_ret || !num_entries_out || num_entries < size)
+    return CL_INVALID_VALUE;
+  init();
+  *layer_dispatch_ret = &dispatch;
+  *num_entries_out = size;
+  return CL_SUCCESS;
+}
+
+} // namespace ocl_layer_utils
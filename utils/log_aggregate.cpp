@@ -0,0 +1,118 @@
+// Aggregates binary layer logs (log_format = binary) by API, rule and
+// returned error, printing one line per distinct violation:
+//
+//   <count> <api> <error> <rule>
+//
+// sorted by decreasing count. Records are read in place from the raw file
+// contents, no text is parsed. Logs kept in a memory mapped ring
+// (log_ring_size) are unwrapped first.
+
+#include "mapped_ring.hpp"
+#include "violation_reporter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct aggregate {
+  std::string api;
+  std::string rule;
+  cl_int error;
+  unsigned long long count;
+};
+
+bool read_file(const char *filename, std::vector<char> &contents) {
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file.good())
+    return false;
+  file.seekg(0, std::ios::end);
+  contents.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0, std::ios::beg);
+  file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+  if (!file.good() && !contents.empty())
+    return false;
+  const std::string raw(contents.begin(), contents.end());
+  if (!ocl_layer_utils::is_mapped_ring(raw))
+    return true;
+  std::string data;
+  if (!ocl_layer_utils::read_mapped_ring(raw, data))
+    return false;
+  contents.assign(data.begin(), data.end());
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  using ocl_layer_utils::log_record_header;
+
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <log>..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::unordered_map<std::string, aggregate> aggregates;
+  std::vector<char> contents;
+  std::string key;
+  for (int i = 1; i < argc; ++i) {
+    if (!read_file(argv[i], contents)) {
+      std::cerr << "error: could not read " << argv[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    size_t offset = 0;
+    while (offset < contents.size()) {
+      log_record_header header;
+      if (contents.size() - offset < sizeof(header)) {
+        std::cerr << "error: truncated record in " << argv[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::memcpy(&header, &contents[offset], sizeof(header));
+      const size_t size = sizeof(header) + header.function_length +
+                          header.rule_length + header.num_handles * sizeof(uint64_t);
+      if (header.magic != log_record_header::magic_value ||
+          contents.size() - offset < size) {
+        std::cerr << "error: malformed record at offset " << offset << " in "
+                  << argv[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      const char *function = &contents[offset + sizeof(header)];
+      const char *rule = function + header.function_length;
+      key.assign(function, header.function_length);
+      key.push_back('\0');
+      key.append(rule, header.rule_length);
+      key.append(reinterpret_cast<const char *>(&header.error), sizeof(header.error));
+
+      auto it = aggregates.find(key);
+      if (it == aggregates.end())
+        it = aggregates.emplace(key, aggregate{std::string(function, header.function_length),
+                                               std::string(rule, header.rule_length),
+                                               header.error, 0}).first;
+      it->second.count += header.count;
+      offset += size;
+    }
+  }
+
+  std::vector<const aggregate *> sorted;
+  sorted.reserve(aggregates.size());
+  for (const auto &kv : aggregates)
+    sorted.push_back(&kv.second);
+  std::sort(sorted.begin(), sorted.end(), [](const aggregate *a, const aggregate *b) {
+    return std::tie(b->count, a->api, a->rule, a->error) <
+           std::tie(a->count, b->api, b->rule, b->error);
+  });
+  for (const aggregate *a : sorted)
+    std::cout << a->count << ' ' << a->api << ' ' << a->error << ' ' << a->rule << '\n';
+
+  return EXIT_SUCCESS;
+}
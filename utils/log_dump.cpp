@@ -0,0 +1,32 @@
+// Prints the contents of a log kept in a memory mapped ring (log_ring_size),
+// oldest first, as they would have been written to a regular log file.
+
+#include "mapped_ring.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <log>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file(argv[1], std::ios::in | std::ios::binary);
+  if (!file.good()) {
+    std::cerr << "error: could not read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  std::string data;
+  if (!ocl_layer_utils::read_mapped_ring(contents, data)) {
+    std::cerr << "error: " << argv[1] << " is not a ring" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout.write(data.data(), static_cast<std::streamsize>(data.size()));
+  return std::cout.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,434 @@
+#include "log_sink.hpp"
+
+#include "mapped_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ocl_layer_utils {
+
+log_sink_options load_log_sink_options(const settings_parser &parser) {
+  log_sink_options options;
+  const auto formats =
+      std::map<std::string, log_format>{{"text", log_format::text},
+                                        {"jsonl", log_format::jsonl},
+                                        {"binary", log_format::binary}};
+  parser.get_enumeration("log_format", formats, options.format);
+  options.line_buffered = options.format != log_format::binary;
+  unsigned value = static_cast<unsigned>(options.buffer_size);
+  parser.get_unsigned("log_buffer_size", value);
+  // Lines longer than the buffer bypass it, keep room for a few of them.
+  options.buffer_size = std::max<size_t>(value, 1024);
+  value = static_cast<unsigned>(options.max_file_size);
+  parser.get_unsigned("log_max_size", value);
+  options.max_file_size = value;
+  parser.get_unsigned("log_max_files", options.max_files);
+  value = static_cast<unsigned>(options.ring_size);
+  parser.get_unsigned("log_ring_size", value);
+  options.ring_size = value;
+  return options;
+}
+
+namespace detail {
+
+// Single producer, single consumer ring of bytes. Only complete lines are
+// pushed, so the consumer never has to look for message boundaries.
+class log_ring {
+public:
+  explicit log_ring(size_t capacity) : data_(capacity) {}
+
+  size_t capacity() const { return data_.size(); }
+
+  // Producer side, fails if there is not enough room for n bytes.
+  bool push(const char *s, size_t n) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    if (data_.size() - (tail - head) < n)
+      return false;
+    const size_t pos = tail % data_.size();
+    const size_t first = std::min(n, data_.size() - pos);
+    std::memcpy(&data_[pos], s, first);
+    std::memcpy(&data_[0], s + first, n - first);
+    tail_.store(tail + n, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, appends the whole content of the ring to out.
+  void pop_all(std::string &out) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    if (head == tail)
+      return;
+    const size_t n = tail - head;
+    const size_t pos = head % data_.size();
+    const size_t first = std::min(n, data_.size() - pos);
+    out.append(&data_[pos], first);
+    out.append(&data_[0], n - first);
+    head_.store(tail, std::memory_order_release);
+  }
+
+  // Set while a thread writes to the ring, rings of exited threads are
+  // handed out to new ones.
+  std::atomic<bool> owned{true};
+  // Incomplete line of the owning thread.
+  std::string line;
+
+private:
+  std::vector<char> data_;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+struct log_sink_state {
+  log_sink_options options;
+  unsigned long long id;
+
+  // Held while writing to the target, which can be replaced at any time.
+  std::mutex target_mutex;
+  std::ostream *target = nullptr;
+  std::ofstream file;
+  std::string filename;
+  size_t file_size = 0;
+  // Set while writing to a ring, which is kept until the sink is destroyed
+  // for threads that are still writing to it when it is retargeted.
+  std::unique_ptr<mapped_ring_buf> ring;
+  std::atomic<mapped_ring_buf *> ring_target{nullptr};
+
+  std::mutex rings_mutex;
+  std::vector<std::shared_ptr<log_ring>> rings;
+  std::atomic<unsigned> rings_version{0};
+
+  // Output of threads that have no ring (anymore) and lines too long for one.
+  std::mutex overflow_mutex;
+  std::string overflow;
+
+  std::atomic<unsigned long long> dropped{0};
+  std::atomic<unsigned long long> flush_requests{0};
+  std::atomic<bool> stop{false};
+  std::mutex wake_mutex;
+  std::condition_variable wake;
+  std::thread writer;
+
+  std::vector<std::shared_ptr<log_ring>> drained_rings;
+  unsigned drained_version = ~0u;
+  std::string batch;
+
+  void write_overflow(const char *s, size_t n) {
+    if (mapped_ring_buf *mapped = ring_target.load(std::memory_order_acquire)) {
+      mapped->sputn(s, static_cast<std::streamsize>(n));
+      return;
+    }
+    std::lock_guard<std::mutex> lock(overflow_mutex);
+    overflow.append(s, n);
+  }
+
+  std::shared_ptr<log_ring> claim_ring() {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (auto &ring : rings) {
+      bool owned = false;
+      if (ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+        ring->line.clear();
+        return ring;
+      }
+    }
+    rings.push_back(std::make_shared<log_ring>(options.buffer_size));
+    rings_version.fetch_add(1, std::memory_order_release);
+    return rings.back();
+  }
+
+  void commit(log_ring &ring, const char *s, size_t n) {
+    if (n > ring.capacity() || ring_target.load(std::memory_order_acquire) != nullptr) {
+      write_overflow(s, n);
+      return;
+    }
+    for (int attempt = 0; !ring.push(s, n); ++attempt) {
+      if (attempt == 100) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      wake.notify_one();
+      std::this_thread::yield();
+    }
+  }
+
+  std::ios::openmode open_mode() const {
+    return options.line_buffered ? std::ios::out | std::ios::trunc
+                                 : std::ios::out | std::ios::trunc | std::ios::binary;
+  }
+
+  void rotate() {
+    file.close();
+    if (options.max_files != 0) {
+      std::remove((filename + "." + std::to_string(options.max_files)).c_str());
+      for (unsigned i = options.max_files; i > 1; --i)
+        std::rename((filename + "." + std::to_string(i - 1)).c_str(),
+                    (filename + "." + std::to_string(i)).c_str());
+      std::rename(filename.c_str(), (filename + ".1").c_str());
+    }
+    file.open(filename, open_mode());
+    file_size = 0;
+  }
+
+  // Writes out everything buffered so far, returns false if there was
+  // nothing to write. Called with target_mutex held.
+  bool drain() {
+    if (rings_version.load(std::memory_order_acquire) != drained_version) {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+      drained_rings = rings;
+      drained_version = rings_version.load(std::memory_order_relaxed);
+    }
+    batch.clear();
+    for (auto &ring : drained_rings)
+      ring->pop_all(batch);
+    {
+      std::lock_guard<std::mutex> lock(overflow_mutex);
+      batch += overflow;
+      overflow.clear();
+    }
+    // Binary output can not be interleaved with text, drops go unreported.
+    const auto n = dropped.exchange(0, std::memory_order_relaxed);
+    if (n != 0 && options.line_buffered)
+      batch += "log sink overloaded, dropped " + std::to_string(n) + " lines\n";
+    if (batch.empty())
+      return false;
+
+    target->write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    if (target == &file && options.max_file_size != 0) {
+      file_size += batch.size();
+      if (file_size >= options.max_file_size)
+        rotate();
+    }
+    return true;
+  }
+
+  void run() {
+    unsigned long long flushed = 0;
+    while (!stop.load(std::memory_order_acquire)) {
+      const auto requested = flush_requests.load(std::memory_order_acquire);
+      bool wrote;
+      {
+        std::lock_guard<std::mutex> lock(target_mutex);
+        wrote = drain();
+        if (requested != flushed)
+          target->flush();
+      }
+      flushed = requested;
+      if (!wrote) {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(10), [&] {
+          return stop.load(std::memory_order_acquire) ||
+                 flush_requests.load(std::memory_order_acquire) != flushed;
+        });
+      }
+    }
+  }
+};
+
+namespace {
+
+std::atomic<unsigned long long> next_sink_id{1};
+
+// The ring a thread writes to. Released when the thread exits so that it
+// can be reused, writes happening after that (from atexit handlers of the
+// main thread) go through the overflow buffer instead.
+struct thread_ring {
+  std::shared_ptr<log_ring> ring;
+  unsigned long long sink_id = 0;
+
+  void release() {
+    if (ring) {
+      ring->owned.store(false, std::memory_order_release);
+      ring.reset();
+    }
+  }
+
+  ~thread_ring();
+};
+
+thread_local bool thread_ring_destroyed = false;
+thread_local thread_ring current;
+
+thread_ring::~thread_ring() {
+  // Pending partial lines are dropped along with the thread.
+  release();
+  thread_ring_destroyed = true;
+}
+
+log_ring *ring_of(log_sink_state &state) {
+  if (thread_ring_destroyed)
+    return nullptr;
+  if (current.sink_id != state.id || !current.ring) {
+    current.release();
+    current.ring = state.claim_ring();
+    current.sink_id = state.id;
+  }
+  return current.ring.get();
+}
+
+} // namespace
+} // namespace detail
+
+log_sink_buf::log_sink_buf(std::ostream &target, const log_sink_options &options)
+    : state_(new detail::log_sink_state) {
+  state_->options = options;
+  state_->target = &target;
+  start();
+}
+
+log_sink_buf::log_sink_buf(const std::string &filename, const log_sink_options &options)
+    : state_(new detail::log_sink_state) {
+  state_->options = options;
+  state_->filename = filename;
+  state_->target = &state_->file;
+  if (options.ring_size != 0) {
+    // Nothing is pinned, formats have no header.
+    state_->ring.reset(new mapped_ring_buf(filename, options.ring_size, 0));
+    if (state_->ring->is_open())
+      state_->ring_target.store(state_->ring.get(), std::memory_order_release);
+  } else {
+    state_->file.open(filename, state_->open_mode());
+  }
+  start();
+}
+
+void log_sink_buf::start() {
+  state_->id = detail::next_sink_id.fetch_add(1, std::memory_order_relaxed);
+  start_writer();
+}
+
+void log_sink_buf::start_writer() {
+  // A sink whose file failed to open has no writer until it is retargeted,
+  // rings need none.
+  if (is_open() && state_->ring_target.load(std::memory_order_relaxed) == nullptr &&
+      !state_->writer.joinable())
+    state_->writer = std::thread(&detail::log_sink_state::run, state_.get());
+}
+
+log_sink_buf::~log_sink_buf() {
+  sync();
+  state_->stop.store(true, std::memory_order_release);
+  state_->wake.notify_one();
+  if (state_->writer.joinable())
+    state_->writer.join();
+  if (is_open()) {
+    std::lock_guard<std::mutex> lock(state_->target_mutex);
+    while (state_->drain()) {}
+    state_->target->flush();
+  }
+  if (!detail::thread_ring_destroyed && detail::current.sink_id == state_->id)
+    detail::current.release();
+}
+
+void log_sink_buf::retarget(std::ostream &target) {
+  sync();
+  state_->ring_target.store(nullptr, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(state_->target_mutex);
+  while (state_->drain()) {}
+  state_->target->flush();
+  state_->file.close();
+  state_->filename.clear();
+  state_->target = &target;
+  start_writer();
+}
+
+bool log_sink_buf::retarget(const std::string &filename) {
+  // Appended to, switching back and forth between files keeps their contents.
+  std::ofstream file(filename, (state_->open_mode() & ~std::ios::trunc) | std::ios::app);
+  if (!file.is_open())
+    return false;
+  const auto size = file.seekp(0, std::ios::end).tellp();
+  sync();
+  state_->ring_target.store(nullptr, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(state_->target_mutex);
+  while (state_->drain()) {}
+  state_->target->flush();
+  state_->file = std::move(file);
+  state_->filename = filename;
+  state_->file_size = size > 0 ? static_cast<size_t>(size) : 0;
+  state_->target = &state_->file;
+  start_writer();
+  return true;
+}
+
+void log_sink_buf::drain() {
+  sync();
+  if (!is_open())
+    return;
+  std::lock_guard<std::mutex> lock(state_->target_mutex);
+  while (state_->drain()) {}
+  state_->target->flush();
+}
+
+bool log_sink_buf::is_open() const {
+  return state_->ring_target.load(std::memory_order_acquire) != nullptr ||
+         state_->target != &state_->file || state_->file.is_open();
+}
+
+log_sink_buf::int_type log_sink_buf::overflow(int_type c) {
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  const char ch = traits_type::to_char_type(c);
+  xsputn(&ch, 1);
+  return c;
+}
+
+std::streamsize log_sink_buf::xsputn(const char *s, std::streamsize n) {
+  const size_t size = static_cast<size_t>(n);
+  detail::log_ring *ring = detail::ring_of(*state_);
+  if (ring == nullptr) {
+    state_->write_overflow(s, size);
+    return n;
+  }
+
+  if (!state_->options.line_buffered) {
+    if (ring->line.empty()) {
+      state_->commit(*ring, s, size);
+    } else {
+      ring->line.append(s, size);
+      state_->commit(*ring, ring->line.data(), ring->line.size());
+      ring->line.clear();
+    }
+    return n;
+  }
+
+  // Only hand complete lines over, messages are written piecewise.
+  const char *end = s + size;
+  const char *last_newline = end;
+  while (last_newline != s && last_newline[-1] != '\n')
+    --last_newline;
+  if (last_newline == s) {
+    ring->line.append(s, size);
+    return n;
+  }
+  if (ring->line.empty()) {
+    state_->commit(*ring, s, static_cast<size_t>(last_newline - s));
+  } else {
+    ring->line.append(s, last_newline);
+    state_->commit(*ring, ring->line.data(), ring->line.size());
+    ring->line.clear();
+  }
+  ring->line.append(last_newline, end);
+  return n;
+}
+
+int log_sink_buf::sync() {
+  detail::log_ring *ring = detail::ring_of(*state_);
+  if (ring != nullptr && !ring->line.empty()) {
+    state_->commit(*ring, ring->line.data(), ring->line.size());
+    ring->line.clear();
+  }
+  state_->flush_requests.fetch_add(1, std::memory_order_release);
+  state_->wake.notify_one();
+  return 0;
+}
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace ocl_layer_utils {
+
+enum class log_format {
+  // Human readable messages, one per line.
+  text,
+  // One JSON object per line.
+  jsonl,
+  // Records made of a log_record_header and its payload.
+  binary
+};
+
+struct log_sink_options {
+  log_format format = log_format::text;
+  // Capacity in bytes of the buffer of each thread writing to the sink.
+  size_t buffer_size = 64 * 1024;
+  // Size in bytes after which the log file is rotated, 0 never rotates.
+  size_t max_file_size = 0;
+  // Number of rotated files kept, as <filename>.1 (newest) to <filename>.N.
+  unsigned max_files = 1;
+  // When not 0, log files are memory mapped rings of this many bytes that
+  // keep the most recent output even if the process is killed, see
+  // mapped_ring_buf. Rings are never rotated.
+  size_t ring_size = 0;
+  // Hand text over line by line. When false every write is handed over as
+  // a whole instead, which keeps binary records written at once together.
+  bool line_buffered = true;
+};
+
+// Reads the log_format, log_buffer_size, log_max_size, log_max_files and
+// log_ring_size settings.
+log_sink_options load_log_sink_options(const settings_parser &parser);
+
+namespace detail {
+struct log_sink_state;
+}
+
+// Stream buffer handing complete lines over to a background writer thread.
+//
+// Every thread writes to a lock-free ring buffer of its own, which the
+// writer drains to the target. When a ring is full the thread waits a
+// bounded amount of time for the writer to catch up, then drops the line;
+// the number of dropped lines is written out with the next batch. Flushing
+// only wakes the writer up; everything is written out synchronously by
+// drain() and when the buffer is destroyed.
+//
+// Files written to a ring (options.ring_size) skip the writer: complete
+// lines, or whole writes when not line buffered, are copied into the ring
+// by the thread writing them.
+class log_sink_buf : public std::streambuf {
+public:
+  // Writes to target, typically std::cout or std::cerr.
+  log_sink_buf(std::ostream &target, const log_sink_options &options);
+  // Writes to filename, rotating it or mapping it as a ring according to
+  // options.
+  log_sink_buf(const std::string &filename, const log_sink_options &options);
+  ~log_sink_buf() override;
+
+  log_sink_buf(const log_sink_buf &) = delete;
+  log_sink_buf &operator=(const log_sink_buf &) = delete;
+
+  // False if the log file could not be opened.
+  bool is_open() const;
+
+  // Writes everything buffered so far to the target and flushes it, for
+  // sinks that stay in use while the process exits. Writers are not
+  // interrupted.
+  void drain();
+
+  // Writes everything buffered so far to the current target, then switches
+  // over to target. Writers are not interrupted.
+  void retarget(std::ostream &target);
+  // As above, appending to filename. Leaves the current target in place and
+  // returns false if filename can not be opened.
+  bool retarget(const std::string &filename);
+
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+  int sync() override;
+
+private:
+  void start();
+  void start_writer();
+
+  std::unique_ptr<detail::log_sink_state> state_;
+};
+
+class log_sink_stream : public std::ostream {
+public:
+  log_sink_stream(std::ostream &target, const log_sink_options &options)
+      : std::ostream(nullptr), buf_(target, options) {
+    rdbuf(&buf_);
+  }
+
+  log_sink_stream(const std::string &filename, const log_sink_options &options)
+      : std::ostream(nullptr), buf_(filename, options) {
+    rdbuf(&buf_);
+  }
+
+  bool is_open() const { return buf_.is_open(); }
+
+  void retarget(std::ostream &target) { buf_.retarget(target); }
+  bool retarget(const std::string &filename) { return buf_.retarget(filename); }
+
+private:
+  log_sink_buf buf_;
+};
+
+} // namespace ocl_layer_utils
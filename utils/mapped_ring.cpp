@@ -0,0 +1,198 @@
+#include "mapped_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ocl_layer_utils {
+
+namespace {
+
+uint64_t align(uint64_t size) {
+  const uint64_t alignment = mapped_ring_header::frame_alignment;
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Stamps of frames must stay in one piece, so areas are made of whole
+// alignment units, which a stamp never straddles.
+static_assert(sizeof(mapped_ring_frame) == mapped_ring_header::frame_alignment,
+              "frame stamps must fill exactly one alignment unit");
+static_assert(sizeof(mapped_ring_header) % mapped_ring_header::frame_alignment == 0,
+              "areas must start aligned");
+
+// Reads the valid frames of an area from first to the cursor. Stamps that
+// do not match their position are stale or torn, the search for the next
+// frame resumes at the next alignment unit.
+void read_area(const char *area, uint64_t capacity, uint64_t first, uint64_t cursor,
+               std::string &data) {
+  for (uint64_t position = first; position < cursor;) {
+    const uint64_t offset = position % capacity;
+    mapped_ring_frame frame;
+    std::memcpy(&frame, area + offset, sizeof(frame));
+    const uint64_t size = align(sizeof(frame) + frame.size);
+    if (frame.magic != mapped_ring_frame::magic_value || frame.position != position ||
+        size > cursor - position) {
+      position += mapped_ring_header::frame_alignment;
+      continue;
+    }
+    for (uint64_t copied = 0; copied < frame.size;) {
+      const uint64_t from = (offset + sizeof(frame) + copied) % capacity;
+      const uint64_t chunk = std::min<uint64_t>(frame.size - copied, capacity - from);
+      data.append(area + from, chunk);
+      copied += chunk;
+    }
+    position += size;
+  }
+}
+
+} // namespace
+
+#if !defined(_WIN32)
+
+mapped_ring_buf::mapped_ring_buf(const std::string &filename, size_t ring_capacity,
+                                 size_t pinned_capacity) {
+  ring_capacity = align(ring_capacity < 1024 ? 1024 : ring_capacity);
+  pinned_capacity = align(pinned_capacity);
+  const size_t size = sizeof(mapped_ring_header) + pinned_capacity + ring_capacity;
+
+  const int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return;
+  // Blocks are allocated up front, running out of disk space while the
+  // mapping is written to would raise SIGBUS.
+  bool allocated = ftruncate(fd, static_cast<off_t>(size)) == 0;
+#if defined(__linux__)
+  allocated = allocated && posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0;
+#endif
+  void *mapping = allocated ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                            : MAP_FAILED;
+  close(fd);
+  if (mapping == MAP_FAILED)
+    return;
+
+  header_ = static_cast<mapped_ring_header *>(mapping);
+  mapping_size_ = size;
+  header_->version = 1;
+  header_->size = sizeof(mapped_ring_header);
+  header_->pinned_capacity = pinned_capacity;
+  header_->ring_capacity = ring_capacity;
+  header_->pinned_cursor = 0;
+  header_->ring_cursor = 0;
+  // Readers ignore the file until the rest of the header is in place.
+  __atomic_store_n(&header_->magic, mapped_ring_header::magic_value, __ATOMIC_RELEASE);
+}
+
+mapped_ring_buf::~mapped_ring_buf() {
+  // Unmapping does not discard anything, the kernel writes the pages back.
+  if (header_ != nullptr)
+    munmap(header_, mapping_size_);
+}
+
+namespace {
+
+// Reserves a frame for size bytes in the area, copies data into it and
+// stamps it. Frames wrap around the end of the ring area, the pinned area
+// never wraps.
+bool write_frame(char *area, uint64_t capacity, uint64_t &cursor, bool wrap,
+                 const char *data, size_t size) {
+  const uint64_t frame_size = align(sizeof(mapped_ring_frame) + size);
+  if (frame_size > (wrap ? capacity / 4 : capacity))
+    return false;
+
+  const uint64_t position = __atomic_fetch_add(&cursor, frame_size, __ATOMIC_RELAXED);
+  if (!wrap && position + frame_size > capacity)
+    return false;
+  const uint64_t offset = position % capacity;
+  for (uint64_t copied = 0; copied < size;) {
+    const uint64_t to = (offset + sizeof(mapped_ring_frame) + copied) % capacity;
+    const uint64_t chunk = std::min<uint64_t>(size - copied, capacity - to);
+    std::memcpy(area + to, data + copied, chunk);
+    copied += chunk;
+  }
+
+  // The position is stored last, a frame is only valid once it matches.
+  auto frame = reinterpret_cast<mapped_ring_frame *>(area + offset);
+  __atomic_store_n(&frame->magic, mapped_ring_frame::magic_value, __ATOMIC_RELAXED);
+  __atomic_store_n(&frame->size, static_cast<uint32_t>(size), __ATOMIC_RELAXED);
+  __atomic_store_n(&frame->position, position, __ATOMIC_RELEASE);
+  return true;
+}
+
+} // namespace
+
+bool mapped_ring_buf::pin(const char *data, size_t size) {
+  if (header_ == nullptr)
+    return false;
+  char *area = reinterpret_cast<char *>(header_ + 1);
+  return write_frame(area, header_->pinned_capacity, header_->pinned_cursor, false, data, size);
+}
+
+mapped_ring_buf::int_type mapped_ring_buf::overflow(int_type c) {
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  const char ch = traits_type::to_char_type(c);
+  return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+}
+
+std::streamsize mapped_ring_buf::xsputn(const char *s, std::streamsize n) {
+  if (header_ == nullptr)
+    return 0;
+  char *area = reinterpret_cast<char *>(header_ + 1) + header_->pinned_capacity;
+  // Dropped writes count as written, the ring makes no promise to keep
+  // anything in the first place.
+  write_frame(area, header_->ring_capacity, header_->ring_cursor, true, s,
+              static_cast<size_t>(n));
+  return n;
+}
+
+#else
+
+mapped_ring_buf::mapped_ring_buf(const std::string &, size_t, size_t) {}
+
+mapped_ring_buf::~mapped_ring_buf() = default;
+
+bool mapped_ring_buf::pin(const char *, size_t) { return false; }
+
+mapped_ring_buf::int_type mapped_ring_buf::overflow(int_type) { return traits_type::eof(); }
+
+std::streamsize mapped_ring_buf::xsputn(const char *, std::streamsize) { return 0; }
+
+#endif
+
+bool is_mapped_ring(const std::string &contents) {
+  mapped_ring_header header;
+  if (contents.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, contents.data(), sizeof(header));
+  return header.magic == mapped_ring_header::magic_value;
+}
+
+bool read_mapped_ring(const std::string &contents, std::string &data) {
+  data.clear();
+  if (!is_mapped_ring(contents))
+    return false;
+  mapped_ring_header header;
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (header.version != 1 || header.size != sizeof(header) ||
+      header.pinned_capacity % mapped_ring_header::frame_alignment != 0 ||
+      header.ring_capacity % mapped_ring_header::frame_alignment != 0 ||
+      header.ring_capacity == 0 ||
+      contents.size() - sizeof(header) < header.pinned_capacity ||
+      contents.size() - sizeof(header) - header.pinned_capacity < header.ring_capacity)
+    return false;
+
+  const char *pinned = contents.data() + sizeof(header);
+  read_area(pinned, header.pinned_capacity, 0,
+            std::min(header.pinned_cursor, header.pinned_capacity), data);
+  const uint64_t cursor = header.ring_cursor;
+  read_area(pinned + header.pinned_capacity, header.ring_capacity,
+            cursor > header.ring_capacity ? cursor - header.ring_capacity : 0, cursor, data);
+  return true;
+}
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+
+namespace ocl_layer_utils {
+
+// Layout of a mapped ring file: this header, a pinned area of
+// pinned_capacity bytes and a ring of ring_capacity bytes.
+//
+// Both areas hold frames of frame_alignment aligned size, made of a
+// mapped_ring_frame followed by the data handed over in one write. The
+// cursors count the bytes reserved in each area so far. The pinned area
+// keeps the data that must not be overwritten, such as format headers,
+// and stops taking data once full; the ring wraps around and only keeps
+// the most recent frames.
+struct mapped_ring_header {
+  static constexpr uint64_t magic_value = 0x31474e49524c43ull; // "CLRING1"
+  static constexpr uint32_t frame_alignment = 16;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint64_t pinned_capacity;
+  uint64_t ring_capacity;
+  uint64_t pinned_cursor;
+  uint64_t ring_cursor;
+  uint64_t reserved[2];
+};
+
+// A frame is only valid if it is stamped with the position it was written
+// at, which is stored last. Frames that were being written when the process
+// died, or that were partly overwritten, are skipped over when reading.
+struct mapped_ring_frame {
+  static constexpr uint32_t magic_value = 0x4d524643; // "CFRM"
+
+  uint32_t magic;
+  uint32_t size;
+  uint64_t position;
+};
+
+// Stream buffer writing to a memory mapped ring file.
+//
+// Every write is copied into the shared mapping right away, so whatever
+// was written is kept by the kernel even if the process is killed without
+// getting a chance to flush, and it is readable with read_mapped_ring().
+// Each write becomes one frame and is either kept whole or dropped whole;
+// writes larger than a quarter of the ring are dropped. Writers reserve
+// their frame with a single atomic add and never wait for each other.
+//
+// Memory mapped files are only supported on POSIX systems, elsewhere
+// is_open() is always false.
+class mapped_ring_buf : public std::streambuf {
+public:
+  // Creates or truncates filename, with ring_capacity rounded up to the
+  // frame alignment.
+  mapped_ring_buf(const std::string &filename, size_t ring_capacity,
+                  size_t pinned_capacity = 64 * 1024);
+  ~mapped_ring_buf() override;
+
+  mapped_ring_buf(const mapped_ring_buf &) = delete;
+  mapped_ring_buf &operator=(const mapped_ring_buf &) = delete;
+
+  // False if the file could not be created and mapped.
+  bool is_open() const { return header_ != nullptr; }
+
+  // Writes data to the pinned area, returns false if it is full.
+  bool pin(const char *data, size_t size);
+
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+private:
+  mapped_ring_header *header_ = nullptr;
+  size_t mapping_size_ = 0;
+};
+
+// Reads the pinned area of the ring file in contents, followed by what is
+// left in the ring, into data, frames in the order they were written.
+// Returns false if contents is not a ring file.
+bool read_mapped_ring(const std::string &contents, std::string &data);
+
+// True if contents starts like a ring file.
+bool is_mapped_ring(const std::string &contents);
+
+} // namespace ocl_layer_utils
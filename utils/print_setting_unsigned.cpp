@@ -0,0 +1,22 @@
+#include "utils.hpp"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+  if (argc <= 4) {
+    std::cerr << "usage: " << argv[0] << " <prefix> <setting> <default> <expected>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto settings = ocl_layer_utils::load_settings();
+  const auto parser =
+    ocl_layer_utils::settings_parser(argv[1], settings);
+
+  unsigned value = static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10));
+  parser.get_unsigned(argv[2], value);
+  std::cout << value << std::endl;
+
+  return value == std::strtoul(argv[4], nullptr, 10) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
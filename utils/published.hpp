@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ocl_layer_utils {
+
+// Publishes immutable values, such as dispatch tables or settings, to
+// concurrent readers without locking them. Values that were replaced are
+// kept alive, as readers may still be using them; publish is meant for
+// rare updates.
+template <typename T>
+class published {
+public:
+  // nullptr until the first value is published.
+  const T *get() const { return current_.load(std::memory_order_acquire); }
+
+  void publish(std::unique_ptr<T> value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_.store(value.get(), std::memory_order_release);
+    values_.push_back(std::move(value));
+  }
+
+private:
+  std::atomic<const T *> current_{nullptr};
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<T>> values_;
+};
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,82 @@
+#include "settings_watcher.hpp"
+#include "utils.hpp"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace ocl_layer_utils {
+
+#if defined(__linux__)
+
+bool settings_watcher::start(const std::string &path, callback on_change) {
+  if (path.empty() || thread_.joinable())
+    return false;
+
+  // Editors often replace the file instead of writing it in place, so the
+  // directory is watched rather than the file itself.
+  const auto slash = path.find_last_of('/');
+  const std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0)
+    return false;
+  if (inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  stop_.store(false, std::memory_order_relaxed);
+  thread_ = std::thread(&settings_watcher::run, this, path, std::move(on_change));
+  return true;
+}
+
+void settings_watcher::stop() {
+  stop_.store(true, std::memory_order_relaxed);
+  if (thread_.joinable())
+    thread_.join();
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void settings_watcher::run(std::string path, callback on_change) {
+  const auto slash = path.find_last_of('/');
+  const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+  alignas(inotify_event) char events[4096];
+  while (!stop_.load(std::memory_order_relaxed)) {
+    pollfd fd = {fd_, POLLIN, 0};
+    if (poll(&fd, 1, 100) <= 0)
+      continue;
+
+    bool changed = false;
+    ssize_t size;
+    while ((size = read(fd_, events, sizeof(events))) > 0) {
+      for (char *p = events; p < events + size;) {
+        const auto *event = reinterpret_cast<const inotify_event *>(p);
+        if (event->len != 0 && name == event->name)
+          changed = true;
+        p += sizeof(inotify_event) + event->len;
+      }
+    }
+    if (changed)
+      on_change(load_settings(path));
+  }
+}
+
+#else
+
+bool settings_watcher::start(const std::string &, callback) { return false; }
+
+void settings_watcher::stop() {}
+
+void settings_watcher::run(std::string, callback) {}
+
+#endif
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+namespace ocl_layer_utils {
+
+// Watches a settings file and hands its new contents over every time it is
+// written or replaced. Changes are picked up with inotify, on other
+// platforms start() fails and the settings are only read once.
+class settings_watcher {
+public:
+  using callback = std::function<void(const std::map<std::string, std::string> &)>;
+
+  settings_watcher() = default;
+  ~settings_watcher() { stop(); }
+
+  settings_watcher(const settings_watcher &) = delete;
+  settings_watcher &operator=(const settings_watcher &) = delete;
+
+  // Calls on_change from a background thread after each change to path.
+  // Returns false if path can not be watched.
+  bool start(const std::string &path, callback on_change);
+  void stop();
+
+private:
+  void run(std::string path, callback on_change);
+
+  int fd_ = -1;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+} // namespace ocl_layer_utils
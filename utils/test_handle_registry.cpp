@@ -0,0 +1,97 @@
+#include "handle_registry.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: "           \
+                << #condition << std::endl;                                    \
+      return EXIT_FAILURE;                                                     \
+    }                                                                          \
+  } while (false)
+
+namespace {
+
+struct payload {
+  std::string name;
+  int value;
+};
+
+void *fake_handle(size_t i) { return reinterpret_cast<void *>((i + 1) * 64); }
+
+} // namespace
+
+// Checks the reference counting and generations of handle_registry, then
+// creates, retains and releases handles from several threads and checks
+// that every registration is gone afterwards.
+int main() {
+  using registry = ocl_layer_utils::handle_registry<payload>;
+  registry handles;
+  void *a = fake_handle(0);
+  void *b = fake_handle(1);
+
+  const uint64_t first = handles.on_create(a, {"a", 1});
+  CHECK(handles.contains(a));
+  CHECK(handles.contains(a, first));
+  CHECK(!handles.contains(b));
+  CHECK(!handles.on_retain(b));
+  CHECK(!handles.on_release(b));
+
+  CHECK(handles.on_retain(a));
+  CHECK(handles.find(a, [](const registry::entry &) {}));
+  unsigned long refcount = 0;
+  handles.find(a, [&](const registry::entry &e) { refcount = e.refcount; });
+  CHECK(refcount == 2);
+
+  CHECK(handles.update(a, [](payload &p) { p.value = 42; }));
+  registry::entry released{};
+  CHECK(handles.on_release(a, &released));
+  CHECK(released.generation == 0);
+  CHECK(handles.on_release(a, &released));
+  CHECK(released.payload.name == "a" && released.payload.value == 42);
+  CHECK(released.generation == first);
+  CHECK(!handles.contains(a));
+
+  // the driver handing out a handle again is a new registration
+  const uint64_t second = handles.on_create(a, {"a again", 2});
+  CHECK(second != first);
+  CHECK(!handles.contains(a, first));
+  CHECK(handles.contains(a, second));
+  handles.on_create(b, {"b", 3});
+  size_t visited = 0;
+  handles.for_each([&](const void *handle, const registry::entry &e) {
+    ++visited;
+    if (handle == a && e.payload.value != 2)
+      visited = 100;
+  });
+  CHECK(visited == 2);
+  CHECK(handles.erase(a) && handles.erase(b));
+  CHECK(handles.size() == 0);
+
+  const size_t threads = 8, per_thread = 2000;
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&handles, t] {
+      for (size_t i = 0; i < per_thread; ++i) {
+        void *handle = fake_handle(t * per_thread + i);
+        handles.on_create(handle, {"", static_cast<int>(i)});
+        handles.on_retain(handle);
+      }
+      for (size_t i = 0; i < per_thread; ++i) {
+        void *handle = fake_handle(t * per_thread + i);
+        handles.on_release(handle);
+        handles.on_release(handle);
+      }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+  CHECK(handles.size() == 0);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#include "latency_histogram.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using ocl_layer_utils::latency_histogram;
+
+namespace {
+
+bool check(const char *what, uint64_t value, uint64_t expected) {
+  // Buckets are 1/32 of a power of two wide.
+  const uint64_t tolerance = expected / 32 + 1;
+  if (value + tolerance < expected || value > expected + tolerance) {
+    std::cerr << "error: " << what << " is " << value << ", expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+// Records known distributions, split over two histograms, and checks the
+// percentiles of their merge against the exact ones.
+int main() {
+  for (uint64_t value = 0; value < 1000000; value += 7) {
+    const uint64_t highest = latency_histogram::highest_value(latency_histogram::bucket(value));
+    if (highest < value || highest - value > value / 32) {
+      std::cerr << "error: " << value << " falls in a bucket up to " << highest << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::unique_ptr<latency_histogram> even(new latency_histogram);
+  std::unique_ptr<latency_histogram> odd(new latency_histogram);
+  for (uint64_t value = 1; value <= 100000; ++value)
+    (value % 2 == 0 ? *even : *odd).record(value * 10);
+  std::unique_ptr<latency_histogram> merged(new latency_histogram);
+  merged->merge(*even);
+  merged->merge(*odd);
+
+  bool ok = merged->count() == 100000 && merged->max() == 1000000 &&
+            merged->total() == 10 * (100000ull * 100001 / 2);
+  if (!ok)
+    std::cerr << "error: merged " << merged->count() << " values up to " << merged->max()
+              << " adding up to " << merged->total() << std::endl;
+  ok = check("p50", merged->value_at_percentile(50.0), 500000) && ok;
+  ok = check("p99", merged->value_at_percentile(99.0), 990000) && ok;
+  ok = check("p999", merged->value_at_percentile(99.9), 999000) && ok;
+  ok = check("p100", merged->value_at_percentile(100.0), 1000000) && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,72 @@
+#include "log_sink.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes lines piecewise from several threads to a rotated log, then checks
+// that rotation kept at most the configured number of files and that no line was
+// torn apart by concurrent writers.
+int main(int argc, char* argv[]) {
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <filename>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string filename = argv[1];
+  for (const char* suffix : {"", ".1", ".2", ".3"})
+    std::remove((filename + suffix).c_str());
+
+  ocl_layer_utils::log_sink_options options;
+  options.max_file_size = 4096;
+  options.max_files = 2;
+  {
+    ocl_layer_utils::log_sink_stream stream(filename, options);
+    if (!stream.is_open()) {
+      std::cerr << "error: could not open " << filename << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&stream, t] {
+        for (int i = 0; i < 200; ++i) {
+          stream << "thread " << t << " line " << i << '\n';
+          if (i % 50 == 0)
+            stream.flush();
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  const std::regex line_regex("thread [0-3] line [0-9]+");
+  for (const char* suffix : {"", ".1", ".2"}) {
+    std::ifstream file(filename + suffix);
+    if (!file.good()) {
+      // Rotation happens between batches, the log itself always exists
+      // and at least one rotation took place.
+      if (suffix[0] == '\0' || suffix[1] == '1') {
+        std::cerr << "error: missing " << filename << suffix << std::endl;
+        return EXIT_FAILURE;
+      }
+      continue;
+    }
+    for (std::string line; std::getline(file, line);) {
+      if (!std::regex_match(line, line_regex)) {
+        std::cerr << "error: malformed line in " << filename << suffix << ": " << line << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  if (std::ifstream(filename + ".3").good()) {
+    std::cerr << "error: more than " << options.max_files << " rotated files were kept" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
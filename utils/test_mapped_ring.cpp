@@ -0,0 +1,145 @@
+#include "log_sink.hpp"
+#include "mapped_ring.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool read_ring(const std::string &filename, std::string &data) {
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  return ocl_layer_utils::read_mapped_ring(contents, data);
+}
+
+// Checks that data is made of whole "thread <t> line <i>" lines, in the
+// order each thread wrote them, and returns how many there are.
+bool check_lines(const std::string &data, size_t &count) {
+  const std::regex line_regex("thread ([0-3]) line ([0-9]+)");
+  std::istringstream lines(data);
+  int last[4] = {-1, -1, -1, -1};
+  count = 0;
+  for (std::string line; std::getline(lines, line); ++count) {
+    std::smatch match;
+    if (!std::regex_match(line, match, line_regex)) {
+      std::cerr << "error: malformed line: " << line << std::endl;
+      return false;
+    }
+    const int t = std::stoi(match[1]);
+    const int i = std::stoi(match[2]);
+    if (i <= last[t]) {
+      std::cerr << "error: out of order line: " << line << std::endl;
+      return false;
+    }
+    last[t] = i;
+  }
+  return true;
+}
+
+} // namespace
+
+// Wraps lines written from several threads around a small ring and checks
+// that only whole lines are read back, in the order each thread wrote
+// them, directly and through a log sink. Then kills a child process writing
+// to a ring and checks that its last lines made it to the file.
+int main(int argc, char *argv[]) {
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <filename>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string filename = argv[1];
+  std::remove(filename.c_str());
+
+  {
+    ocl_layer_utils::mapped_ring_buf ring(filename, 4096);
+    if (!ring.is_open()) {
+      std::cerr << "error: could not create " << filename << std::endl;
+      return EXIT_FAILURE;
+    }
+    ring.pin("pinned\n", 7);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&ring, t] {
+        for (int i = 0; i < 2000; ++i) {
+          const std::string line = "thread " + std::to_string(t) + " line " + std::to_string(i) + '\n';
+          ring.sputn(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  std::string data;
+  if (!read_ring(filename, data) || data.compare(0, 7, "pinned\n") != 0) {
+    std::cerr << "error: could not read the pinned data back" << std::endl;
+    return EXIT_FAILURE;
+  }
+  size_t count = 0;
+  if (!check_lines(data.substr(7), count))
+    return EXIT_FAILURE;
+  // Frames of these lines take 48 bytes, 4096 bytes keep about 85 of them.
+  if (count < 64 || count > 4096 / 32) {
+    std::cerr << "error: read " << count << " lines back" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Log sinks hand whole lines over to the ring, however they are written.
+  std::remove(filename.c_str());
+  {
+    ocl_layer_utils::log_sink_options options;
+    options.ring_size = 4096;
+    ocl_layer_utils::log_sink_stream stream(filename, options);
+    if (!stream.is_open()) {
+      std::cerr << "error: could not map a log sink to " << filename << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&stream, t] {
+        for (int i = 0; i < 2000; ++i)
+          stream << "thread " << t << " line " << i << '\n';
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+  }
+  if (!read_ring(filename, data) || !check_lines(data, count))
+    return EXIT_FAILURE;
+  if (count < 64 || count > 4096 / 32) {
+    std::cerr << "error: read " << count << " lines back from the log sink" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::remove(filename.c_str());
+  const pid_t child = fork();
+  if (child == 0) {
+    ocl_layer_utils::mapped_ring_buf ring(filename, 4096);
+    for (int i = 0; i < 10000; ++i) {
+      const std::string line = "line " + std::to_string(i) + '\n';
+      ring.sputn(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    raise(SIGKILL);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!read_ring(filename, data) || data.size() < 10 ||
+      data.compare(data.size() - 10, 10, "line 9999\n") != 0) {
+    std::cerr << "error: the last lines of a killed process were lost" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -9,6 +9,9 @@ target_link_libraries(print_setting_bool PRIVATE LayersUtils LayersCommon)
 add_executable(print_setting_enum print_setting_enum.cpp)
 target_link_libraries(print_setting_enum PRIVATE LayersUtils LayersCommon)
 
+add_executable(print_setting_unsigned print_setting_unsigned.cpp)
+target_link_libraries(print_setting_unsigned PRIVATE LayersUtils LayersCommon)
+
 function(test_settings)
   cmake_parse_arguments(PARSE_ARGV 0 ARG "" "NAME;SETTINGS;SETTING;SETTING_TYPE;DEFAULT;EXPECTED" "ENVIRONMENT;VARIANTS")
 
@@ -28,6 +31,8 @@ function(test_settings)
     set(TEST_EXE $<TARGET_FILE:print_setting_filename>)
   elseif(ARG_SETTING_TYPE STREQUAL "enum")
     set(TEST_EXE $<TARGET_FILE:print_setting_enum>)
+  elseif(ARG_SETTING_TYPE STREQUAL "unsigned")
+    set(TEST_EXE $<TARGET_FILE:print_setting_unsigned>)
   else()
     message(FATAL_ERROR "invalid setting type ${SETTING_TYPE}")
   endif()
@@ -298,3 +303,22 @@ test_settings(
   ENVIRONMENT OPENCL_TEST_LAYER_TEST_SETTING=invalid
 )
 
+
+test_settings(
+  NAME Settings-Config-Unsigned
+  SETTING_TYPE unsigned
+  SETTINGS "test_layer.test_setting=25"
+  SETTING test_layer.test_setting
+  DEFAULT 10
+  EXPECTED 25
+)
+
+test_settings(
+  NAME Settings-Unsigned-Invalid-Override
+  SETTING_TYPE unsigned
+  SETTINGS "test_layer.test_setting=25"
+  SETTING test_layer.test_setting
+  DEFAULT 10
+  EXPECTED 25
+  ENVIRONMENT OPENCL_TEST_LAYER_TEST_SETTING=-1
+)
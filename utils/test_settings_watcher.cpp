@@ -0,0 +1,57 @@
+#include "settings_watcher.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// Changes a watched settings file in place and by replacing it, and checks
+// that every change is picked up.
+int main(int argc, char* argv[]) {
+  if (argc <= 1) {
+    std::cerr << "usage: " << argv[0] << " <filename>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string filename = argv[1];
+  const std::string replacement = filename + ".new";
+  std::ofstream(filename) << "test.value = 0\n";
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::string value;
+  ocl_layer_utils::settings_watcher watcher;
+  const bool started = watcher.start(filename, [&](const std::map<std::string, std::string>& settings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = settings.find("test.value");
+    value = it != settings.end() ? it->second : "";
+    changed.notify_all();
+  });
+  if (!started) {
+    std::cerr << "error: could not watch " << filename << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto expect = [&](const std::string& expected) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!changed.wait_for(lock, std::chrono::seconds(10), [&] { return value == expected; })) {
+      std::cerr << "error: expected test.value = " << expected << ", got '" << value << "'" << std::endl;
+      return false;
+    }
+    return true;
+  };
+
+  std::ofstream(filename) << "test.value = 1\n";
+  if (!expect("1"))
+    return EXIT_FAILURE;
+
+  std::ofstream(replacement) << "# replaced\ntest.value = 2\n";
+  std::rename(replacement.c_str(), filename.c_str());
+  if (!expect("2"))
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
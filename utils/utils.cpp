@@ -1,7 +1,9 @@
 #include "utils.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <limits>
 #include <locale>
 #include <map>
 #include <string>
@@ -133,6 +135,16 @@ void parse_bool(const std::string &option, bool &out) {
   }
 }
 
+void parse_unsigned(const std::string &option, unsigned &out) {
+  if (option.empty() || option.find_first_not_of("0123456789") != std::string::npos) {
+    return;
+  }
+  const unsigned long value = std::strtoul(option.c_str(), nullptr, 10);
+  if (value <= std::numeric_limits<unsigned>::max()) {
+    out = static_cast<unsigned>(value);
+  }
+}
+
 } // namespace detail
 
 std::string find_settings() {
@@ -218,8 +230,12 @@ std::string find_settings() {
 }
 
 std::map<std::string, std::string> load_settings() {
+  return load_settings(find_settings());
+}
+
+std::map<std::string, std::string> load_settings(const std::string &path) {
   auto result = std::map<std::string, std::string>{};
-  auto file = std::ifstream{find_settings()};
+  auto file = std::ifstream{path};
   if (!file.good()) {
     return result;
   }
@@ -250,6 +266,24 @@ void settings_parser::get_filename(const char *option_name, std::string &out) co
   });
 }
 
+void settings_parser::get_unsigned(const char *option_name, unsigned &out) const {
+  get_option(option_name, [&out](const std::string &value) {
+    detail::parse_unsigned(value, out);
+  });
+}
+
+void settings_parser::get_list(const char *option_name, std::vector<std::string> &out) const {
+  get_option(option_name, [&out](const std::string &value) {
+    out.clear();
+    std::stringstream items(value);
+    for (std::string item; std::getline(items, item, ',');) {
+      item = detail::trim(item);
+      if (!item.empty())
+        out.push_back(std::move(item));
+    }
+  });
+}
+
 cl_version parse_cl_version_string(const char* version_str, cl_version* parsed_version) {
   std::stringstream ss;
   ss << version_str;
@@ -1,5 +1,8 @@
+#pragma once
+
 #include <map>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <memory>
 #include <CL/cl.h>
@@ -24,6 +27,7 @@ bool get_environment(const std::string& variable, std::string& value);
 std::string find_settings();
 
 std::map<std::string, std::string> load_settings();
+std::map<std::string, std::string> load_settings(const std::string &path);
 
 struct settings_parser {
   settings_parser(std::string prefix,
@@ -32,6 +36,9 @@ struct settings_parser {
 
   void get_bool(const char *option_name, bool &out) const;
   void get_filename(const char *option_name, std::string &out) const;
+  void get_unsigned(const char *option_name, unsigned &out) const;
+  // Comma separated list, surrounding whitespace and empty items are dropped.
+  void get_list(const char *option_name, std::vector<std::string> &out) const;
 
   template <typename T>
   void get_enumeration(const char *option_name,
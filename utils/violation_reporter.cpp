@@ -0,0 +1,159 @@
+#include "violation_reporter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+namespace ocl_layer_utils {
+
+namespace {
+
+void append_json_string(std::string &out, const char *s, size_t n) {
+  out += '"';
+  for (size_t i = 0; i < n; ++i) {
+    const char c = s[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+} // namespace
+
+void violation_reporter::init(std::ostream *stream, unsigned limit,
+                              log_format format, clock::duration interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stream_ = stream;
+  limit_ = limit;
+  format_ = format;
+  interval_ = interval;
+  last_flush_ = clock::now();
+}
+
+void violation_reporter::set_limit(unsigned limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  limit_ = limit;
+}
+
+void violation_reporter::summarize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stream_ == nullptr)
+    return;
+  flush(clock::now());
+  // Flushing a log sink only wakes its writer up, which may not get to run
+  // again when this is called at exit.
+  if (auto sink = dynamic_cast<log_sink_buf *>(stream_->rdbuf()))
+    sink->drain();
+}
+
+void violation_reporter::flush_if_due() {
+  const auto now = clock::now();
+  if (now - last_flush_ < interval_)
+    return;
+  flush(now);
+}
+
+void violation_reporter::flush(clock::time_point now) {
+  last_flush_ = now;
+  write_summary();
+  if (pending_) {
+    stream_->flush();
+    pending_ = false;
+  }
+}
+
+void violation_reporter::write_summary() {
+  for (auto &kv : entries_) {
+    entry &e = kv.second;
+    if (e.suppressed == 0)
+      continue;
+    if (format_ == log_format::text) {
+      *stream_ << "In ";
+      stream_->write(e.function, e.function_length)
+          << ": " << e.suppressed << " more occurrence"
+          << (e.suppressed == 1 ? "" : "s") << " of: " << e.rule << '\n';
+    } else {
+      write_record(log_record_header::summary_kind, e.function,
+                   e.function_length, e.rule, {}, e.error, e.suppressed);
+    }
+    e.suppressed = 0;
+    pending_ = true;
+  }
+}
+
+void violation_reporter::write_record(log_record_header::kind_type kind,
+                                      const char *function,
+                                      size_t function_length, const char *rule,
+                                      std::initializer_list<const void *> handles,
+                                      cl_int error, unsigned long long count) {
+  const auto timestamp = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  const auto thread = static_cast<uint64_t>(
+      std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+  record_.clear();
+  if (format_ == log_format::binary) {
+    log_record_header header;
+    header.magic = log_record_header::magic_value;
+    header.kind = kind;
+    header.num_handles = static_cast<uint8_t>(std::min<size_t>(handles.size(), UINT8_MAX));
+    header.function_length = static_cast<uint16_t>(function_length);
+    header.rule_length = static_cast<uint32_t>(std::char_traits<char>::length(rule));
+    header.error = error;
+    header.timestamp = timestamp;
+    header.thread = thread;
+    header.count = count;
+    record_.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    record_.append(function, header.function_length);
+    record_.append(rule, header.rule_length);
+    size_t written = 0;
+    for (const void *handle : handles) {
+      if (written++ == header.num_handles)
+        break;
+      const auto value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+      record_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+  } else {
+    record_ += "{\"time\":";
+    record_ += std::to_string(timestamp);
+    record_ += ",\"thread\":";
+    record_ += std::to_string(thread);
+    record_ += ",\"api\":";
+    append_json_string(record_, function, function_length);
+    record_ += ",\"rule\":";
+    append_json_string(record_, rule, std::char_traits<char>::length(rule));
+    if (kind == log_record_header::violation_kind) {
+      record_ += ",\"handles\":[";
+      for (const void *handle : handles) {
+        char value[32];
+        std::snprintf(value, sizeof(value), "\"0x%llx\",",
+                      static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(handle)));
+        record_ += value;
+      }
+      if (record_.back() == ',')
+        record_.back() = ']';
+      else
+        record_ += ']';
+    } else {
+      record_ += ",\"suppressed\":";
+      record_ += std::to_string(count);
+    }
+    record_ += ",\"error\":";
+    record_ += std::to_string(error);
+    record_ += "}\n";
+  }
+  stream_->write(record_.data(), static_cast<std::streamsize>(record_.size()));
+}
+
+} // namespace ocl_layer_utils
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "log_sink.hpp"
+
+#include <CL/cl.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace ocl_layer_utils {
+
+// A violation detected by a layer.
+struct violation {
+  const char *function;
+  size_t function_length;
+  // Identifies the rule that was broken, string literals are keyed by
+  // address. In text form the message is "In <function>: <rule>".
+  const char *rule;
+  // Handles the call was made with.
+  std::initializer_list<const void *> handles;
+  // Error returned to the application.
+  cl_int error;
+};
+
+// Binary records are a native endian header followed by the function name,
+// the rule and num_handles 64-bit handle values.
+struct log_record_header {
+  static constexpr uint32_t magic_value = 0x524c4c43; // "CLLR"
+  enum kind_type : uint8_t { violation_kind = 0, summary_kind = 1 };
+
+  uint32_t magic;
+  uint8_t kind;
+  uint8_t num_handles;
+  uint16_t function_length;
+  uint32_t rule_length;
+  int32_t error;
+  // Nanoseconds since the epoch.
+  uint64_t timestamp;
+  uint64_t thread;
+  // 1 for violations, the number of suppressed occurrences for summaries.
+  uint64_t count;
+};
+
+// Deduplicates and rate-limits the violations reported by a layer.
+//
+// Violations are keyed by the function they were detected in and the rule
+// that was broken. The first `limit` occurrences of a key are written out
+// in full, the remaining ones are only counted and summarized once per
+// `interval` and when summarize() is called, typically at exit. The stream
+// is flushed at the same points instead of after every message.
+class violation_reporter {
+public:
+  using clock = std::chrono::steady_clock;
+
+  // A limit of 0 writes out every occurrence.
+  void init(std::ostream *stream, unsigned limit,
+            log_format format = log_format::text,
+            clock::duration interval = std::chrono::seconds(1));
+
+  log_format format() const { return format_; }
+
+  // Applies to later reports, occurrences counted so far are kept.
+  void set_limit(unsigned limit);
+
+  // Reports v. In text format write(std::ostream&) is called to print the
+  // full message, unless the limit for this key has already been reached.
+  template <typename Write>
+  void report(const violation &v, Write &&write) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &entry = entries_[key(v.function, v.rule)];
+    if (entry.function == nullptr) {
+      entry.function = v.function;
+      entry.function_length = v.function_length;
+      entry.rule = v.rule;
+      entry.error = v.error;
+    }
+    if (limit_ == 0 || entry.count++ < limit_) {
+      if (format_ == log_format::text)
+        write(*stream_);
+      else
+        write_record(log_record_header::violation_kind, v.function,
+                     v.function_length, v.rule, v.handles, v.error, 1);
+      pending_ = true;
+    } else {
+      ++entry.suppressed;
+    }
+    flush_if_due();
+  }
+
+  // Reports a violation whose text message is "In <function>: <rule>".
+  void report(const violation &v) {
+    report(v, [&](std::ostream &out) {
+      out << "In ";
+      out.write(v.function, v.function_length) << ": " << v.rule << '\n';
+    });
+  }
+
+  // Writes out the counts of all suppressed violations and flushes, log
+  // sinks are drained before returning. Safe to call from exit handlers.
+  void summarize();
+
+private:
+  struct entry {
+    const char *function = nullptr;
+    size_t function_length = 0;
+    const char *rule = nullptr;
+    cl_int error = CL_SUCCESS;
+    unsigned long long count = 0;
+    unsigned long long suppressed = 0;
+  };
+  using key = std::pair<const char *, const char *>;
+
+  void flush_if_due();
+  void flush(clock::time_point now);
+  void write_summary();
+  void write_record(log_record_header::kind_type kind, const char *function,
+                    size_t function_length, const char *rule,
+                    std::initializer_list<const void *> handles, cl_int error,
+                    unsigned long long count);
+
+  std::mutex mutex_;
+  std::ostream *stream_ = nullptr;
+  unsigned limit_ = 0;
+  log_format format_ = log_format::text;
+  clock::duration interval_ = std::chrono::seconds(1);
+  clock::time_point last_flush_;
+  bool pending_ = false;
+  std::map<key, entry> entries_;
+  std::string record_;
+};
+
+} // namespace ocl_layer_utils